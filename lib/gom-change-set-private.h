@@ -0,0 +1,45 @@
+/* gom-change-set-private.h
+ *
+ * Copyright 2026 Christian Hergert <christian@sourceandstack.com>
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of the
+ * License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include "gom-change-set.h"
+#include "gom-types-private.h"
+
+G_BEGIN_DECLS
+
+GomChangeSet *_gom_change_set_new          (void);
+void          _gom_change_set_add          (GomChangeSet *self,
+                                            const char   *relation,
+                                            GomDeltaKind  kind,
+                                            const GValue *identity);
+void          _gom_change_set_add_rowid    (GomChangeSet *self,
+                                            const char   *relation,
+                                            GomDeltaKind  kind,
+                                            gint64        rowid);
+void          _gom_change_set_set_identity (GomChangeSet *self,
+                                            guint         index,
+                                            const GValue *identity);
+void          _gom_change_set_append       (GomChangeSet *self,
+                                            GomChangeSet *other);
+void          _gom_change_set_truncate     (GomChangeSet *self,
+                                            guint         n_changes);
+
+G_END_DECLS
@@ -0,0 +1,370 @@
+/* gom-change-set.c
+ *
+ * Copyright 2026 Christian Hergert <christian@sourceandstack.com>
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of the
+ * License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include "config.h"
+
+#include "gom-change-set-private.h"
+
+/**
+ * GomChangeSet:
+ *
+ * The rows changed by a committed transaction.
+ *
+ * Each change names the relation that was written, the kind of change and,
+ * when the backend can report it, the rowid and identity of the row.
+ * Change sets are delivered by [signal@Gom.Repository::changes-committed]
+ * and are immutable.
+ */
+
+typedef struct
+{
+  const char   *relation;
+  GValue        identity;
+  gint64        rowid;
+  GomDeltaKind  kind;
+  guint         has_rowid : 1;
+} GomChange;
+
+struct _GomChangeSet
+{
+  GObject  parent_instance;
+  GArray  *changes;
+};
+
+struct _GomChangeSetClass
+{
+  GObjectClass parent_class;
+};
+
+G_DEFINE_FINAL_TYPE (GomChangeSet, gom_change_set, G_TYPE_OBJECT)
+
+static void
+gom_change_clear (gpointer data)
+{
+  GomChange *change = data;
+
+  if (G_IS_VALUE (&change->identity))
+    g_value_unset (&change->identity);
+}
+
+static void
+gom_change_set_finalize (GObject *object)
+{
+  GomChangeSet *self = GOM_CHANGE_SET (object);
+
+  g_clear_pointer (&self->changes, g_array_unref);
+
+  G_OBJECT_CLASS (gom_change_set_parent_class)->finalize (object);
+}
+
+static void
+gom_change_set_class_init (GomChangeSetClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = gom_change_set_finalize;
+}
+
+static void
+gom_change_set_init (GomChangeSet *self)
+{
+  self->changes = g_array_new (FALSE, TRUE, sizeof (GomChange));
+  g_array_set_clear_func (self->changes, gom_change_clear);
+}
+
+static inline const GomChange *
+gom_change_set_get_change (GomChangeSet *self,
+                           guint         index)
+{
+  if (index >= self->changes->len)
+    return NULL;
+
+  return &g_array_index (self->changes, GomChange, index);
+}
+
+GomChangeSet *
+_gom_change_set_new (void)
+{
+  return g_object_new (GOM_TYPE_CHANGE_SET, NULL);
+}
+
+static GomChange *
+gom_change_set_push (GomChangeSet *self,
+                     const char   *relation,
+                     GomDeltaKind  kind)
+{
+  GomChange *change;
+
+  g_array_set_size (self->changes, self->changes->len + 1);
+
+  change = &g_array_index (self->changes, GomChange, self->changes->len - 1);
+  change->relation = g_intern_string (relation);
+  change->kind = kind;
+
+  return change;
+}
+
+void
+_gom_change_set_add (GomChangeSet *self,
+                     const char   *relation,
+                     GomDeltaKind  kind,
+                     const GValue *identity)
+{
+  GomChange *change;
+
+  g_return_if_fail (GOM_IS_CHANGE_SET (self));
+  g_return_if_fail (relation != NULL);
+
+  change = gom_change_set_push (self, relation, kind);
+
+  if (identity != NULL && G_IS_VALUE (identity))
+    {
+      g_value_init (&change->identity, G_VALUE_TYPE (identity));
+      g_value_copy (identity, &change->identity);
+    }
+}
+
+void
+_gom_change_set_add_rowid (GomChangeSet *self,
+                           const char   *relation,
+                           GomDeltaKind  kind,
+                           gint64        rowid)
+{
+  GomChange *change;
+
+  g_return_if_fail (GOM_IS_CHANGE_SET (self));
+  g_return_if_fail (relation != NULL);
+
+  change = gom_change_set_push (self, relation, kind);
+  change->rowid = rowid;
+  change->has_rowid = TRUE;
+}
+
+/* Used by the repository to fill in identities the backend could only
+ * report as a rowid, before the change set is delivered.
+ */
+void
+_gom_change_set_set_identity (GomChangeSet *self,
+                              guint         index,
+                              const GValue *identity)
+{
+  GomChange *change;
+
+  g_return_if_fail (GOM_IS_CHANGE_SET (self));
+  g_return_if_fail (index < self->changes->len);
+  g_return_if_fail (G_IS_VALUE (identity));
+
+  change = &g_array_index (self->changes, GomChange, index);
+
+  if (G_IS_VALUE (&change->identity))
+    g_value_unset (&change->identity);
+
+  g_value_init (&change->identity, G_VALUE_TYPE (identity));
+  g_value_copy (identity, &change->identity);
+}
+
+void
+_gom_change_set_append (GomChangeSet *self,
+                        GomChangeSet *other)
+{
+  g_return_if_fail (GOM_IS_CHANGE_SET (self));
+  g_return_if_fail (GOM_IS_CHANGE_SET (other));
+
+  for (guint i = 0; i < other->changes->len; i++)
+    {
+      const GomChange *src = &g_array_index (other->changes, GomChange, i);
+      GomChange *dest = gom_change_set_push (self, src->relation, src->kind);
+
+      dest->rowid = src->rowid;
+      dest->has_rowid = src->has_rowid;
+
+      if (G_IS_VALUE (&src->identity))
+        {
+          g_value_init (&dest->identity, G_VALUE_TYPE (&src->identity));
+          g_value_copy (&src->identity, &dest->identity);
+        }
+    }
+}
+
+/* Drops changes recorded after the first @n_changes, such as those of a
+ * statement or savepoint that was rolled back.
+ */
+void
+_gom_change_set_truncate (GomChangeSet *self,
+                          guint         n_changes)
+{
+  g_return_if_fail (GOM_IS_CHANGE_SET (self));
+
+  if (n_changes < self->changes->len)
+    g_array_set_size (self->changes, n_changes);
+}
+
+/**
+ * gom_change_set_get_n_changes:
+ * @self: a [class@Gom.ChangeSet]
+ *
+ * Gets the number of changed rows in @self.
+ *
+ * Returns: the number of changes
+ */
+guint
+gom_change_set_get_n_changes (GomChangeSet *self)
+{
+  g_return_val_if_fail (GOM_IS_CHANGE_SET (self), 0);
+
+  return self->changes->len;
+}
+
+/**
+ * gom_change_set_get_relation:
+ * @self: a [class@Gom.ChangeSet]
+ * @index: the index of the change
+ *
+ * Gets the relation (table) that was written by the change at @index.
+ *
+ * Returns: (nullable): the relation name, or %NULL if @index is out of range
+ */
+const char *
+gom_change_set_get_relation (GomChangeSet *self,
+                             guint         index)
+{
+  const GomChange *change;
+
+  g_return_val_if_fail (GOM_IS_CHANGE_SET (self), NULL);
+
+  if (!(change = gom_change_set_get_change (self, index)))
+    return NULL;
+
+  return change->relation;
+}
+
+/**
+ * gom_change_set_get_kind:
+ * @self: a [class@Gom.ChangeSet]
+ * @index: the index of the change
+ *
+ * Gets whether the row at @index was inserted, updated or deleted.
+ *
+ * Returns: the kind of change
+ */
+GomDeltaKind
+gom_change_set_get_kind (GomChangeSet *self,
+                         guint         index)
+{
+  const GomChange *change;
+
+  g_return_val_if_fail (GOM_IS_CHANGE_SET (self), GOM_DELTA_KIND_UPDATE);
+
+  if (!(change = gom_change_set_get_change (self, index)))
+    return GOM_DELTA_KIND_UPDATE;
+
+  return change->kind;
+}
+
+/**
+ * gom_change_set_get_rowid:
+ * @self: a [class@Gom.ChangeSet]
+ * @index: the index of the change
+ * @rowid: (out) (optional): location for the rowid
+ *
+ * Gets the rowid of the row changed at @index.
+ *
+ * Only backends with rowids, such as SQLite, report them.
+ *
+ * Returns: %TRUE if the change has a rowid
+ */
+gboolean
+gom_change_set_get_rowid (GomChangeSet *self,
+                          guint         index,
+                          gint64       *rowid)
+{
+  const GomChange *change;
+
+  g_return_val_if_fail (GOM_IS_CHANGE_SET (self), FALSE);
+
+  if (!(change = gom_change_set_get_change (self, index)) || !change->has_rowid)
+    return FALSE;
+
+  if (rowid != NULL)
+    *rowid = change->rowid;
+
+  return TRUE;
+}
+
+/**
+ * gom_change_set_get_identity:
+ * @self: a [class@Gom.ChangeSet]
+ * @index: the index of the change
+ * @value: an uninitialized [struct@GObject.Value]
+ *
+ * Gets the identity of the row changed at @index.
+ *
+ * The identity is known for relations mapped by an entity with a single
+ * identity property. On SQLite it is only known when that property is an
+ * integer, which makes it an alias for the rowid.
+ *
+ * Returns: %TRUE if @value was set to the identity of the row
+ */
+gboolean
+gom_change_set_get_identity (GomChangeSet *self,
+                             guint         index,
+                             GValue       *value)
+{
+  const GomChange *change;
+
+  g_return_val_if_fail (GOM_IS_CHANGE_SET (self), FALSE);
+  g_return_val_if_fail (value != NULL, FALSE);
+
+  if (!(change = gom_change_set_get_change (self, index)) ||
+      !G_IS_VALUE (&change->identity))
+    return FALSE;
+
+  g_value_init (value, G_VALUE_TYPE (&change->identity));
+  g_value_copy (&change->identity, value);
+
+  return TRUE;
+}
+
+/**
+ * gom_change_set_contains_relation:
+ * @self: a [class@Gom.ChangeSet]
+ * @relation: a relation name
+ *
+ * Checks whether any row of @relation was changed.
+ *
+ * Returns: %TRUE if @self has a change for @relation
+ */
+gboolean
+gom_change_set_contains_relation (GomChangeSet *self,
+                                  const char   *relation)
+{
+  g_return_val_if_fail (GOM_IS_CHANGE_SET (self), FALSE);
+  g_return_val_if_fail (relation != NULL, FALSE);
+
+  for (guint i = 0; i < self->changes->len; i++)
+    {
+      const char *changed = g_array_index (self->changes, GomChange, i).relation;
+
+      if (changed == relation || g_str_equal (changed, relation))
+        return TRUE;
+    }
+
+  return FALSE;
+}
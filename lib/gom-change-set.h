@@ -0,0 +1,55 @@
+/* gom-change-set.h
+ *
+ * Copyright 2026 Christian Hergert <christian@sourceandstack.com>
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of the
+ * License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include <glib-object.h>
+
+#include "gom-types.h"
+#include "gom-version-macros.h"
+
+G_BEGIN_DECLS
+
+#define GOM_TYPE_CHANGE_SET (gom_change_set_get_type())
+
+GOM_AVAILABLE_IN_ALL
+G_DECLARE_FINAL_TYPE (GomChangeSet, gom_change_set, GOM, CHANGE_SET, GObject)
+
+GOM_AVAILABLE_IN_ALL
+guint         gom_change_set_get_n_changes      (GomChangeSet *self);
+GOM_AVAILABLE_IN_ALL
+const char   *gom_change_set_get_relation       (GomChangeSet *self,
+                                                 guint         index);
+GOM_AVAILABLE_IN_ALL
+GomDeltaKind  gom_change_set_get_kind           (GomChangeSet *self,
+                                                 guint         index);
+GOM_AVAILABLE_IN_ALL
+gboolean      gom_change_set_get_rowid          (GomChangeSet *self,
+                                                 guint         index,
+                                                 gint64       *rowid);
+GOM_AVAILABLE_IN_ALL
+gboolean      gom_change_set_get_identity       (GomChangeSet *self,
+                                                 guint         index,
+                                                 GValue       *value);
+GOM_AVAILABLE_IN_ALL
+gboolean      gom_change_set_contains_relation  (GomChangeSet *self,
+                                                 const char   *relation);
+
+G_END_DECLS
@@ -27,6 +27,27 @@
 
 G_BEGIN_DECLS
 
+#define GOM_CURSOR_BATCH_SIZE     256
+#define GOM_CURSOR_BATCH_MAX_ROWS 4096
+
+/* Rows fetched by next_batch are stored column-major so that a column is
+ * contiguous across the batch. The cell for @row/@column lives at
+ * values[column * capacity + row].
+ */
+typedef struct _GomCursorBatch
+{
+  char   **column_names;
+  GValue  *values;
+  char   **strings;
+  guint    n_columns;
+  guint    n_rows;
+  guint    capacity;
+  /* The backend stepped past the last row while filling the batch */
+  guint    past_end : 1;
+} GomCursorBatch;
+
+typedef struct _GomCursorPlan GomCursorPlan;
+
 struct _GomCursor
 {
   GObject        parent_instance;
@@ -37,6 +58,13 @@ struct _GomCursor
   guint          discriminator_cached : 1;
   GHashTable    *discriminator_cache;
   GomSession    *session;
+  GomCursorBatch *batch;
+  guint          batch_row;
+  char         **prefetches;
+  GHashTable    *plans;
+  GomCursorPlan *plan;
+  GomRecordArena *record_arena;
+  GArray        *peeked;
 };
 
 struct _GomCursorClass
@@ -61,6 +89,18 @@ struct _GomCursorClass
                                                gint64     offset);
   GomCursorCapabilities  (*get_capabilities)  (GomCursor *self);
   guint64                (*get_count)         (GomCursor *self);
+  DexFuture             *(*next_batch)        (GomCursor *self,
+                                               guint      n_rows);
+  gboolean               (*peek_column_bytes) (GomCursor     *self,
+                                               guint          column,
+                                               const guint8 **data,
+                                               gsize         *len);
+  gboolean               (*get_column_int64)  (GomCursor *self,
+                                               guint      column,
+                                               gint64    *value);
+  gboolean               (*get_column_uint64) (GomCursor *self,
+                                               guint      column,
+                                               guint64   *value);
 };
 
 void           _gom_cursor_set_repository     (GomCursor     *self,
@@ -69,6 +109,38 @@ GomRepository *_gom_cursor_dup_repository     (GomCursor     *self);
 void           _gom_cursor_set_session        (GomCursor     *self,
                                                GomSession    *session);
 GomSession    *_gom_cursor_dup_session        (GomCursor     *self);
+DexFuture     *_gom_cursor_bind_prefetches    (DexFuture     *future,
+                                               GomQuery      *query) G_GNUC_WARN_UNUSED_RESULT;
 DexFuture     *_gom_cursor_exhaust_to_records (GomCursor     *self) G_GNUC_WARN_UNUSED_RESULT;
+gboolean       _gom_cursor_get_column_value   (GomCursor     *self,
+                                               guint          column,
+                                               GValue        *value);
+void           _gom_cursor_take_batch         (GomCursor     *self,
+                                               GomCursorBatch *batch);
+GomCursorBatch *_gom_cursor_batch_new         (GomCursor     *self,
+                                               guint          capacity);
+void           _gom_cursor_batch_append       (GomCursorBatch *batch,
+                                               GomCursor     *self);
+void           _gom_cursor_batch_grow         (GomCursorBatch *batch,
+                                               guint          capacity);
+const char    *_gom_cursor_batch_get_string   (GomCursorBatch *batch,
+                                               guint          row,
+                                               guint          column);
+gboolean       _gom_cursor_batch_peek_bytes   (GomCursorBatch *batch,
+                                               guint          row,
+                                               guint          column,
+                                               const guint8 **data,
+                                               gsize         *len);
+void           _gom_cursor_batch_free         (GomCursorBatch *batch);
+
+static inline GValue *
+_gom_cursor_batch_get_value (GomCursorBatch *batch,
+                             guint           row,
+                             guint           column)
+{
+  return &batch->values[column * batch->capacity + row];
+}
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (GomCursorBatch, _gom_cursor_batch_free)
 
 G_END_DECLS
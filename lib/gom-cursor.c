@@ -20,15 +20,18 @@
 
 #include "config.h"
 
+#include <string.h>
+
 #include "gom-cursor-private.h"
 #include "gom-entity-private.h"
+#include "gom-identity-key-private.h"
 #include "gom-meta-private.h"
+#include "gom-query-private.h"
 #include "gom-session-private.h"
 #include "gom-repository-private.h"
 #include "gom-record-private.h"
 #include "gom-trace-private.h"
 #include "gom-util-private.h"
-#include "gom-value-private.h"
 
 G_DEFINE_ABSTRACT_TYPE (GomCursor, gom_cursor, G_TYPE_OBJECT)
 
@@ -40,11 +43,315 @@ gom_cursor_finalize (GObject *object)
   g_clear_object (&self->repository);
   g_clear_object (&self->session);
   g_clear_pointer (&self->discriminator_cache, g_hash_table_unref);
+  g_clear_pointer (&self->batch, _gom_cursor_batch_free);
+  g_clear_pointer (&self->prefetches, g_strfreev);
+  g_clear_pointer (&self->plans, g_hash_table_unref);
+  g_clear_pointer (&self->record_arena, _gom_record_arena_free);
+  g_clear_pointer (&self->peeked, g_array_unref);
   gom_trace_counter_add (GOM_TRACE_COUNTER_CURSORS, -1);
 
   G_OBJECT_CLASS (gom_cursor_parent_class)->finalize (object);
 }
 
+/* Creates a batch shaped like the current row of @self. This only uses
+ * the backend vfuncs so it may be called from a backend worker thread.
+ */
+GomCursorBatch *
+_gom_cursor_batch_new (GomCursor *self,
+                       guint      capacity)
+{
+  GomCursorClass *klass;
+  GomCursorBatch *batch;
+
+  g_return_val_if_fail (GOM_IS_CURSOR (self), NULL);
+  g_return_val_if_fail (capacity > 0, NULL);
+
+  klass = GOM_CURSOR_GET_CLASS (self);
+
+  batch = g_new0 (GomCursorBatch, 1);
+  batch->n_columns = klass->get_n_columns (self);
+  batch->capacity = capacity;
+  batch->column_names = g_new0 (char *, batch->n_columns + 1);
+  batch->values = g_new0 (GValue, (gsize)batch->n_columns * capacity);
+
+  for (guint column = 0; column < batch->n_columns; column++)
+    batch->column_names[column] = g_strdup (klass->get_column_name (self, column));
+
+  return batch;
+}
+
+/* Copies the current backend row into @batch. Cells the backend cannot
+ * read are left unset so that reading them fails the same way it would
+ * have without batching.
+ */
+void
+_gom_cursor_batch_append (GomCursorBatch *batch,
+                          GomCursor      *self)
+{
+  GomCursorClass *klass;
+  guint row;
+
+  g_return_if_fail (batch != NULL);
+  g_return_if_fail (GOM_IS_CURSOR (self));
+  g_return_if_fail (batch->n_rows < batch->capacity);
+
+  klass = GOM_CURSOR_GET_CLASS (self);
+  row = batch->n_rows;
+
+  for (guint column = 0; column < batch->n_columns; column++)
+    {
+      GValue *value = _gom_cursor_batch_get_value (batch, row, column);
+
+      if (!klass->get_column_value (self, column, value) &&
+          G_VALUE_TYPE (value) != G_TYPE_INVALID)
+        g_value_unset (value);
+    }
+
+  batch->n_rows++;
+}
+
+/* Grows @batch so it can hold @capacity rows. Cells are moved rather
+ * than copied since the column-major layout depends on the capacity.
+ */
+void
+_gom_cursor_batch_grow (GomCursorBatch *batch,
+                        guint           capacity)
+{
+  GValue *values;
+  char **strings = NULL;
+
+  g_return_if_fail (batch != NULL);
+
+  if (capacity <= batch->capacity)
+    return;
+
+  values = g_new0 (GValue, (gsize)batch->n_columns * capacity);
+
+  if (batch->strings != NULL)
+    strings = g_new0 (char *, (gsize)batch->n_columns * capacity);
+
+  for (guint column = 0; column < batch->n_columns; column++)
+    {
+      gsize from = (gsize)column * batch->capacity;
+      gsize to = (gsize)column * capacity;
+
+      memcpy (&values[to], &batch->values[from], sizeof (GValue) * batch->n_rows);
+
+      if (strings != NULL)
+        memcpy (&strings[to], &batch->strings[from], sizeof (char *) * batch->n_rows);
+    }
+
+  g_free (batch->values);
+  g_free (batch->strings);
+
+  batch->values = values;
+  batch->strings = strings;
+  batch->capacity = capacity;
+}
+
+/* Returns the cell at @row/@column as a string. Non-text cells are
+ * rendered lazily so the returned string stays valid for as long as the
+ * batch does, like the backend accessors.
+ */
+const char *
+_gom_cursor_batch_get_string (GomCursorBatch *batch,
+                              guint           row,
+                              guint           column)
+{
+  const GValue *value;
+  gsize index;
+
+  g_return_val_if_fail (batch != NULL, NULL);
+  g_return_val_if_fail (row < batch->n_rows, NULL);
+
+  if (column >= batch->n_columns)
+    return NULL;
+
+  value = _gom_cursor_batch_get_value (batch, row, column);
+
+  if (G_VALUE_HOLDS_STRING (value))
+    return g_value_get_string (value);
+
+  if (G_VALUE_TYPE (value) == G_TYPE_INVALID ||
+      G_VALUE_HOLDS_POINTER (value) ||
+      G_VALUE_HOLDS_BOXED (value))
+    return NULL;
+
+  index = (gsize)column * batch->capacity + row;
+
+  if (batch->strings == NULL)
+    batch->strings = g_new0 (char *, (gsize)batch->n_columns * batch->capacity);
+
+  if (batch->strings[index] == NULL)
+    {
+      g_auto(GValue) str = G_VALUE_INIT;
+
+      g_value_init (&str, G_TYPE_STRING);
+      if (g_value_transform (value, &str))
+        batch->strings[index] = g_value_dup_string (&str);
+    }
+
+  return batch->strings[index];
+}
+
+static gboolean
+gom_cursor_value_peek_bytes (const GValue  *value,
+                             const guint8 **data,
+                             gsize         *len)
+{
+  if (G_VALUE_HOLDS (value, G_TYPE_BYTES))
+    {
+      GBytes *bytes = g_value_get_boxed (value);
+
+      if (bytes == NULL)
+        return FALSE;
+
+      *data = g_bytes_get_data (bytes, len);
+      return TRUE;
+    }
+
+  if (G_VALUE_HOLDS_STRING (value))
+    {
+      const char *str = g_value_get_string (value);
+
+      if (str == NULL)
+        return FALSE;
+
+      *data = (const guint8 *)str;
+      *len = strlen (str);
+      return TRUE;
+    }
+
+  return FALSE;
+}
+
+/* Borrows the binary or text contents of the cell at @row/@column. The
+ * data is owned by @batch.
+ */
+gboolean
+_gom_cursor_batch_peek_bytes (GomCursorBatch  *batch,
+                              guint            row,
+                              guint            column,
+                              const guint8   **data,
+                              gsize           *len)
+{
+  g_return_val_if_fail (batch != NULL, FALSE);
+  g_return_val_if_fail (row < batch->n_rows, FALSE);
+  g_return_val_if_fail (data != NULL, FALSE);
+  g_return_val_if_fail (len != NULL, FALSE);
+
+  if (column >= batch->n_columns)
+    return FALSE;
+
+  return gom_cursor_value_peek_bytes (_gom_cursor_batch_get_value (batch, row, column), data, len);
+}
+
+void
+_gom_cursor_batch_free (GomCursorBatch *batch)
+{
+  gsize n_cells;
+
+  if (batch == NULL)
+    return;
+
+  n_cells = (gsize)batch->n_columns * batch->capacity;
+
+  for (gsize i = 0; i < n_cells; i++)
+    {
+      if (G_VALUE_TYPE (&batch->values[i]) != G_TYPE_INVALID)
+        g_value_unset (&batch->values[i]);
+    }
+
+  if (batch->strings != NULL)
+    {
+      for (gsize i = 0; i < n_cells; i++)
+        g_free (batch->strings[i]);
+      g_free (batch->strings);
+    }
+
+  g_strfreev (batch->column_names);
+  g_free (batch->values);
+  g_free (batch);
+}
+
+void
+_gom_cursor_take_batch (GomCursor      *self,
+                        GomCursorBatch *batch)
+{
+  g_return_if_fail (GOM_IS_CURSOR (self));
+
+  g_clear_pointer (&self->batch, _gom_cursor_batch_free);
+
+  if (batch != NULL && batch->n_rows == 0)
+    g_clear_pointer (&batch, _gom_cursor_batch_free);
+
+  self->batch = batch;
+  self->batch_row = 0;
+}
+
+static inline gboolean
+gom_cursor_has_batch (GomCursor *self)
+{
+  return self->batch != NULL && self->batch_row < self->batch->n_rows;
+}
+
+/* Values borrowed through the generic peek fallback are only valid for
+ * the current row.
+ */
+static inline void
+gom_cursor_clear_peeked (GomCursor *self)
+{
+  g_clear_pointer (&self->peeked, g_array_unref);
+}
+
+static void
+gom_cursor_peeked_value_clear (gpointer data)
+{
+  GValue *value = data;
+
+  if (G_VALUE_TYPE (value) != G_TYPE_INVALID)
+    g_value_unset (value);
+}
+
+/* Number of rows the backend has already stepped past the row the
+ * cursor is logically positioned on.
+ */
+static inline guint
+gom_cursor_get_batch_lead (GomCursor *self)
+{
+  if (!gom_cursor_has_batch (self))
+    return 0;
+
+  return self->batch->n_rows - self->batch_row - 1;
+}
+
+gboolean
+_gom_cursor_get_column_value (GomCursor *self,
+                              guint      column,
+                              GValue    *value)
+{
+  g_assert (GOM_IS_CURSOR (self));
+  g_assert (value != NULL);
+
+  if (gom_cursor_has_batch (self))
+    {
+      const GValue *src;
+
+      if (column >= self->batch->n_columns)
+        return FALSE;
+
+      src = _gom_cursor_batch_get_value (self->batch, self->batch_row, column);
+      if (G_VALUE_TYPE (src) == G_TYPE_INVALID)
+        return FALSE;
+
+      g_value_init (value, G_VALUE_TYPE (src));
+      g_value_copy (src, value);
+      return TRUE;
+    }
+
+  return GOM_CURSOR_GET_CLASS (self)->get_column_value (self, column, value);
+}
+
 static DexFuture *
 gom_cursor_exhaust_fiber (gpointer user_data)
 {
@@ -97,10 +404,9 @@ gom_cursor_exhaust_to_list_fiber (gpointer user_data)
 
   for (;;)
     {
-      g_autoptr(GomEntity) entity = NULL;
-      gboolean has_row;
+      guint n_rows;
 
-      has_row = dex_await_boolean (gom_cursor_next (self), &error);
+      n_rows = dex_await_uint (gom_cursor_next_batch (self, GOM_CURSOR_BATCH_SIZE), &error);
 
       if (error != NULL)
         {
@@ -108,31 +414,44 @@ gom_cursor_exhaust_to_list_fiber (gpointer user_data)
           return dex_future_new_for_error (g_steal_pointer (&error));
         }
 
-      if (!has_row)
+      if (n_rows == 0)
         break;
 
-      if (!(entity = gom_cursor_materialize (self, &error)))
+      for (guint i = 0; i < n_rows; i++)
         {
-          dex_await (gom_cursor_close (self), NULL);
-          return dex_future_new_for_error (g_steal_pointer (&error));
-        }
+          g_autoptr(GomEntity) entity = NULL;
 
-      if (entity == NULL)
-        {
-          g_set_error_literal (&error,
-                               G_IO_ERROR,
-                               G_IO_ERROR_FAILED,
-                               "Failed to materialize cursor row");
-          dex_await (gom_cursor_close (self), NULL);
-          return dex_future_new_for_error (g_steal_pointer (&error));
-        }
+          if (i > 0)
+            self->batch_row++;
+
+          if (!(entity = gom_cursor_materialize (self, &error)))
+            {
+              if (error == NULL)
+                g_set_error_literal (&error,
+                                     G_IO_ERROR,
+                                     G_IO_ERROR_FAILED,
+                                     "Failed to materialize cursor row");
+              dex_await (gom_cursor_close (self), NULL);
+              return dex_future_new_for_error (g_steal_pointer (&error));
+            }
 
-      g_list_store_append (result, entity);
+          g_list_store_append (result, entity);
+        }
     }
 
   if (!dex_await (gom_cursor_close (self), &error))
     return dex_future_new_for_error (g_steal_pointer (&error));
 
+  if (self->prefetches != NULL &&
+      g_list_model_get_n_items (G_LIST_MODEL (result)) > 0 &&
+      !_gom_entity_prefetch_related (self->entity_type,
+                                     G_LIST_MODEL (result),
+                                     (const char * const *)self->prefetches,
+                                     self->repository,
+                                     self->session,
+                                     &error))
+    return dex_future_new_for_error (g_steal_pointer (&error));
+
   return dex_future_new_take_object (g_steal_pointer (&result));
 }
 
@@ -149,10 +468,9 @@ gom_cursor_exhaust_to_records_fiber (gpointer user_data)
 
   for (;;)
     {
-      g_autoptr(GomRecord) record = NULL;
-      gboolean has_row;
+      guint n_rows;
 
-      has_row = dex_await_boolean (gom_cursor_next (self), &error);
+      n_rows = dex_await_uint (gom_cursor_next_batch (self, GOM_CURSOR_BATCH_SIZE), &error);
 
       if (error != NULL)
         {
@@ -160,26 +478,29 @@ gom_cursor_exhaust_to_records_fiber (gpointer user_data)
           return dex_future_new_for_error (g_steal_pointer (&error));
         }
 
-      if (!has_row)
+      if (n_rows == 0)
         break;
 
-      if (!(record = gom_cursor_snapshot (self, &error)))
+      for (guint i = 0; i < n_rows; i++)
         {
-          dex_await (gom_cursor_close (self), NULL);
-          return dex_future_new_for_error (g_steal_pointer (&error));
-        }
+          g_autoptr(GomRecord) record = NULL;
 
-      if (record == NULL)
-        {
-          g_set_error_literal (&error,
-                               G_IO_ERROR,
-                               G_IO_ERROR_FAILED,
-                               "Failed to snapshot cursor row");
-          dex_await (gom_cursor_close (self), NULL);
-          return dex_future_new_for_error (g_steal_pointer (&error));
-        }
+          if (i > 0)
+            self->batch_row++;
+
+          if (!(record = gom_cursor_snapshot (self, &error)))
+            {
+              if (error == NULL)
+                g_set_error_literal (&error,
+                                     G_IO_ERROR,
+                                     G_IO_ERROR_FAILED,
+                                     "Failed to snapshot cursor row");
+              dex_await (gom_cursor_close (self), NULL);
+              return dex_future_new_for_error (g_steal_pointer (&error));
+            }
 
-      g_list_store_append (result, record);
+          g_list_store_append (result, record);
+        }
     }
 
   if (!dex_await (gom_cursor_close (self), &error))
@@ -188,6 +509,78 @@ gom_cursor_exhaust_to_records_fiber (gpointer user_data)
   return dex_future_new_take_object (g_steal_pointer (&result));
 }
 
+typedef struct _NextBatch
+{
+  GomCursor *self;
+  guint      n_rows;
+} NextBatch;
+
+static void
+next_batch_free (NextBatch *state)
+{
+  g_clear_object (&state->self);
+  g_free (state);
+}
+
+static DexFuture *
+gom_cursor_real_next_batch_fiber (gpointer user_data)
+{
+  NextBatch *state = user_data;
+  GomCursor *self = state->self;
+  g_autoptr(GomCursorBatch) batch = NULL;
+  g_autoptr(GError) error = NULL;
+  guint n_rows;
+
+  g_assert (GOM_IS_CURSOR (self));
+
+  while (batch == NULL || batch->n_rows < state->n_rows)
+    {
+      if (!dex_await_boolean (GOM_CURSOR_GET_CLASS (self)->next (self), &error))
+        {
+          if (error != NULL)
+            return dex_future_new_for_error (g_steal_pointer (&error));
+
+          if (batch != NULL)
+            batch->past_end = TRUE;
+
+          break;
+        }
+
+      if (batch == NULL)
+        batch = _gom_cursor_batch_new (self, state->n_rows);
+
+      _gom_cursor_batch_append (batch, self);
+    }
+
+  if (batch == NULL)
+    return dex_future_new_for_uint (0);
+
+  n_rows = batch->n_rows;
+  _gom_cursor_take_batch (self, g_steal_pointer (&batch));
+
+  return dex_future_new_for_uint (n_rows);
+}
+
+static DexFuture *
+gom_cursor_real_next_batch (GomCursor *self,
+                            guint      n_rows)
+{
+  NextBatch *state;
+
+  g_assert (GOM_IS_CURSOR (self));
+  g_assert (n_rows > 0);
+
+  state = g_new0 (NextBatch, 1);
+  state->self = g_object_ref (self);
+  state->n_rows = n_rows;
+
+  return dex_scheduler_spawn (NULL,
+                              0,
+                              gom_cursor_real_next_batch_fiber,
+                              state,
+                              (GDestroyNotify)next_batch_free);
+}
+
 static DexFuture *
 gom_cursor_real_exhaust (GomCursor *self)
 {
@@ -250,6 +643,7 @@ gom_cursor_class_init (GomCursorClass *klass)
   object_class->finalize = gom_cursor_finalize;
 
   klass->exhaust = gom_cursor_real_exhaust;
+  klass->next_batch = gom_cursor_real_next_batch;
   klass->get_capabilities = gom_cursor_real_get_capabilities;
 }
 
@@ -297,54 +691,49 @@ _gom_cursor_dup_session (GomCursor *self)
   return self->session ? g_object_ref (self->session) : NULL;
 }
 
-static char *
-gom_cursor_build_identity_key (GType               entity_type,
-                               GomEntityClass     *entity_class,
-                               const char * const *property_names,
-                               const GValue       *property_values,
-                               guint               n_properties)
+static DexFuture *
+gom_cursor_bind_prefetches_cb (DexFuture *completed,
+                               gpointer   user_data)
 {
-  g_autoptr(GString) key = NULL;
-  const char * const *identity_fields;
+  const char * const *prefetches = user_data;
+  const GValue *value;
+  GomCursor *cursor;
 
-  g_return_val_if_fail (GOM_IS_ENTITY_CLASS (entity_class), NULL);
-  g_return_val_if_fail (property_names != NULL || n_properties == 0, NULL);
-  g_return_val_if_fail (property_values != NULL || n_properties == 0, NULL);
+  g_assert (DEX_IS_FUTURE (completed));
+  g_assert (prefetches != NULL);
 
-  identity_fields = gom_entity_class_get_identity_fields (entity_class);
-  if (identity_fields == NULL || identity_fields[0] == NULL)
-    return NULL;
+  value = dex_future_get_value (completed, NULL);
+  g_assert (value != NULL);
+  g_assert (G_VALUE_HOLDS (value, GOM_TYPE_CURSOR));
 
-  key = g_string_new (g_type_name (entity_type));
-  g_string_append_c (key, '\n');
+  cursor = g_value_get_object (value);
+  g_clear_pointer (&cursor->prefetches, g_strfreev);
+  cursor->prefetches = g_strdupv ((char **)prefetches);
 
-  for (guint i = 0; identity_fields[i] != NULL; i++)
-    {
-      gboolean found = FALSE;
+  return dex_ref (completed);
+}
 
-      for (guint j = 0; j < n_properties; j++)
-        {
-          if (g_str_equal (property_names[j], identity_fields[i]))
-            {
-              g_autofree char *value_contents = _gom_value_dup_identity_key (&property_values[j]);
+/* Attaches the relationships @query asks to prefetch to the cursor that
+ * @future resolves to, so that exhausting it into a list loads them for
+ * the whole result set. @future is returned untouched when there is
+ * nothing to prefetch.
+ */
+DexFuture *
+_gom_cursor_bind_prefetches (DexFuture *future,
+                             GomQuery  *query)
+{
+  const char * const *prefetches;
 
-              if (value_contents == NULL)
-                return NULL;
+  g_return_val_if_fail (DEX_IS_FUTURE (future), NULL);
+  g_return_val_if_fail (GOM_IS_QUERY (query), NULL);
 
-              g_string_append (key, identity_fields[i]);
-              g_string_append_c (key, '=');
-              g_string_append (key, value_contents);
-              g_string_append_c (key, '\n');
-              found = TRUE;
-              break;
-            }
-        }
-
-      if (!found)
-        return NULL;
-    }
+  if (!(prefetches = _gom_query_get_prefetches (query)))
+    return future;
 
-  return g_string_free (g_steal_pointer (&key), FALSE);
+  return dex_future_then (future,
+                          gom_cursor_bind_prefetches_cb,
+                          g_strdupv ((char **)prefetches),
+                          (GDestroyNotify)g_strfreev);
 }
 
 static gboolean
@@ -606,7 +995,7 @@ gom_cursor_value_to_property (GomCursor   *self,
       return TRUE;
     }
 
-  if (!GOM_CURSOR_GET_CLASS (self)->get_column_value (self, column, &value))
+  if (!_gom_cursor_get_column_value (self, column, &value))
     {
       g_set_error (error,
                    G_IO_ERROR,
@@ -831,7 +1220,7 @@ gom_cursor_bytes_to_property (GomCursor              *self,
   g_assert (prop_info->from_bytes_func != NULL);
   g_assert (out != NULL);
 
-  if (!GOM_CURSOR_GET_CLASS (self)->get_column_value (self, column, &value))
+  if (!_gom_cursor_get_column_value (self, column, &value))
     {
       g_set_error (error,
                    G_IO_ERROR,
@@ -876,6 +1265,9 @@ gom_cursor_get_n_columns (GomCursor *self)
 {
   g_return_val_if_fail (GOM_IS_CURSOR (self), 0);
 
+  if (gom_cursor_has_batch (self))
+    return self->batch->n_columns;
+
   return GOM_CURSOR_GET_CLASS (self)->get_n_columns (self);
 }
 
@@ -885,6 +1277,9 @@ gom_cursor_get_column_name (GomCursor *self,
 {
   g_return_val_if_fail (GOM_IS_CURSOR (self), 0);
 
+  if (gom_cursor_has_batch (self))
+    return column < self->batch->n_columns ? self->batch->column_names[column] : NULL;
+
   return GOM_CURSOR_GET_CLASS (self)->get_column_name (self, column);
 }
 
@@ -894,43 +1289,189 @@ gom_cursor_get_column_string (GomCursor *self,
 {
   g_return_val_if_fail (GOM_IS_CURSOR (self), NULL);
 
+  if (gom_cursor_has_batch (self))
+    return _gom_cursor_batch_get_string (self->batch, self->batch_row, column);
+
   return GOM_CURSOR_GET_CLASS (self)->get_column_string (self, column);
 }
 
+static gint64
+gom_cursor_value_to_int64 (const GValue *value)
+{
+  if (G_VALUE_TYPE (value) == G_TYPE_INVALID)
+    return 0;
+  else if (G_VALUE_HOLDS_INT64 (value))
+    return g_value_get_int64 (value);
+  else if (G_VALUE_HOLDS_INT (value))
+    return (gint64)g_value_get_int (value);
+  else if (G_VALUE_HOLDS_UINT (value))
+    return (gint64)g_value_get_uint (value);
+  else if (G_VALUE_HOLDS_UINT64 (value))
+    return (gint64)g_value_get_uint64 (value);
+  else if (G_VALUE_HOLDS_DOUBLE (value))
+    return (gint64)g_value_get_double (value);
+  else if (G_VALUE_HOLDS_FLOAT (value))
+    return (gint64)g_value_get_float (value);
+  else if (G_VALUE_HOLDS_BOOLEAN (value))
+    return g_value_get_boolean (value) ? 1 : 0;
+  else if (G_VALUE_HOLDS_STRING (value))
+    {
+      const char *str = g_value_get_string (value);
+      if (str != NULL)
+        return g_ascii_strtoll (str, NULL, 10);
+    }
+
+  return 0;
+}
+
+static guint64
+gom_cursor_value_to_uint64 (const GValue *value)
+{
+  if (G_VALUE_TYPE (value) == G_TYPE_INVALID)
+    return 0;
+  else if (G_VALUE_HOLDS_UINT64 (value))
+    return g_value_get_uint64 (value);
+  else if (G_VALUE_HOLDS_STRING (value))
+    {
+      const char *str = g_value_get_string (value);
+      if (str != NULL)
+        return g_ascii_strtoull (str, NULL, 10);
+      return 0;
+    }
+
+  return (guint64)gom_cursor_value_to_int64 (value);
+}
+
 gint64
 gom_cursor_get_column_int64 (GomCursor *self,
                              guint      column)
 {
   g_auto(GValue) value = G_VALUE_INIT;
+  GomCursorClass *klass;
   gint64 result = 0;
 
   g_return_val_if_fail (GOM_IS_CURSOR (self), 0);
 
-  if (!GOM_CURSOR_GET_CLASS (self)->get_column_value (self, column, &value))
+  if (gom_cursor_has_batch (self))
+    {
+      if (column >= self->batch->n_columns)
+        return 0;
+
+      return gom_cursor_value_to_int64 (_gom_cursor_batch_get_value (self->batch, self->batch_row, column));
+    }
+
+  klass = GOM_CURSOR_GET_CLASS (self);
+
+  if (klass->get_column_int64 != NULL && klass->get_column_int64 (self, column, &result))
+    return result;
+
+  if (!_gom_cursor_get_column_value (self, column, &value))
+    return 0;
+
+  return gom_cursor_value_to_int64 (&value);
+}
+
+guint64
+gom_cursor_get_column_uint64 (GomCursor *self,
+                              guint      column)
+{
+  g_auto(GValue) value = G_VALUE_INIT;
+  GomCursorClass *klass;
+  guint64 result = 0;
+
+  g_return_val_if_fail (GOM_IS_CURSOR (self), 0);
+
+  if (gom_cursor_has_batch (self))
+    {
+      if (column >= self->batch->n_columns)
+        return 0;
+
+      return gom_cursor_value_to_uint64 (_gom_cursor_batch_get_value (self->batch, self->batch_row, column));
+    }
+
+  klass = GOM_CURSOR_GET_CLASS (self);
+
+  if (klass->get_column_uint64 != NULL && klass->get_column_uint64 (self, column, &result))
+    return result;
+
+  if (!_gom_cursor_get_column_value (self, column, &value))
     return 0;
 
-  if (G_VALUE_HOLDS_INT64 (&value))
-    result = g_value_get_int64 (&value);
-  else if (G_VALUE_HOLDS_INT (&value))
-    result = (gint64)g_value_get_int (&value);
-  else if (G_VALUE_HOLDS_UINT (&value))
-    result = (gint64)g_value_get_uint (&value);
-  else if (G_VALUE_HOLDS_UINT64 (&value))
-    result = (gint64)g_value_get_uint64 (&value);
-  else if (G_VALUE_HOLDS_DOUBLE (&value))
-    result = (gint64)g_value_get_double (&value);
-  else if (G_VALUE_HOLDS_FLOAT (&value))
-    result = (gint64)g_value_get_float (&value);
-  else if (G_VALUE_HOLDS_BOOLEAN (&value))
-    result = g_value_get_boolean (&value) ? 1 : 0;
-  else if (G_VALUE_HOLDS_STRING (&value))
-    {
-      const char *str = g_value_get_string (&value);
-      if (str != NULL)
-        result = g_ascii_strtoll (str, NULL, 10);
+  return gom_cursor_value_to_uint64 (&value);
+}
+
+/**
+ * gom_cursor_peek_column_bytes:
+ * @self: a [class@Gom.Cursor]
+ * @column: the column index
+ * @data: (out) (transfer none) (array length=len) (nullable) (optional):
+ *   location for the borrowed data
+ * @len: (out) (optional): location for the length of @data
+ *
+ * Borrows the contents of a binary or text column without copying it.
+ *
+ * Text columns yield their UTF-8 contents without the trailing nul byte.
+ * The data is owned by @self and is only valid until the cursor is advanced,
+ * moved, rewound or closed. Use [method@Gom.Cursor.dup_column_bytes] to keep
+ * the contents beyond that.
+ *
+ * Returns: %TRUE if @column holds binary or text data; %FALSE if it is `NULL`,
+ *   of another type or out of range.
+ */
+gboolean
+gom_cursor_peek_column_bytes (GomCursor     *self,
+                              guint          column,
+                              const guint8 **data,
+                              gsize         *len)
+{
+  GomCursorClass *klass;
+  const guint8 *out_data = NULL;
+  gsize out_len = 0;
+  gboolean ret = FALSE;
+
+  g_return_val_if_fail (GOM_IS_CURSOR (self), FALSE);
+
+  klass = GOM_CURSOR_GET_CLASS (self);
+
+  if (gom_cursor_has_batch (self))
+    {
+      if (column < self->batch->n_columns)
+        ret = _gom_cursor_batch_peek_bytes (self->batch, self->batch_row, column, &out_data, &out_len);
+    }
+  else if (klass->peek_column_bytes != NULL)
+    {
+      ret = klass->peek_column_bytes (self, column, &out_data, &out_len);
+    }
+  else if (column < gom_cursor_get_n_columns (self))
+    {
+      GValue *value;
+
+      /* Backends without native access copy the cell once and keep it
+       * alive until the cursor moves.
+       */
+      if (self->peeked == NULL)
+        {
+          self->peeked = g_array_sized_new (FALSE, TRUE, sizeof (GValue), column + 1);
+          g_array_set_clear_func (self->peeked, gom_cursor_peeked_value_clear);
+        }
+
+      if (self->peeked->len <= column)
+        g_array_set_size (self->peeked, column + 1);
+
+      value = &g_array_index (self->peeked, GValue, column);
+
+      if (G_VALUE_TYPE (value) != G_TYPE_INVALID ||
+          klass->get_column_value (self, column, value))
+        ret = gom_cursor_value_peek_bytes (value, &out_data, &out_len);
     }
 
-  return result;
+  if (data != NULL)
+    *data = ret ? out_data : NULL;
+
+  if (len != NULL)
+    *len = ret ? out_len : 0;
+
+  return ret;
 }
 
 gboolean
@@ -944,7 +1485,7 @@ gom_cursor_get_column (GomCursor *self,
   if (G_VALUE_TYPE (value) != G_TYPE_INVALID)
     g_value_unset (value);
 
-  return GOM_CURSOR_GET_CLASS (self)->get_column_value (self, column, value);
+  return _gom_cursor_get_column_value (self, column, value);
 }
 
 gboolean
@@ -955,7 +1496,7 @@ gom_cursor_get_column_null (GomCursor *self,
 
   g_return_val_if_fail (GOM_IS_CURSOR (self), TRUE);
 
-  if (!GOM_CURSOR_GET_CLASS (self)->get_column_value (self, column, &value))
+  if (!_gom_cursor_get_column_value (self, column, &value))
     return TRUE;
 
   if (G_VALUE_HOLDS_POINTER (&value))
@@ -976,7 +1517,7 @@ gom_cursor_get_column_boolean (GomCursor *self,
 
   g_return_val_if_fail (GOM_IS_CURSOR (self), FALSE);
 
-  if (!GOM_CURSOR_GET_CLASS (self)->get_column_value (self, column, &value))
+  if (!_gom_cursor_get_column_value (self, column, &value))
     return FALSE;
 
   if (G_VALUE_HOLDS_BOOLEAN (&value))
@@ -997,7 +1538,7 @@ gom_cursor_get_column_double (GomCursor *self,
 
   g_return_val_if_fail (GOM_IS_CURSOR (self), 0.0);
 
-  if (!GOM_CURSOR_GET_CLASS (self)->get_column_value (self, column, &value))
+  if (!_gom_cursor_get_column_value (self, column, &value))
     return 0.0;
 
   if (gom_value_get_double (&value, &v))
@@ -1046,7 +1587,7 @@ gom_cursor_dup_column_bytes (GomCursor *self,
 
   g_return_val_if_fail (GOM_IS_CURSOR (self), NULL);
 
-  if (!GOM_CURSOR_GET_CLASS (self)->get_column_value (self, column, &value))
+  if (!_gom_cursor_get_column_value (self, column, &value))
     return NULL;
 
   if (G_VALUE_HOLDS_POINTER (&value) && g_value_get_pointer (&value) == NULL)
@@ -1080,10 +1621,68 @@ gom_cursor_next (GomCursor *self)
 {
   dex_return_error_if_fail (GOM_IS_CURSOR (self));
 
+  gom_cursor_clear_peeked (self);
+
+  if (self->batch != NULL)
+    {
+      if (self->batch_row + 1 < self->batch->n_rows)
+        {
+          self->batch_row++;
+          return dex_future_new_true ();
+        }
+
+      g_clear_pointer (&self->batch, _gom_cursor_batch_free);
+    }
+
   GOM_TRACE_MARK ("Cursor", "next", "type=%s", G_OBJECT_TYPE_NAME (self));
   return GOM_CURSOR_GET_CLASS (self)->next (self);
 }
 
+/**
+ * gom_cursor_next_batch:
+ * @self: a [class@Gom.Cursor]
+ * @n_rows: the maximum number of rows to fetch
+ *
+ * Advances the cursor by up to @n_rows rows in a single round-trip to
+ * the backend, buffering the row values within the cursor.
+ *
+ * Once the future resolves, the cursor is positioned on the first row of
+ * the batch. Subsequent calls to [method@Gom.Cursor.next] step through the
+ * buffered rows without touching the backend until the batch is drained.
+ *
+ * If rows from a previous batch have not yet been consumed, the cursor
+ * moves to the next buffered row and no backend work is performed.
+ *
+ * Returns: (transfer full): a [class@Dex.Future] that resolves to a
+ *   `guint` containing the number of rows available from the current
+ *   position, which is zero once the cursor is exhausted.
+ */
+DexFuture *
+gom_cursor_next_batch (GomCursor *self,
+                       guint      n_rows)
+{
+  dex_return_error_if_fail (GOM_IS_CURSOR (self));
+  dex_return_error_if_fail (n_rows > 0);
+
+  gom_cursor_clear_peeked (self);
+
+  if (self->batch != NULL)
+    {
+      if (self->batch_row + 1 < self->batch->n_rows)
+        {
+          self->batch_row++;
+          return dex_future_new_for_uint (self->batch->n_rows - self->batch_row);
+        }
+
+      g_clear_pointer (&self->batch, _gom_cursor_batch_free);
+    }
+
+  n_rows = MIN (n_rows, GOM_CURSOR_BATCH_MAX_ROWS);
+
+  GOM_TRACE_MARK ("Cursor", "next-batch", "type=%s n_rows=%u", G_OBJECT_TYPE_NAME (self), n_rows);
+  return GOM_CURSOR_GET_CLASS (self)->next_batch (self, n_rows);
+}
+
 /**
  * gom_cursor_close:
  * @self: a [class@Gom.Cursor]
@@ -1098,6 +1697,9 @@ gom_cursor_close (GomCursor *self)
 {
   dex_return_error_if_fail (GOM_IS_CURSOR (self));
 
+  gom_cursor_clear_peeked (self);
+  g_clear_pointer (&self->batch, _gom_cursor_batch_free);
+
   GOM_TRACE_MARK ("Cursor", "close", "type=%s", G_OBJECT_TYPE_NAME (self));
   return GOM_CURSOR_GET_CLASS (self)->close (self);
 }
@@ -1116,6 +1718,9 @@ gom_cursor_exhaust (GomCursor *self)
 {
   dex_return_error_if_fail (GOM_IS_CURSOR (self));
 
+  gom_cursor_clear_peeked (self);
+  g_clear_pointer (&self->batch, _gom_cursor_batch_free);
+
   return GOM_CURSOR_GET_CLASS (self)->exhaust (self);
 }
 
@@ -1142,6 +1747,9 @@ gom_cursor_rewind (GomCursor *self)
                                   G_IO_ERROR_NOT_SUPPORTED,
                                   "Rewinding is not supported");
 
+  gom_cursor_clear_peeked (self);
+  g_clear_pointer (&self->batch, _gom_cursor_batch_free);
+
   return GOM_CURSOR_GET_CLASS (self)->rewind (self);
 }
 
@@ -1170,6 +1778,9 @@ gom_cursor_move_absolute (GomCursor *self,
                                   G_IO_ERROR_NOT_SUPPORTED,
                                   "Absolute movement is not supported");
 
+  gom_cursor_clear_peeked (self);
+  g_clear_pointer (&self->batch, _gom_cursor_batch_free);
+
   return GOM_CURSOR_GET_CLASS (self)->move_absolute (self, position);
 }
 
@@ -1198,9 +1809,218 @@ gom_cursor_move_relative (GomCursor *self,
                                   G_IO_ERROR_NOT_SUPPORTED,
                                   "Relative movement is not supported");
 
+  gom_cursor_clear_peeked (self);
+
+  /* The backend is positioned on the last row of the batch, or one past
+   * it when the batch ran into the end of the results, so account for the
+   * buffered rows that have not been consumed yet.
+   */
+  if (self->batch != NULL)
+    {
+      gint64 lead = gom_cursor_get_batch_lead (self);
+
+      if (self->batch->past_end)
+        lead++;
+
+      g_clear_pointer (&self->batch, _gom_cursor_batch_free);
+      offset -= lead;
+    }
+
   return GOM_CURSOR_GET_CLASS (self)->move_relative (self, offset);
 }
 
+/* A materialization plan resolves the columns of a cursor against the
+ * properties of one entity type. Column names do not change while a
+ * cursor is alive, so the plan is built on the first row and reused for
+ * every following row materialized as that type.
+ */
+typedef struct
+{
+  guint                  column;
+  GParamSpec            *pspec;
+  GomEntityPropertyInfo *bytes_info;
+} GomCursorPlanSlot;
+
+struct _GomCursorPlan
+{
+  GType               entity_type;
+  GomEntityClass     *entity_class;
+  guint               n_columns;
+  guint               n_slots;
+  GomCursorPlanSlot  *slots;
+  const char        **property_names;
+
+  /* Slot holding each identity field, in identity order. NULL when the
+   * identity is not projected.
+   */
+  guint              *identity_slots;
+  guint               n_identity;
+};
+
+static void
+gom_cursor_plan_free (GomCursorPlan *plan)
+{
+  if (plan == NULL)
+    return;
+
+  g_free (plan->slots);
+  g_free (plan->property_names);
+  g_free (plan->identity_slots);
+  g_free (plan);
+}
+
+static GomCursorPlan *
+gom_cursor_build_plan (GomCursor       *self,
+                       GomRegistry     *registry,
+                       GomEntityClass  *entity_class,
+                       guint            n_columns,
+                       GError         **error)
+{
+  const GomEntitySpec *entity_spec;
+  const char * const *identity_fields;
+  GomCursorPlan *plan;
+  GType entity_type;
+
+  g_assert (GOM_IS_CURSOR (self));
+  g_assert (GOM_IS_ENTITY_CLASS (entity_class));
+
+  entity_type = G_TYPE_FROM_CLASS (entity_class);
+
+  if (!(entity_spec = _gom_registry_lookup_entity_by_type (registry, entity_type)))
+    {
+      g_set_error (error,
+                   G_IO_ERROR,
+                   G_IO_ERROR_INVALID_ARGUMENT,
+                   "Cursor entity type `%s` is not in the registry",
+                   g_type_name (entity_type));
+      return NULL;
+    }
+
+  plan = g_new0 (GomCursorPlan, 1);
+  plan->entity_type = entity_type;
+  plan->entity_class = entity_class;
+  plan->n_columns = n_columns;
+  plan->slots = g_new0 (GomCursorPlanSlot, n_columns);
+  plan->property_names = g_new0 (const char *, n_columns);
+
+  for (guint i = 0; i < n_columns; i++)
+    {
+      const char *column_name = gom_cursor_get_column_name (self, i);
+      const GomPropertySpec *property_spec;
+      const char *property_name;
+      GomEntityPropertyInfo *prop_info;
+      GParamSpec *pspec;
+
+      if (column_name == NULL || *column_name == '\0')
+        continue;
+
+      if (!(property_spec = _gom_entity_spec_lookup_property_by_field ((GomEntitySpec *)entity_spec, column_name)) &&
+          !(property_spec = _gom_entity_spec_lookup_property_by_name ((GomEntitySpec *)entity_spec, column_name)))
+        continue;
+
+      if (!gom_property_spec_get_mapped ((GomPropertySpec *)property_spec))
+        continue;
+
+      if (!(property_name = gom_property_spec_get_name ((GomPropertySpec *)property_spec)))
+        continue;
+
+      if (!(pspec = _gom_property_spec_get_pspec ((GomPropertySpec *)property_spec)))
+        continue;
+
+      prop_info = _gom_entity_class_get_property (entity_class, property_name, FALSE);
+
+      plan->slots[plan->n_slots].column = i;
+      plan->slots[plan->n_slots].pspec = pspec;
+      if (prop_info != NULL && prop_info->from_bytes_func != NULL)
+        plan->slots[plan->n_slots].bytes_info = prop_info;
+      plan->property_names[plan->n_slots] = property_name;
+      plan->n_slots++;
+    }
+
+  identity_fields = gom_entity_class_get_identity_fields (entity_class);
+
+  if (identity_fields != NULL && identity_fields[0] != NULL)
+    {
+      guint n_identity = g_strv_length ((char **)identity_fields);
+
+      plan->identity_slots = g_new0 (guint, n_identity);
+
+      for (guint i = 0; i < n_identity; i++)
+        {
+          guint j;
+
+          for (j = 0; j < plan->n_slots; j++)
+            {
+              if (g_str_equal (plan->property_names[j], identity_fields[i]))
+                break;
+            }
+
+          if (j == plan->n_slots)
+            {
+              g_clear_pointer (&plan->identity_slots, g_free);
+              break;
+            }
+
+          plan->identity_slots[i] = j;
+        }
+
+      if (plan->identity_slots != NULL)
+        plan->n_identity = n_identity;
+    }
+
+  return plan;
+}
+
+static GomCursorPlan *
+gom_cursor_get_plan (GomCursor       *self,
+                     GomRegistry     *registry,
+                     GomEntityClass  *entity_class,
+                     guint            n_columns,
+                     GError         **error)
+{
+  GomCursorPlan *plan;
+  GType entity_type = G_TYPE_FROM_CLASS (entity_class);
+
+  if (self->plan != NULL &&
+      self->plan->entity_type == entity_type &&
+      self->plan->n_columns == n_columns)
+    return self->plan;
+
+  if (self->plans == NULL)
+    self->plans = g_hash_table_new_full (NULL, NULL, NULL, (GDestroyNotify)gom_cursor_plan_free);
+
+  if (!(plan = g_hash_table_lookup (self->plans, GSIZE_TO_POINTER (entity_type))) ||
+      plan->n_columns != n_columns)
+    {
+      if (!(plan = gom_cursor_build_plan (self, registry, entity_class, n_columns, error)))
+        return NULL;
+
+      g_hash_table_replace (self->plans, GSIZE_TO_POINTER (entity_type), plan);
+    }
+
+  return self->plan = plan;
+}
+
+/* Encodes the identity of a row materialized with @plan into @builder.
+ * Returns %FALSE when the plan has no identity or a value is unsupported.
+ */
+static gboolean
+gom_cursor_plan_build_identity_key (GomCursorPlan         *plan,
+                                    const GValue          *property_values,
+                                    GomIdentityKeyBuilder *builder)
+{
+  if (plan->n_identity == 0)
+    return FALSE;
+
+  for (guint i = 0; i < plan->n_identity; i++)
+    {
+      if (!_gom_identity_key_builder_append (builder, &property_values[plan->identity_slots[i]]))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
 /**
  * gom_cursor_materialize:
  * @self: a [class@Gom.Cursor]
@@ -1214,16 +2034,17 @@ GomEntity *
 gom_cursor_materialize (GomCursor  *self,
                         GError    **error)
 {
-  g_autofree const char **property_names = NULL;
   g_autofree GValue *property_values = NULL;
   g_autoptr(GomEntity) entity = NULL;
   g_autoptr(GomSession) session = NULL;
-  const GomEntitySpec *entity_spec;
+  GomCursorPlan *plan;
   GomRepository *repository;
   GomRegistry *registry;
   GomEntityClass *entity_class;
+  GomIdentityKeyBuilder key_builder;
   guint n_columns;
   guint n_properties = 0;
+  gboolean has_key = FALSE;
   GType entity_type;
 
   g_return_val_if_fail (GOM_IS_CURSOR (self), NULL);
@@ -1246,16 +2067,6 @@ gom_cursor_materialize (GomCursor  *self,
       return NULL;
     }
 
-  if (!(entity_spec = _gom_registry_lookup_entity_by_type (registry, entity_type)))
-    {
-      g_set_error (error,
-                   G_IO_ERROR,
-                   G_IO_ERROR_INVALID_ARGUMENT,
-                   "Cursor entity type `%s` is not in the registry",
-                   g_type_name (entity_type));
-      return NULL;
-    }
-
   entity_class = g_type_class_get (entity_type);
   n_columns = gom_cursor_get_n_columns (self);
 
@@ -1304,17 +2115,6 @@ gom_cursor_materialize (GomCursor  *self,
               if ((match = gom_cursor_lookup_discriminator (self, entity_class, discriminator_value)))
                 {
                   entity_class = match;
-                  entity_type = G_TYPE_FROM_CLASS (entity_class);
-
-                  if (!(entity_spec = _gom_registry_lookup_entity_by_type (registry, entity_type)))
-                    {
-                      g_set_error (error,
-                                   G_IO_ERROR,
-                                   G_IO_ERROR_INVALID_ARGUMENT,
-                                   "Cursor entity type `%s` is not in the registry",
-                                   g_type_name (entity_type));
-                      return NULL;
-                    }
                 }
             }
         }
@@ -1322,51 +2122,31 @@ gom_cursor_materialize (GomCursor  *self,
 
   g_assert (entity_class != NULL);
 
-  property_names = g_new0 (const char *, n_columns);
-  property_values = g_new0 (GValue, n_columns);
-
-  for (guint i = 0; i < n_columns; i++)
-    {
-      const char *column_name = gom_cursor_get_column_name (self, i);
-      const GomPropertySpec *property_spec;
-      const char *property_name;
-      GParamSpec *pspec;
-      GomEntityPropertyInfo *prop_info;
-
-      if (column_name == NULL || *column_name == '\0')
-        continue;
-
-      if (!(property_spec = _gom_entity_spec_lookup_property_by_field ((GomEntitySpec *)entity_spec, column_name)) &&
-          !(property_spec = _gom_entity_spec_lookup_property_by_name ((GomEntitySpec *)entity_spec, column_name)))
-        continue;
-
-      if (!gom_property_spec_get_mapped ((GomPropertySpec *)property_spec))
-        continue;
-
-      if (!(property_name = gom_property_spec_get_name ((GomPropertySpec *)property_spec)))
-        continue;
+  if (!(plan = gom_cursor_get_plan (self, registry, entity_class, n_columns, error)))
+    return NULL;
 
-      if (!(pspec = _gom_property_spec_get_pspec ((GomPropertySpec *)property_spec)))
-        continue;
+  _gom_identity_key_builder_init (&key_builder, plan->entity_type);
+  property_values = g_new0 (GValue, MAX (plan->n_slots, 1));
 
-      prop_info = _gom_entity_class_get_property (entity_class, property_name, FALSE);
+  for (guint i = 0; i < plan->n_slots; i++)
+    {
+      const GomCursorPlanSlot *slot = &plan->slots[i];
 
-      if (prop_info != NULL && prop_info->from_bytes_func != NULL)
+      if (slot->bytes_info != NULL)
         {
           if (!gom_cursor_bytes_to_property (self,
-                                             i,
-                                             prop_info,
+                                             slot->column,
+                                             slot->bytes_info,
                                              &property_values[n_properties],
                                              error))
             goto cleanup;
         }
       else
         {
-          if (!gom_cursor_value_to_property (self, i, pspec, &property_values[n_properties], error))
+          if (!gom_cursor_value_to_property (self, slot->column, slot->pspec, &property_values[n_properties], error))
             goto cleanup;
         }
 
-      property_names[n_properties] = property_name;
       n_properties++;
     }
 
@@ -1379,29 +2159,24 @@ gom_cursor_materialize (GomCursor  *self,
       goto cleanup;
     }
 
-  if (session != NULL)
+  if (session != NULL &&
+      (has_key = gom_cursor_plan_build_identity_key (plan, property_values, &key_builder)))
     {
-      g_autofree char *entity_key = gom_cursor_build_identity_key (entity_type,
-                                                                   entity_class,
-                                                                   property_names,
-                                                                   property_values,
-                                                                   n_properties);
+      GomEntity *existing;
 
-      if (entity_key != NULL)
+      /* Probe with the borrowed key so rows already in the identity map
+       * never allocate one.
+       */
+      if ((existing = _gom_session_lookup_entity (session, _gom_identity_key_builder_peek (&key_builder))))
         {
-          GomEntity *existing;
-
-          if ((existing = _gom_session_lookup_entity (session, entity_key)))
-            {
-              entity = existing;
-              goto cleanup;
-            }
+          entity = existing;
+          goto cleanup;
         }
     }
 
   entity = entity_class->materialize (entity_class,
                                       self,
-                                      property_names,
+                                      plan->property_names,
                                       property_values,
                                       n_properties,
                                       error);
@@ -1410,7 +2185,7 @@ gom_cursor_materialize (GomCursor  *self,
     {
       _gom_entity_set_origin (entity, GOM_ENTITY_ORIGIN_MATERIALIZED);
       _gom_entity_capture_change_state (entity,
-                                        property_names,
+                                        plan->property_names,
                                         property_values,
                                         n_properties,
                                         FALSE);
@@ -1418,30 +2193,17 @@ gom_cursor_materialize (GomCursor  *self,
       if (repository != NULL)
         gom_entity_set_repository (entity, repository);
 
-      if (session != NULL)
+      if (session != NULL && has_key)
         {
-          g_autofree char *entity_key = gom_cursor_build_identity_key (entity_type,
-                                                                       entity_class,
-                                                                       property_names,
-                                                                       property_values,
-                                                                       n_properties);
-
-          if (entity_key != NULL)
-            {
-              GomEntity *registered;
+          GomEntity *registered;
 
-              registered = _gom_session_register_entity (session,
-                                                         entity,
-                                                         g_steal_pointer (&entity_key));
-              if (registered != entity)
-                {
-                  g_clear_object (&entity);
-                  entity = registered;
-                }
-            }
-          else
+          registered = _gom_session_register_entity (session,
+                                                     entity,
+                                                     _gom_identity_key_builder_end (&key_builder));
+          if (registered != entity)
             {
-              _gom_entity_set_lifecycle (entity, GOM_ENTITY_LIFECYCLE_DETACHED);
+              g_clear_object (&entity);
+              entity = registered;
             }
         }
       else
@@ -1454,6 +2216,8 @@ cleanup:
   for (guint i = 0; i < n_properties; i++)
     g_value_unset (&property_values[i]);
 
+  _gom_identity_key_builder_clear (&key_builder);
+
   return g_steal_pointer (&entity);
 }
 
@@ -1480,7 +2244,29 @@ GomRecord *
 gom_cursor_snapshot (GomCursor  *self,
                      GError    **error)
 {
+  guint n_columns;
+
   g_return_val_if_fail (GOM_IS_CURSOR (self), NULL);
 
-  return _gom_record_new (self, error);
+  n_columns = gom_cursor_get_n_columns (self);
+
+  /* Every record snapshotted from this cursor shares one column header
+   * and draws its values from the same arena.
+   */
+  if (self->record_arena == NULL ||
+      _gom_record_header_get_n_columns (_gom_record_arena_get_header (self->record_arena)) != n_columns)
+    {
+      g_autofree const char **column_names = g_new0 (const char *, n_columns + 1);
+      g_autoptr(GomRecordHeader) header = NULL;
+
+      for (guint i = 0; i < n_columns; i++)
+        column_names[i] = gom_cursor_get_column_name (self, i);
+
+      header = _gom_record_header_new (column_names, n_columns);
+
+      g_clear_pointer (&self->record_arena, _gom_record_arena_free);
+      self->record_arena = _gom_record_arena_new (header);
+    }
+
+  return _gom_record_arena_read (self->record_arena, self, error);
 }
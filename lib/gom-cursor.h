@@ -40,6 +40,9 @@ const char            *gom_cursor_get_column_name    (GomCursor   *self,
 GOM_AVAILABLE_IN_ALL
 DexFuture             *gom_cursor_next               (GomCursor   *self) G_GNUC_WARN_UNUSED_RESULT;
 GOM_AVAILABLE_IN_ALL
+DexFuture             *gom_cursor_next_batch         (GomCursor   *self,
+                                                      guint        n_rows) G_GNUC_WARN_UNUSED_RESULT;
+GOM_AVAILABLE_IN_ALL
 DexFuture             *gom_cursor_close              (GomCursor   *self) G_GNUC_WARN_UNUSED_RESULT;
 GOM_AVAILABLE_IN_ALL
 DexFuture             *gom_cursor_exhaust            (GomCursor   *self) G_GNUC_WARN_UNUSED_RESULT;
@@ -88,6 +91,14 @@ GOM_AVAILABLE_IN_ALL
 gint64                 gom_cursor_get_column_int64   (GomCursor   *self,
                                                       guint        column);
 GOM_AVAILABLE_IN_ALL
+guint64                gom_cursor_get_column_uint64  (GomCursor   *self,
+                                                      guint        column);
+GOM_AVAILABLE_IN_ALL
+gboolean               gom_cursor_peek_column_bytes  (GomCursor     *self,
+                                                      guint          column,
+                                                      const guint8 **data,
+                                                      gsize         *len);
+GOM_AVAILABLE_IN_ALL
 GomCursorCapabilities  gom_cursor_get_capabilities   (GomCursor   *self);
 GOM_AVAILABLE_IN_ALL
 guint64                gom_cursor_get_count          (GomCursor   *self);
@@ -24,8 +24,20 @@
 
 struct _GomDriverOptions
 {
-  GObject  parent_instance;
-  GBytes  *encryption_key;
+  GObject       parent_instance;
+  GBytes       *encryption_key;
+  gint64        mmap_size;
+  gint64        wal_size_limit;
+  guint         max_connections;
+  guint         max_concurrent_opens;
+  guint         busy_timeout_msec;
+  guint         checkpoint_interval_msec;
+  guint         cursor_spool_rows;
+  guint         group_commit_window_msec;
+  guint         group_commit_size;
+  int           cache_size;
+  int           wal_autocheckpoint;
+  GomTempStore  temp_store;
 };
 
 struct _GomDriverOptionsClass
@@ -56,6 +68,9 @@ gom_driver_options_class_init (GomDriverOptionsClass *klass)
 static void
 gom_driver_options_init (GomDriverOptions *self)
 {
+  self->mmap_size = -1;
+  self->wal_autocheckpoint = -1;
+  self->temp_store = GOM_TEMP_STORE_DEFAULT;
 }
 
 /**
@@ -110,3 +125,458 @@ gom_driver_options_dup_encryption_key (GomDriverOptions *self)
 
   return g_bytes_ref (self->encryption_key);
 }
+
+/**
+ * gom_driver_options_set_max_connections:
+ * @self: a [class@Gom.DriverOptions]
+ * @max_connections: the maximum number of reading connections, or 0
+ *
+ * Sets how many connections the driver may lease at once for reading.
+ * Backends that pool connections use this to bound concurrent queries.
+ *
+ * The SQLite backend keeps one more connection on top of these for
+ * writing, so up to @max_connections + 1 connections may be open.
+ *
+ * Set to 0 to use the backend default.
+ */
+void
+gom_driver_options_set_max_connections (GomDriverOptions *self,
+                                        guint             max_connections)
+{
+  g_return_if_fail (GOM_IS_DRIVER_OPTIONS (self));
+
+  self->max_connections = max_connections;
+}
+
+/**
+ * gom_driver_options_get_max_connections:
+ * @self: a [class@Gom.DriverOptions]
+ *
+ * Gets the maximum number of reading connections.
+ *
+ * Returns: the maximum number of connections, or 0 for the backend default
+ */
+guint
+gom_driver_options_get_max_connections (GomDriverOptions *self)
+{
+  g_return_val_if_fail (GOM_IS_DRIVER_OPTIONS (self), 0);
+
+  return self->max_connections;
+}
+
+/**
+ * gom_driver_options_set_max_concurrent_opens:
+ * @self: a [class@Gom.DriverOptions]
+ * @max_concurrent_opens: the maximum number of concurrent opens, or 0
+ *
+ * Sets how many connections may be opened concurrently. Opening a
+ * connection may be expensive (such as deriving an encryption key) so
+ * this is usually smaller than [method@Gom.DriverOptions.set_max_connections].
+ *
+ * Set to 0 to use the backend default.
+ */
+void
+gom_driver_options_set_max_concurrent_opens (GomDriverOptions *self,
+                                             guint             max_concurrent_opens)
+{
+  g_return_if_fail (GOM_IS_DRIVER_OPTIONS (self));
+
+  self->max_concurrent_opens = max_concurrent_opens;
+}
+
+/**
+ * gom_driver_options_get_max_concurrent_opens:
+ * @self: a [class@Gom.DriverOptions]
+ *
+ * Gets the maximum number of connections opened concurrently.
+ *
+ * Returns: the maximum number of concurrent opens, or 0 for the backend default
+ */
+guint
+gom_driver_options_get_max_concurrent_opens (GomDriverOptions *self)
+{
+  g_return_val_if_fail (GOM_IS_DRIVER_OPTIONS (self), 0);
+
+  return self->max_concurrent_opens;
+}
+
+/**
+ * gom_driver_options_set_mmap_size:
+ * @self: a [class@Gom.DriverOptions]
+ * @mmap_size: the number of bytes to memory-map, or -1
+ *
+ * Sets the maximum number of bytes of the database file that may be
+ * accessed using memory-mapped I/O. For SQLite this is applied with
+ * `PRAGMA mmap_size` on every connection. A value of 0 disables
+ * memory-mapped I/O.
+ *
+ * Set to -1 to use the backend default.
+ */
+void
+gom_driver_options_set_mmap_size (GomDriverOptions *self,
+                                  gint64            mmap_size)
+{
+  g_return_if_fail (GOM_IS_DRIVER_OPTIONS (self));
+  g_return_if_fail (mmap_size >= -1);
+
+  self->mmap_size = mmap_size;
+}
+
+/**
+ * gom_driver_options_get_mmap_size:
+ * @self: a [class@Gom.DriverOptions]
+ *
+ * Gets the memory-mapped I/O size.
+ *
+ * Returns: the number of bytes to memory-map, or -1 for the backend default
+ */
+gint64
+gom_driver_options_get_mmap_size (GomDriverOptions *self)
+{
+  g_return_val_if_fail (GOM_IS_DRIVER_OPTIONS (self), -1);
+
+  return self->mmap_size;
+}
+
+/**
+ * gom_driver_options_set_cache_size:
+ * @self: a [class@Gom.DriverOptions]
+ * @cache_size: the page cache size, or 0
+ *
+ * Sets the page cache size for each connection. This follows the
+ * semantics of SQLite's `PRAGMA cache_size`; positive values are a
+ * number of pages and negative values are a size in KiB.
+ *
+ * Set to 0 to use the backend default.
+ */
+void
+gom_driver_options_set_cache_size (GomDriverOptions *self,
+                                   int               cache_size)
+{
+  g_return_if_fail (GOM_IS_DRIVER_OPTIONS (self));
+
+  self->cache_size = cache_size;
+}
+
+/**
+ * gom_driver_options_get_cache_size:
+ * @self: a [class@Gom.DriverOptions]
+ *
+ * Gets the page cache size.
+ *
+ * Returns: the page cache size, or 0 for the backend default
+ */
+int
+gom_driver_options_get_cache_size (GomDriverOptions *self)
+{
+  g_return_val_if_fail (GOM_IS_DRIVER_OPTIONS (self), 0);
+
+  return self->cache_size;
+}
+
+/**
+ * gom_driver_options_set_temp_store:
+ * @self: a [class@Gom.DriverOptions]
+ * @temp_store: a [enum@Gom.TempStore]
+ *
+ * Sets where temporary tables and indices are stored.
+ */
+void
+gom_driver_options_set_temp_store (GomDriverOptions *self,
+                                   GomTempStore      temp_store)
+{
+  g_return_if_fail (GOM_IS_DRIVER_OPTIONS (self));
+  g_return_if_fail (temp_store <= GOM_TEMP_STORE_MEMORY);
+
+  self->temp_store = temp_store;
+}
+
+/**
+ * gom_driver_options_get_temp_store:
+ * @self: a [class@Gom.DriverOptions]
+ *
+ * Gets where temporary tables and indices are stored.
+ *
+ * Returns: a [enum@Gom.TempStore]
+ */
+GomTempStore
+gom_driver_options_get_temp_store (GomDriverOptions *self)
+{
+  g_return_val_if_fail (GOM_IS_DRIVER_OPTIONS (self), GOM_TEMP_STORE_DEFAULT);
+
+  return self->temp_store;
+}
+
+/**
+ * gom_driver_options_set_wal_autocheckpoint:
+ * @self: a [class@Gom.DriverOptions]
+ * @wal_autocheckpoint: the number of WAL pages between checkpoints, or -1
+ *
+ * Sets how many pages may accumulate in the write-ahead log before a
+ * committing connection checkpoints it. A value of 0 disables automatic
+ * checkpoints entirely.
+ *
+ * Set to -1 to use the backend default.
+ */
+void
+gom_driver_options_set_wal_autocheckpoint (GomDriverOptions *self,
+                                           int               wal_autocheckpoint)
+{
+  g_return_if_fail (GOM_IS_DRIVER_OPTIONS (self));
+  g_return_if_fail (wal_autocheckpoint >= -1);
+
+  self->wal_autocheckpoint = wal_autocheckpoint;
+}
+
+/**
+ * gom_driver_options_get_wal_autocheckpoint:
+ * @self: a [class@Gom.DriverOptions]
+ *
+ * Gets the write-ahead log autocheckpoint interval.
+ *
+ * Returns: the number of pages, or -1 for the backend default
+ */
+int
+gom_driver_options_get_wal_autocheckpoint (GomDriverOptions *self)
+{
+  g_return_val_if_fail (GOM_IS_DRIVER_OPTIONS (self), -1);
+
+  return self->wal_autocheckpoint;
+}
+
+/**
+ * gom_driver_options_set_busy_timeout:
+ * @self: a [class@Gom.DriverOptions]
+ * @busy_timeout_msec: the busy timeout in milliseconds, or 0
+ *
+ * Sets how long the database engine itself may wait on a locked database
+ * before reporting it as busy. Gom still applies its own bounded retry on
+ * top of this.
+ *
+ * Set to 0 to use the backend default.
+ */
+void
+gom_driver_options_set_busy_timeout (GomDriverOptions *self,
+                                     guint             busy_timeout_msec)
+{
+  g_return_if_fail (GOM_IS_DRIVER_OPTIONS (self));
+  g_return_if_fail (busy_timeout_msec <= G_MAXINT);
+
+  self->busy_timeout_msec = busy_timeout_msec;
+}
+
+/**
+ * gom_driver_options_get_busy_timeout:
+ * @self: a [class@Gom.DriverOptions]
+ *
+ * Gets the busy timeout in milliseconds.
+ *
+ * Returns: the busy timeout, or 0 for the backend default
+ */
+guint
+gom_driver_options_get_busy_timeout (GomDriverOptions *self)
+{
+  g_return_val_if_fail (GOM_IS_DRIVER_OPTIONS (self), 0);
+
+  return self->busy_timeout_msec;
+}
+
+/**
+ * gom_driver_options_set_checkpoint_interval:
+ * @self: a [class@Gom.DriverOptions]
+ * @interval_msec: milliseconds between background checkpoints, or 0
+ *
+ * Enables a background write-ahead log checkpointer that runs every
+ * @interval_msec milliseconds on an idle connection. This moves
+ * checkpoint cost off of committing sessions.
+ *
+ * Unless [method@Gom.DriverOptions.set_wal_autocheckpoint] is also set,
+ * enabling the background checkpointer disables automatic checkpoints
+ * on commit.
+ *
+ * Set to 0 to disable the background checkpointer, which is the default.
+ */
+void
+gom_driver_options_set_checkpoint_interval (GomDriverOptions *self,
+                                            guint             interval_msec)
+{
+  g_return_if_fail (GOM_IS_DRIVER_OPTIONS (self));
+
+  self->checkpoint_interval_msec = interval_msec;
+}
+
+/**
+ * gom_driver_options_get_checkpoint_interval:
+ * @self: a [class@Gom.DriverOptions]
+ *
+ * Gets the background checkpoint interval.
+ *
+ * Returns: milliseconds between checkpoints, or 0 if disabled
+ */
+guint
+gom_driver_options_get_checkpoint_interval (GomDriverOptions *self)
+{
+  g_return_val_if_fail (GOM_IS_DRIVER_OPTIONS (self), 0);
+
+  return self->checkpoint_interval_msec;
+}
+
+/**
+ * gom_driver_options_set_wal_size_limit:
+ * @self: a [class@Gom.DriverOptions]
+ * @wal_size_limit: size of the write-ahead log in bytes, or 0
+ *
+ * Sets the write-ahead log size at which the background checkpointer
+ * escalates from a passive checkpoint to one that also resets and
+ * truncates the log.
+ *
+ * Set to 0 to use the backend default.
+ */
+void
+gom_driver_options_set_wal_size_limit (GomDriverOptions *self,
+                                       gint64            wal_size_limit)
+{
+  g_return_if_fail (GOM_IS_DRIVER_OPTIONS (self));
+  g_return_if_fail (wal_size_limit >= 0);
+
+  self->wal_size_limit = wal_size_limit;
+}
+
+/**
+ * gom_driver_options_get_wal_size_limit:
+ * @self: a [class@Gom.DriverOptions]
+ *
+ * Gets the write-ahead log size limit for the background checkpointer.
+ *
+ * Returns: the size in bytes, or 0 for the backend default
+ */
+gint64
+gom_driver_options_get_wal_size_limit (GomDriverOptions *self)
+{
+  g_return_val_if_fail (GOM_IS_DRIVER_OPTIONS (self), 0);
+
+  return self->wal_size_limit;
+}
+
+/**
+ * gom_driver_options_set_cursor_spool_rows:
+ * @self: a [class@Gom.DriverOptions]
+ * @cursor_spool_rows: maximum number of rows to spool per cursor, or 0
+ *
+ * Sets how many rows a cursor may keep in memory once they have been
+ * read from the backend.
+ *
+ * Spooled rows can be revisited with [method@Gom.Cursor.move_absolute],
+ * [method@Gom.Cursor.move_relative] or [method@Gom.Cursor.rewind]
+ * without executing the query again. A cursor that reads more rows than
+ * this limit drops its spool and falls back to re-executing the query
+ * when moving backwards.
+ *
+ * Set to 0 to disable spooling, which is the default.
+ */
+void
+gom_driver_options_set_cursor_spool_rows (GomDriverOptions *self,
+                                          guint             cursor_spool_rows)
+{
+  g_return_if_fail (GOM_IS_DRIVER_OPTIONS (self));
+
+  self->cursor_spool_rows = cursor_spool_rows;
+}
+
+/**
+ * gom_driver_options_get_cursor_spool_rows:
+ * @self: a [class@Gom.DriverOptions]
+ *
+ * Gets the maximum number of rows a cursor may spool.
+ *
+ * Returns: the number of rows, or 0 if spooling is disabled
+ */
+guint
+gom_driver_options_get_cursor_spool_rows (GomDriverOptions *self)
+{
+  g_return_val_if_fail (GOM_IS_DRIVER_OPTIONS (self), 0);
+
+  return self->cursor_spool_rows;
+}
+
+/**
+ * gom_driver_options_set_group_commit_window:
+ * @self: a [class@Gom.DriverOptions]
+ * @window_msec: milliseconds to collect mutations before committing, or 0
+ *
+ * Enables group commit for mutations made outside of a session, such as
+ * [method@Gom.Repository.mutate], [method@Gom.Entity.insert] and
+ * [method@Gom.Entity.update].
+ *
+ * Mutations arriving within @window_msec of each other are applied in a
+ * single transaction instead of committing one at a time. Each mutation
+ * still completes with its own result, and a failing mutation is rolled
+ * back without affecting the others in the group. The group is committed
+ * early once it reaches [method@Gom.DriverOptions.set_group_commit_size]
+ * mutations.
+ *
+ * While a group is collecting it holds the write lock, so sessions and
+ * migrations may wait up to @window_msec longer to begin.
+ *
+ * Set to 0 to commit every mutation on its own, which is the default.
+ */
+void
+gom_driver_options_set_group_commit_window (GomDriverOptions *self,
+                                            guint             window_msec)
+{
+  g_return_if_fail (GOM_IS_DRIVER_OPTIONS (self));
+
+  self->group_commit_window_msec = window_msec;
+}
+
+/**
+ * gom_driver_options_get_group_commit_window:
+ * @self: a [class@Gom.DriverOptions]
+ *
+ * Gets the group commit window.
+ *
+ * Returns: the window in milliseconds, or 0 if group commit is disabled
+ */
+guint
+gom_driver_options_get_group_commit_window (GomDriverOptions *self)
+{
+  g_return_val_if_fail (GOM_IS_DRIVER_OPTIONS (self), 0);
+
+  return self->group_commit_window_msec;
+}
+
+/**
+ * gom_driver_options_set_group_commit_size:
+ * @self: a [class@Gom.DriverOptions]
+ * @group_commit_size: maximum number of mutations per group, or 0
+ *
+ * Sets how many mutations may be applied in a single group commit. A group
+ * that fills up is committed without waiting for the rest of the window
+ * set with [method@Gom.DriverOptions.set_group_commit_window].
+ *
+ * Set to 0 to use the backend default.
+ */
+void
+gom_driver_options_set_group_commit_size (GomDriverOptions *self,
+                                          guint             group_commit_size)
+{
+  g_return_if_fail (GOM_IS_DRIVER_OPTIONS (self));
+
+  self->group_commit_size = group_commit_size;
+}
+
+/**
+ * gom_driver_options_get_group_commit_size:
+ * @self: a [class@Gom.DriverOptions]
+ *
+ * Gets the maximum number of mutations per group commit.
+ *
+ * Returns: the number of mutations, or 0 for the backend default
+ */
+guint
+gom_driver_options_get_group_commit_size (GomDriverOptions *self)
+{
+  g_return_val_if_fail (GOM_IS_DRIVER_OPTIONS (self), 0);
+
+  return self->group_commit_size;
+}
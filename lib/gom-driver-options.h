@@ -33,11 +33,71 @@ GOM_AVAILABLE_IN_ALL
 G_DECLARE_FINAL_TYPE (GomDriverOptions, gom_driver_options, GOM, DRIVER_OPTIONS, GObject)
 
 GOM_AVAILABLE_IN_ALL
-GomDriverOptions *gom_driver_options_new                (void);
+GomDriverOptions *gom_driver_options_new                      (void);
 GOM_AVAILABLE_IN_ALL
-void              gom_driver_options_set_encryption_key (GomDriverOptions *self,
-                                                         GBytes           *key);
+void              gom_driver_options_set_encryption_key       (GomDriverOptions *self,
+                                                               GBytes           *key);
 GOM_AVAILABLE_IN_ALL
-GBytes           *gom_driver_options_dup_encryption_key (GomDriverOptions *self);
+GBytes           *gom_driver_options_dup_encryption_key       (GomDriverOptions *self);
+GOM_AVAILABLE_IN_ALL
+void              gom_driver_options_set_max_connections      (GomDriverOptions *self,
+                                                               guint             max_connections);
+GOM_AVAILABLE_IN_ALL
+guint             gom_driver_options_get_max_connections      (GomDriverOptions *self);
+GOM_AVAILABLE_IN_ALL
+void              gom_driver_options_set_max_concurrent_opens (GomDriverOptions *self,
+                                                               guint             max_concurrent_opens);
+GOM_AVAILABLE_IN_ALL
+guint             gom_driver_options_get_max_concurrent_opens (GomDriverOptions *self);
+GOM_AVAILABLE_IN_ALL
+void              gom_driver_options_set_mmap_size            (GomDriverOptions *self,
+                                                               gint64            mmap_size);
+GOM_AVAILABLE_IN_ALL
+gint64            gom_driver_options_get_mmap_size            (GomDriverOptions *self);
+GOM_AVAILABLE_IN_ALL
+void              gom_driver_options_set_cache_size           (GomDriverOptions *self,
+                                                               int               cache_size);
+GOM_AVAILABLE_IN_ALL
+int               gom_driver_options_get_cache_size           (GomDriverOptions *self);
+GOM_AVAILABLE_IN_ALL
+void              gom_driver_options_set_temp_store           (GomDriverOptions *self,
+                                                               GomTempStore      temp_store);
+GOM_AVAILABLE_IN_ALL
+GomTempStore      gom_driver_options_get_temp_store           (GomDriverOptions *self);
+GOM_AVAILABLE_IN_ALL
+void              gom_driver_options_set_wal_autocheckpoint   (GomDriverOptions *self,
+                                                               int               wal_autocheckpoint);
+GOM_AVAILABLE_IN_ALL
+int               gom_driver_options_get_wal_autocheckpoint   (GomDriverOptions *self);
+GOM_AVAILABLE_IN_ALL
+void              gom_driver_options_set_busy_timeout         (GomDriverOptions *self,
+                                                               guint             busy_timeout_msec);
+GOM_AVAILABLE_IN_ALL
+guint             gom_driver_options_get_busy_timeout         (GomDriverOptions *self);
+GOM_AVAILABLE_IN_ALL
+void              gom_driver_options_set_checkpoint_interval  (GomDriverOptions *self,
+                                                               guint             interval_msec);
+GOM_AVAILABLE_IN_ALL
+guint             gom_driver_options_get_checkpoint_interval  (GomDriverOptions *self);
+GOM_AVAILABLE_IN_ALL
+void              gom_driver_options_set_wal_size_limit       (GomDriverOptions *self,
+                                                               gint64            wal_size_limit);
+GOM_AVAILABLE_IN_ALL
+gint64            gom_driver_options_get_wal_size_limit       (GomDriverOptions *self);
+GOM_AVAILABLE_IN_ALL
+void              gom_driver_options_set_cursor_spool_rows    (GomDriverOptions *self,
+                                                               guint             cursor_spool_rows);
+GOM_AVAILABLE_IN_ALL
+guint             gom_driver_options_get_cursor_spool_rows    (GomDriverOptions *self);
+GOM_AVAILABLE_IN_ALL
+void              gom_driver_options_set_group_commit_window  (GomDriverOptions *self,
+                                                               guint             window_msec);
+GOM_AVAILABLE_IN_ALL
+guint             gom_driver_options_get_group_commit_window  (GomDriverOptions *self);
+GOM_AVAILABLE_IN_ALL
+void              gom_driver_options_set_group_commit_size    (GomDriverOptions *self,
+                                                               guint             group_commit_size);
+GOM_AVAILABLE_IN_ALL
+guint             gom_driver_options_get_group_commit_size    (GomDriverOptions *self);
 
 G_END_DECLS
@@ -33,8 +33,14 @@ typedef GomDriver *(*GomDriverConstructor) (const char        *uri,
 
 struct _GomDriver
 {
-  GObject parent_instance;
-  int     repository_use_count;
+  GObject    parent_instance;
+  int        repository_use_count;
+
+  /* Repositories to notify of committed changes, as weak references
+   * paired with the scheduler they were opened on.
+   */
+  GMutex     repositories_mutex;
+  GPtrArray *repositories;
 };
 
 struct _GomDriverClass
@@ -96,7 +102,11 @@ gboolean   _gom_driver_supports_feature         (GomDriver            *self,
 gboolean   _gom_driver_supports_vector_distance (GomDriver            *self,
                                                  GomVectorFormat       format,
                                                  GomVectorMetric       metric);
-void       _gom_driver_acquire_repository       (GomDriver            *self);
+void       _gom_driver_acquire_repository       (GomDriver            *self,
+                                                 GomRepository        *repository);
 void       _gom_driver_release_repository       (GomDriver            *self);
+void       _gom_driver_post_changes             (GomDriver            *self,
+                                                 GomChangeSet         *changes);
+gboolean   _gom_driver_wants_changes            (GomDriver            *self);
 
 G_END_DECLS
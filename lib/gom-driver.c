@@ -24,13 +24,14 @@
 
 #include <gmodule.h>
 
+#include "gom-change-set-private.h"
 #include "gom-config.h"
 #include "gom-driver-options.h"
 #include "gom-driver-private.h"
 #include "gom-meta.h"
 #include "gom-mutation-private.h"
 #include "gom-query-private.h"
-#include "gom-repository.h"
+#include "gom-repository-private.h"
 #include "gom-schema.h"
 #include "gom-util-private.h"
 
@@ -45,6 +46,40 @@ G_DEFINE_ABSTRACT_TYPE (GomDriver, gom_driver, G_TYPE_OBJECT)
 
 static GParamSpec *properties[N_PROPS];
 
+typedef struct
+{
+  GWeakRef      repository;
+  DexScheduler *scheduler;
+} GomDriverRepository;
+
+typedef struct
+{
+  GomRepository *repository;
+  DexScheduler  *scheduler;
+  GomChangeSet  *changes;
+} GomDriverDispatch;
+
+static void
+gom_driver_repository_free (gpointer data)
+{
+  GomDriverRepository *entry = data;
+
+  g_weak_ref_clear (&entry->repository);
+  dex_clear (&entry->scheduler);
+  g_free (entry);
+}
+
+static void
+gom_driver_finalize (GObject *object)
+{
+  GomDriver *self = GOM_DRIVER (object);
+
+  g_clear_pointer (&self->repositories, g_ptr_array_unref);
+  g_mutex_clear (&self->repositories_mutex);
+
+  G_OBJECT_CLASS (gom_driver_parent_class)->finalize (object);
+}
+
 static void
 gom_driver_get_property (GObject    *object,
                          guint       prop_id,
@@ -69,6 +104,7 @@ gom_driver_class_init (GomDriverClass *klass)
 {
   GObjectClass *object_class = G_OBJECT_CLASS (klass);
 
+  object_class->finalize = gom_driver_finalize;
   object_class->get_property = gom_driver_get_property;
 
   properties[PROP_URI] =
@@ -82,6 +118,8 @@ gom_driver_class_init (GomDriverClass *klass)
 static void
 gom_driver_init (GomDriver *self)
 {
+  g_mutex_init (&self->repositories_mutex);
+  self->repositories = g_ptr_array_new_with_free_func (gom_driver_repository_free);
 }
 
 typedef struct
@@ -524,19 +562,165 @@ gom_driver_open (const char  *uri,
 }
 
 void
-_gom_driver_acquire_repository (GomDriver *self)
+_gom_driver_acquire_repository (GomDriver     *self,
+                                GomRepository *repository)
 {
+  GomDriverRepository *entry;
+
   g_return_if_fail (GOM_IS_DRIVER (self));
+  g_return_if_fail (GOM_IS_REPOSITORY (repository));
 
   g_atomic_int_inc (&self->repository_use_count);
+
+  entry = g_new0 (GomDriverRepository, 1);
+  g_weak_ref_init (&entry->repository, repository);
+  if (!(entry->scheduler = dex_scheduler_ref_thread_default ()))
+    entry->scheduler = dex_ref (dex_scheduler_get_default ());
+
+  g_mutex_lock (&self->repositories_mutex);
+  g_ptr_array_add (self->repositories, entry);
+  g_mutex_unlock (&self->repositories_mutex);
 }
 
 void
 _gom_driver_release_repository (GomDriver *self)
 {
+  g_autoptr(GPtrArray) alive = NULL;
+
   g_return_if_fail (GOM_IS_DRIVER (self));
 
   g_atomic_int_dec_and_test (&self->repository_use_count);
+
+  /* Called from repository finalize, so its weak reference is already
+   * cleared. Drop every entry whose repository is gone. The references
+   * taken on the others are only released once unlocked, since dropping
+   * the last one finalizes that repository and lands back here.
+   */
+  alive = g_ptr_array_new_with_free_func (g_object_unref);
+
+  g_mutex_lock (&self->repositories_mutex);
+  for (guint i = self->repositories->len; i > 0; i--)
+    {
+      GomDriverRepository *entry = g_ptr_array_index (self->repositories, i - 1);
+      GomRepository *repository = g_weak_ref_get (&entry->repository);
+
+      if (repository == NULL)
+        g_ptr_array_remove_index_fast (self->repositories, i - 1);
+      else
+        g_ptr_array_add (alive, repository);
+    }
+  g_mutex_unlock (&self->repositories_mutex);
+}
+
+static void
+gom_driver_dispatch_free (gpointer data)
+{
+  GomDriverDispatch *dispatch = data;
+
+  g_clear_object (&dispatch->repository);
+  dex_clear (&dispatch->scheduler);
+  g_clear_object (&dispatch->changes);
+  g_free (dispatch);
+}
+
+static void
+gom_driver_dispatch_changes (gpointer data)
+{
+  GomDriverDispatch *dispatch = data;
+
+  _gom_repository_emit_changes (dispatch->repository, dispatch->changes);
+  gom_driver_dispatch_free (dispatch);
+}
+
+/* Returns a GomDriverDispatch without changes for every repository that
+ * is still alive. Callers must release the array unlocked, as dropping
+ * the last reference to a repository calls back into
+ * _gom_driver_release_repository().
+ */
+static GPtrArray *
+gom_driver_collect_repositories (GomDriver *self)
+{
+  GPtrArray *dispatches = g_ptr_array_new_with_free_func (gom_driver_dispatch_free);
+
+  g_mutex_lock (&self->repositories_mutex);
+  for (guint i = 0; i < self->repositories->len; i++)
+    {
+      GomDriverRepository *entry = g_ptr_array_index (self->repositories, i);
+      GomRepository *repository = g_weak_ref_get (&entry->repository);
+      GomDriverDispatch *dispatch;
+
+      if (repository == NULL)
+        continue;
+
+      dispatch = g_new0 (GomDriverDispatch, 1);
+      dispatch->repository = repository;
+      dispatch->scheduler = dex_ref (entry->scheduler);
+      g_ptr_array_add (dispatches, dispatch);
+    }
+  g_mutex_unlock (&self->repositories_mutex);
+
+  return dispatches;
+}
+
+/* Delivers @changes, which were just committed, to every repository
+ * using @self. May be called from any thread; each repository is
+ * notified on the scheduler it was opened on.
+ */
+void
+_gom_driver_post_changes (GomDriver    *self,
+                          GomChangeSet *changes)
+{
+  g_autoptr(GPtrArray) dispatches = NULL;
+
+  g_return_if_fail (GOM_IS_DRIVER (self));
+  g_return_if_fail (GOM_IS_CHANGE_SET (changes));
+
+  if (gom_change_set_get_n_changes (changes) == 0)
+    return;
+
+  dispatches = gom_driver_collect_repositories (self);
+
+  while (dispatches->len > 0)
+    {
+      GomDriverDispatch *dispatch = g_ptr_array_steal_index_fast (dispatches, dispatches->len - 1);
+
+      /* Nobody would see the copy */
+      if (!_gom_repository_has_changes_handlers (dispatch->repository))
+        {
+          gom_driver_dispatch_free (dispatch);
+          continue;
+        }
+
+      /* Each repository resolves identities against its own registry */
+      dispatch->changes = _gom_change_set_new ();
+      _gom_change_set_append (dispatch->changes, changes);
+
+      dex_scheduler_push (dispatch->scheduler, gom_driver_dispatch_changes, dispatch);
+    }
+}
+
+/* Whether any repository using @self listens for committed changes.
+ * Drivers that have to capture changed rows themselves check this before
+ * doing so. May be called from any thread.
+ */
+gboolean
+_gom_driver_wants_changes (GomDriver *self)
+{
+  g_autoptr(GPtrArray) dispatches = NULL;
+
+  g_return_val_if_fail (GOM_IS_DRIVER (self), FALSE);
+
+  dispatches = gom_driver_collect_repositories (self);
+
+  for (guint i = 0; i < dispatches->len; i++)
+    {
+      GomDriverDispatch *dispatch = g_ptr_array_index (dispatches, i);
+
+      if (_gom_repository_has_changes_handlers (dispatch->repository))
+        return TRUE;
+    }
+
+  return FALSE;
 }
 
 /**
@@ -24,12 +24,15 @@
 #include "gom-entity.h"
 #include "gom-entity-list-item-private.h"
 #include "gom-entity-list-model-private.h"
+#include "gom-keyset-private.h"
+#include "gom-page-cache-private.h"
 #include "gom-query-private.h"
 #include "gom-repository-private.h"
 #include "gom-trace-private.h"
 #include "gom-session-private.h"
 
 #define GOM_ENTITY_LIST_DEFAULT_PAGE_SIZE 64
+#define GOM_ENTITY_LIST_DEFAULT_MAX_PAGES 16
 
 typedef enum
 {
@@ -45,6 +48,7 @@ typedef struct
   GListStore      *items;
   guint            loaded : 1;
   guint            loading : 1;
+  guint            prefetch : 1;
 } GomEntityListPage;
 
 struct _GomEntityListModel
@@ -53,11 +57,18 @@ struct _GomEntityListModel
   GomSession          *session;
   GomRepository       *repository;
   GomQuery            *query;
+  GomKeyset           *keyset;
   GHashTable          *wrappers;
-  GHashTable          *pages;
+  GomPageCache        *pages;
   DexFuture           *reload_future;
+  GArray              *prefetch;
+  GSource             *prefetch_source;
   guint64              generation;
-  gulong               session_changed_handler;
+  GomReadAhead         read_ahead;
+  guint                read_ahead_window[GOM_READ_AHEAD_MAX_PAGES];
+  guint                n_read_ahead_window;
+  guint                n_loading_pages;
+  guint                reload_handle;
   guint                n_items;
   guint                page_size;
   guint                loading : 1;
@@ -72,6 +83,7 @@ enum
   PROP_REPOSITORY,
   PROP_QUERY,
   PROP_LOADING,
+  PROP_MAX_PAGES,
   N_PROPS
 };
 
@@ -92,7 +104,8 @@ static void       gom_entity_list_model_invalidate_snapshot (GomEntityListModel
 static DexFuture *gom_entity_list_model_request_reload      (GomEntityListModel  *self,
                                                              gboolean             invalidate);
 static void       gom_entity_list_model_queue_page          (GomEntityListModel  *self,
-                                                             guint                page_index);
+                                                             guint                page_index,
+                                                             gboolean             prefetch);
 
 G_DEFINE_TYPE_WITH_CODE (GomEntityListModel,
                          gom_entity_list_model,
@@ -208,20 +221,36 @@ gom_entity_list_model_dup_page_query (GomEntityListModel *self,
 {
   guint64 page_offset = (guint64)page_index * self->page_size;
 
+  if (self->keyset != NULL)
+    return _gom_keyset_dup_page_query (self->keyset, page_index, self->page_size);
+
   return _gom_query_slice (self->query, page_offset, self->page_size);
 }
 
+static void
+gom_entity_list_model_weak_ref_free (GWeakRef *weak_ref)
+{
+  g_weak_ref_clear (weak_ref);
+  g_free (weak_ref);
+}
+
 static GomEntityListItem *
 gom_entity_list_model_ensure_wrapper (GomEntityListModel *self,
                                       guint               position)
 {
   GomEntityListItem *wrapper;
+  GWeakRef *weak_ref;
 
-  if ((wrapper = g_hash_table_lookup (self->wrappers, GUINT_TO_POINTER (position))))
+  weak_ref = g_hash_table_lookup (self->wrappers, GUINT_TO_POINTER (position));
+  if (weak_ref != NULL && (wrapper = g_weak_ref_get (weak_ref)))
     return wrapper;
 
   wrapper = gom_entity_list_item_new (position);
-  g_hash_table_insert (self->wrappers, GUINT_TO_POINTER (position), wrapper);
+
+  weak_ref = g_new0 (GWeakRef, 1);
+  g_weak_ref_init (weak_ref, wrapper);
+
+  g_hash_table_replace (self->wrappers, GUINT_TO_POINTER (position), weak_ref);
 
   return wrapper;
 }
@@ -230,14 +259,19 @@ static GomEntityListItem *
 gom_entity_list_model_lookup_wrapper (GomEntityListModel *self,
                                       guint               position)
 {
-  return g_hash_table_lookup (self->wrappers, GUINT_TO_POINTER (position));
+  GWeakRef *weak_ref;
+
+  if (!(weak_ref = g_hash_table_lookup (self->wrappers, GUINT_TO_POINTER (position))))
+    return NULL;
+
+  return g_weak_ref_get (weak_ref);
 }
 
 static GomEntityListPage *
 gom_entity_list_model_lookup_page (GomEntityListModel *self,
                                    guint               page_index)
 {
-  return g_hash_table_lookup (self->pages, GUINT_TO_POINTER (page_index));
+  return _gom_page_cache_lookup (self->pages, page_index);
 }
 
 static void
@@ -245,9 +279,13 @@ gom_entity_list_model_set_wrapper_loading (gpointer key,
                                            gpointer value,
                                            gpointer user_data)
 {
-  GomEntityListItem *item = value;
+  GWeakRef *weak_ref = value;
+  g_autoptr(GomEntityListItem) item = NULL;
+
+  g_assert (weak_ref != NULL);
 
-  g_assert (GOM_IS_ENTITY_LIST_ITEM (item));
+  if (!(item = g_weak_ref_get (weak_ref)))
+    return;
 
   _gom_entity_list_item_set_loading (item, FALSE);
 }
@@ -272,7 +310,16 @@ gom_entity_list_model_clear_snapshot (GomEntityListModel *self)
     }
 
   if (self->pages != NULL)
-    g_hash_table_remove_all (self->pages);
+    _gom_page_cache_remove_all (self->pages);
+
+  if (self->prefetch != NULL)
+    g_array_set_size (self->prefetch, 0);
+
+  _gom_read_ahead_reset (&self->read_ahead);
+  self->n_read_ahead_window = 0;
+
+  if (self->keyset != NULL)
+    _gom_keyset_reset (self->keyset);
 }
 
 static void
@@ -307,8 +354,8 @@ gom_entity_list_model_update_page_wrappers (GomEntityListModel *self,
   for (guint i = 0; i < n_items; i++)
     {
       guint position = page->index * self->page_size + i;
+      g_autoptr(GomEntityListItem) wrapper = NULL;
       g_autoptr(GomEntity) item = NULL;
-      GomEntityListItem *wrapper;
 
       if (position >= self->n_items)
         break;
@@ -323,6 +370,55 @@ gom_entity_list_model_update_page_wrappers (GomEntityListModel *self,
     }
 }
 
+static gboolean
+gom_entity_list_model_evict_page_cb (guint    page_index,
+                                     gpointer data,
+                                     gpointer user_data)
+{
+  GomEntityListModel *self = user_data;
+  GomEntityListPage *page = data;
+  guint start;
+  guint end;
+
+  g_assert (GOM_IS_ENTITY_LIST_MODEL (self));
+  g_assert (page != NULL);
+
+  if (page->loading)
+    return FALSE;
+
+  start = page_index * self->page_size;
+  end = MIN (start + self->page_size, self->n_items);
+
+  /* A wrapper that is still alive is bound to a row of a view, which must
+   * never go blank. Such pages stay loaded even past the budget.
+   */
+  for (guint position = start; position < end; position++)
+    {
+      g_autoptr(GomEntityListItem) wrapper = gom_entity_list_model_lookup_wrapper (self, position);
+
+      if (wrapper != NULL)
+        return FALSE;
+    }
+
+  for (guint position = start; position < end; position++)
+    g_hash_table_remove (self->wrappers, GUINT_TO_POINTER (position));
+
+  return TRUE;
+}
+
+static void
+gom_entity_list_model_evict_pages (GomEntityListModel *self)
+{
+  guint n_evicted;
+
+  g_assert (GOM_IS_ENTITY_LIST_MODEL (self));
+
+  n_evicted = _gom_page_cache_evict (self->pages, gom_entity_list_model_evict_page_cb, self);
+
+  if (n_evicted > 0)
+    GOM_TRACE_MARK ("EntityListModel", "evict", "n_pages=%u", n_evicted);
+}
+
 static void
 gom_entity_list_model_page_started (GomEntityListModel *self,
                                     GomEntityListPage  *page)
@@ -338,7 +434,7 @@ gom_entity_list_model_page_started (GomEntityListModel *self,
 
   for (guint position = start; position < end; position++)
     {
-      GomEntityListItem *wrapper = gom_entity_list_model_lookup_wrapper (self, position);
+      g_autoptr(GomEntityListItem) wrapper = gom_entity_list_model_lookup_wrapper (self, position);
 
       if (wrapper != NULL)
         _gom_entity_list_item_set_loading (wrapper, TRUE);
@@ -406,7 +502,7 @@ gom_entity_list_model_query_to_list_fiber (gpointer user_data)
   gom_entity_list_model_emit_size_change (self, old_n_items, self->n_items);
 
   if (self->n_items > 0)
-    gom_entity_list_model_queue_page (self, 0);
+    gom_entity_list_model_queue_page (self, 0, FALSE);
 
 complete:
   gom_entity_list_model_set_loading (self, FALSE);
@@ -438,11 +534,96 @@ fail:
   return dex_future_new_for_error (g_steal_pointer (&error));
 }
 
+static gboolean
+gom_entity_list_model_prefetch_cb (gpointer user_data)
+{
+  GomEntityListModel *self = user_data;
+
+  g_assert (GOM_IS_ENTITY_LIST_MODEL (self));
+
+  g_clear_pointer (&self->prefetch_source, g_source_unref);
+
+  while (self->prefetch->len > 0 && self->n_loading_pages == 0)
+    {
+      guint page_index = g_array_index (self->prefetch, guint, 0);
+
+      g_array_remove_index (self->prefetch, 0);
+      gom_entity_list_model_queue_page (self, page_index, TRUE);
+    }
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Prefetches only start from a low priority idle once no page is loading,
+ * so they never hold the lease a requested page is waiting for.
+ */
+static void
+gom_entity_list_model_schedule_prefetch (GomEntityListModel *self)
+{
+  g_assert (GOM_IS_ENTITY_LIST_MODEL (self));
+
+  if (self->prefetch_source != NULL ||
+      self->prefetch->len == 0 ||
+      self->n_loading_pages > 0)
+    return;
+
+  self->prefetch_source = g_idle_source_new ();
+  g_source_set_priority (self->prefetch_source, G_PRIORITY_LOW);
+  g_source_set_static_name (self->prefetch_source, "[gom-entity-list-prefetch]");
+  g_source_set_callback (self->prefetch_source, gom_entity_list_model_prefetch_cb, self, NULL);
+  g_source_attach (self->prefetch_source, g_main_context_get_thread_default ());
+}
+
+static void
+gom_entity_list_model_read_ahead (GomEntityListModel *self,
+                                  guint               page_index)
+{
+  guint64 n_pages;
+
+  g_assert (GOM_IS_ENTITY_LIST_MODEL (self));
+
+  n_pages = ((guint64)self->n_items + self->page_size - 1) / self->page_size;
+
+  if (!_gom_read_ahead_update (&self->read_ahead,
+                               page_index,
+                               MIN (n_pages, G_MAXUINT),
+                               _gom_page_cache_max_read_ahead (self->pages),
+                               self->read_ahead_window,
+                               &self->n_read_ahead_window))
+    return;
+
+  /* Queued pages that are no longer ahead of the reader are dropped */
+  g_array_set_size (self->prefetch, 0);
+
+  for (guint i = 0; i < self->n_read_ahead_window; i++)
+    {
+      GomEntityListPage *page = _gom_page_cache_peek (self->pages, self->read_ahead_window[i]);
+
+      if (page == NULL || (!page->loaded && !page->loading))
+        g_array_append_val (self->prefetch, self->read_ahead_window[i]);
+    }
+
+  gom_entity_list_model_schedule_prefetch (self);
+}
+
+static gboolean
+gom_entity_list_model_prefetch_wanted (GomEntityListModel *self,
+                                       GomEntityListPage  *page)
+{
+  return !page->prefetch ||
+         _gom_read_ahead_contains (self->read_ahead_window,
+                                   self->n_read_ahead_window,
+                                   page->index);
+}
+
 static void
 gom_entity_list_model_page_future_free (gpointer data)
 {
   GomEntityListPageTask *task = data;
 
+  task->self->n_loading_pages--;
+  gom_entity_list_model_schedule_prefetch (task->self);
+
   g_clear_object (&task->self);
   gom_entity_list_page_unref (task->page);
   g_free (task);
@@ -470,6 +651,15 @@ gom_entity_list_model_page_fiber (gpointer user_data)
   if (generation != self->generation)
     goto complete;
 
+  /* The reader moved elsewhere before this prefetch got to run */
+  if (!gom_entity_list_model_prefetch_wanted (self, page))
+    {
+      page->loading = FALSE;
+      if (_gom_page_cache_peek (self->pages, page->index) == page)
+        _gom_page_cache_remove (self->pages, page->index);
+      goto complete;
+    }
+
   query = gom_entity_list_model_dup_page_query (self, page->index);
 
   if (self->source == GOM_ENTITY_LIST_SOURCE_SESSION)
@@ -500,7 +690,11 @@ gom_entity_list_model_page_fiber (gpointer user_data)
   page->loaded = TRUE;
   page->loading = FALSE;
 
+  if (self->keyset != NULL)
+    _gom_keyset_set_page (self->keyset, page->index, self->page_size, G_LIST_MODEL (results));
+
   gom_entity_list_model_update_page_wrappers (self, page);
+  gom_entity_list_model_evict_pages (self);
 
 complete:
   return dex_future_new_true ();
@@ -514,7 +708,7 @@ fail:
 
     for (guint position = start; position < end; position++)
       {
-        GomEntityListItem *wrapper = gom_entity_list_model_lookup_wrapper (self, position);
+        g_autoptr(GomEntityListItem) wrapper = gom_entity_list_model_lookup_wrapper (self, position);
 
         if (wrapper != NULL)
           _gom_entity_list_item_set_loading (wrapper, FALSE);
@@ -529,7 +723,8 @@ fail:
 
 static void
 gom_entity_list_model_queue_page (GomEntityListModel *self,
-                                  guint               page_index)
+                                  guint               page_index,
+                                  gboolean            prefetch)
 {
   GomEntityListPage *page;
   GomEntityListPageTask *task;
@@ -542,19 +737,31 @@ gom_entity_list_model_queue_page (GomEntityListModel *self,
   if (!(page = gom_entity_list_model_lookup_page (self, page_index)))
     {
       page = gom_entity_list_page_new (page_index, self->generation);
-      g_hash_table_insert (self->pages, GUINT_TO_POINTER (page_index), page);
+      _gom_page_cache_insert (self->pages, page_index, page);
+      gom_entity_list_model_evict_pages (self);
     }
 
+  /* A request for a page being prefetched keeps it from being cancelled */
+  if (!prefetch)
+    page->prefetch = FALSE;
+
   if (page->loading || page->loaded)
     return;
 
   page->loading = TRUE;
-  gom_entity_list_model_page_started (self, page);
+  page->prefetch = !!prefetch;
+
+  if (!prefetch)
+    gom_entity_list_model_page_started (self, page);
 
   task = g_new0 (GomEntityListPageTask, 1);
   task->self = g_object_ref (self);
   task->page = gom_entity_list_page_ref (page);
 
+  self->n_loading_pages++;
+
+  GOM_TRACE_MARK ("EntityListModel", "queue-page", "page=%u prefetch=%d", page_index, !!prefetch);
+
   dex_future_disown (dex_scheduler_spawn (NULL,
                                           0,
                                           gom_entity_list_model_page_fiber,
@@ -609,14 +816,12 @@ gom_entity_list_model_request_reload (GomEntityListModel *self,
                                   invalidate);
 }
 
-static void
-gom_entity_list_model_session_changed_cb (GomEntityListModel *self,
-                                          GomSession         *session)
+static DexFuture *
+gom_entity_list_model_scheduled_reload (gpointer instance)
 {
-  g_assert (GOM_IS_ENTITY_LIST_MODEL (self));
-  g_assert (GOM_IS_SESSION (session));
+  g_assert (GOM_IS_ENTITY_LIST_MODEL (instance));
 
-  dex_future_disown (gom_entity_list_model_request_reload (self, TRUE));
+  return gom_entity_list_model_request_reload (instance, TRUE);
 }
 
 static GType
@@ -638,7 +843,7 @@ gom_entity_list_model_get_item_iface (GListModel *model,
                                       guint       position)
 {
   GomEntityListModel *self = GOM_ENTITY_LIST_MODEL (model);
-  GomEntityListItem *wrapper;
+  g_autoptr(GomEntityListItem) wrapper = NULL;
   guint page_index;
 
   if (position >= self->n_items)
@@ -665,11 +870,13 @@ gom_entity_list_model_get_item_iface (GListModel *model,
     else
       {
         _gom_entity_list_item_set_loading (wrapper, TRUE);
-        gom_entity_list_model_queue_page (self, page_index);
+        gom_entity_list_model_queue_page (self, page_index, FALSE);
       }
   }
 
-  return g_object_ref (wrapper);
+  gom_entity_list_model_read_ahead (self, page_index);
+
+  return g_steal_pointer (&wrapper);
 }
 
 static void
@@ -685,15 +892,25 @@ gom_entity_list_model_finalize (GObject *object)
 {
   GomEntityListModel *self = GOM_ENTITY_LIST_MODEL (object);
 
-  if (self->session != NULL && self->session_changed_handler != 0)
-    g_clear_signal_handler (&self->session_changed_handler, self->session);
+  if (self->session != NULL && self->reload_handle != 0 &&
+      _gom_session_get_reload_scheduler (self->session) != NULL)
+    _gom_reload_scheduler_remove (_gom_session_get_reload_scheduler (self->session),
+                                  self->reload_handle);
 
   g_clear_object (&self->session);
   g_clear_object (&self->repository);
   g_clear_object (&self->query);
+  g_clear_pointer (&self->keyset, _gom_keyset_free);
   g_clear_pointer (&self->wrappers, g_hash_table_unref);
-  g_clear_pointer (&self->pages, g_hash_table_unref);
+  g_clear_pointer (&self->pages, _gom_page_cache_free);
   g_clear_pointer (&self->reload_future, dex_unref);
+  g_clear_pointer (&self->prefetch, g_array_unref);
+
+  if (self->prefetch_source != NULL)
+    {
+      g_source_destroy (self->prefetch_source);
+      g_clear_pointer (&self->prefetch_source, g_source_unref);
+    }
 
   G_OBJECT_CLASS (gom_entity_list_model_parent_class)->finalize (object);
 }
@@ -724,6 +941,10 @@ gom_entity_list_model_get_property (GObject    *object,
       g_value_set_boolean (value, self->loading);
       break;
 
+    case PROP_MAX_PAGES:
+      g_value_set_uint (value, gom_entity_list_model_get_max_pages (self));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
     }
@@ -755,6 +976,10 @@ gom_entity_list_model_set_property (GObject      *object,
       g_set_object (&self->query, g_value_get_object (value));
       break;
 
+    case PROP_MAX_PAGES:
+      gom_entity_list_model_set_max_pages (self, g_value_get_uint (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
     }
@@ -772,13 +997,19 @@ gom_entity_list_model_constructed (GObject *object)
   else if (self->repository != NULL)
     self->source = GOM_ENTITY_LIST_SOURCE_REPOSITORY;
 
-  if (self->session != NULL)
-    self->session_changed_handler =
-      g_signal_connect_object (self->session,
-                               "changed",
-                               G_CALLBACK (gom_entity_list_model_session_changed_cb),
-                               self,
-                               G_CONNECT_SWAPPED);
+  if (self->session != NULL && self->query != NULL &&
+      _gom_session_get_reload_scheduler (self->session) != NULL)
+    {
+      _gom_session_follow_committed_changes (self->session);
+      self->reload_handle =
+        _gom_reload_scheduler_add (_gom_session_get_reload_scheduler (self->session),
+                                   self,
+                                   _gom_reload_scheduler_query_relation (self->query),
+                                   gom_entity_list_model_scheduled_reload);
+    }
+
+  if (self->query != NULL)
+    self->keyset = _gom_keyset_new (self->query);
 
   gom_entity_list_model_request_reload (self, FALSE);
 }
@@ -813,15 +1044,35 @@ gom_entity_list_model_class_init (GomEntityListModelClass *klass)
                           FALSE,
                           (G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GomEntityListModel:max-pages:
+   *
+   * The number of loaded pages kept in memory, or 0 for no limit.
+   *
+   * Pages furthest from the recently requested positions are released
+   * first. Their items stay in the model and load again on demand. Pages
+   * holding an item that is still referenced, such as one bound to a
+   * row of a view, are kept even when that exceeds the budget.
+   */
+  properties[PROP_MAX_PAGES] =
+    g_param_spec_uint ("max-pages", NULL, NULL,
+                       0, G_MAXUINT, GOM_ENTITY_LIST_DEFAULT_MAX_PAGES,
+                       (G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS));
+
   g_object_class_install_properties (object_class, N_PROPS, properties);
 }
 
 static void
 gom_entity_list_model_init (GomEntityListModel *self)
 {
-  self->wrappers = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, g_object_unref);
-  self->pages = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL,
-                                       (GDestroyNotify)gom_entity_list_page_unref);
+  self->wrappers = g_hash_table_new_full (g_direct_hash,
+                                          g_direct_equal,
+                                          NULL,
+                                          (GDestroyNotify)gom_entity_list_model_weak_ref_free);
+  self->pages = _gom_page_cache_new ((GDestroyNotify)gom_entity_list_page_unref);
+  _gom_page_cache_set_max_pages (self->pages, GOM_ENTITY_LIST_DEFAULT_MAX_PAGES);
+  self->prefetch = g_array_new (FALSE, FALSE, sizeof (guint));
+  _gom_read_ahead_reset (&self->read_ahead);
   self->page_size = GOM_ENTITY_LIST_DEFAULT_PAGE_SIZE;
 }
 
@@ -943,3 +1194,40 @@ gom_entity_list_model_dup_repository (GomEntityListModel *self)
 
   return self->session ? gom_session_dup_repository (self->session) : NULL;
 }
+
+/**
+ * gom_entity_list_model_get_max_pages:
+ * @self: a [class@Gom.EntityListModel]
+ *
+ * Returns: the number of loaded pages kept in memory, or 0 for no limit
+ */
+guint
+gom_entity_list_model_get_max_pages (GomEntityListModel *self)
+{
+  g_return_val_if_fail (GOM_IS_ENTITY_LIST_MODEL (self), 0);
+
+  return _gom_page_cache_get_max_pages (self->pages);
+}
+
+/**
+ * gom_entity_list_model_set_max_pages:
+ * @self: a [class@Gom.EntityListModel]
+ * @max_pages: the number of pages to keep, or 0 for no limit
+ *
+ * Sets how many loaded pages are kept in memory. Pages over the budget
+ * are released right away, unless they hold an item that is still
+ * referenced.
+ */
+void
+gom_entity_list_model_set_max_pages (GomEntityListModel *self,
+                                     guint               max_pages)
+{
+  g_return_if_fail (GOM_IS_ENTITY_LIST_MODEL (self));
+
+  if (max_pages == _gom_page_cache_get_max_pages (self->pages))
+    return;
+
+  _gom_page_cache_set_max_pages (self->pages, max_pages);
+  gom_entity_list_model_evict_pages (self);
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_MAX_PAGES]);
+}
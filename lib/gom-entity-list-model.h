@@ -44,5 +44,10 @@ GOM_AVAILABLE_IN_ALL
 GomSession    *gom_entity_list_model_dup_session    (GomEntityListModel *self);
 GOM_AVAILABLE_IN_ALL
 GomRepository *gom_entity_list_model_dup_repository (GomEntityListModel *self);
+GOM_AVAILABLE_IN_ALL
+guint          gom_entity_list_model_get_max_pages  (GomEntityListModel *self);
+GOM_AVAILABLE_IN_ALL
+void           gom_entity_list_model_set_max_pages  (GomEntityListModel *self,
+                                                     guint               max_pages);
 
 G_END_DECLS
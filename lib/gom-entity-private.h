@@ -115,7 +115,7 @@ void                       _gom_entity_apply_delta               (GomEntity
 gboolean                   _gom_entity_change_state_is_complete  (GomEntity           *self);
 void                       _gom_entity_clear_change_state        (GomEntity           *self);
 GomSession                *_gom_entity_dup_session               (GomEntity           *self);
-char                      *_gom_entity_dup_session_key           (GomEntity           *self);
+GomIdentityKey            *_gom_entity_dup_session_key           (GomEntity           *self);
 GList                     *_gom_entity_get_session_link          (GomEntity           *self);
 GList                     *_gom_entity_get_pending_link          (GomEntity           *self);
 GList                     *_gom_entity_get_dirty_link            (GomEntity           *self);
@@ -127,7 +127,7 @@ void                       _gom_entity_set_dirty                 (GomEntity
                                                                   gboolean             dirty);
 void                       _gom_entity_attach                    (GomEntity           *self,
                                                                   GomSession          *session,
-                                                                  char                *entity_key);
+                                                                  GomIdentityKey      *entity_key);
 void                       _gom_entity_detach                    (GomEntity           *self);
 void                       _gom_entity_track_changes             (GomEntity           *self,
                                                                   GomSession          *session);
@@ -136,5 +136,28 @@ void                       _gom_entity_set_origin                (GomEntity
                                                                   GomEntityOrigin      origin);
 void                       _gom_entity_set_lifecycle             (GomEntity           *self,
                                                                   GomEntityLifecycle   lifecycle);
+GPtrArray                 *_gom_entity_collect_insert_batch      (GQueue              *queue,
+                                                                  guint                max_entities);
+DexFuture                 *_gom_entity_insert_batch              (GPtrArray           *entities);
+GPtrArray                 *_gom_entity_collect_update_batch      (GQueue              *queue,
+                                                                  guint                max_entities);
+DexFuture                 *_gom_entity_update_batch              (GPtrArray           *entities);
+GPtrArray                 *_gom_entity_fetch_related             (GType                entity_type,
+                                                                  GListModel          *owners,
+                                                                  const char          *relationship_name,
+                                                                  GomRepository       *repository,
+                                                                  GomSession          *session,
+                                                                  GError             **error);
+gboolean                   _gom_entity_prefetch_related          (GType                entity_type,
+                                                                  GListModel          *owners,
+                                                                  const char * const  *relationship_names,
+                                                                  GomRepository       *repository,
+                                                                  GomSession          *session,
+                                                                  GError             **error);
+void                       _gom_entity_set_prefetched_related    (GomEntity           *self,
+                                                                  const char          *relationship_name,
+                                                                  GPtrArray           *related);
+GPtrArray                 *_gom_entity_steal_prefetched_related  (GomEntity           *self,
+                                                                  const char          *relationship_name);
 
 G_END_DECLS
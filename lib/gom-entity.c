@@ -22,6 +22,8 @@
 
 #include "gom-deletion-builder.h"
 #include "gom-expression.h"
+#include "gom-expression-private.h"
+#include "gom-identity-key-private.h"
 #include "gom-insertion-builder.h"
 #include "gom-mutation-private.h"
 #include "gom-deletion-private.h"
@@ -31,7 +33,8 @@
 #include "gom-meta-private.h"
 #include "gom-query-private.h"
 #include "gom-query-builder.h"
-#include "gom-related-model.h"
+#include "gom-record.h"
+#include "gom-related-model-private.h"
 #include "gom-repository-private.h"
 #include "gom-cursor-private.h"
 #include "gom-session-private.h"
@@ -46,9 +49,10 @@ typedef struct _GomEntityPrivate
 {
   GomRepository      *repository;
   GomSession         *session;
-  char               *session_key;
+  GomIdentityKey     *session_key;
   GHashTable         *baseline_values;
   GHashTable         *dirty_properties;
+  GHashTable         *prefetched;
   GList               link;
   GList               pending_link;
   GList               dirty_link;
@@ -80,7 +84,7 @@ G_DEFINE_ENUM_TYPE (GomEntityOrigin, gom_entity_origin,
 static GomExpression         *gom_entity_real_dup_identity_value         (GomEntity                  *self,
                                                                           const char                 *identity_field,
                                                                           GError                    **error);
-static char                  *gom_entity_build_identity_key              (GomEntity                  *self);
+static GomIdentityKey        *gom_entity_build_identity_key              (GomEntity                  *self);
 static GomExpression         *gom_entity_build_identity_filter           (GomEntity                  *self,
                                                                           GomEntityClass             *entity_class,
                                                                           const char * const         *identity_fields,
@@ -156,7 +160,7 @@ gom_entity_finalize (GObject *object)
 {
   GomEntityPrivate *priv = gom_entity_get_instance_private ((GomEntity *)object);
 
-  g_clear_pointer (&priv->session_key, g_free);
+  g_clear_pointer (&priv->session_key, _gom_identity_key_unref);
   g_clear_pointer (&priv->baseline_values, g_hash_table_unref);
   g_clear_pointer (&priv->dirty_properties, g_hash_table_unref);
 
@@ -170,6 +174,7 @@ gom_entity_dispose (GObject *object)
 
   g_clear_object (&priv->repository);
   g_clear_object (&priv->session);
+  g_clear_pointer (&priv->prefetched, g_hash_table_unref);
 
   G_OBJECT_CLASS (gom_entity_parent_class)->dispose (object);
 }
@@ -304,6 +309,9 @@ gom_entity_mark_property_dirty (GomEntity  *self,
     priv->dirty_properties = g_hash_table_new (g_str_hash, g_str_equal);
 
   g_hash_table_add (priv->dirty_properties, (gpointer)g_intern_string (property_name));
+
+  /* A changed key may point at different related rows now. */
+  g_clear_pointer (&priv->prefetched, g_hash_table_unref);
 }
 
 /**
@@ -367,10 +375,10 @@ gom_entity_get_origin (GomEntity *self)
   return priv->origin;
 }
 
-static char *
+static GomIdentityKey *
 gom_entity_build_identity_key (GomEntity *self)
 {
-  g_autoptr(GString) key = NULL;
+  GomIdentityKeyBuilder builder;
   GomEntityClass *entity_class;
   const GomPropertySpec *property_spec;
   GType value_type;
@@ -386,21 +394,57 @@ gom_entity_build_identity_key (GomEntity *self)
   if (gom_entity_get_entity_spec (self) == NULL)
     return NULL;
 
-  key = g_string_new (G_OBJECT_TYPE_NAME (self));
-  g_string_append_c (key, '\n');
+  _gom_identity_key_builder_init (&builder, G_OBJECT_TYPE (self));
 
   for (guint i = 0; identity_fields[i] != NULL; i++)
     {
       g_auto(GValue) value = G_VALUE_INIT;
-      g_autofree char *value_contents = NULL;
 
       if (!(property_spec = gom_entity_get_property_spec (self, identity_fields[i])))
-        return NULL;
+        {
+          _gom_identity_key_builder_clear (&builder);
+          return NULL;
+        }
 
       value_type = gom_property_spec_get_value_type ((GomPropertySpec *)property_spec);
 
       g_value_init (&value, value_type);
       g_object_get_property (G_OBJECT (self), identity_fields[i], &value);
+
+      if (!_gom_identity_key_builder_append (&builder, &value))
+        break;
+    }
+
+  return _gom_identity_key_builder_end (&builder);
+}
+
+/* The string form of the identity handed to GomEntityClass.attach. The
+ * session itself uses the binary key from gom_entity_build_identity_key().
+ */
+static char *
+gom_entity_build_identity_string (GomEntity *self)
+{
+  g_autoptr(GString) key = NULL;
+  const char * const *identity_fields;
+
+  g_assert (GOM_IS_ENTITY (self));
+
+  key = g_string_new (G_OBJECT_TYPE_NAME (self));
+  g_string_append_c (key, '\n');
+
+  identity_fields = gom_entity_class_get_identity_fields (GOM_ENTITY_GET_CLASS (self));
+
+  for (guint i = 0; identity_fields != NULL && identity_fields[i] != NULL; i++)
+    {
+      const GomPropertySpec *property_spec;
+      g_auto(GValue) value = G_VALUE_INIT;
+      g_autofree char *value_contents = NULL;
+
+      if (!(property_spec = gom_entity_get_property_spec (self, identity_fields[i])))
+        continue;
+
+      g_value_init (&value, gom_property_spec_get_value_type ((GomPropertySpec *)property_spec));
+      g_object_get_property (G_OBJECT (self), identity_fields[i], &value);
       value_contents = g_strdup_value_contents (&value);
 
       g_string_append (key, identity_fields[i]);
@@ -423,8 +467,6 @@ gom_entity_real_attach (GomEntity  *self,
   g_return_if_fail (session == NULL || GOM_IS_SESSION (session));
 
   g_set_object (&priv->session, session);
-  g_clear_pointer (&priv->session_key, g_free);
-  priv->session_key = entity_key;
   priv->link.data = self;
   priv->pending_link.data = self;
   priv->dirty_link.data = self;
@@ -438,6 +480,8 @@ gom_entity_real_attach (GomEntity  *self,
       priv->pending = TRUE;
       priv->lifecycle = GOM_ENTITY_LIFECYCLE_PENDING;
     }
+
+  g_free (entity_key);
 }
 
 static void
@@ -454,7 +498,7 @@ gom_entity_real_detach (GomEntity *self)
   _gom_entity_clear_change_state (self);
 
   g_clear_object (&priv->session);
-  g_clear_pointer (&priv->session_key, g_free);
+  g_clear_pointer (&priv->session_key, _gom_identity_key_unref);
 
   priv->pending = FALSE;
   priv->dirty = FALSE;
@@ -472,7 +516,7 @@ _gom_entity_dup_session (GomEntity *self)
   return priv->session ? g_object_ref (priv->session) : NULL;
 }
 
-char *
+GomIdentityKey *
 _gom_entity_dup_session_key (GomEntity *self)
 {
   GomEntityPrivate *priv = gom_entity_get_instance_private (self);
@@ -482,7 +526,7 @@ _gom_entity_dup_session_key (GomEntity *self)
   if (priv->session_key == NULL)
     priv->session_key = gom_entity_build_identity_key (self);
 
-  return priv->session_key ? g_strdup (priv->session_key) : NULL;
+  return priv->session_key ? _gom_identity_key_ref (priv->session_key) : NULL;
 }
 
 GList *
@@ -557,15 +601,28 @@ _gom_entity_set_dirty (GomEntity *self,
   priv->dirty = dirty != FALSE;
 }
 
+/* Takes ownership of @entity_key. The binary key stays private to the
+ * entity and its session, while GomEntityClass.attach keeps receiving
+ * the public string form.
+ */
 void
-_gom_entity_attach (GomEntity  *self,
-                    GomSession *session,
-                    char       *entity_key)
+_gom_entity_attach (GomEntity      *self,
+                    GomSession     *session,
+                    GomIdentityKey *entity_key)
 {
+  GomEntityPrivate *priv = gom_entity_get_instance_private (self);
+  char *public_key = NULL;
+
   g_return_if_fail (GOM_IS_ENTITY (self));
   g_return_if_fail (session == NULL || GOM_IS_SESSION (session));
 
-  GOM_ENTITY_GET_CLASS (self)->attach (self, session, entity_key);
+  g_clear_pointer (&priv->session_key, _gom_identity_key_unref);
+  priv->session_key = entity_key;
+
+  if (entity_key != NULL)
+    public_key = gom_entity_build_identity_string (self);
+
+  GOM_ENTITY_GET_CLASS (self)->attach (self, session, public_key);
 }
 
 static void
@@ -1067,7 +1124,7 @@ _gom_entity_detach (GomEntity *self)
 gboolean
 gom_entity_rekey_session_identity (GomEntity *self)
 {
-  g_autofree char *entity_key = NULL;
+  g_autoptr(GomIdentityKey) entity_key = NULL;
   g_autoptr(GomSession) session = NULL;
 
   g_return_val_if_fail (GOM_IS_ENTITY (self), FALSE);
@@ -2534,53 +2591,77 @@ gom_entity_mutation_task_free (gpointer data)
   g_free (task);
 }
 
-static DexFuture *
-gom_entity_mutation_fiber (gpointer user_data)
+/* Applies the row @record returned for the insertion of @self: backfills
+ * generated identity values and records the insert as a change.
+ */
+static gboolean
+gom_entity_complete_insert (GomEntity      *self,
+                            GomSession     *session,
+                            GomRepository  *repository,
+                            GomRecord      *record,
+                            GError        **error)
+{
+  g_autoptr(GomDelta) delta = NULL;
+
+  g_assert (GOM_IS_ENTITY (self));
+  g_assert (!session || GOM_IS_SESSION (session));
+  g_assert (GOM_IS_REPOSITORY (repository));
+
+  if (record == NULL || !gom_entity_backfill_identity_from_record (self, record, error))
+    {
+      if (error != NULL && *error == NULL)
+        g_set_error_literal (error,
+                             G_IO_ERROR,
+                             G_IO_ERROR_FAILED,
+                             "Insert did not return an identity value");
+      return FALSE;
+    }
+
+  if (!(delta = gom_entity_build_snapshot_delta (self, repository, GOM_DELTA_KIND_INSERT, error)))
+    return FALSE;
+
+  gom_entity_capture_current_state (self, TRUE);
+
+  if (session != NULL)
+    _gom_session_record_entity_changes (session, self, delta);
+  else if (!gom_entity_stage_repository_change (self, repository, delta, error))
+    return FALSE;
+
+  return TRUE;
+}
+
+static GomMutationResult *
+gom_entity_mutation_task_run (GomEntityMutationTask  *task,
+                              GError                **error)
 {
-  GomEntityMutationTask *task = user_data;
   g_autoptr(GomMutationResult) result = NULL;
-  g_autoptr(GError) error = NULL;
 
   g_assert (task != NULL);
   g_assert (GOM_IS_ENTITY (task->self));
   g_assert (GOM_IS_MUTATION (task->mutation));
 
-  if (!gom_entity_validate_relationships_for_mutation (task->self, &error))
-    return dex_future_new_for_error (g_steal_pointer (&error));
+  if (!gom_entity_validate_relationships_for_mutation (task->self, error))
+    return NULL;
 
-  if (!(result = dex_await_object (gom_entity_mutate_run (task->self, task->mutation, task->session, task->repository), &error)))
-    return dex_future_new_for_error (g_steal_pointer (&error));
+  if (!(result = dex_await_object (gom_entity_mutate_run (task->self, task->mutation, task->session, task->repository), error)))
+    return NULL;
 
   if (GOM_IS_INSERTION (task->mutation))
     {
-      g_autoptr(GomDelta) delta = NULL;
       g_autoptr(GomRecord) record = NULL;
 
       if (g_list_model_get_n_items (G_LIST_MODEL (result)) == 0)
-        return dex_future_new_reject (G_IO_ERROR,
-                                      G_IO_ERROR_FAILED,
-                                      "Insert did not return mutation rows");
-
-      record = g_list_model_get_item (G_LIST_MODEL (result), 0);
-      if (record == NULL || !gom_entity_backfill_identity_from_record (task->self, record, &error))
         {
-          if (error == NULL)
-            return dex_future_new_reject (G_IO_ERROR,
-                                          G_IO_ERROR_FAILED,
-                                          "Insert did not return an identity value");
-
-          return dex_future_new_for_error (g_steal_pointer (&error));
+          g_set_error_literal (error,
+                               G_IO_ERROR,
+                               G_IO_ERROR_FAILED,
+                               "Insert did not return mutation rows");
+          return NULL;
         }
 
-      if (!(delta = gom_entity_build_snapshot_delta (task->self, task->repository, GOM_DELTA_KIND_INSERT, &error)))
-        return dex_future_new_for_error (g_steal_pointer (&error));
-
-      gom_entity_capture_current_state (task->self, TRUE);
-
-      if (task->session != NULL)
-        _gom_session_record_entity_changes (task->session, task->self, delta);
-      else if (!gom_entity_stage_repository_change (task->self, task->repository, delta, &error))
-        return dex_future_new_for_error (g_steal_pointer (&error));
+      record = g_list_model_get_item (G_LIST_MODEL (result), 0);
+      if (!gom_entity_complete_insert (task->self, task->session, task->repository, record, error))
+        return NULL;
     }
   else if (task->session != NULL && GOM_IS_UPDATE (task->mutation))
     {
@@ -2589,10 +2670,23 @@ gom_entity_mutation_fiber (gpointer user_data)
   else if (GOM_IS_UPDATE (task->mutation))
     {
       _gom_entity_apply_delta (task->self, task->delta, task->change_state_complete);
-      if (!gom_entity_stage_repository_change (task->self, task->repository, task->delta, &error))
-        return dex_future_new_for_error (g_steal_pointer (&error));
+      if (!gom_entity_stage_repository_change (task->self, task->repository, task->delta, error))
+        return NULL;
     }
 
+  return g_steal_pointer (&result);
+}
+
+static DexFuture *
+gom_entity_mutation_fiber (gpointer user_data)
+{
+  GomEntityMutationTask *task = user_data;
+  g_autoptr(GomMutationResult) result = NULL;
+  g_autoptr(GError) error = NULL;
+
+  if (!(result = gom_entity_mutation_task_run (task, &error)))
+    return dex_future_new_for_error (g_steal_pointer (&error));
+
   return dex_future_new_take_object (g_steal_pointer (&result));
 }
 
@@ -2605,7 +2699,7 @@ gom_entity_delete_visit (GomEntityDeleteTask  *task,
   g_autoptr(GomDeletionBuilder) builder = NULL;
   g_autoptr(GomDeletion) deletion = NULL;
   g_autoptr(GomExpression) filter = NULL;
-  g_autofree char *entity_key = NULL;
+  g_autoptr(GomIdentityKey) entity_key = NULL;
   GomEntityClass *entity_class;
   const char * const *identity_fields;
   GType entity_type;
@@ -2624,11 +2718,6 @@ gom_entity_delete_visit (GomEntityDeleteTask  *task,
       return FALSE;
     }
 
-  if (g_hash_table_contains (task->visited, entity_key))
-    return TRUE;
-
-  g_hash_table_add (task->visited, g_steal_pointer (&entity_key));
-
   entity_class = GOM_ENTITY_CLASS (G_OBJECT_GET_CLASS (entity));
   identity_fields = gom_entity_class_get_identity_fields (entity_class);
   entity_type = G_OBJECT_TYPE (entity);
@@ -2847,804 +2936,2281 @@ gom_entity_delete_visit (GomEntityDeleteTask  *task,
   return TRUE;
 }
 
-static GomExpression *
-gom_entity_real_dup_identity_value (GomEntity   *self,
-                                    const char  *identity_field,
-                                    GError     **error)
-{
-  GomEntityClass *entity_class;
-  GObjectClass *object_class;
-  const GomPropertySpec *property_spec;
-  GParamSpec *pspec;
-  GType value_type;
-  g_auto(GValue) fallback_default_value = G_VALUE_INIT;
-  const GValue *default_value = NULL;
-  g_auto(GValue) value = G_VALUE_INIT;
-  g_auto(GValue) storage_value = G_VALUE_INIT;
-
-  g_return_val_if_fail (GOM_IS_ENTITY (self), NULL);
-  g_return_val_if_fail (identity_field != NULL, NULL);
-
-  object_class = G_OBJECT_GET_CLASS (self);
-  entity_class = GOM_ENTITY_CLASS (object_class);
-
-  if (!(property_spec = gom_entity_get_property_spec (self, identity_field)) &&
-      !(pspec = g_object_class_find_property (object_class, identity_field)))
-    {
-      g_set_error (error,
-                   G_IO_ERROR,
-                   G_IO_ERROR_INVALID_ARGUMENT,
-                   "Entity identity field '%s' is not a property",
-                   identity_field);
-      return NULL;
-    }
-
-  if (property_spec != NULL)
-    {
-      value_type = gom_property_spec_get_value_type ((GomPropertySpec *)property_spec);
-      default_value = gom_property_spec_get_default_value ((GomPropertySpec *)property_spec);
-    }
-  else
-    {
-      value_type = G_PARAM_SPEC_VALUE_TYPE (pspec);
-    }
+/* Deleting through the set-based path works on identity tuples instead of
+ * entity instances. Each key is an array of literal expressions holding
+ * the storage values of the owning type's identity fields, in order.
+ */
+#define GOM_ENTITY_CASCADE_BATCH_SIZE 500
 
-  g_value_init (&value, value_type);
-  g_object_get_property (G_OBJECT (self), identity_field, &value);
+static char *
+gom_entity_cascade_key_string (GType      entity_type,
+                               GPtrArray *key)
+{
+  GString *str = g_string_new (g_type_name (entity_type));
 
-  if (property_spec == NULL)
+  for (guint i = 0; i < key->len; i++)
     {
-      g_value_init (&fallback_default_value, value_type);
-      g_param_value_set_default (pspec, &fallback_default_value);
-      default_value = &fallback_default_value;
-    }
-
-  if (gom_entity_value_matches_default (default_value, &value))
-    return NULL;
+      const GValue *value = _gom_literal_expression_peek_value (g_ptr_array_index (key, i));
+      g_autofree char *contents = value != NULL ? g_strdup_value_contents (value) : NULL;
 
-  if (property_spec != NULL)
-    {
-      if (!gom_entity_get_property_storage_value (self, entity_class, object_class, identity_field, &storage_value, error))
-        return NULL;
-    }
-  else
-    {
-      g_value_init (&storage_value, value_type);
-      g_value_copy (&value, &storage_value);
+      g_string_append_c (str, '\n');
+      g_string_append (str, contents != NULL ? contents : "");
     }
 
-  return gom_literal_expression_new (&storage_value);
+  return g_string_free (str, FALSE);
 }
 
 static GomExpression *
-gom_entity_build_identity_filter (GomEntity           *self,
-                                  GomEntityClass      *entity_class,
-                                  const char * const  *identity_fields,
-                                  GError             **error)
+gom_entity_cascade_build_key_filter (GPtrArray          *key,
+                                     const char * const *fields)
 {
   g_autoptr(GomExpression) filter = NULL;
 
-  g_assert (GOM_IS_ENTITY (self));
-  g_assert (GOM_IS_ENTITY_CLASS (entity_class));
-  g_assert (identity_fields != NULL);
-
-  for (guint i = 0; identity_fields[i] != NULL; i++)
+  for (guint i = 0; i < key->len && fields[i] != NULL; i++)
     {
-      const char *identity_field = identity_fields[i];
-      g_autoptr(GomExpression) identity_value = NULL;
+      g_autoptr(GomExpression) field = gom_field_expression_new (fields[i]);
       g_autoptr(GomExpression) predicate = NULL;
 
-      if (!(identity_value = entity_class->dup_identity_value (self, identity_field, error)))
-        {
-          if (error != NULL && *error != NULL)
-            return NULL;
-
-          g_set_error (error,
-                       G_IO_ERROR,
-                       G_IO_ERROR_INVALID_ARGUMENT,
-                       "Entity identity field '%s' is unset",
-                       identity_field);
-          return NULL;
-        }
-
-      if (!gom_expression_is_constant (identity_value))
-        {
-          g_set_error (error,
-                       G_IO_ERROR,
-                       G_IO_ERROR_INVALID_ARGUMENT,
-                       "Entity identity field '%s' did not produce a constant identity expression",
-                       identity_field);
-          return NULL;
-        }
-
-      predicate = gom_binary_expression_new_equal (gom_field_expression_new (identity_field),
-                                                   g_steal_pointer (&identity_value));
+      predicate = gom_binary_expression_new_equal (field, g_ptr_array_index (key, i));
 
       if (filter == NULL)
         filter = g_steal_pointer (&predicate);
       else
-        filter = gom_binary_expression_new_and (g_steal_pointer (&filter),
-                                                g_steal_pointer (&predicate));
+        {
+          GomExpression *conjunction = gom_binary_expression_new_and (filter, predicate);
+
+          g_object_unref (filter);
+          filter = conjunction;
+        }
     }
 
   return g_steal_pointer (&filter);
 }
 
+/* Matches any of @keys[begin..end) against @fields. Single-column keys
+ * become one IN expression so the whole batch binds as a single array.
+ * Composite keys fall back to a disjunction built as a balanced tree so
+ * large batches stay well within the backends' expression depth limits.
+ */
 static GomExpression *
-gom_entity_build_field_filter (GomEntity           *self,
-                               const char * const  *source_fields,
-                               const char * const  *target_fields,
-                               GError             **error)
+gom_entity_cascade_build_filter (GPtrArray          *keys,
+                                 guint               begin,
+                                 guint               end,
+                                 const char * const *fields)
 {
-  g_autoptr(GomExpression) filter = NULL;
-  GomEntityClass *entity_class;
-  GObjectClass *object_class;
-  guint n_source_fields = 0;
-  guint n_target_fields = 0;
+  g_autoptr(GomExpression) left = NULL;
+  g_autoptr(GomExpression) right = NULL;
+  guint middle;
 
-  g_assert (GOM_IS_ENTITY (self));
-  g_assert (source_fields != NULL);
-  g_assert (target_fields != NULL);
+  g_assert (begin < end);
 
-  object_class = G_OBJECT_GET_CLASS (self);
-  entity_class = GOM_ENTITY_CLASS (object_class);
+  if (fields[0] != NULL && fields[1] == NULL)
+    {
+      g_autoptr(GomExpression) target = gom_field_expression_new (fields[0]);
+      g_autoptr(GArray) values = g_array_sized_new (FALSE, TRUE, sizeof (GValue), end - begin);
 
-  while (source_fields[n_source_fields] != NULL)
-    n_source_fields++;
+      g_array_set_clear_func (values, (GDestroyNotify)g_value_unset);
+      g_array_set_size (values, end - begin);
 
-  while (target_fields[n_target_fields] != NULL)
-    n_target_fields++;
+      for (guint i = begin; i < end; i++)
+        {
+          GPtrArray *key = g_ptr_array_index (keys, i);
+          const GValue *value = _gom_literal_expression_peek_value (g_ptr_array_index (key, 0));
+          GValue *dest = &g_array_index (values, GValue, i - begin);
 
-  if (n_source_fields != n_target_fields)
-    {
-      g_set_error_literal (error,
-                           G_IO_ERROR,
-                           G_IO_ERROR_INVALID_ARGUMENT,
-                           "Relationship field cardinality does not match");
-      return NULL;
+          if (value == NULL || G_VALUE_TYPE (value) == G_TYPE_INVALID)
+            continue;
+
+          g_value_init (dest, G_VALUE_TYPE (value));
+          g_value_copy (value, dest);
+        }
+
+      return gom_in_expression_new (target, (const GValue *)(gpointer)values->data, values->len);
     }
 
-  for (guint i = 0; source_fields[i] != NULL && target_fields[i] != NULL; i++)
-    {
-      g_auto(GValue) value = G_VALUE_INIT;
-      g_autoptr(GomExpression) predicate = NULL;
-      g_autoptr(GomExpression) left = NULL;
-      g_autoptr(GomExpression) right = NULL;
+  if (end - begin == 1)
+    return gom_entity_cascade_build_key_filter (g_ptr_array_index (keys, begin), fields);
 
-      if (!gom_entity_get_property_storage_value (self, entity_class, object_class, source_fields[i], &value, error))
-        return NULL;
+  middle = begin + (end - begin) / 2;
 
-      left = gom_field_expression_new (target_fields[i]);
-      right = gom_literal_expression_new (&value);
-      predicate = gom_binary_expression_new_equal (g_steal_pointer (&left),
-                                                   g_steal_pointer (&right));
+  left = gom_entity_cascade_build_filter (keys, begin, middle, fields);
+  right = gom_entity_cascade_build_filter (keys, middle, end, fields);
 
-      if (filter == NULL)
-        filter = g_steal_pointer (&predicate);
-      else
-        filter = gom_binary_expression_new_and (g_steal_pointer (&filter),
+  return gom_binary_expression_new_or (left, right);
+}
+
+static GListModel *
+gom_entity_cascade_query (GomEntityDeleteTask  *task,
+                          GType                 entity_type,
+                          const char           *relation,
+                          const char * const   *projections,
+                          GomExpression        *filter,
+                          gboolean              first_only,
+                          GError              **error)
+{
+  g_autoptr(GomQueryBuilder) query_builder = NULL;
+  g_autoptr(GomQuery) query = NULL;
+
+  query_builder = gom_query_builder_new ();
+
+  if (relation != NULL)
+    gom_query_builder_set_target_relation (query_builder, relation);
+  else
+    gom_query_builder_set_target_entity_type (query_builder, entity_type);
+
+  for (guint i = 0; projections != NULL && projections[i] != NULL; i++)
+    gom_query_builder_add_projection (query_builder, gom_field_expression_new (projections[i]));
+
+  gom_query_builder_set_filter (query_builder, filter);
+
+  if (first_only)
+    gom_query_builder_set_limit (query_builder, 1);
+
+  if (!(query = gom_query_builder_build (query_builder, error)))
+    return NULL;
+
+  return gom_entity_delete_run_query (task, query, error);
+}
+
+static gboolean gom_entity_delete_visit_keys (GomEntityDeleteTask  *task,
+                                              GType                 entity_type,
+                                              const char * const   *identity_fields,
+                                              GPtrArray            *keys,
+                                              GError              **error);
+
+/* Loads the identity of every @owner_type row matching @filter that has
+ * not been visited yet, cascades into them and then deletes them all with
+ * a single statement.
+ */
+static gboolean
+gom_entity_cascade_delete_owners (GomEntityDeleteTask  *task,
+                                  GomEntitySpec        *owner_spec,
+                                  GomExpression        *filter,
+                                  GError              **error)
+{
+  g_autoptr(GomDeletionBuilder) delete_builder = NULL;
+  g_autoptr(GomDeletion) deletion = NULL;
+  g_autoptr(GListModel) records = NULL;
+  g_autoptr(GPtrArray) keys = NULL;
+  const char * const *owner_identity;
+  GType owner_type;
+  guint n_records;
+  guint n_identity = 0;
+
+  owner_type = gom_entity_spec_get_entity_type (owner_spec);
+  owner_identity = gom_entity_spec_get_identity_fields (owner_spec);
+
+  if (owner_identity == NULL || owner_identity[0] == NULL)
+    {
+      g_set_error (error,
+                   G_IO_ERROR,
+                   G_IO_ERROR_INVALID_ARGUMENT,
+                   "Entity type `%s` has no identity fields",
+                   g_type_name (owner_type));
+      return FALSE;
+    }
+
+  n_identity = g_strv_length ((char **)owner_identity);
+
+  if (!(records = gom_entity_cascade_query (task, owner_type, NULL, owner_identity, filter, FALSE, error)))
+    return FALSE;
+
+  n_records = g_list_model_get_n_items (records);
+  if (n_records == 0)
+    return TRUE;
+
+  keys = g_ptr_array_new_with_free_func ((GDestroyNotify)g_ptr_array_unref);
+
+  for (guint i = 0; i < n_records; i++)
+    {
+      g_autoptr(GomRecord) record = g_list_model_get_item (records, i);
+      g_autoptr(GPtrArray) key = g_ptr_array_new_with_free_func (g_object_unref);
+      g_autofree char *key_string = NULL;
+
+      for (guint j = 0; j < n_identity; j++)
+        {
+          g_auto(GValue) value = G_VALUE_INIT;
+
+          if (!gom_record_get_column (record, j, &value))
+            {
+              g_set_error_literal (error,
+                                   G_IO_ERROR,
+                                   G_IO_ERROR_FAILED,
+                                   "Failed to load related entity for cascade delete");
+              return FALSE;
+            }
+
+          g_ptr_array_add (key, gom_literal_expression_new (&value));
+        }
+
+      key_string = gom_entity_cascade_key_string (owner_type, key);
+
+      if (g_hash_table_contains (task->visited, key_string))
+        continue;
+
+      g_hash_table_add (task->visited, g_steal_pointer (&key_string));
+      g_ptr_array_add (keys, g_steal_pointer (&key));
+    }
+
+  if (keys->len > 0 &&
+      !gom_entity_delete_visit_keys (task, owner_type, owner_identity, keys, error))
+    return FALSE;
+
+  delete_builder = gom_deletion_builder_new ();
+  gom_deletion_builder_set_target_entity_type (delete_builder, owner_type);
+  gom_deletion_builder_set_filter (delete_builder, filter);
+
+  if (!(deletion = gom_deletion_builder_build (delete_builder, error)))
+    return FALSE;
+
+  return dex_await (gom_entity_delete_run_mutation (task, GOM_MUTATION (deletion)), error);
+}
+
+/* The set-based counterpart of gom_entity_delete_visit(). Rather than
+ * loading and deleting related entities one at a time, every relationship
+ * targeting @entity_type is applied to all of @keys at once, a batch of
+ * keys per statement, one relationship level at a time.
+ */
+static gboolean
+gom_entity_delete_visit_keys (GomEntityDeleteTask  *task,
+                              GType                 entity_type,
+                              const char * const   *identity_fields,
+                              GPtrArray            *keys,
+                              GError              **error)
+{
+  g_autoptr(GomRegistry) snapshot = NULL;
+  const GomEntitySpec * const *entities;
+  guint n_entities = 0;
+
+  g_assert (task != NULL);
+  g_assert (identity_fields != NULL);
+  g_assert (keys != NULL);
+
+  snapshot = gom_registry_snapshot (task->registry, gom_registry_get_version (task->registry));
+  entities = gom_registry_list_entities (snapshot, &n_entities);
+
+  for (guint i = 0; i < n_entities; i++)
+    {
+      GomEntitySpec *entity_spec = (GomEntitySpec *)entities[i];
+      g_autoptr(GListModel) relationships = NULL;
+      guint n_relationships;
+
+      relationships = gom_entity_spec_list_relationships (entity_spec);
+      n_relationships = g_list_model_get_n_items (relationships);
+
+      for (guint j = 0; j < n_relationships; j++)
+        {
+          g_autoptr(GomRelationshipSpec) relationship = NULL;
+          GomRelationshipDeleteRule delete_rule;
+          const char * const *fields;
+          const char *join_relation = NULL;
+          GType owner_type;
+
+          if (!(relationship = g_list_model_get_item (relationships, j)))
+            continue;
+
+          if (gom_relationship_spec_get_target_type (relationship) != entity_type)
+            continue;
+
+          owner_type = gom_entity_spec_get_entity_type (entity_spec);
+          delete_rule = gom_relationship_spec_get_delete_rule (relationship);
+
+          if (gom_relationship_spec_get_storage (relationship) == GOM_RELATIONSHIP_STORAGE_FK)
+            {
+              fields = gom_relationship_spec_get_local_fields (relationship);
+
+              if (fields == NULL || fields[0] == NULL)
+                continue;
+            }
+          else if (gom_relationship_spec_get_storage (relationship) == GOM_RELATIONSHIP_STORAGE_JOIN_TABLE)
+            {
+              join_relation = gom_relationship_spec_get_join_relation (relationship);
+              fields = gom_relationship_spec_get_join_remote_fields (relationship);
+
+              if (join_relation == NULL || join_relation[0] == '\0')
+                {
+                  g_set_error (error,
+                               G_IO_ERROR,
+                               G_IO_ERROR_INVALID_ARGUMENT,
+                               "Relationship `%s` is missing a join relation",
+                               gom_relationship_spec_get_name (relationship));
+                  return FALSE;
+                }
+
+              if (!gom_entity_delete_relation_exists (task, join_relation, error))
+                {
+                  if (error != NULL && *error != NULL)
+                    return FALSE;
+
+                  continue;
+                }
+
+              if (fields == NULL || fields[0] == NULL)
+                {
+                  g_set_error (error,
+                               G_IO_ERROR,
+                               G_IO_ERROR_INVALID_ARGUMENT,
+                               "Relationship `%s` is missing join-table fields",
+                               gom_relationship_spec_get_name (relationship));
+                  return FALSE;
+                }
+            }
+          else
+            {
+              continue;
+            }
+
+          if (g_strv_length ((char **)fields) != g_strv_length ((char **)identity_fields))
+            {
+              g_set_error_literal (error,
+                                   G_IO_ERROR,
+                                   G_IO_ERROR_INVALID_ARGUMENT,
+                                   "Relationship field cardinality does not match");
+              return FALSE;
+            }
+
+          if (delete_rule == GOM_RELATIONSHIP_DELETE_NO_ACTION)
+            continue;
+
+          for (guint begin = 0; begin < keys->len; begin += GOM_ENTITY_CASCADE_BATCH_SIZE)
+            {
+              guint end = MIN (begin + GOM_ENTITY_CASCADE_BATCH_SIZE, keys->len);
+              g_autoptr(GomExpression) filter = NULL;
+
+              filter = gom_entity_cascade_build_filter (keys, begin, end, fields);
+
+              if (delete_rule == GOM_RELATIONSHIP_DELETE_DENY)
+                {
+                  g_autoptr(GListModel) rows = NULL;
+
+                  if (!(rows = gom_entity_cascade_query (task, owner_type, join_relation, NULL, filter, TRUE, error)))
+                    return FALSE;
+
+                  if (g_list_model_get_n_items (rows) > 0)
+                    {
+                      g_set_error (error,
+                                   G_IO_ERROR,
+                                   G_IO_ERROR_FAILED,
+                                   "Deleting `%s` is denied by relationship `%s`",
+                                   g_type_name (entity_type),
+                                   gom_relationship_spec_get_name (relationship));
+                      return FALSE;
+                    }
+                }
+              else if (join_relation != NULL)
+                {
+                  g_autoptr(GomDeletionBuilder) delete_builder = NULL;
+                  g_autoptr(GomDeletion) join_deletion = NULL;
+
+                  delete_builder = gom_deletion_builder_new ();
+                  gom_deletion_builder_set_target_relation (delete_builder, join_relation);
+                  gom_deletion_builder_set_filter (delete_builder, filter);
+
+                  if (!(join_deletion = gom_deletion_builder_build (delete_builder, error)))
+                    return FALSE;
+
+                  if (!dex_await (gom_entity_delete_run_mutation (task, GOM_MUTATION (join_deletion)), error))
+                    return FALSE;
+                }
+              else if (delete_rule == GOM_RELATIONSHIP_DELETE_NULLIFY)
+                {
+                  g_autoptr(GomUpdateBuilder) update_builder = NULL;
+                  g_autoptr(GomUpdate) update = NULL;
+
+                  update_builder = gom_update_builder_new ();
+                  gom_update_builder_set_target_entity_type (update_builder, owner_type);
+                  gom_update_builder_set_filter (update_builder, filter);
+
+                  for (guint k = 0; fields[k] != NULL; k++)
+                    gom_update_builder_add_assignment (update_builder,
+                                                       gom_field_expression_new (fields[k]),
+                                                       gom_literal_expression_new (NULL));
+
+                  if (!(update = gom_update_builder_build (update_builder, error)))
+                    return FALSE;
+
+                  if (!dex_await (gom_entity_delete_run_mutation (task, GOM_MUTATION (update)), error))
+                    return FALSE;
+                }
+              else if (!gom_entity_cascade_delete_owners (task, entity_spec, filter, error))
+                {
+                  return FALSE;
+                }
+            }
+        }
+    }
+
+  return TRUE;
+}
+
+/* Without a session there are no managed instances to notify about
+ * cascaded deletions, and without a sync coordinator no per-entity
+ * changes to stage, so related rows can be handled a set at a time.
+ */
+static gboolean
+gom_entity_delete_can_visit_keys (GomEntityDeleteTask *task)
+{
+  g_autoptr(GomSyncCoordinator) coordinator = NULL;
+
+  g_assert (task != NULL);
+
+  if (task->session != NULL)
+    return FALSE;
+
+  if ((coordinator = gom_repository_dup_coordinator (task->repository)))
+    return FALSE;
+
+  return TRUE;
+}
+
+static gboolean
+gom_entity_delete_visit_set (GomEntityDeleteTask  *task,
+                             GomEntity            *entity,
+                             GError              **error)
+{
+  g_autoptr(GPtrArray) keys = NULL;
+  g_autoptr(GPtrArray) key = NULL;
+  GomEntityClass *entity_class;
+  GObjectClass *object_class;
+  const char * const *identity_fields;
+
+  g_assert (task != NULL);
+  g_assert (GOM_IS_ENTITY (entity));
+
+  object_class = G_OBJECT_GET_CLASS (entity);
+  entity_class = GOM_ENTITY_CLASS (object_class);
+  identity_fields = gom_entity_class_get_identity_fields (entity_class);
+
+  if (identity_fields == NULL || identity_fields[0] == NULL)
+    {
+      g_set_error_literal (error,
+                           G_IO_ERROR,
+                           G_IO_ERROR_INVALID_ARGUMENT,
+                           "Entity type has no identity fields");
+      return FALSE;
+    }
+
+  key = g_ptr_array_new_with_free_func (g_object_unref);
+
+  for (guint i = 0; identity_fields[i] != NULL; i++)
+    {
+      g_auto(GValue) value = G_VALUE_INIT;
+
+      if (!gom_entity_get_property_storage_value (entity, entity_class, object_class, identity_fields[i], &value, error))
+        return FALSE;
+
+      g_ptr_array_add (key, gom_literal_expression_new (&value));
+    }
+
+  g_hash_table_add (task->visited, gom_entity_cascade_key_string (G_OBJECT_TYPE (entity), key));
+
+  keys = g_ptr_array_new_with_free_func ((GDestroyNotify)g_ptr_array_unref);
+  g_ptr_array_add (keys, g_steal_pointer (&key));
+
+  return gom_entity_delete_visit_keys (task, G_OBJECT_TYPE (entity), identity_fields, keys, error);
+}
+
+static GomExpression *
+gom_entity_real_dup_identity_value (GomEntity   *self,
+                                    const char  *identity_field,
+                                    GError     **error)
+{
+  GomEntityClass *entity_class;
+  GObjectClass *object_class;
+  const GomPropertySpec *property_spec;
+  GParamSpec *pspec;
+  GType value_type;
+  g_auto(GValue) fallback_default_value = G_VALUE_INIT;
+  const GValue *default_value = NULL;
+  g_auto(GValue) value = G_VALUE_INIT;
+  g_auto(GValue) storage_value = G_VALUE_INIT;
+
+  g_return_val_if_fail (GOM_IS_ENTITY (self), NULL);
+  g_return_val_if_fail (identity_field != NULL, NULL);
+
+  object_class = G_OBJECT_GET_CLASS (self);
+  entity_class = GOM_ENTITY_CLASS (object_class);
+
+  if (!(property_spec = gom_entity_get_property_spec (self, identity_field)) &&
+      !(pspec = g_object_class_find_property (object_class, identity_field)))
+    {
+      g_set_error (error,
+                   G_IO_ERROR,
+                   G_IO_ERROR_INVALID_ARGUMENT,
+                   "Entity identity field '%s' is not a property",
+                   identity_field);
+      return NULL;
+    }
+
+  if (property_spec != NULL)
+    {
+      value_type = gom_property_spec_get_value_type ((GomPropertySpec *)property_spec);
+      default_value = gom_property_spec_get_default_value ((GomPropertySpec *)property_spec);
+    }
+  else
+    {
+      value_type = G_PARAM_SPEC_VALUE_TYPE (pspec);
+    }
+
+  g_value_init (&value, value_type);
+  g_object_get_property (G_OBJECT (self), identity_field, &value);
+
+  if (property_spec == NULL)
+    {
+      g_value_init (&fallback_default_value, value_type);
+      g_param_value_set_default (pspec, &fallback_default_value);
+      default_value = &fallback_default_value;
+    }
+
+  if (gom_entity_value_matches_default (default_value, &value))
+    return NULL;
+
+  if (property_spec != NULL)
+    {
+      if (!gom_entity_get_property_storage_value (self, entity_class, object_class, identity_field, &storage_value, error))
+        return NULL;
+    }
+  else
+    {
+      g_value_init (&storage_value, value_type);
+      g_value_copy (&value, &storage_value);
+    }
+
+  return gom_literal_expression_new (&storage_value);
+}
+
+static GomExpression *
+gom_entity_build_identity_filter (GomEntity           *self,
+                                  GomEntityClass      *entity_class,
+                                  const char * const  *identity_fields,
+                                  GError             **error)
+{
+  g_autoptr(GomExpression) filter = NULL;
+
+  g_assert (GOM_IS_ENTITY (self));
+  g_assert (GOM_IS_ENTITY_CLASS (entity_class));
+  g_assert (identity_fields != NULL);
+
+  for (guint i = 0; identity_fields[i] != NULL; i++)
+    {
+      const char *identity_field = identity_fields[i];
+      g_autoptr(GomExpression) identity_value = NULL;
+      g_autoptr(GomExpression) predicate = NULL;
+
+      if (!(identity_value = entity_class->dup_identity_value (self, identity_field, error)))
+        {
+          if (error != NULL && *error != NULL)
+            return NULL;
+
+          g_set_error (error,
+                       G_IO_ERROR,
+                       G_IO_ERROR_INVALID_ARGUMENT,
+                       "Entity identity field '%s' is unset",
+                       identity_field);
+          return NULL;
+        }
+
+      if (!gom_expression_is_constant (identity_value))
+        {
+          g_set_error (error,
+                       G_IO_ERROR,
+                       G_IO_ERROR_INVALID_ARGUMENT,
+                       "Entity identity field '%s' did not produce a constant identity expression",
+                       identity_field);
+          return NULL;
+        }
+
+      predicate = gom_binary_expression_new_equal (gom_field_expression_new (identity_field),
+                                                   g_steal_pointer (&identity_value));
+
+      if (filter == NULL)
+        filter = g_steal_pointer (&predicate);
+      else
+        filter = gom_binary_expression_new_and (g_steal_pointer (&filter),
+                                                g_steal_pointer (&predicate));
+    }
+
+  return g_steal_pointer (&filter);
+}
+
+static GomExpression *
+gom_entity_build_field_filter (GomEntity           *self,
+                               const char * const  *source_fields,
+                               const char * const  *target_fields,
+                               GError             **error)
+{
+  g_autoptr(GomExpression) filter = NULL;
+  GomEntityClass *entity_class;
+  GObjectClass *object_class;
+  guint n_source_fields = 0;
+  guint n_target_fields = 0;
+
+  g_assert (GOM_IS_ENTITY (self));
+  g_assert (source_fields != NULL);
+  g_assert (target_fields != NULL);
+
+  object_class = G_OBJECT_GET_CLASS (self);
+  entity_class = GOM_ENTITY_CLASS (object_class);
+
+  while (source_fields[n_source_fields] != NULL)
+    n_source_fields++;
+
+  while (target_fields[n_target_fields] != NULL)
+    n_target_fields++;
+
+  if (n_source_fields != n_target_fields)
+    {
+      g_set_error_literal (error,
+                           G_IO_ERROR,
+                           G_IO_ERROR_INVALID_ARGUMENT,
+                           "Relationship field cardinality does not match");
+      return NULL;
+    }
+
+  for (guint i = 0; source_fields[i] != NULL && target_fields[i] != NULL; i++)
+    {
+      g_auto(GValue) value = G_VALUE_INIT;
+      g_autoptr(GomExpression) predicate = NULL;
+      g_autoptr(GomExpression) left = NULL;
+      g_autoptr(GomExpression) right = NULL;
+
+      if (!gom_entity_get_property_storage_value (self, entity_class, object_class, source_fields[i], &value, error))
+        return NULL;
+
+      left = gom_field_expression_new (target_fields[i]);
+      right = gom_literal_expression_new (&value);
+      predicate = gom_binary_expression_new_equal (g_steal_pointer (&left),
+                                                   g_steal_pointer (&right));
+
+      if (filter == NULL)
+        filter = g_steal_pointer (&predicate);
+      else
+        filter = gom_binary_expression_new_and (g_steal_pointer (&filter),
                                                 g_steal_pointer (&predicate));
     }
 
-  return g_steal_pointer (&filter);
-}
+  return g_steal_pointer (&filter);
+}
+
+static gboolean
+gom_entity_property_visible_at_version (GomEntityClass *entity_class,
+                                        const char     *property_name,
+                                        guint           version)
+{
+  guint version_added;
+  guint version_removed;
+
+  g_assert (GOM_IS_ENTITY_CLASS (entity_class));
+  g_assert (property_name != NULL);
+
+  version_added = gom_entity_class_property_get_version_added (entity_class, property_name);
+  version_removed = gom_entity_class_property_get_version_removed (entity_class, property_name);
+
+  if (version_added > version)
+    return FALSE;
+
+  if (version_removed != 0 && version >= version_removed)
+    return FALSE;
+
+  return TRUE;
+}
+
+static gboolean
+gom_property_spec_visible_at_version (GomPropertySpec *property,
+                                      guint            version)
+{
+  guint version_added;
+  guint version_removed;
+
+  g_assert (GOM_IS_PROPERTY_SPEC (property));
+
+  version_added = gom_property_spec_get_version_added (property);
+  version_removed = gom_property_spec_get_version_removed (property);
+
+  if (version_added > version)
+    return FALSE;
+
+  if (version_removed != 0 && version >= version_removed)
+    return FALSE;
+
+  return TRUE;
+}
+
+static gboolean
+gom_entity_relationship_visible_at_version (GomEntityRelationshipInfo *relationship,
+                                            guint                      version)
+{
+  g_assert (relationship != NULL);
+
+  if (relationship->version_added > version)
+    return FALSE;
+
+  if (relationship->version_removed != 0 && version >= relationship->version_removed)
+    return FALSE;
+
+  return TRUE;
+}
+
+gboolean
+gom_entity_dup_identity_value_is_set (GomEntity       *self,
+                                      GomEntityClass  *entity_class,
+                                      const char      *identity_field,
+                                      GomExpression  **out_identity_value,
+                                      GError         **error)
+{
+  g_autoptr(GomExpression) identity_value = NULL;
+
+  g_assert (GOM_IS_ENTITY (self));
+  g_assert (GOM_IS_ENTITY_CLASS (entity_class));
+  g_assert (identity_field != NULL);
+  g_assert (out_identity_value != NULL);
+
+  if (!(identity_value = entity_class->dup_identity_value (self, identity_field, error)))
+    {
+      if (error != NULL && *error != NULL)
+        return FALSE;
+
+      return FALSE;
+    }
+
+  if (!gom_expression_is_constant (identity_value))
+    {
+      g_set_error (error,
+                   G_IO_ERROR,
+                   G_IO_ERROR_INVALID_ARGUMENT,
+                   "Entity identity field '%s' did not produce a constant identity expression",
+                   identity_field);
+      return FALSE;
+    }
+
+  *out_identity_value = g_steal_pointer (&identity_value);
+
+  return TRUE;
+}
+
+static DexFuture *
+gom_entity_validate_mutation_setup (GomEntity           *self,
+                                    GomEntityClass     **entity_class_out,
+                                    GObjectClass       **object_class_out,
+                                    GomRepository      **repository_out,
+                                    const char * const **identity_fields_out)
+{
+  GomEntityClass *entity_class;
+  GObjectClass *object_class;
+  GomRepository *repository;
+  const char * const *identity_fields;
+
+  g_assert (GOM_IS_ENTITY (self));
+  g_assert (entity_class_out != NULL);
+  g_assert (object_class_out != NULL);
+  g_assert (repository_out != NULL);
+  g_assert (identity_fields_out != NULL);
+
+  object_class = G_OBJECT_GET_CLASS (self);
+  entity_class = GOM_ENTITY_CLASS (object_class);
+  repository = gom_entity_dup_repository (self);
+  identity_fields = gom_entity_class_get_identity_fields (entity_class);
+
+  if (repository == NULL)
+    return dex_future_new_reject (G_IO_ERROR,
+                                  G_IO_ERROR_INVALID_ARGUMENT,
+                                  "Entity is not bound to a repository");
+
+  if (identity_fields == NULL || identity_fields[0] == NULL)
+    {
+      g_object_unref (repository);
+      return dex_future_new_reject (G_IO_ERROR,
+                                    G_IO_ERROR_INVALID_ARGUMENT,
+                                    "Entity type has no identity fields");
+    }
+
+  *entity_class_out = entity_class;
+  *object_class_out = object_class;
+  *repository_out = repository;
+  *identity_fields_out = identity_fields;
+
+  return NULL;
+}
+
+static gboolean
+gom_entity_real_backfill_identity (GomEntity           *self,
+                                   const char * const  *identity_fields,
+                                   GomRecord           *record,
+                                   GError             **error)
+{
+  g_autoptr(GomSession) session = NULL;
+  const GomPropertySpec *property_spec;
+  const GParamSpec *pspec;
+  guint n_identity_fields;
+  guint n_identity_fields_total;
+  gboolean have_writable_identity = FALSE;
+  gboolean updated = FALSE;
+
+  g_assert (GOM_IS_ENTITY (self));
+  g_assert (GOM_IS_RECORD (record));
+  g_assert (identity_fields != NULL);
+  g_assert (identity_fields[0] != NULL);
+
+  session = _gom_entity_dup_session (self);
+
+  for (n_identity_fields_total = 0;
+       identity_fields[n_identity_fields_total] != NULL;
+       n_identity_fields_total++) { /* Do Nothing */ }
+
+  for (n_identity_fields = 0; identity_fields[n_identity_fields]; n_identity_fields++)
+    {
+      const char *identity_field = identity_fields[n_identity_fields];
+      g_auto(GValue) value = G_VALUE_INIT;
+      gboolean have_value = FALSE;
+
+      if (!(property_spec = gom_entity_get_property_spec (self, identity_field)))
+        continue;
+
+      pspec = _gom_property_spec_get_pspec ((GomPropertySpec *)property_spec);
+
+      if (pspec == NULL || (pspec->flags & G_PARAM_WRITABLE) == 0)
+        continue;
+
+      have_writable_identity = TRUE;
+      have_value = gom_record_get_column_by_name (record, identity_field, &value);
+
+      if (!have_value && n_identity_fields_total == 1)
+        have_value = gom_record_get_column_by_name (record, "rowid", &value);
+
+      if (!have_value)
+        continue;
+
+      g_object_set_property (G_OBJECT (self), identity_field, &value);
+
+      updated = TRUE;
+    }
+
+  if (!have_writable_identity)
+    return TRUE;
+
+  if (!updated)
+    {
+      g_set_error (error,
+                   G_IO_ERROR,
+                   G_IO_ERROR_FAILED,
+                   "Insert did not return an identity value");
+      return FALSE;
+    }
+
+  if (session != NULL && !gom_entity_rekey_session_identity (self))
+    {
+      g_set_error (error,
+                   G_IO_ERROR,
+                   G_IO_ERROR_FAILED,
+                   "Failed to re-key entity identity");
+      return FALSE;
+    }
+
+  if (session != NULL)
+    _gom_session_unregister_pending_entity (session, self);
+
+  return TRUE;
+}
+
+static gboolean
+gom_entity_backfill_identity_from_record (GomEntity  *self,
+                                          GomRecord  *record,
+                                          GError    **error)
+{
+  GomEntityClass *entity_class;
+  const char * const *identity_fields;
+
+  g_assert (GOM_IS_ENTITY (self));
+  g_assert (GOM_IS_RECORD (record));
+
+  entity_class = GOM_ENTITY_CLASS (G_OBJECT_GET_CLASS (self));
+  identity_fields = gom_entity_class_get_identity_fields (entity_class);
+
+  if (identity_fields == NULL || identity_fields[0] == NULL)
+    {
+      g_set_error (error,
+                   G_IO_ERROR,
+                   G_IO_ERROR_FAILED,
+                   "Entity type has no identity fields");
+      return FALSE;
+    }
+
+  if (entity_class->backfill_identity == NULL)
+    {
+      g_set_error (error,
+                   G_IO_ERROR,
+                   G_IO_ERROR_FAILED,
+                   "Entity class has no backfill_identity vfunc");
+      return FALSE;
+    }
+
+  return entity_class->backfill_identity (self, identity_fields, record, error);
+}
+
+/* Appends the field names and values gom_entity_insert() writes for @self
+ * to @fields and @values. Identity fields without a value are left for the
+ * database to assign. @values takes ownership of each expression.
+ */
+static gboolean
+gom_entity_collect_insert_row (GomEntity      *self,
+                               GomRepository  *repository,
+                               GPtrArray      *fields,
+                               GPtrArray      *values,
+                               GError        **error)
+{
+  const GomEntitySpec *entity_spec;
+  const GomPropertySpec * const *properties = NULL;
+  GObjectClass *object_class;
+  GomEntityClass *entity_class;
+  const char * const *identity_fields;
+  guint n_properties = 0;
+  guint version;
+
+  g_assert (GOM_IS_ENTITY (self));
+  g_assert (GOM_IS_REPOSITORY (repository));
+  g_assert (fields != NULL);
+  g_assert (values != NULL);
+
+  object_class = G_OBJECT_GET_CLASS (self);
+  entity_class = GOM_ENTITY_CLASS (object_class);
+  identity_fields = gom_entity_class_get_identity_fields (entity_class);
+  version = gom_registry_get_version (_gom_repository_get_registry (repository));
+
+  if (!(entity_spec = gom_entity_get_entity_spec (self)))
+    {
+      g_set_error (error,
+                   G_IO_ERROR,
+                   G_IO_ERROR_INVALID_ARGUMENT,
+                   "Entity type `%s` is not in the registry",
+                   G_OBJECT_TYPE_NAME (self));
+      return FALSE;
+    }
+
+  properties = gom_entity_spec_list_properties ((GomEntitySpec *)entity_spec, &n_properties);
+
+  for (guint i = 0; i < n_properties; i++)
+    {
+      const char *property_name = gom_property_spec_get_name ((GomPropertySpec *)properties[i]);
+      GomEntityPropertyInfo *prop_info;
+      const char *field_name;
+      g_auto(GValue) value = G_VALUE_INIT;
+      gboolean is_identity;
+
+      if (!gom_property_spec_get_mapped ((GomPropertySpec *)properties[i]))
+        continue;
+
+      if (!gom_property_spec_visible_at_version ((GomPropertySpec *)properties[i], version))
+        continue;
+
+      prop_info = _gom_entity_class_get_property (entity_class, property_name, FALSE);
+      field_name = prop_info != NULL && prop_info->field_name != NULL ? prop_info->field_name
+                                                                      : property_name;
+      is_identity = _gom_strv_contains (identity_fields, property_name);
+
+      if (is_identity)
+        {
+          g_autoptr(GomExpression) identity_value = NULL;
+
+          if (!gom_entity_dup_identity_value_is_set (self, entity_class, property_name, &identity_value, error))
+            {
+              if (error != NULL && *error != NULL)
+                return FALSE;
+
+              continue;
+            }
+
+          g_ptr_array_add (fields, (gpointer)field_name);
+          g_ptr_array_add (values, g_steal_pointer (&identity_value));
+          continue;
+        }
+
+      if (!gom_entity_get_property_storage_value (self, entity_class, object_class, property_name, &value, error))
+        return FALSE;
+
+      g_ptr_array_add (fields, (gpointer)field_name);
+      g_ptr_array_add (values, gom_literal_expression_new (&value));
+    }
+
+  if (fields->len == 0)
+    {
+      g_set_error_literal (error,
+                           G_IO_ERROR,
+                           G_IO_ERROR_INVALID_ARGUMENT,
+                           "Entity has no mapped properties to insert");
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+/**
+ * gom_entity_insert:
+ * @self: a [class@Gom.Entity]
+ *
+ * Inserts @self using mapped properties.
+ *
+ * Identity fields are omitted from insertion when
+ * `GomEntityClass.dup_identity_value` returns `NULL`.
+ *
+ * The entity must be bound to a repository with
+ * [method@Gom.Entity.set_repository].
+ *
+ * Returns: (transfer full): a [class@Dex.Future] that resolves to a
+ *   [class@Gom.MutationResult] of [class@Gom.Record] rows or rejects with
+ *   error.
+ */
+DexFuture *
+gom_entity_insert (GomEntity *self)
+{
+  g_autoptr(GomInsertionBuilder) builder = NULL;
+  g_autoptr(GomInsertion) insertion = NULL;
+  g_autoptr(GPtrArray) fields = NULL;
+  g_autoptr(GPtrArray) row_values = NULL;
+  g_autoptr(GomRepository) repository = NULL;
+  g_autoptr(GomSession) session = NULL;
+  g_autoptr(GError) error = NULL;
+
+  dex_return_error_if_fail (GOM_IS_ENTITY (self));
+
+  if (!(repository = gom_entity_dup_repository (self)))
+    return dex_future_new_reject (G_IO_ERROR,
+                                  G_IO_ERROR_INVALID_ARGUMENT,
+                                  "Entity is not bound to a repository");
+
+  session = _gom_entity_dup_session (self);
+
+  builder = gom_insertion_builder_new (repository);
+  gom_insertion_builder_set_target_entity_type (builder, G_OBJECT_TYPE (self));
+  fields = g_ptr_array_new ();
+  row_values = g_ptr_array_new ();
+
+  if (!gom_entity_collect_insert_row (self, repository, fields, row_values, &error))
+    {
+      g_ptr_array_foreach (row_values, (GFunc)g_object_unref, NULL);
+      return dex_future_new_for_error (g_steal_pointer (&error));
+    }
+
+  for (guint i = 0; i < fields->len; i++)
+    gom_insertion_builder_add_column (builder, gom_field_expression_new (g_ptr_array_index (fields, i)));
+
+  gom_insertion_builder_add_row (builder, (GomExpression **)row_values->pdata, row_values->len);
+
+  if (!(insertion = gom_insertion_builder_build (builder, &error)))
+    return dex_future_new_for_error (g_steal_pointer (&error));
+
+  {
+    GomEntityMutationTask *task = g_new0 (GomEntityMutationTask, 1);
+
+    task->self = g_object_ref (self);
+    task->session = session != NULL ? g_object_ref (session) : NULL;
+    task->repository = g_object_ref (repository);
+    task->mutation = GOM_MUTATION (g_object_ref (insertion));
+
+    return dex_scheduler_spawn (NULL,
+                                0,
+                                gom_entity_mutation_fiber,
+                                task,
+                                gom_entity_mutation_task_free);
+  }
+}
+
+/* Builds the update gom_entity_update() runs for @self. Returns %NULL
+ * without setting @error when nothing changed, after accepting the empty
+ * change set.
+ */
+static GomEntityMutationTask *
+gom_entity_prepare_update (GomEntity  *self,
+                           GError    **error)
+{
+  g_autoptr(GomUpdateBuilder) builder = NULL;
+  g_autoptr(GomUpdate) update = NULL;
+  g_autoptr(GomDelta) delta = NULL;
+  g_autoptr(GomRepository) repository = NULL;
+  g_autoptr(GomSession) session = NULL;
+  g_autoptr(GomExpression) filter = NULL;
+  GomEntityClass *entity_class;
+  GObjectClass *object_class;
+  const char * const *identity_fields;
+  DexFuture *failure;
+
+  g_assert (GOM_IS_ENTITY (self));
+
+  if ((failure = gom_entity_validate_mutation_setup (self, &entity_class, &object_class, &repository, &identity_fields)))
+    {
+      dex_future_get_value (failure, error);
+      dex_unref (failure);
+      return NULL;
+    }
+
+  session = _gom_entity_dup_session (self);
+
+  if (!(delta = gom_entity_build_delta (self, error)))
+    {
+      if (error != NULL && *error != NULL)
+        return NULL;
+
+      if (session != NULL)
+        _gom_session_accept_entity_changes (session, self, NULL);
+      else
+        _gom_entity_apply_delta (self, NULL, FALSE);
+
+      return NULL;
+    }
+
+  if (gom_delta_is_empty (delta))
+    {
+      if (session != NULL)
+        _gom_session_accept_entity_changes (session, self, NULL);
+      else
+        _gom_entity_apply_delta (self, NULL, FALSE);
+
+      return NULL;
+    }
+
+  builder = gom_update_builder_new ();
+  gom_update_builder_set_target_entity_type (builder, G_OBJECT_TYPE (self));
+
+  if (!(filter = gom_entity_build_identity_filter (self, entity_class, identity_fields, error)))
+    return NULL;
+
+  gom_update_builder_set_filter (builder, g_steal_pointer (&filter));
+  gom_update_builder_set_limit (builder, 1);
+
+  {
+    guint version = gom_registry_get_version (_gom_repository_get_registry (repository));
+
+    for (guint i = 0; i < gom_delta_get_n_changes (delta); i++)
+      {
+        const char *property_name = gom_delta_get_property_name (delta, i);
+        GomEntityPropertyInfo *prop_info;
+        const char *field_name;
+        g_auto(GValue) value = G_VALUE_INIT;
+
+        if (property_name == NULL)
+          continue;
+
+        if (!gom_entity_property_visible_at_version (entity_class, property_name, version))
+          continue;
+
+        if (gom_entity_get_property_spec (self, property_name) == NULL)
+          continue;
+
+        prop_info = _gom_entity_class_get_property (entity_class, property_name, FALSE);
+        field_name = prop_info != NULL && prop_info->field_name != NULL ? prop_info->field_name
+                                                                        : property_name;
+
+        if (!gom_entity_get_property_storage_value (self, entity_class, object_class, property_name, &value, error))
+          return NULL;
+
+        gom_update_builder_add_assignment (builder,
+                                           gom_field_expression_new (field_name),
+                                           gom_literal_expression_new (&value));
+      }
+  }
+
+  if (!(update = gom_update_builder_build (builder, error)))
+    return NULL;
+
+  {
+    GomEntityMutationTask *task = g_new0 (GomEntityMutationTask, 1);
+
+    task->self = g_object_ref (self);
+    task->session = session != NULL ? g_object_ref (session) : NULL;
+    task->repository = g_object_ref (repository);
+    task->mutation = GOM_MUTATION (g_object_ref (update));
+    task->delta = g_object_ref (delta);
+    task->change_state_complete = _gom_entity_change_state_is_complete (self);
+
+    return task;
+  }
+}
+
+/**
+ * gom_entity_update:
+ * @self: a [class@Gom.Entity]
+ *
+ * Updates @self using mapped properties.
+ *
+ * A `WHERE` clause is generated from identity fields and the update is
+ * limited to one row.
+ *
+ * The entity must be bound to a repository and must have identity fields
+ * whose values resolve through `GomEntityClass.dup_identity_value`.
+ *
+ * Returns: (transfer full): a [class@Dex.Future] that resolves to a
+ *   [class@Gom.MutationResult] of [class@Gom.Record] rows or rejects with
+ *   error.
+ */
+DexFuture *
+gom_entity_update (GomEntity *self)
+{
+  GomEntityMutationTask *task;
+  g_autoptr(GError) error = NULL;
+
+  dex_return_error_if_fail (GOM_IS_ENTITY (self));
+
+  if (!(task = gom_entity_prepare_update (self, &error)))
+    {
+      if (error != NULL)
+        return dex_future_new_for_error (g_steal_pointer (&error));
+
+      return dex_future_new_take_object (_gom_mutation_result_new ());
+    }
+
+  return dex_scheduler_spawn (NULL,
+                              0,
+                              gom_entity_mutation_fiber,
+                              task,
+                              gom_entity_mutation_task_free);
+}
+
+/* Whether @klass has a relationship or foreign key field that points at
+ * @target_class, so its rows may need those of @target_class to exist.
+ */
+static gboolean
+gom_entity_class_references (GomEntityClass *klass,
+                             GomEntityClass *target_class)
+{
+  GomEntityClassInfo *target_info;
+  GType target_type;
+
+  g_assert (GOM_IS_ENTITY_CLASS (klass));
+  g_assert (GOM_IS_ENTITY_CLASS (target_class));
+
+  target_type = G_TYPE_FROM_CLASS (target_class);
+  target_info = _gom_entity_class_get_info (target_class, FALSE);
+
+  for (GomEntityClassInfo *iter = _gom_entity_class_get_info (klass, FALSE);
+       iter != NULL;
+       iter = iter->parent_info)
+    {
+      for (GomEntityRelationshipInfo *relationship = iter->relationships;
+           relationship != NULL;
+           relationship = relationship->next)
+        {
+          if (relationship->target_type == G_TYPE_INVALID)
+            continue;
+
+          if (g_type_is_a (relationship->target_type, target_type) ||
+              g_type_is_a (target_type, relationship->target_type))
+            return TRUE;
+        }
+
+      for (GomEntityPropertyInfo *property = iter->properties;
+           property != NULL;
+           property = property->next)
+        {
+          if (property->ref_table == NULL)
+            continue;
+
+          for (GomEntityClassInfo *target = target_info; target != NULL; target = target->parent_info)
+            {
+              if (g_strcmp0 (property->ref_table, target->table) == 0)
+                return TRUE;
+            }
+        }
+    }
+
+  return FALSE;
+}
+
+static gboolean
+gom_entity_types_related (GomEntity *a,
+                          GomEntity *b)
+{
+  GomEntityClass *a_class = GOM_ENTITY_GET_CLASS (a);
+  GomEntityClass *b_class = GOM_ENTITY_GET_CLASS (b);
+
+  return gom_entity_class_references (a_class, b_class) ||
+         gom_entity_class_references (b_class, a_class);
+}
+
+/* Entities with the same type and the same set identity fields produce the
+ * same column list in gom_entity_collect_insert_row().
+ */
+static gboolean
+gom_entity_get_insert_signature (GomEntity *self,
+                                 guint64   *signature)
+{
+  GomEntityClass *entity_class;
+  const char * const *identity_fields;
+
+  g_assert (GOM_IS_ENTITY (self));
+  g_assert (signature != NULL);
+
+  entity_class = GOM_ENTITY_GET_CLASS (self);
+  identity_fields = gom_entity_class_get_identity_fields (entity_class);
+
+  *signature = 0;
+
+  if (identity_fields == NULL)
+    return TRUE;
+
+  for (guint i = 0; identity_fields[i] != NULL; i++)
+    {
+      g_autoptr(GomExpression) identity_value = NULL;
+      g_autoptr(GError) error = NULL;
+
+      if (i >= 64)
+        return FALSE;
+
+      if (gom_entity_dup_identity_value_is_set (self, entity_class, identity_fields[i], &identity_value, &error))
+        *signature |= G_GUINT64_CONSTANT (1) << i;
+      else if (error != NULL)
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+/* Collects up to @max_entities entities of @queue, starting at the head,
+ * that can be written with one multi-row insertion because they share a
+ * type, repository and column list. Entities of unrelated types are
+ * skipped, but collection stops at the first entity of a related type so
+ * no row is written ahead of a row it may reference. Types that reference
+ * themselves are never batched. The entities stay in @queue.
+ */
+GPtrArray *
+_gom_entity_collect_insert_batch (GQueue *queue,
+                                  guint   max_entities)
+{
+  g_autoptr(GPtrArray) batch = NULL;
+  g_autoptr(GomRepository) repository = NULL;
+  GomEntity *head;
+  GType unrelated_type = G_TYPE_INVALID;
+  guint64 signature;
+
+  g_return_val_if_fail (queue != NULL, NULL);
+
+  batch = g_ptr_array_new_with_free_func (g_object_unref);
+
+  if (!(head = g_queue_peek_head (queue)))
+    return g_steal_pointer (&batch);
+
+  g_ptr_array_add (batch, g_object_ref (head));
+
+  if (max_entities <= 1 ||
+      gom_entity_types_related (head, head) ||
+      !gom_entity_get_insert_signature (head, &signature) ||
+      !(repository = gom_entity_dup_repository (head)))
+    return g_steal_pointer (&batch);
+
+  for (const GList *iter = queue->head->next;
+       iter != NULL && batch->len < max_entities;
+       iter = iter->next)
+    {
+      GomEntity *entity = iter->data;
+      g_autoptr(GomRepository) entity_repository = NULL;
+      GType entity_type = G_OBJECT_TYPE (entity);
+      guint64 entity_signature;
+
+      if (entity_type != G_OBJECT_TYPE (head))
+        {
+          if (entity_type == unrelated_type)
+            continue;
+
+          if (gom_entity_types_related (entity, head))
+            break;
+
+          unrelated_type = entity_type;
+          continue;
+        }
+
+      entity_repository = gom_entity_dup_repository (entity);
+
+      if (entity_repository != repository ||
+          !gom_entity_get_insert_signature (entity, &entity_signature) ||
+          entity_signature != signature)
+        continue;
+
+      g_ptr_array_add (batch, g_object_ref (entity));
+    }
+
+  return g_steal_pointer (&batch);
+}
+
+static DexFuture *
+gom_entity_insert_batch_fiber (gpointer user_data)
+{
+  GPtrArray *entities = user_data;
+  g_autoptr(GomInsertionBuilder) builder = NULL;
+  g_autoptr(GomInsertion) insertion = NULL;
+  g_autoptr(GomMutationResult) result = NULL;
+  g_autoptr(GomRepository) repository = NULL;
+  g_autoptr(GomSession) session = NULL;
+  g_autoptr(GError) error = NULL;
+  GomEntity *first;
+  guint n_columns = 0;
+
+  g_assert (entities != NULL);
+  g_assert (entities->len > 0);
+
+  first = g_ptr_array_index (entities, 0);
 
-static gboolean
-gom_entity_property_visible_at_version (GomEntityClass *entity_class,
-                                        const char     *property_name,
-                                        guint           version)
-{
-  guint version_added;
-  guint version_removed;
+  if (!(repository = gom_entity_dup_repository (first)))
+    return dex_future_new_reject (G_IO_ERROR,
+                                  G_IO_ERROR_INVALID_ARGUMENT,
+                                  "Entity is not bound to a repository");
 
-  g_assert (GOM_IS_ENTITY_CLASS (entity_class));
-  g_assert (property_name != NULL);
+  session = _gom_entity_dup_session (first);
 
-  version_added = gom_entity_class_property_get_version_added (entity_class, property_name);
-  version_removed = gom_entity_class_property_get_version_removed (entity_class, property_name);
+  builder = gom_insertion_builder_new (repository);
+  gom_insertion_builder_set_target_entity_type (builder, G_OBJECT_TYPE (first));
 
-  if (version_added > version)
-    return FALSE;
+  for (guint i = 0; i < entities->len; i++)
+    {
+      GomEntity *entity = g_ptr_array_index (entities, i);
+      g_autoptr(GPtrArray) fields = g_ptr_array_new ();
+      g_autoptr(GPtrArray) row_values = g_ptr_array_new ();
 
-  if (version_removed != 0 && version >= version_removed)
-    return FALSE;
+      if (!gom_entity_validate_relationships_for_mutation (entity, &error))
+        return dex_future_new_for_error (g_steal_pointer (&error));
 
-  return TRUE;
-}
+      if (!gom_entity_collect_insert_row (entity, repository, fields, row_values, &error))
+        {
+          g_ptr_array_foreach (row_values, (GFunc)g_object_unref, NULL);
+          return dex_future_new_for_error (g_steal_pointer (&error));
+        }
 
-static gboolean
-gom_property_spec_visible_at_version (GomPropertySpec *property,
-                                      guint            version)
-{
-  guint version_added;
-  guint version_removed;
+      if (i == 0)
+        {
+          for (guint j = 0; j < fields->len; j++)
+            gom_insertion_builder_add_column (builder, gom_field_expression_new (g_ptr_array_index (fields, j)));
 
-  g_assert (GOM_IS_PROPERTY_SPEC (property));
+          n_columns = fields->len;
+        }
+      else if (fields->len != n_columns)
+        {
+          g_ptr_array_foreach (row_values, (GFunc)g_object_unref, NULL);
+          return dex_future_new_reject (G_IO_ERROR,
+                                        G_IO_ERROR_INVALID_ARGUMENT,
+                                        "Batched entities do not share the same columns");
+        }
 
-  version_added = gom_property_spec_get_version_added (property);
-  version_removed = gom_property_spec_get_version_removed (property);
+      gom_insertion_builder_add_row (builder, (GomExpression **)row_values->pdata, row_values->len);
+    }
 
-  if (version_added > version)
-    return FALSE;
+  if (!(insertion = gom_insertion_builder_build (builder, &error)))
+    return dex_future_new_for_error (g_steal_pointer (&error));
 
-  if (version_removed != 0 && version >= version_removed)
-    return FALSE;
+  if (!(result = dex_await_object (gom_entity_mutate_run (first, GOM_MUTATION (insertion), session, repository), &error)))
+    return dex_future_new_for_error (g_steal_pointer (&error));
 
-  return TRUE;
+  if (g_list_model_get_n_items (G_LIST_MODEL (result)) != entities->len)
+    return dex_future_new_reject (G_IO_ERROR,
+                                  G_IO_ERROR_FAILED,
+                                  "Insert did not return mutation rows");
+
+  for (guint i = 0; i < entities->len; i++)
+    {
+      g_autoptr(GomRecord) record = g_list_model_get_item (G_LIST_MODEL (result), i);
+
+      if (!gom_entity_complete_insert (g_ptr_array_index (entities, i), session, repository, record, &error))
+        return dex_future_new_for_error (g_steal_pointer (&error));
+    }
+
+  return dex_future_new_take_object (g_steal_pointer (&result));
+}
+
+/* Like gom_entity_insert() for each of @entities, as collected by
+ * _gom_entity_collect_insert_batch(), but written with a single insertion.
+ * Resolves to the mutation result with one row per entity.
+ */
+DexFuture *
+_gom_entity_insert_batch (GPtrArray *entities)
+{
+  dex_return_error_if_fail (entities != NULL);
+  dex_return_error_if_fail (entities->len > 0);
+
+  return dex_scheduler_spawn (NULL,
+                              0,
+                              gom_entity_insert_batch_fiber,
+                              g_ptr_array_ref (entities),
+                              (GDestroyNotify)g_ptr_array_unref);
 }
 
 static gboolean
-gom_entity_relationship_visible_at_version (GomEntityRelationshipInfo *relationship,
-                                            guint                      version)
+gom_entity_dirty_properties_equal (GomEntity *a,
+                                   GomEntity *b)
 {
-  g_assert (relationship != NULL);
+  GomEntityPrivate *a_priv = gom_entity_get_instance_private (a);
+  GomEntityPrivate *b_priv = gom_entity_get_instance_private (b);
+  GHashTableIter iter;
+  gpointer key;
+  guint a_size;
+  guint b_size;
 
-  if (relationship->version_added > version)
-    return FALSE;
+  a_size = a_priv->dirty_properties != NULL ? g_hash_table_size (a_priv->dirty_properties) : 0;
+  b_size = b_priv->dirty_properties != NULL ? g_hash_table_size (b_priv->dirty_properties) : 0;
 
-  if (relationship->version_removed != 0 && version >= relationship->version_removed)
+  if (a_size != b_size)
     return FALSE;
 
+  if (a_size == 0)
+    return TRUE;
+
+  g_hash_table_iter_init (&iter, a_priv->dirty_properties);
+  while (g_hash_table_iter_next (&iter, &key, NULL))
+    {
+      if (!g_hash_table_contains (b_priv->dirty_properties, key))
+        return FALSE;
+    }
+
   return TRUE;
 }
 
-gboolean
-gom_entity_dup_identity_value_is_set (GomEntity       *self,
-                                      GomEntityClass  *entity_class,
-                                      const char      *identity_field,
-                                      GomExpression  **out_identity_value,
-                                      GError         **error)
+/* Collects the run of up to @max_entities entities at the head of @queue
+ * that share a type and set of dirty properties, and therefore produce the
+ * same UPDATE statement. Only a contiguous run is taken so updates touching
+ * unique columns still apply in the order they were made. The entities stay
+ * in @queue.
+ */
+GPtrArray *
+_gom_entity_collect_update_batch (GQueue *queue,
+                                  guint   max_entities)
 {
-  g_autoptr(GomExpression) identity_value = NULL;
+  g_autoptr(GPtrArray) batch = NULL;
+  GomEntity *head;
 
-  g_assert (GOM_IS_ENTITY (self));
-  g_assert (GOM_IS_ENTITY_CLASS (entity_class));
-  g_assert (identity_field != NULL);
-  g_assert (out_identity_value != NULL);
+  g_return_val_if_fail (queue != NULL, NULL);
 
-  if (!(identity_value = entity_class->dup_identity_value (self, identity_field, error)))
+  batch = g_ptr_array_new_with_free_func (g_object_unref);
+
+  if (!(head = g_queue_peek_head (queue)))
+    return g_steal_pointer (&batch);
+
+  for (const GList *iter = queue->head;
+       iter != NULL && batch->len < MAX (max_entities, 1);
+       iter = iter->next)
     {
-      if (error != NULL && *error != NULL)
-        return FALSE;
+      GomEntity *entity = iter->data;
 
-      return FALSE;
+      if (G_OBJECT_TYPE (entity) != G_OBJECT_TYPE (head) ||
+          !gom_entity_dirty_properties_equal (entity, head))
+        break;
+
+      g_ptr_array_add (batch, g_object_ref (entity));
     }
 
-  if (!gom_expression_is_constant (identity_value))
+  return g_steal_pointer (&batch);
+}
+
+static DexFuture *
+gom_entity_update_batch_fiber (gpointer user_data)
+{
+  GPtrArray *entities = user_data;
+
+  g_assert (entities != NULL);
+
+  for (guint i = 0; i < entities->len; i++)
     {
-      g_set_error (error,
-                   G_IO_ERROR,
-                   G_IO_ERROR_INVALID_ARGUMENT,
-                   "Entity identity field '%s' did not produce a constant identity expression",
-                   identity_field);
-      return FALSE;
+      GomEntity *entity = g_ptr_array_index (entities, i);
+      g_autoptr(GomMutationResult) result = NULL;
+      g_autoptr(GError) error = NULL;
+      GomEntityMutationTask *task;
+
+      if (!(task = gom_entity_prepare_update (entity, &error)))
+        {
+          if (error != NULL)
+            return dex_future_new_for_error (g_steal_pointer (&error));
+
+          continue;
+        }
+
+      result = gom_entity_mutation_task_run (task, &error);
+      gom_entity_mutation_task_free (task);
+
+      if (result == NULL)
+        return dex_future_new_for_error (g_steal_pointer (&error));
     }
 
-  *out_identity_value = g_steal_pointer (&identity_value);
+  return dex_future_new_true ();
+}
 
-  return TRUE;
+/* Like gom_entity_update() for each of @entities, in order, from a single
+ * fiber. The updates share one statement shape, so backends that cache
+ * prepared statements reuse the same one for every entity.
+ */
+DexFuture *
+_gom_entity_update_batch (GPtrArray *entities)
+{
+  dex_return_error_if_fail (entities != NULL);
+
+  return dex_scheduler_spawn (NULL,
+                              0,
+                              gom_entity_update_batch_fiber,
+                              g_ptr_array_ref (entities),
+                              (GDestroyNotify)g_ptr_array_unref);
+}
+
+static void
+gom_entity_delete_task_free (gpointer data)
+{
+  GomEntityDeleteTask *task = data;
+
+  g_clear_object (&task->self);
+  g_clear_object (&task->session);
+  g_clear_object (&task->repository);
+  g_clear_object (&task->registry);
+  g_clear_pointer (&task->visited, g_hash_table_unref);
+  g_free (task);
 }
 
 static DexFuture *
-gom_entity_validate_mutation_setup (GomEntity           *self,
-                                    GomEntityClass     **entity_class_out,
-                                    GObjectClass       **object_class_out,
-                                    GomRepository      **repository_out,
-                                    const char * const **identity_fields_out)
+gom_entity_delete_fiber (gpointer user_data)
 {
+  GomEntityDeleteTask *task = user_data;
+  g_autoptr(GomDelta) delta = NULL;
+  g_autoptr(GomDeletionBuilder) builder = NULL;
+  g_autoptr(GomDeletion) deletion = NULL;
+  g_autoptr(GomExpression) filter = NULL;
+  g_autoptr(GomMutationResult) result = NULL;
+  g_autoptr(GError) error = NULL;
   GomEntityClass *entity_class;
-  GObjectClass *object_class;
-  GomRepository *repository;
   const char * const *identity_fields;
 
-  g_assert (GOM_IS_ENTITY (self));
-  g_assert (entity_class_out != NULL);
-  g_assert (object_class_out != NULL);
-  g_assert (repository_out != NULL);
-  g_assert (identity_fields_out != NULL);
+  g_assert (task != NULL);
+  g_assert (GOM_IS_ENTITY (task->self));
 
-  object_class = G_OBJECT_GET_CLASS (self);
-  entity_class = GOM_ENTITY_CLASS (object_class);
-  repository = gom_entity_dup_repository (self);
+  if (gom_entity_delete_can_visit_keys (task))
+    {
+      if (!gom_entity_delete_visit_set (task, task->self, &error))
+        return dex_future_new_for_error (g_steal_pointer (&error));
+    }
+  else if (!gom_entity_delete_visit (task, task->self, &error))
+    {
+      return dex_future_new_for_error (g_steal_pointer (&error));
+    }
+
+  if (!(delta = gom_entity_build_snapshot_delta (task->self, task->repository, GOM_DELTA_KIND_DELETE, &error)))
+    return dex_future_new_for_error (g_steal_pointer (&error));
+
+  entity_class = GOM_ENTITY_CLASS (G_OBJECT_GET_CLASS (task->self));
   identity_fields = gom_entity_class_get_identity_fields (entity_class);
 
-  if (repository == NULL)
-    return dex_future_new_reject (G_IO_ERROR,
-                                  G_IO_ERROR_INVALID_ARGUMENT,
-                                  "Entity is not bound to a repository");
+  builder = gom_deletion_builder_new ();
+  gom_deletion_builder_set_target_entity_type (builder, G_OBJECT_TYPE (task->self));
 
-  if (identity_fields == NULL || identity_fields[0] == NULL)
-    {
-      g_object_unref (repository);
-      return dex_future_new_reject (G_IO_ERROR,
-                                    G_IO_ERROR_INVALID_ARGUMENT,
-                                    "Entity type has no identity fields");
-    }
+  if (!(filter = gom_entity_build_identity_filter (task->self, entity_class, identity_fields, &error)))
+    return dex_future_new_for_error (g_steal_pointer (&error));
 
-  *entity_class_out = entity_class;
-  *object_class_out = object_class;
-  *repository_out = repository;
-  *identity_fields_out = identity_fields;
+  gom_deletion_builder_set_filter (builder, filter);
+  gom_deletion_builder_set_limit (builder, 1);
 
-  return NULL;
+  if (!(deletion = gom_deletion_builder_build (builder, &error)))
+    return dex_future_new_for_error (g_steal_pointer (&error));
+
+  if (!(result = dex_await_object (gom_entity_delete_run_mutation (task, GOM_MUTATION (deletion)), &error)))
+    return dex_future_new_for_error (g_steal_pointer (&error));
+
+  _gom_entity_set_lifecycle (task->self, GOM_ENTITY_LIFECYCLE_DELETED);
+
+  if (task->session != NULL)
+    _gom_session_record_entity_changes (task->session, task->self, delta);
+  else if (!gom_entity_stage_repository_change (task->self, task->repository, delta, &error))
+    return dex_future_new_for_error (g_steal_pointer (&error));
+
+  return dex_future_new_take_object (g_steal_pointer (&result));
+}
+
+/**
+ * gom_entity_delete:
+ * @self: a [class@Gom.Entity]
+ *
+ * Deletes @self using identity fields.
+ *
+ * A `WHERE` clause is generated from identity fields and the deletion is
+ * limited to one row.
+ *
+ * The entity must be bound to a repository and must have identity fields
+ * whose values resolve through `GomEntityClass.dup_identity_value`.
+ *
+ * Returns: (transfer full): a [class@Dex.Future] that resolves to a
+ *   [class@Gom.MutationResult] of [class@Gom.Record] rows or rejects with
+ *   error.
+ */
+DexFuture *
+gom_entity_delete (GomEntity *self)
+{
+  GomEntityDeleteTask *task;
+  g_autoptr(GomRepository) repository = NULL;
+  g_autoptr(GomSession) session = NULL;
+  GomEntityClass *entity_class;
+  GObjectClass *object_class;
+  const char * const *identity_fields;
+  DexFuture *failure;
+
+  dex_return_error_if_fail (GOM_IS_ENTITY (self));
+
+  if ((failure = gom_entity_validate_mutation_setup (self, &entity_class, &object_class, &repository, &identity_fields)))
+    return g_steal_pointer (&failure);
+
+  session = _gom_entity_dup_session (self);
+
+  task = g_new0 (GomEntityDeleteTask, 1);
+  task->self = g_object_ref (self);
+  task->session = session != NULL ? g_object_ref (session) : NULL;
+  task->repository = g_object_ref (repository);
+  task->registry = g_object_ref (_gom_repository_get_registry (repository));
+  task->visited = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+  return dex_scheduler_spawn (NULL,
+                              0,
+                              gom_entity_delete_fiber,
+                              task,
+                              gom_entity_delete_task_free);
 }
 
+/* Prefetched relationships are matched on key strings: the identity key
+ * of each column value joined by newlines, so an owner's fields and a
+ * related row's fields compare equal exactly when they would in SQL. A
+ * key containing NULL never matches anything.
+ */
 static gboolean
-gom_entity_real_backfill_identity (GomEntity           *self,
-                                   const char * const  *identity_fields,
-                                   GomRecord           *record,
-                                   GError             **error)
+gom_entity_prefetch_append_key (GString      *key,
+                                const GValue *value)
 {
-  g_autoptr(GomSession) session = NULL;
-  const GomPropertySpec *property_spec;
-  const GParamSpec *pspec;
-  guint n_identity_fields;
-  guint n_identity_fields_total;
-  gboolean have_writable_identity = FALSE;
-  gboolean updated = FALSE;
+  g_autofree char *str = NULL;
 
-  g_assert (GOM_IS_ENTITY (self));
-  g_assert (GOM_IS_RECORD (record));
-  g_assert (identity_fields != NULL);
-  g_assert (identity_fields[0] != NULL);
+  if (!G_IS_VALUE (value) ||
+      !(str = _gom_value_dup_identity_key (value)) ||
+      g_str_equal (str, "\\N"))
+    return FALSE;
 
-  session = _gom_entity_dup_session (self);
+  g_string_append_c (key, '\n');
+  g_string_append (key, str);
 
-  for (n_identity_fields_total = 0;
-       identity_fields[n_identity_fields_total] != NULL;
-       n_identity_fields_total++) { /* Do Nothing */ }
+  return TRUE;
+}
 
-  for (n_identity_fields = 0; identity_fields[n_identity_fields]; n_identity_fields++)
+/* Builds the key of @fields on @entity. When @literals is provided the
+ * values are also appended to it as literal expressions, in the shape
+ * gom_entity_cascade_build_filter() expects. Returns %NULL without
+ * setting @error when one of the values is NULL.
+ */
+static char *
+gom_entity_prefetch_entity_key (GomEntity           *entity,
+                                const char * const  *fields,
+                                GPtrArray           *literals,
+                                GError             **error)
+{
+  g_autoptr(GString) key = g_string_new (NULL);
+  GObjectClass *object_class = G_OBJECT_GET_CLASS (entity);
+  GomEntityClass *entity_class = GOM_ENTITY_CLASS (object_class);
+
+  for (guint i = 0; fields[i] != NULL; i++)
     {
-      const char *identity_field = identity_fields[n_identity_fields];
       g_auto(GValue) value = G_VALUE_INIT;
-      gboolean have_value = FALSE;
 
-      if (!(property_spec = gom_entity_get_property_spec (self, identity_field)))
-        continue;
-
-      pspec = _gom_property_spec_get_pspec ((GomPropertySpec *)property_spec);
+      if (!gom_entity_get_property_storage_value (entity, entity_class, object_class, fields[i], &value, error))
+        return NULL;
 
-      if (pspec == NULL || (pspec->flags & G_PARAM_WRITABLE) == 0)
-        continue;
+      if (!gom_entity_prefetch_append_key (key, &value))
+        return NULL;
 
-      have_writable_identity = TRUE;
-      have_value = gom_record_get_column_by_name (record, identity_field, &value);
+      if (literals != NULL)
+        g_ptr_array_add (literals, gom_literal_expression_new (&value));
+    }
 
-      if (!have_value && n_identity_fields_total == 1)
-        have_value = gom_record_get_column_by_name (record, "rowid", &value);
+  return g_string_free (g_steal_pointer (&key), FALSE);
+}
 
-      if (!have_value)
-        continue;
+static char *
+gom_entity_prefetch_record_key (GomRecord           *record,
+                                const char * const  *fields,
+                                GPtrArray           *literals,
+                                GError             **error)
+{
+  g_autoptr(GString) key = g_string_new (NULL);
 
-      g_object_set_property (G_OBJECT (self), identity_field, &value);
+  for (guint i = 0; fields[i] != NULL; i++)
+    {
+      g_auto(GValue) value = G_VALUE_INIT;
 
-      updated = TRUE;
-    }
+      if (!gom_record_get_column_by_name (record, fields[i], &value))
+        {
+          g_set_error (error,
+                       G_IO_ERROR,
+                       G_IO_ERROR_INVALID_ARGUMENT,
+                       "Join record is missing field `%s`",
+                       fields[i]);
+          return NULL;
+        }
 
-  if (!have_writable_identity)
-    return TRUE;
+      if (!gom_entity_prefetch_append_key (key, &value))
+        return NULL;
 
-  if (!updated)
-    {
-      g_set_error (error,
-                   G_IO_ERROR,
-                   G_IO_ERROR_FAILED,
-                   "Insert did not return an identity value");
-      return FALSE;
+      if (literals != NULL)
+        g_ptr_array_add (literals, gom_literal_expression_new (&value));
     }
 
-  if (session != NULL && !gom_entity_rekey_session_identity (self))
+  return g_string_free (g_steal_pointer (&key), FALSE);
+}
+
+/* Adds @literals to @keys unless an equal key was already collected. */
+static void
+gom_entity_prefetch_collect_key (GHashTable *seen,
+                                 GPtrArray  *keys,
+                                 char       *key,
+                                 GPtrArray  *literals)
+{
+  if (g_hash_table_contains (seen, key))
     {
-      g_set_error (error,
-                   G_IO_ERROR,
-                   G_IO_ERROR_FAILED,
-                   "Failed to re-key entity identity");
-      return FALSE;
+      g_free (key);
+      g_ptr_array_unref (literals);
+      return;
     }
 
-  if (session != NULL)
-    _gom_session_unregister_pending_entity (session, self);
-
-  return TRUE;
+  g_hash_table_add (seen, key);
+  g_ptr_array_add (keys, literals);
 }
 
 static gboolean
-gom_entity_backfill_identity_from_record (GomEntity  *self,
-                                          GomRecord  *record,
-                                          GError    **error)
+gom_entity_prefetch_check_fields (GomEntityRelationshipInfo  *relationship,
+                                  const char * const         *source_fields,
+                                  const char * const         *target_fields,
+                                  GError                    **error)
 {
-  GomEntityClass *entity_class;
-  const char * const *identity_fields;
-
-  g_assert (GOM_IS_ENTITY (self));
-  g_assert (GOM_IS_RECORD (record));
-
-  entity_class = GOM_ENTITY_CLASS (G_OBJECT_GET_CLASS (self));
-  identity_fields = gom_entity_class_get_identity_fields (entity_class);
-
-  if (identity_fields == NULL || identity_fields[0] == NULL)
+  if (source_fields == NULL || source_fields[0] == NULL ||
+      target_fields == NULL || target_fields[0] == NULL)
     {
       g_set_error (error,
                    G_IO_ERROR,
-                   G_IO_ERROR_FAILED,
-                   "Entity type has no identity fields");
+                   G_IO_ERROR_INVALID_ARGUMENT,
+                   "Relationship `%s` does not provide enough field mapping information",
+                   relationship->name);
       return FALSE;
     }
 
-  if (entity_class->backfill_identity == NULL)
+  if (g_strv_length ((char **)source_fields) != g_strv_length ((char **)target_fields))
     {
       g_set_error (error,
                    G_IO_ERROR,
-                   G_IO_ERROR_FAILED,
-                   "Entity class has no backfill_identity vfunc");
+                   G_IO_ERROR_INVALID_ARGUMENT,
+                   "Relationship `%s` field cardinality does not match",
+                   relationship->name);
       return FALSE;
     }
 
-  return entity_class->backfill_identity (self, identity_fields, record, error);
+  return TRUE;
 }
 
-/**
- * gom_entity_insert:
- * @self: a [class@Gom.Entity]
- *
- * Inserts @self using mapped properties.
- *
- * Identity fields are omitted from insertion when
- * `GomEntityClass.dup_identity_value` returns `NULL`.
- *
- * The entity must be bound to a repository with
- * [method@Gom.Entity.set_repository].
- *
- * Returns: (transfer full): a [class@Dex.Future] that resolves to a
- *   [class@Gom.MutationResult] of [class@Gom.Record] rows or rejects with
- *   error.
+/* Runs one query per batch of @keys matched against @fields and appends
+ * the results to @results. Going through the session registers every
+ * loaded entity with its identity map.
  */
-DexFuture *
-gom_entity_insert (GomEntity *self)
-{
-  g_autoptr(GomInsertionBuilder) builder = NULL;
-  g_autoptr(GomInsertion) insertion = NULL;
-  g_autoptr(GPtrArray) row_values = NULL;
-  g_autoptr(GomRepository) repository = NULL;
-  g_autoptr(GomSession) session = NULL;
-  g_autoptr(GError) error = NULL;
-  const GomEntitySpec *entity_spec;
-  const GomPropertySpec * const *properties = NULL;
-  GObjectClass *object_class;
-  GomEntityClass *entity_class;
-  guint version = 0;
-  const char * const *identity_fields;
-  guint n_properties = 0;
-  guint n_columns = 0;
-
-  dex_return_error_if_fail (GOM_IS_ENTITY (self));
-
-  if (!(repository = gom_entity_dup_repository (self)))
-    return dex_future_new_reject (G_IO_ERROR,
-                                  G_IO_ERROR_INVALID_ARGUMENT,
-                                  "Entity is not bound to a repository");
-
-  session = _gom_entity_dup_session (self);
-  object_class = G_OBJECT_GET_CLASS (self);
-  entity_class = GOM_ENTITY_CLASS (object_class);
-  identity_fields = gom_entity_class_get_identity_fields (entity_class);
-  version = gom_registry_get_version (_gom_repository_get_registry (repository));
-
-  if (!(entity_spec = gom_entity_get_entity_spec (self)))
-    return dex_future_new_reject (G_IO_ERROR,
-                                  G_IO_ERROR_INVALID_ARGUMENT,
-                                  "Entity type `%s` is not in the registry",
-                                  G_OBJECT_TYPE_NAME (self));
-
-  properties = gom_entity_spec_list_properties ((GomEntitySpec *)entity_spec, &n_properties);
-  builder = gom_insertion_builder_new (repository);
-  gom_insertion_builder_set_target_entity_type (builder, G_OBJECT_TYPE (self));
-  row_values = g_ptr_array_new ();
-
-  for (guint i = 0; i < n_properties; i++)
+static gboolean
+gom_entity_prefetch_run (GomRepository       *repository,
+                         GomSession          *session,
+                         GType                target_type,
+                         const char          *relation,
+                         GPtrArray           *keys,
+                         const char * const  *fields,
+                         GPtrArray           *results,
+                         GError             **error)
+{
+  for (guint begin = 0; begin < keys->len; begin += GOM_ENTITY_CASCADE_BATCH_SIZE)
     {
-      const char *property_name = gom_property_spec_get_name ((GomPropertySpec *)properties[i]);
-      GomEntityPropertyInfo *prop_info;
-      const char *field_name;
-      g_auto(GValue) value = G_VALUE_INIT;
-      gboolean is_identity;
-
-      if (!gom_property_spec_get_mapped ((GomPropertySpec *)properties[i]))
-        continue;
-
-      if (!gom_property_spec_visible_at_version ((GomPropertySpec *)properties[i], version))
-        continue;
+      guint end = MIN (begin + GOM_ENTITY_CASCADE_BATCH_SIZE, keys->len);
+      g_autoptr(GomExpression) filter = NULL;
+      g_autoptr(GObject) list = NULL;
+      guint n_items;
 
-      prop_info = _gom_entity_class_get_property (entity_class, property_name, FALSE);
-      field_name = prop_info != NULL && prop_info->field_name != NULL ? prop_info->field_name
-                                                                      : property_name;
-      is_identity = _gom_strv_contains (identity_fields, property_name);
+      filter = gom_entity_cascade_build_filter (keys, begin, end, fields);
 
-      if (is_identity)
+      if (relation != NULL)
         {
-          g_autoptr(GomExpression) identity_value = NULL;
-
-          if (!gom_entity_dup_identity_value_is_set (self, entity_class, property_name, &identity_value, &error))
-            {
-              if (error != NULL)
-                return dex_future_new_for_error (g_steal_pointer (&error));
+          g_autoptr(GomQueryBuilder) query_builder = gom_query_builder_new ();
+          g_autoptr(GomQuery) query = NULL;
+          g_autoptr(GObject) cursor = NULL;
 
-              continue;
-            }
-
-          gom_insertion_builder_add_column (builder, gom_field_expression_new (field_name));
-          g_ptr_array_add (row_values, g_steal_pointer (&identity_value));
-          n_columns++;
-          continue;
-        }
+          gom_query_builder_set_target_relation (query_builder, relation);
+          gom_query_builder_set_filter (query_builder, filter);
 
-      if (!gom_entity_get_property_storage_value (self, entity_class, object_class, property_name, &value, &error))
-        return dex_future_new_for_error (g_steal_pointer (&error));
+          if (!(query = gom_query_builder_build (query_builder, error)))
+            return FALSE;
 
-      gom_insertion_builder_add_column (builder, gom_field_expression_new (field_name));
-      g_ptr_array_add (row_values, gom_literal_expression_new (&value));
-      n_columns++;
-    }
+          if (session != NULL)
+            cursor = dex_await_object (gom_session_query (session, query), error);
+          else
+            cursor = dex_await_object (gom_repository_query (repository, query), error);
 
-  if (n_columns == 0)
-    return dex_future_new_reject (G_IO_ERROR,
-                                  G_IO_ERROR_INVALID_ARGUMENT,
-                                  "Entity has no mapped properties to insert");
+          if (cursor == NULL)
+            return FALSE;
 
-  gom_insertion_builder_add_row (builder, (GomExpression **)row_values->pdata, row_values->len);
+          list = dex_await_object (_gom_cursor_exhaust_to_records (GOM_CURSOR (cursor)), error);
+        }
+      else if (session != NULL)
+        list = dex_await_object (gom_session_list_entities (session, target_type, filter, NULL), error);
+      else
+        list = dex_await_object (gom_repository_list_entities (repository, target_type, filter, NULL), error);
 
-  if (!(insertion = gom_insertion_builder_build (builder, &error)))
-    return dex_future_new_for_error (g_steal_pointer (&error));
+      if (list == NULL)
+        return FALSE;
 
-  {
-    GomEntityMutationTask *task = g_new0 (GomEntityMutationTask, 1);
+      n_items = g_list_model_get_n_items (G_LIST_MODEL (list));
 
-    task->self = g_object_ref (self);
-    task->session = session != NULL ? g_object_ref (session) : NULL;
-    task->repository = g_object_ref (repository);
-    task->mutation = GOM_MUTATION (g_object_ref (insertion));
+      for (guint i = 0; i < n_items; i++)
+        g_ptr_array_add (results, g_list_model_get_item (G_LIST_MODEL (list), i));
+    }
 
-    return dex_scheduler_spawn (NULL,
-                                0,
-                                gom_entity_mutation_fiber,
-                                task,
-                                gom_entity_mutation_task_free);
-  }
+  return TRUE;
 }
 
-/**
- * gom_entity_update:
- * @self: a [class@Gom.Entity]
- *
- * Updates @self using mapped properties.
- *
- * A `WHERE` clause is generated from identity fields and the update is
- * limited to one row.
- *
- * The entity must be bound to a repository and must have identity fields
- * whose values resolve through `GomEntityClass.dup_identity_value`.
- *
- * Returns: (transfer full): a [class@Dex.Future] that resolves to a
- *   [class@Gom.MutationResult] of [class@Gom.Record] rows or rejects with
- *   error.
- */
-DexFuture *
-gom_entity_update (GomEntity *self)
+static void
+gom_entity_prefetch_bucket_add (GHashTable *buckets,
+                                char       *key,
+                                GomEntity  *entity)
 {
-  g_autoptr(GomUpdateBuilder) builder = NULL;
-  g_autoptr(GomUpdate) update = NULL;
-  g_autoptr(GomDelta) delta = NULL;
-  g_autoptr(GomRepository) repository = NULL;
-  g_autoptr(GomSession) session = NULL;
-  g_autoptr(GomExpression) filter = NULL;
-  g_autoptr(GError) error = NULL;
-  GomEntityClass *entity_class;
-  GObjectClass *object_class;
-  const char * const *identity_fields;
-  DexFuture *failure;
+  GPtrArray *bucket;
+
+  if (!(bucket = g_hash_table_lookup (buckets, key)))
+    {
+      bucket = g_ptr_array_new_with_free_func (g_object_unref);
+      g_hash_table_insert (buckets, key, bucket);
+    }
+  else
+    {
+      g_free (key);
+    }
 
-  dex_return_error_if_fail (GOM_IS_ENTITY (self));
+  g_ptr_array_add (bucket, g_object_ref (entity));
+}
 
-  if ((failure = gom_entity_validate_mutation_setup (self, &entity_class, &object_class, &repository, &identity_fields)))
-    return failure;
+static gboolean
+gom_entity_prefetch_relationship (GListModel                 *owners,
+                                  GomEntityClass             *owner_class,
+                                  GomEntityRelationshipInfo  *relationship,
+                                  GomRepository              *repository,
+                                  GomSession                 *session,
+                                  GPtrArray                  *out_buckets,
+                                  GError                    **error)
+{
+  g_autoptr(GHashTable) seen = NULL;
+  g_autoptr(GHashTable) buckets = NULL;
+  g_autoptr(GPtrArray) keys = NULL;
+  g_autoptr(GPtrArray) related = NULL;
+  const char * const *owner_fields;
+  const char * const *target_fields;
+  const char * const *owner_identity;
+  const char * const *target_identity;
+  guint n_owners;
+
+  owner_identity = gom_entity_class_get_identity_fields (owner_class);
+  target_identity = gom_entity_class_get_identity_fields (g_type_class_get (relationship->target_type));
+
+  if (relationship->storage == GOM_RELATIONSHIP_STORAGE_FK &&
+      relationship->cardinality == GOM_RELATIONSHIP_CARDINALITY_TO_ONE)
+    {
+      owner_fields = (const char * const *)relationship->local_fields;
+      target_fields = target_identity;
+    }
+  else if (relationship->storage == GOM_RELATIONSHIP_STORAGE_FK &&
+           relationship->cardinality == GOM_RELATIONSHIP_CARDINALITY_TO_MANY)
+    {
+      owner_fields = owner_identity;
+      target_fields = (const char * const *)relationship->remote_fields;
+    }
+  else if (relationship->storage == GOM_RELATIONSHIP_STORAGE_JOIN_TABLE)
+    {
+      if (relationship->join_relation == NULL || relationship->join_relation[0] == '\0')
+        {
+          g_set_error (error,
+                       G_IO_ERROR,
+                       G_IO_ERROR_INVALID_ARGUMENT,
+                       "Relationship `%s` is missing a join relation",
+                       relationship->name);
+          return FALSE;
+        }
 
-  session = _gom_entity_dup_session (self);
+      if (!gom_entity_prefetch_check_fields (relationship,
+                                             (const char * const *)relationship->join_remote_fields,
+                                             target_identity,
+                                             error))
+        return FALSE;
 
-  if (!(delta = gom_entity_build_delta (self, &error)))
+      owner_fields = owner_identity;
+      target_fields = (const char * const *)relationship->join_local_fields;
+    }
+  else
     {
-      if (error != NULL)
-        return dex_future_new_for_error (g_steal_pointer (&error));
+      g_set_error (error,
+                   G_IO_ERROR,
+                   G_IO_ERROR_NOT_SUPPORTED,
+                   "Relationship `%s` cannot be prefetched",
+                   relationship->name);
+      return FALSE;
+    }
 
-      if (session != NULL)
-        _gom_session_accept_entity_changes (session, self, NULL);
-      else
-        _gom_entity_apply_delta (self, NULL, FALSE);
+  if (!gom_entity_prefetch_check_fields (relationship, owner_fields, target_fields, error))
+    return FALSE;
 
-      return dex_future_new_take_object (_gom_mutation_result_new ());
+  seen = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  buckets = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify)g_ptr_array_unref);
+  keys = g_ptr_array_new_with_free_func ((GDestroyNotify)g_ptr_array_unref);
+  related = g_ptr_array_new_with_free_func (g_object_unref);
+  n_owners = g_list_model_get_n_items (owners);
+
+  for (guint i = 0; i < n_owners; i++)
+    {
+      g_autoptr(GomEntity) owner = g_list_model_get_item (owners, i);
+      g_autoptr(GPtrArray) literals = g_ptr_array_new_with_free_func (g_object_unref);
+      g_autoptr(GError) local_error = NULL;
+      char *key;
+
+      if ((key = gom_entity_prefetch_entity_key (owner, owner_fields, literals, &local_error)))
+        gom_entity_prefetch_collect_key (seen, keys, key, g_steal_pointer (&literals));
+      else if (local_error != NULL)
+        {
+          g_propagate_error (error, g_steal_pointer (&local_error));
+          return FALSE;
+        }
     }
 
-  if (gom_delta_is_empty (delta))
+  if (relationship->storage == GOM_RELATIONSHIP_STORAGE_JOIN_TABLE)
     {
-      if (session != NULL)
-        _gom_session_accept_entity_changes (session, self, NULL);
-      else
-        _gom_entity_apply_delta (self, NULL, FALSE);
+      g_autoptr(GPtrArray) records = g_ptr_array_new_with_free_func (g_object_unref);
+      g_autoptr(GHashTable) targets = NULL;
+      const char * const *remote_fields = (const char * const *)relationship->join_remote_fields;
+
+      /* The join rows come first so the targets can be loaded by
+       * identity, then each join row links an owner key to a target.
+       */
+      if (!gom_entity_prefetch_run (repository, session, G_TYPE_INVALID, relationship->join_relation,
+                                    keys, target_fields, records, error))
+        return FALSE;
 
-      return dex_future_new_take_object (_gom_mutation_result_new ());
-    }
+      g_hash_table_remove_all (seen);
+      g_ptr_array_set_size (keys, 0);
 
-  builder = gom_update_builder_new ();
-  gom_update_builder_set_target_entity_type (builder, G_OBJECT_TYPE (self));
+      for (guint i = 0; i < records->len; i++)
+        {
+          g_autoptr(GPtrArray) literals = g_ptr_array_new_with_free_func (g_object_unref);
+          g_autoptr(GError) local_error = NULL;
+          char *key;
 
-  if (!(filter = gom_entity_build_identity_filter (self, entity_class, identity_fields, &error)))
-    return dex_future_new_for_error (g_steal_pointer (&error));
+          if ((key = gom_entity_prefetch_record_key (g_ptr_array_index (records, i), remote_fields, literals, &local_error)))
+            gom_entity_prefetch_collect_key (seen, keys, key, g_steal_pointer (&literals));
+          else if (local_error != NULL)
+            {
+              g_propagate_error (error, g_steal_pointer (&local_error));
+              return FALSE;
+            }
+        }
 
-  gom_update_builder_set_filter (builder, g_steal_pointer (&filter));
-  gom_update_builder_set_limit (builder, 1);
+      if (!gom_entity_prefetch_run (repository, session, relationship->target_type, NULL,
+                                    keys, target_identity, related, error))
+        return FALSE;
 
-  {
-    guint version = gom_registry_get_version (_gom_repository_get_registry (repository));
+      targets = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
 
-    for (guint i = 0; i < gom_delta_get_n_changes (delta); i++)
-      {
-        const char *property_name = gom_delta_get_property_name (delta, i);
-        GomEntityPropertyInfo *prop_info;
-        const char *field_name;
-        g_auto(GValue) value = G_VALUE_INIT;
+      for (guint i = 0; i < related->len; i++)
+        {
+          GomEntity *target = g_ptr_array_index (related, i);
+          char *key;
 
-        if (property_name == NULL)
-          continue;
+          if (!(key = gom_entity_prefetch_entity_key (target, target_identity, NULL, error)))
+            {
+              if (error != NULL && *error != NULL)
+                return FALSE;
+              continue;
+            }
 
-        if (!gom_entity_property_visible_at_version (entity_class, property_name, version))
-          continue;
+          g_hash_table_replace (targets, key, target);
+        }
 
-        if (gom_entity_get_property_spec (self, property_name) == NULL)
-          continue;
+      for (guint i = 0; i < records->len; i++)
+        {
+          GomRecord *record = g_ptr_array_index (records, i);
+          g_autofree char *remote_key = NULL;
+          char *local_key;
+          GomEntity *target;
+
+          if (!(remote_key = gom_entity_prefetch_record_key (record, remote_fields, NULL, NULL)) ||
+              !(target = g_hash_table_lookup (targets, remote_key)) ||
+              !(local_key = gom_entity_prefetch_record_key (record, target_fields, NULL, NULL)))
+            continue;
 
-        prop_info = _gom_entity_class_get_property (entity_class, property_name, FALSE);
-        field_name = prop_info != NULL && prop_info->field_name != NULL ? prop_info->field_name
-                                                                        : property_name;
+          gom_entity_prefetch_bucket_add (buckets, local_key, target);
+        }
+    }
+  else
+    {
+      if (!gom_entity_prefetch_run (repository, session, relationship->target_type, NULL,
+                                    keys, target_fields, related, error))
+        return FALSE;
 
-        if (!gom_entity_get_property_storage_value (self, entity_class, object_class, property_name, &value, &error))
-          return dex_future_new_for_error (g_steal_pointer (&error));
+      for (guint i = 0; i < related->len; i++)
+        {
+          GomEntity *target = g_ptr_array_index (related, i);
+          char *key;
 
-        gom_update_builder_add_assignment (builder,
-                                           gom_field_expression_new (field_name),
-                                           gom_literal_expression_new (&value));
-      }
-  }
+          if (!(key = gom_entity_prefetch_entity_key (target, target_fields, NULL, error)))
+            {
+              if (error != NULL && *error != NULL)
+                return FALSE;
+              continue;
+            }
 
-  if (!(update = gom_update_builder_build (builder, &error)))
-    return dex_future_new_for_error (g_steal_pointer (&error));
+          gom_entity_prefetch_bucket_add (buckets, key, target);
+        }
+    }
 
-  {
-    GomEntityMutationTask *task = g_new0 (GomEntityMutationTask, 1);
+  for (guint i = 0; i < n_owners; i++)
+    {
+      g_autoptr(GomEntity) owner = g_list_model_get_item (owners, i);
+      g_autoptr(GPtrArray) empty = NULL;
+      g_autofree char *key = NULL;
+      GPtrArray *bucket = NULL;
 
-    task->self = g_object_ref (self);
-    task->session = session != NULL ? g_object_ref (session) : NULL;
-    task->repository = g_object_ref (repository);
-    task->mutation = GOM_MUTATION (g_object_ref (update));
-    task->delta = g_object_ref (delta);
-    task->change_state_complete = _gom_entity_change_state_is_complete (self);
+      if ((key = gom_entity_prefetch_entity_key (owner, owner_fields, NULL, NULL)))
+        bucket = g_hash_table_lookup (buckets, key);
 
-    return dex_scheduler_spawn (NULL,
-                                0,
-                                gom_entity_mutation_fiber,
-                                task,
-                                gom_entity_mutation_task_free);
-  }
-}
+      if (bucket == NULL)
+        bucket = empty = g_ptr_array_new_with_free_func (g_object_unref);
 
-static void
-gom_entity_delete_task_free (gpointer data)
-{
-  GomEntityDeleteTask *task = data;
+      g_ptr_array_add (out_buckets, g_ptr_array_ref (bucket));
+    }
 
-  g_clear_object (&task->self);
-  g_clear_object (&task->session);
-  g_clear_object (&task->repository);
-  g_clear_object (&task->registry);
-  g_clear_pointer (&task->visited, g_hash_table_unref);
-  g_free (task);
+  return TRUE;
 }
 
-static DexFuture *
-gom_entity_delete_fiber (gpointer user_data)
-{
-  GomEntityDeleteTask *task = user_data;
-  g_autoptr(GomDelta) delta = NULL;
-  g_autoptr(GomDeletionBuilder) builder = NULL;
-  g_autoptr(GomDeletion) deletion = NULL;
-  g_autoptr(GomExpression) filter = NULL;
-  g_autoptr(GomMutationResult) result = NULL;
-  g_autoptr(GError) error = NULL;
+/* Loads @relationship_name for every entity in @owners with one query,
+ * two for join-table relationships. Returns an array holding one array
+ * of related entities per owner, in the order of @owners. Nothing is
+ * stored on the owners. Must be called from a fiber.
+ */
+GPtrArray *
+_gom_entity_fetch_related (GType                entity_type,
+                           GListModel          *owners,
+                           const char          *relationship_name,
+                           GomRepository       *repository,
+                           GomSession          *session,
+                           GError             **error)
+{
+  g_autoptr(GomRepository) session_repository = NULL;
+  g_autoptr(GPtrArray) buckets = NULL;
+  GomEntityRelationshipInfo *relationship;
   GomEntityClass *entity_class;
-  const char * const *identity_fields;
 
-  g_assert (task != NULL);
-  g_assert (GOM_IS_ENTITY (task->self));
+  g_return_val_if_fail (g_type_is_a (entity_type, GOM_TYPE_ENTITY), NULL);
+  g_return_val_if_fail (G_IS_LIST_MODEL (owners), NULL);
+  g_return_val_if_fail (relationship_name != NULL, NULL);
 
-  if (!gom_entity_delete_visit (task, task->self, &error))
-    return dex_future_new_for_error (g_steal_pointer (&error));
+  if (repository == NULL && session != NULL)
+    repository = session_repository = _gom_session_dup_repository (session);
 
-  if (!(delta = gom_entity_build_snapshot_delta (task->self, task->repository, GOM_DELTA_KIND_DELETE, &error)))
-    return dex_future_new_for_error (g_steal_pointer (&error));
+  if (repository == NULL)
+    {
+      g_set_error_literal (error,
+                           G_IO_ERROR,
+                           G_IO_ERROR_INVALID_ARGUMENT,
+                           "Entity is not bound to a repository");
+      return NULL;
+    }
 
-  entity_class = GOM_ENTITY_CLASS (G_OBJECT_GET_CLASS (task->self));
-  identity_fields = gom_entity_class_get_identity_fields (entity_class);
+  entity_class = g_type_class_get (entity_type);
 
-  builder = gom_deletion_builder_new ();
-  gom_deletion_builder_set_target_entity_type (builder, G_OBJECT_TYPE (task->self));
+  if (!(relationship = _gom_entity_class_get_relationship (entity_class, relationship_name, FALSE)))
+    {
+      g_set_error (error,
+                   G_IO_ERROR,
+                   G_IO_ERROR_INVALID_ARGUMENT,
+                   "Entity type `%s` does not define relationship `%s`",
+                   g_type_name (entity_type),
+                   relationship_name);
+      return NULL;
+    }
 
-  if (!(filter = gom_entity_build_identity_filter (task->self, entity_class, identity_fields, &error)))
-    return dex_future_new_for_error (g_steal_pointer (&error));
+  buckets = g_ptr_array_new_with_free_func ((GDestroyNotify)g_ptr_array_unref);
 
-  gom_deletion_builder_set_filter (builder, filter);
-  gom_deletion_builder_set_limit (builder, 1);
+  if (!gom_entity_prefetch_relationship (owners, entity_class, relationship, repository, session, buckets, error))
+    return NULL;
 
-  if (!(deletion = gom_deletion_builder_build (builder, &error)))
-    return dex_future_new_for_error (g_steal_pointer (&error));
+  return g_steal_pointer (&buckets);
+}
 
-  if (!(result = dex_await_object (gom_entity_delete_run_mutation (task, GOM_MUTATION (deletion)), &error)))
-    return dex_future_new_for_error (g_steal_pointer (&error));
+/* Loads @relationship_names for every entity in @owners and hands each
+ * owner its share for the next gom_entity_load_related_entity() or
+ * gom_entity_load_related_model(). Must be called from a fiber.
+ */
+gboolean
+_gom_entity_prefetch_related (GType                entity_type,
+                              GListModel          *owners,
+                              const char * const  *relationship_names,
+                              GomRepository       *repository,
+                              GomSession          *session,
+                              GError             **error)
+{
+  g_return_val_if_fail (g_type_is_a (entity_type, GOM_TYPE_ENTITY), FALSE);
+  g_return_val_if_fail (G_IS_LIST_MODEL (owners), FALSE);
+  g_return_val_if_fail (relationship_names != NULL, FALSE);
+
+  for (guint i = 0; relationship_names[i] != NULL; i++)
+    {
+      g_autoptr(GPtrArray) buckets = NULL;
+
+      if (!(buckets = _gom_entity_fetch_related (entity_type,
+                                                 owners,
+                                                 relationship_names[i],
+                                                 repository,
+                                                 session,
+                                                 error)))
+        return FALSE;
 
-  _gom_entity_set_lifecycle (task->self, GOM_ENTITY_LIFECYCLE_DELETED);
+      for (guint j = 0; j < buckets->len; j++)
+        {
+          g_autoptr(GomEntity) owner = g_list_model_get_item (owners, j);
 
-  if (task->session != NULL)
-    _gom_session_record_entity_changes (task->session, task->self, delta);
-  else if (!gom_entity_stage_repository_change (task->self, task->repository, delta, &error))
-    return dex_future_new_for_error (g_steal_pointer (&error));
+          _gom_entity_set_prefetched_related (owner, relationship_names[i], g_ptr_array_index (buckets, j));
+        }
+    }
 
-  return dex_future_new_take_object (g_steal_pointer (&result));
+  return TRUE;
 }
 
-/**
- * gom_entity_delete:
- * @self: a [class@Gom.Entity]
- *
- * Deletes @self using identity fields.
- *
- * A `WHERE` clause is generated from identity fields and the deletion is
- * limited to one row.
- *
- * The entity must be bound to a repository and must have identity fields
- * whose values resolve through `GomEntityClass.dup_identity_value`.
- *
- * Returns: (transfer full): a [class@Dex.Future] that resolves to a
- *   [class@Gom.MutationResult] of [class@Gom.Record] rows or rejects with
- *   error.
- */
-DexFuture *
-gom_entity_delete (GomEntity *self)
+void
+_gom_entity_set_prefetched_related (GomEntity  *self,
+                                    const char *relationship_name,
+                                    GPtrArray  *related)
 {
-  GomEntityDeleteTask *task;
-  g_autoptr(GomRepository) repository = NULL;
-  g_autoptr(GomSession) session = NULL;
-  GomEntityClass *entity_class;
-  GObjectClass *object_class;
-  const char * const *identity_fields;
-  DexFuture *failure;
+  GomEntityPrivate *priv = gom_entity_get_instance_private (self);
 
-  dex_return_error_if_fail (GOM_IS_ENTITY (self));
+  g_return_if_fail (GOM_IS_ENTITY (self));
+  g_return_if_fail (relationship_name != NULL);
+  g_return_if_fail (related != NULL);
 
-  if ((failure = gom_entity_validate_mutation_setup (self, &entity_class, &object_class, &repository, &identity_fields)))
-    return g_steal_pointer (&failure);
+  if (priv->prefetched == NULL)
+    priv->prefetched = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, (GDestroyNotify)g_ptr_array_unref);
 
-  session = _gom_entity_dup_session (self);
+  g_hash_table_replace (priv->prefetched,
+                        (gpointer)g_intern_string (relationship_name),
+                        g_ptr_array_ref (related));
+}
 
-  task = g_new0 (GomEntityDeleteTask, 1);
-  task->self = g_object_ref (self);
-  task->session = session != NULL ? g_object_ref (session) : NULL;
-  task->repository = g_object_ref (repository);
-  task->registry = g_object_ref (_gom_repository_get_registry (repository));
-  task->visited = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+/* Prefetched rows are a snapshot of the query that loaded @self, so
+ * they are handed out once. Later loads query again and see children
+ * added, removed or moved since, and related entities do not keep each
+ * other alive through a bidirectional prefetch.
+ */
+GPtrArray *
+_gom_entity_steal_prefetched_related (GomEntity  *self,
+                                      const char *relationship_name)
+{
+  GomEntityPrivate *priv = gom_entity_get_instance_private (self);
+  gpointer related = NULL;
 
-  return dex_scheduler_spawn (NULL,
-                              0,
-                              gom_entity_delete_fiber,
-                              task,
-                              gom_entity_delete_task_free);
+  g_return_val_if_fail (GOM_IS_ENTITY (self), NULL);
+  g_return_val_if_fail (relationship_name != NULL, NULL);
+
+  if (priv->prefetched == NULL ||
+      !g_hash_table_steal_extended (priv->prefetched, relationship_name, NULL, &related))
+    return NULL;
+
+  if (g_hash_table_size (priv->prefetched) == 0)
+    g_clear_pointer (&priv->prefetched, g_hash_table_unref);
+
+  return related;
 }
 
 typedef struct
@@ -3668,6 +5234,7 @@ gom_entity_load_related_model_fiber (gpointer user_data)
 {
   GomRelationshipLoadTask *task = user_data;
   g_autoptr(GomRelatedModel) model = NULL;
+  g_autoptr(GPtrArray) prefetched = NULL;
   g_autoptr(GError) error = NULL;
 
   g_assert (task != NULL);
@@ -3678,6 +5245,12 @@ gom_entity_load_related_model_fiber (gpointer user_data)
                                   G_IO_ERROR_INVALID_ARGUMENT,
                                   "Failed to create related model");
 
+  if ((prefetched = _gom_entity_steal_prefetched_related (task->self, task->relationship_name)))
+    {
+      _gom_related_model_set_items (model, prefetched);
+      return dex_future_new_take_object (g_steal_pointer (&model));
+    }
+
   if (!dex_await (gom_related_model_reload (model), &error))
     return dex_future_new_for_error (g_steal_pointer (&error));
 
@@ -3693,12 +5266,21 @@ gom_entity_load_related_entity_fiber (gpointer user_data)
   g_autoptr(GomExpression) filter = NULL;
   g_autoptr(GError) error = NULL;
   g_autoptr(GObject) list = NULL;
+  g_autoptr(GPtrArray) prefetched = NULL;
   GomEntityClass *entity_class;
   GomEntityRelationshipInfo *relationship;
 
   g_assert (task != NULL);
   g_assert (GOM_IS_ENTITY (task->self));
 
+  if ((prefetched = _gom_entity_steal_prefetched_related (task->self, task->relationship_name)))
+    {
+      if (prefetched->len == 0)
+        return dex_future_new_for_object (NULL);
+
+      return dex_future_new_for_object (g_ptr_array_index (prefetched, 0));
+    }
+
   entity_class = GOM_ENTITY_GET_CLASS (task->self);
   relationship = _gom_entity_class_get_relationship (entity_class, task->relationship_name, FALSE);
 
@@ -3795,6 +5377,10 @@ gom_entity_load_related_entity_fiber (gpointer user_data)
  * @self: a [class@Gom.Entity]
  * @relationship_name: the relationship to load
  *
+ * If the query that loaded @self prefetched @relationship_name, see
+ * [method@Gom.QueryBuilder.add_prefetch], the first load resolves
+ * without querying.
+ *
  * Returns: (transfer full): a [class@Dex.Future] that resolves to the
  *   related entity or %NULL.
  */
@@ -3825,6 +5411,10 @@ gom_entity_load_related_entity (GomEntity  *self,
  *
  * Loads a related collection asynchronously.
  *
+ * If the query that loaded @self prefetched @relationship_name, the first
+ * model is filled without querying. Later loads query the database. Use
+ * [method@Gom.RelatedModel.reload] to refresh a model.
+ *
  * Returns: (transfer full): a [class@Dex.Future] that resolves to a
  *   [class@Gom.RelatedModel]
  */
@@ -44,5 +44,7 @@ GomExpression     *_gom_vector_distance_expression_new        (GomExpression
 GomExpression     *_gom_vector_distance_expression_get_target (GomVectorDistanceExpression *self);
 GomVector         *_gom_vector_distance_expression_get_query  (GomVectorDistanceExpression *self);
 GomVectorMetric    _gom_vector_distance_expression_get_metric (GomVectorDistanceExpression *self);
+GomExpression     *_gom_in_expression_get_target              (GomInExpression             *self);
+GArray            *_gom_in_expression_get_values              (GomInExpression             *self);
 
 G_END_DECLS
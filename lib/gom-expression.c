@@ -128,6 +128,19 @@ struct _GomVectorDistanceExpressionClass
   GomExpressionClass parent_class;
 };
 
+struct _GomInExpression
+{
+  GomExpression parent_instance;
+
+  GomExpression *target;
+  GArray        *values;
+};
+
+struct _GomInExpressionClass
+{
+  GomExpressionClass parent_class;
+};
+
 /**
  * GomExpression: (set-value-func gom_value_set_expression)
  *   (get-value-func gom_value_get_expression)
@@ -143,6 +156,7 @@ G_DEFINE_FINAL_TYPE (GomUnaryExpression, gom_unary_expression, GOM_TYPE_EXPRESSI
 G_DEFINE_FINAL_TYPE (GomBinaryExpression, gom_binary_expression, GOM_TYPE_EXPRESSION)
 G_DEFINE_FINAL_TYPE (GomSearchExpression, gom_search_expression, GOM_TYPE_EXPRESSION)
 G_DEFINE_FINAL_TYPE (GomVectorDistanceExpression, gom_vector_distance_expression, GOM_TYPE_EXPRESSION)
+G_DEFINE_FINAL_TYPE (GomInExpression, gom_in_expression, GOM_TYPE_EXPRESSION)
 
 static void
 gom_expression_finalize (GObject *object)
@@ -415,6 +429,42 @@ gom_vector_distance_expression_init (GomVectorDistanceExpression *self)
 {
 }
 
+static void
+gom_in_expression_finalize (GObject *object)
+{
+  GomInExpression *self = (GomInExpression *)object;
+
+  g_clear_pointer (&self->target, g_object_unref);
+  g_clear_pointer (&self->values, g_array_unref);
+
+  G_OBJECT_CLASS (gom_in_expression_parent_class)->finalize (object);
+}
+
+static gboolean
+gom_in_expression_is_constant (GomExpression *expression)
+{
+  GomInExpression *self = (GomInExpression *)expression;
+
+  return self->target != NULL && gom_expression_is_constant (self->target);
+}
+
+static void
+gom_in_expression_class_init (GomInExpressionClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+  GomExpressionClass *expression_class = GOM_EXPRESSION_CLASS (klass);
+
+  object_class->finalize = gom_in_expression_finalize;
+  expression_class->is_constant = gom_in_expression_is_constant;
+}
+
+static void
+gom_in_expression_init (GomInExpression *self)
+{
+  self->values = g_array_new (FALSE, TRUE, sizeof (GValue));
+  g_array_set_clear_func (self->values, (GDestroyNotify)g_value_unset);
+}
+
 /**
  * gom_literal_expression_new:
  * @value: (nullable): the literal value
@@ -949,6 +999,126 @@ gom_search_expression_get_mode (GomSearchExpression *self)
   return self->mode;
 }
 
+/**
+ * gom_in_expression_new:
+ * @target: a [class@Gom.Expression]
+ * @values: (array length=n_values) (nullable): the set of values to match
+ * @n_values: the number of elements in @values
+ *
+ * Creates a set-membership expression which matches when @target is
+ * equal to one of @values.
+ *
+ * The values are handed to the driver as a single bound array so the
+ * rendered statement does not change with the number of values. An
+ * empty set never matches.
+ *
+ * Returns: (transfer full) (type Gom.InExpression): a [class@Gom.Expression]
+ */
+GomExpression *
+gom_in_expression_new (GomExpression *target,
+                       const GValue  *values,
+                       guint          n_values)
+{
+  GomInExpression *self;
+
+  g_return_val_if_fail (GOM_IS_EXPRESSION (target), NULL);
+  g_return_val_if_fail (values != NULL || n_values == 0, NULL);
+
+  self = g_object_new (GOM_TYPE_IN_EXPRESSION, NULL);
+  self->target = g_object_ref (target);
+
+  g_array_set_size (self->values, n_values);
+
+  for (guint i = 0; i < n_values; i++)
+    {
+      GValue *value = &g_array_index (self->values, GValue, i);
+
+      if (G_VALUE_TYPE (&values[i]) == G_TYPE_INVALID)
+        continue;
+
+      g_value_init (value, G_VALUE_TYPE (&values[i]));
+      g_value_copy (&values[i], value);
+    }
+
+  return GOM_EXPRESSION (self);
+}
+
+/**
+ * gom_in_expression_new_for_field:
+ * @field: the field or member name
+ * @values: (array length=n_values) (nullable): the set of values to match
+ * @n_values: the number of elements in @values
+ *
+ * Creates a set-membership expression for @field.
+ *
+ * Returns: (transfer full) (type Gom.InExpression): a [class@Gom.Expression]
+ */
+GomExpression *
+gom_in_expression_new_for_field (const char   *field,
+                                 const GValue *values,
+                                 guint         n_values)
+{
+  g_autoptr(GomExpression) target = NULL;
+
+  g_return_val_if_fail (field != NULL, NULL);
+  g_return_val_if_fail (values != NULL || n_values == 0, NULL);
+
+  target = gom_field_expression_new (field);
+
+  return gom_in_expression_new (target, values, n_values);
+}
+
+/**
+ * gom_in_expression_get_target:
+ * @self: a [class@Gom.InExpression]
+ *
+ * Gets the expression tested for membership.
+ *
+ * Returns: (transfer none): a [class@Gom.Expression]
+ */
+GomExpression *
+gom_in_expression_get_target (GomInExpression *self)
+{
+  g_return_val_if_fail (GOM_IS_IN_EXPRESSION (self), NULL);
+
+  return self->target;
+}
+
+/**
+ * gom_in_expression_get_n_values:
+ * @self: a [class@Gom.InExpression]
+ *
+ * Gets the number of values in the set.
+ *
+ * Returns: the number of values
+ */
+guint
+gom_in_expression_get_n_values (GomInExpression *self)
+{
+  g_return_val_if_fail (GOM_IS_IN_EXPRESSION (self), 0);
+
+  return self->values->len;
+}
+
+/**
+ * gom_in_expression_get_value:
+ * @self: a [class@Gom.InExpression]
+ * @position: the index of the value
+ *
+ * Gets the value at @position.
+ *
+ * Returns: (transfer none): a `GValue`
+ */
+const GValue *
+gom_in_expression_get_value (GomInExpression *self,
+                             guint            position)
+{
+  g_return_val_if_fail (GOM_IS_IN_EXPRESSION (self), NULL);
+  g_return_val_if_fail (position < self->values->len, NULL);
+
+  return &g_array_index (self->values, GValue, position);
+}
+
 GomUnaryOperator
 _gom_unary_expression_get_operator (GomUnaryExpression *self)
 {
@@ -1095,6 +1265,22 @@ _gom_vector_distance_expression_get_metric (GomVectorDistanceExpression *self)
   return self->metric;
 }
 
+GomExpression *
+_gom_in_expression_get_target (GomInExpression *self)
+{
+  g_return_val_if_fail (GOM_IS_IN_EXPRESSION (self), NULL);
+
+  return self->target;
+}
+
+GArray *
+_gom_in_expression_get_values (GomInExpression *self)
+{
+  g_return_val_if_fail (GOM_IS_IN_EXPRESSION (self), NULL);
+
+  return self->values;
+}
+
 /**
  * gom_value_set_expression:
  * @value: a `GValue` initialized with type `GOM_TYPE_EXPRESSION`
@@ -34,6 +34,7 @@ G_BEGIN_DECLS
 #define GOM_TYPE_BINARY_EXPRESSION (gom_binary_expression_get_type())
 #define GOM_TYPE_SEARCH_EXPRESSION (gom_search_expression_get_type())
 #define GOM_TYPE_VECTOR_DISTANCE_EXPRESSION (gom_vector_distance_expression_get_type())
+#define GOM_TYPE_IN_EXPRESSION (gom_in_expression_get_type())
 
 GOM_AVAILABLE_IN_ALL
 GOM_DECLARE_INTERNAL_TYPE (GomExpression, gom_expression, GOM, EXPRESSION, GObject)
@@ -51,6 +52,8 @@ GOM_AVAILABLE_IN_ALL
 GOM_DECLARE_INTERNAL_TYPE (GomSearchExpression, gom_search_expression, GOM, SEARCH_EXPRESSION, GomExpression)
 GOM_AVAILABLE_IN_ALL
 GOM_DECLARE_INTERNAL_TYPE (GomVectorDistanceExpression, gom_vector_distance_expression, GOM, VECTOR_DISTANCE_EXPRESSION, GomExpression)
+GOM_AVAILABLE_IN_ALL
+GOM_DECLARE_INTERNAL_TYPE (GomInExpression, gom_in_expression, GOM, IN_EXPRESSION, GomExpression)
 
 GOM_AVAILABLE_IN_ALL
 GParamSpec    *gom_param_spec_expression               (const char           *name,
@@ -143,6 +146,21 @@ GOM_AVAILABLE_IN_ALL
 GomExpression *gom_search_expression_get_query         (GomSearchExpression  *self);
 GOM_AVAILABLE_IN_ALL
 GomSearchMode  gom_search_expression_get_mode          (GomSearchExpression  *self);
+GOM_AVAILABLE_IN_ALL
+GomExpression *gom_in_expression_new                   (GomExpression        *target,
+                                                        const GValue         *values,
+                                                        guint                 n_values);
+GOM_AVAILABLE_IN_ALL
+GomExpression *gom_in_expression_new_for_field         (const char           *field,
+                                                        const GValue         *values,
+                                                        guint                 n_values);
+GOM_AVAILABLE_IN_ALL
+GomExpression *gom_in_expression_get_target            (GomInExpression      *self);
+GOM_AVAILABLE_IN_ALL
+guint          gom_in_expression_get_n_values          (GomInExpression      *self);
+GOM_AVAILABLE_IN_ALL
+const GValue  *gom_in_expression_get_value             (GomInExpression      *self,
+                                                        guint                 position);
 
 #ifndef __GI_SCANNER__
 static inline gboolean
@@ -0,0 +1,70 @@
+/* gom-identity-key-private.h
+ *
+ * Copyright 2026 Christian Hergert <christian@sourceandstack.com>
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of the
+ * License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include <glib-object.h>
+
+#include "gom-types-private.h"
+
+G_BEGIN_DECLS
+
+/* A session identity key is the entity GType plus a compact, typed
+ * encoding of its identity values. The 64-bit hash is computed once
+ * when the key is built so that hash table probes never touch the
+ * encoded values unless the hashes already match.
+ *
+ * Keys returned from _gom_identity_key_builder_end() are immutable and
+ * reference counted. The key returned from _gom_identity_key_builder_peek()
+ * borrows the builder storage and may only be used for lookups.
+ */
+struct _GomIdentityKey
+{
+  GType         entity_type;
+  guint64       hash;
+  gsize         len;
+  const guint8 *data;
+};
+
+typedef struct _GomIdentityKeyBuilder
+{
+  GomIdentityKey  key;
+  guint8         *data;
+  gsize           allocated;
+  guint           failed : 1;
+  guint8          inline_data[128];
+} GomIdentityKeyBuilder;
+
+void                  _gom_identity_key_builder_init   (GomIdentityKeyBuilder *builder,
+                                                        GType                  entity_type);
+gboolean              _gom_identity_key_builder_append (GomIdentityKeyBuilder *builder,
+                                                        const GValue          *value);
+const GomIdentityKey *_gom_identity_key_builder_peek   (GomIdentityKeyBuilder *builder);
+GomIdentityKey       *_gom_identity_key_builder_end    (GomIdentityKeyBuilder *builder) G_GNUC_WARN_UNUSED_RESULT;
+void                  _gom_identity_key_builder_clear  (GomIdentityKeyBuilder *builder);
+GomIdentityKey       *_gom_identity_key_ref            (GomIdentityKey        *self);
+void                  _gom_identity_key_unref          (GomIdentityKey        *self);
+guint                 _gom_identity_key_hash           (gconstpointer          key);
+gboolean              _gom_identity_key_equal          (gconstpointer          a,
+                                                        gconstpointer          b);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (GomIdentityKey, _gom_identity_key_unref)
+
+G_END_DECLS
@@ -0,0 +1,384 @@
+/* gom-identity-key.c
+ *
+ * Copyright 2026 Christian Hergert <christian@sourceandstack.com>
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of the
+ * License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include "gom-identity-key-private.h"
+
+/* Each identity value is encoded as a one byte tag followed by a fixed
+ * or length-prefixed payload. Integers are normalized to 64-bit so that
+ * an `int` property and the `int64` column it was read from produce the
+ * same key, while values of different kinds never compare equal.
+ */
+enum {
+  GOM_IDENTITY_TAG_NULL     = 'N',
+  GOM_IDENTITY_TAG_FALSE    = 'f',
+  GOM_IDENTITY_TAG_TRUE     = 't',
+  GOM_IDENTITY_TAG_INT      = 'i',
+  GOM_IDENTITY_TAG_UINT     = 'u',
+  GOM_IDENTITY_TAG_DOUBLE   = 'd',
+  GOM_IDENTITY_TAG_STRING   = 's',
+  GOM_IDENTITY_TAG_GTYPE    = 'g',
+  GOM_IDENTITY_TAG_DATETIME = 'T',
+  GOM_IDENTITY_TAG_BYTES    = 'b',
+};
+
+#define GOM_IDENTITY_HASH_PRIME G_GUINT64_CONSTANT (0x9e3779b97f4a7c15)
+
+static inline guint64
+gom_identity_key_mix (guint64 h)
+{
+  h ^= h >> 33;
+  h *= G_GUINT64_CONSTANT (0xff51afd7ed558ccd);
+  h ^= h >> 33;
+  h *= G_GUINT64_CONSTANT (0xc4ceb9fe1a85ec53);
+  h ^= h >> 33;
+
+  return h;
+}
+
+static guint64
+gom_identity_key_compute_hash (GType         entity_type,
+                               const guint8 *data,
+                               gsize         len)
+{
+  guint64 h = gom_identity_key_mix ((guint64)entity_type ^ ((guint64)len * GOM_IDENTITY_HASH_PRIME));
+  gsize i = 0;
+
+  for (; i + sizeof (guint64) <= len; i += sizeof (guint64))
+    {
+      guint64 word;
+
+      memcpy (&word, &data[i], sizeof word);
+      h = (h ^ word) * GOM_IDENTITY_HASH_PRIME;
+      h ^= h >> 29;
+    }
+
+  if (i < len)
+    {
+      guint64 word = 0;
+
+      memcpy (&word, &data[i], len - i);
+      h = (h ^ word) * GOM_IDENTITY_HASH_PRIME;
+      h ^= h >> 29;
+    }
+
+  return gom_identity_key_mix (h);
+}
+
+static guint8 *
+gom_identity_key_builder_reserve (GomIdentityKeyBuilder *builder,
+                                  gsize                  len)
+{
+  gsize needed = builder->key.len + len;
+  guint8 *ret;
+
+  if (needed > builder->allocated)
+    {
+      gsize allocated = MAX (builder->allocated * 2, needed);
+
+      if (builder->data == builder->inline_data)
+        {
+          builder->data = g_malloc (allocated);
+          memcpy (builder->data, builder->inline_data, builder->key.len);
+        }
+      else
+        {
+          builder->data = g_realloc (builder->data, allocated);
+        }
+
+      builder->allocated = allocated;
+    }
+
+  ret = &builder->data[builder->key.len];
+  builder->key.len = needed;
+
+  return ret;
+}
+
+static void
+gom_identity_key_builder_put (GomIdentityKeyBuilder *builder,
+                              guint8                 tag,
+                              gconstpointer          payload,
+                              gsize                  payload_len)
+{
+  guint8 *dest = gom_identity_key_builder_reserve (builder, 1 + payload_len);
+
+  dest[0] = tag;
+
+  if (payload_len > 0)
+    memcpy (&dest[1], payload, payload_len);
+}
+
+static void
+gom_identity_key_builder_put_sized (GomIdentityKeyBuilder *builder,
+                                    guint8                 tag,
+                                    gconstpointer          payload,
+                                    gsize                  payload_len)
+{
+  guint64 len64 = payload_len;
+  guint8 *dest = gom_identity_key_builder_reserve (builder, 1 + sizeof len64 + payload_len);
+
+  dest[0] = tag;
+  memcpy (&dest[1], &len64, sizeof len64);
+
+  if (payload_len > 0)
+    memcpy (&dest[1 + sizeof len64], payload, payload_len);
+}
+
+static void
+gom_identity_key_builder_put_int (GomIdentityKeyBuilder *builder,
+                                  gint64                 value)
+{
+  gom_identity_key_builder_put (builder, GOM_IDENTITY_TAG_INT, &value, sizeof value);
+}
+
+static void
+gom_identity_key_builder_put_uint (GomIdentityKeyBuilder *builder,
+                                   guint64                value)
+{
+  if (value <= G_MAXINT64)
+    gom_identity_key_builder_put_int (builder, (gint64)value);
+  else
+    gom_identity_key_builder_put (builder, GOM_IDENTITY_TAG_UINT, &value, sizeof value);
+}
+
+static void
+gom_identity_key_builder_put_double (GomIdentityKeyBuilder *builder,
+                                     double                 value)
+{
+  gom_identity_key_builder_put (builder, GOM_IDENTITY_TAG_DOUBLE, &value, sizeof value);
+}
+
+void
+_gom_identity_key_builder_init (GomIdentityKeyBuilder *builder,
+                                GType                  entity_type)
+{
+  g_return_if_fail (builder != NULL);
+
+  builder->key.entity_type = entity_type;
+  builder->key.hash = 0;
+  builder->key.len = 0;
+  builder->key.data = NULL;
+  builder->data = builder->inline_data;
+  builder->allocated = sizeof builder->inline_data;
+  builder->failed = FALSE;
+}
+
+/* Appends the next identity value. Returns %FALSE and poisons the
+ * builder if @value has a type that cannot participate in identity.
+ */
+gboolean
+_gom_identity_key_builder_append (GomIdentityKeyBuilder *builder,
+                                  const GValue          *value)
+{
+  g_return_val_if_fail (builder != NULL, FALSE);
+  g_return_val_if_fail (G_IS_VALUE (value), FALSE);
+
+  if (builder->failed)
+    return FALSE;
+
+  if (G_VALUE_HOLDS_BOOLEAN (value))
+    gom_identity_key_builder_put (builder,
+                                  g_value_get_boolean (value) ? GOM_IDENTITY_TAG_TRUE : GOM_IDENTITY_TAG_FALSE,
+                                  NULL, 0);
+  else if (G_VALUE_HOLDS_CHAR (value))
+    gom_identity_key_builder_put_int (builder, g_value_get_schar (value));
+  else if (G_VALUE_HOLDS_UCHAR (value))
+    gom_identity_key_builder_put_uint (builder, g_value_get_uchar (value));
+  else if (G_VALUE_HOLDS_INT (value))
+    gom_identity_key_builder_put_int (builder, g_value_get_int (value));
+  else if (G_VALUE_HOLDS_UINT (value))
+    gom_identity_key_builder_put_uint (builder, g_value_get_uint (value));
+  else if (G_VALUE_HOLDS_LONG (value))
+    gom_identity_key_builder_put_int (builder, g_value_get_long (value));
+  else if (G_VALUE_HOLDS_ULONG (value))
+    gom_identity_key_builder_put_uint (builder, g_value_get_ulong (value));
+  else if (G_VALUE_HOLDS_INT64 (value))
+    gom_identity_key_builder_put_int (builder, g_value_get_int64 (value));
+  else if (G_VALUE_HOLDS_UINT64 (value))
+    gom_identity_key_builder_put_uint (builder, g_value_get_uint64 (value));
+  else if (G_VALUE_HOLDS_FLOAT (value))
+    gom_identity_key_builder_put_double (builder, g_value_get_float (value));
+  else if (G_VALUE_HOLDS_DOUBLE (value))
+    gom_identity_key_builder_put_double (builder, g_value_get_double (value));
+  else if (G_VALUE_HOLDS_ENUM (value))
+    gom_identity_key_builder_put_int (builder, g_value_get_enum (value));
+  else if (G_VALUE_HOLDS_FLAGS (value))
+    gom_identity_key_builder_put_uint (builder, g_value_get_flags (value));
+  else if (G_VALUE_HOLDS_STRING (value))
+    {
+      const char *str = g_value_get_string (value);
+
+      if (str == NULL)
+        gom_identity_key_builder_put (builder, GOM_IDENTITY_TAG_NULL, NULL, 0);
+      else
+        gom_identity_key_builder_put_sized (builder, GOM_IDENTITY_TAG_STRING, str, strlen (str));
+    }
+  else if (G_VALUE_HOLDS_GTYPE (value))
+    {
+      GType gtype = g_value_get_gtype (value);
+
+      gom_identity_key_builder_put (builder, GOM_IDENTITY_TAG_GTYPE, &gtype, sizeof gtype);
+    }
+  else if (G_VALUE_HOLDS (value, G_TYPE_DATE_TIME))
+    {
+      GDateTime *datetime = g_value_get_boxed (value);
+
+      if (datetime == NULL)
+        {
+          gom_identity_key_builder_put (builder, GOM_IDENTITY_TAG_NULL, NULL, 0);
+        }
+      else
+        {
+          gint64 payload[2] = {
+            g_date_time_to_unix_usec (datetime),
+            g_date_time_get_utc_offset (datetime),
+          };
+
+          gom_identity_key_builder_put (builder, GOM_IDENTITY_TAG_DATETIME, payload, sizeof payload);
+        }
+    }
+  else if (G_VALUE_HOLDS (value, G_TYPE_BYTES))
+    {
+      GBytes *bytes = g_value_get_boxed (value);
+
+      if (bytes == NULL)
+        {
+          gom_identity_key_builder_put (builder, GOM_IDENTITY_TAG_NULL, NULL, 0);
+        }
+      else
+        {
+          gsize len = 0;
+          const guint8 *data = g_bytes_get_data (bytes, &len);
+
+          gom_identity_key_builder_put_sized (builder, GOM_IDENTITY_TAG_BYTES, data, len);
+        }
+    }
+  else
+    {
+      g_critical ("Cannot build identity key for unsupported value type `%s`",
+                  G_VALUE_TYPE_NAME (value));
+      builder->failed = TRUE;
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+/* Returns a key borrowing the builder storage, suitable for probing an
+ * identity map without allocating. It stays valid until the builder is
+ * appended to, ended or cleared.
+ */
+const GomIdentityKey *
+_gom_identity_key_builder_peek (GomIdentityKeyBuilder *builder)
+{
+  g_return_val_if_fail (builder != NULL, NULL);
+
+  if (builder->failed || builder->key.len == 0)
+    return NULL;
+
+  builder->key.data = builder->data;
+  builder->key.hash = gom_identity_key_compute_hash (builder->key.entity_type,
+                                                     builder->data,
+                                                     builder->key.len);
+
+  return &builder->key;
+}
+
+GomIdentityKey *
+_gom_identity_key_builder_end (GomIdentityKeyBuilder *builder)
+{
+  GomIdentityKey *self;
+  guint8 *data;
+
+  g_return_val_if_fail (builder != NULL, NULL);
+
+  if (builder->failed || builder->key.len == 0)
+    {
+      _gom_identity_key_builder_clear (builder);
+      return NULL;
+    }
+
+  self = g_atomic_rc_box_alloc (sizeof *self + builder->key.len);
+  data = (guint8 *)(self + 1);
+  memcpy (data, builder->data, builder->key.len);
+
+  self->entity_type = builder->key.entity_type;
+  self->len = builder->key.len;
+  self->data = data;
+  self->hash = gom_identity_key_compute_hash (self->entity_type, data, self->len);
+
+  _gom_identity_key_builder_clear (builder);
+
+  return self;
+}
+
+void
+_gom_identity_key_builder_clear (GomIdentityKeyBuilder *builder)
+{
+  g_return_if_fail (builder != NULL);
+
+  if (builder->data != builder->inline_data)
+    g_free (builder->data);
+
+  _gom_identity_key_builder_init (builder, builder->key.entity_type);
+}
+
+GomIdentityKey *
+_gom_identity_key_ref (GomIdentityKey *self)
+{
+  return g_atomic_rc_box_acquire (self);
+}
+
+void
+_gom_identity_key_unref (GomIdentityKey *self)
+{
+  g_atomic_rc_box_release (self);
+}
+
+guint
+_gom_identity_key_hash (gconstpointer key)
+{
+  const GomIdentityKey *self = key;
+
+  return (guint)(self->hash ^ (self->hash >> 32));
+}
+
+/* The hash only narrows the comparison; the encoded values are always
+ * compared so that a 64-bit collision cannot alias two entities.
+ */
+gboolean
+_gom_identity_key_equal (gconstpointer a,
+                         gconstpointer b)
+{
+  const GomIdentityKey *key_a = a;
+  const GomIdentityKey *key_b = b;
+
+  if (key_a == key_b)
+    return TRUE;
+
+  return key_a->hash == key_b->hash &&
+         key_a->entity_type == key_b->entity_type &&
+         key_a->len == key_b->len &&
+         memcmp (key_a->data, key_b->data, key_a->len) == 0;
+}
@@ -0,0 +1,45 @@
+/* gom-keyset-private.h
+ *
+ * Copyright 2026 Christian Hergert <christian@sourceandstack.com>
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of the
+ * License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include <gio/gio.h>
+
+#include "gom-query.h"
+#include "gom-types-private.h"
+
+G_BEGIN_DECLS
+
+typedef struct _GomKeyset GomKeyset;
+
+GomKeyset *_gom_keyset_new            (GomQuery   *query);
+void       _gom_keyset_free           (GomKeyset  *self);
+void       _gom_keyset_reset          (GomKeyset  *self);
+GomQuery  *_gom_keyset_dup_page_query (GomKeyset  *self,
+                                       guint       page_index,
+                                       guint       page_size);
+void       _gom_keyset_set_page       (GomKeyset  *self,
+                                       guint       page_index,
+                                       guint       page_size,
+                                       GListModel *items);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (GomKeyset, _gom_keyset_free)
+
+G_END_DECLS
@@ -0,0 +1,451 @@
+/* gom-keyset.c
+ *
+ * Copyright 2026 Christian Hergert <christian@sourceandstack.com>
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of the
+ * License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include "config.h"
+
+#include "gom-entity.h"
+#include "gom-expression.h"
+#include "gom-expression-private.h"
+#include "gom-keyset-private.h"
+#include "gom-ordering.h"
+#include "gom-query-private.h"
+#include "gom-record.h"
+#include "gom-util-private.h"
+
+/* GomKeyset implements seek pagination for the list models.
+ *
+ * When a page has been loaded, the ordering key of its last row is kept
+ * so that the following page can be fetched with a predicate such as
+ * `WHERE (a, b) > (:a, :b)` instead of an OFFSET. Deep sequential scrolls
+ * therefore cost O(page) rather than O(offset). Random jumps to a page
+ * whose predecessor has not been loaded fall back to OFFSET.
+ *
+ * For the predicate to be exact the ordering must be total, so the
+ * identity fields of the target entity are appended as tie-breakers.
+ * The same orderings are used for OFFSET pages so both paths agree on
+ * row order.
+ */
+
+typedef struct
+{
+  GValue *values;
+  guint   n_values;
+} GomKeysetBoundary;
+
+struct _GomKeyset
+{
+  GomQuery    *query;
+  GPtrArray   *orderings;
+  char       **fields;
+  GHashTable  *boundaries;
+  guint        n_fields;
+};
+
+static void
+gom_keyset_boundary_free (GomKeysetBoundary *boundary)
+{
+  for (guint i = 0; i < boundary->n_values; i++)
+    g_value_unset (&boundary->values[i]);
+
+  g_free (boundary->values);
+  g_free (boundary);
+}
+
+static gboolean
+gom_keyset_ordering_is_supported (GomOrdering        *ordering,
+                                  const char * const *identity_fields)
+{
+  GomExpression *expression = gom_ordering_get_expression (ordering);
+  const char *field;
+
+  if (!GOM_IS_FIELD_EXPRESSION (expression))
+    return FALSE;
+
+  if (!(field = _gom_field_expression_get_field (GOM_FIELD_EXPRESSION (expression))))
+    return FALSE;
+
+  /* Where NULLs land with GOM_NULLS_DEFAULT differs between backends, so
+   * only identity fields (which are never NULL) may use the default.
+   */
+  if (gom_ordering_get_nulls_mode (ordering) == GOM_NULLS_DEFAULT &&
+      !_gom_strv_contains (identity_fields, field))
+    return FALSE;
+
+  return TRUE;
+}
+
+GomKeyset *
+_gom_keyset_new (GomQuery *query)
+{
+  g_autoptr(GPtrArray) orderings = NULL;
+  g_autoptr(GPtrArray) fields = NULL;
+  const char * const *identity_fields;
+  GomEntityClass *entity_class;
+  GPtrArray *query_orderings;
+  GomKeyset *self;
+  GType entity_type;
+
+  g_return_val_if_fail (GOM_IS_QUERY (query), NULL);
+
+  entity_type = _gom_query_get_target_entity_type (query);
+  query_orderings = _gom_query_get_orderings (query);
+
+  if (!g_type_is_a (entity_type, GOM_TYPE_ENTITY) ||
+      query_orderings == NULL ||
+      query_orderings->len == 0 ||
+      _gom_query_get_target_relation (query) != NULL ||
+      _gom_query_get_projections (query) != NULL ||
+      _gom_query_get_groupings (query) != NULL ||
+      _gom_query_get_group_filter (query) != NULL)
+    return NULL;
+
+  entity_class = g_type_class_get (entity_type);
+  identity_fields = gom_entity_class_get_identity_fields (entity_class);
+
+  if (identity_fields == NULL || identity_fields[0] == NULL)
+    return NULL;
+
+  orderings = g_ptr_array_new_with_free_func (g_object_unref);
+  fields = g_ptr_array_new_with_free_func (g_free);
+
+  for (guint i = 0; i < query_orderings->len; i++)
+    {
+      GomOrdering *ordering = g_ptr_array_index (query_orderings, i);
+      GomExpression *expression = gom_ordering_get_expression (ordering);
+
+      if (!gom_keyset_ordering_is_supported (ordering, identity_fields))
+        return NULL;
+
+      g_ptr_array_add (orderings, g_object_ref (ordering));
+      g_ptr_array_add (fields, g_strdup (_gom_field_expression_get_field (GOM_FIELD_EXPRESSION (expression))));
+    }
+
+  for (guint i = 0; identity_fields[i] != NULL; i++)
+    {
+      if (g_ptr_array_find_with_equal_func (fields, identity_fields[i], g_str_equal, NULL))
+        continue;
+
+      g_ptr_array_add (orderings,
+                       gom_ordering_new (gom_field_expression_new (identity_fields[i]),
+                                         GOM_SORT_ASCENDING));
+      g_ptr_array_add (fields, g_strdup (identity_fields[i]));
+    }
+
+  self = g_new0 (GomKeyset, 1);
+  self->query = g_object_ref (query);
+  self->orderings = g_steal_pointer (&orderings);
+  self->n_fields = fields->len;
+  g_ptr_array_add (fields, NULL);
+  self->fields = (char **)g_ptr_array_free (g_steal_pointer (&fields), FALSE);
+  self->boundaries = g_hash_table_new_full (NULL, NULL, NULL,
+                                            (GDestroyNotify)gom_keyset_boundary_free);
+
+  return self;
+}
+
+void
+_gom_keyset_free (GomKeyset *self)
+{
+  if (self == NULL)
+    return;
+
+  g_clear_object (&self->query);
+  g_clear_pointer (&self->orderings, g_ptr_array_unref);
+  g_clear_pointer (&self->fields, g_strfreev);
+  g_clear_pointer (&self->boundaries, g_hash_table_unref);
+  g_free (self);
+}
+
+void
+_gom_keyset_reset (GomKeyset *self)
+{
+  g_return_if_fail (self != NULL);
+
+  g_hash_table_remove_all (self->boundaries);
+}
+
+static GomExpression *
+gom_keyset_build_predicate (GomKeyset         *self,
+                            GomKeysetBoundary *boundary)
+{
+  g_autoptr(GomExpression) predicate = NULL;
+
+  g_assert (self != NULL);
+  g_assert (boundary != NULL);
+  g_assert (boundary->n_values == self->n_fields);
+
+  /* Expands (c1, c2, ..., cn) > (v1, v2, ..., vn) into
+   *
+   *   c1 > v1 OR (c1 = v1 AND c2 > v2) OR ...
+   *
+   * which allows mixing sort directions and NULL placement per column.
+   * Binary expressions take their own references to the operands.
+   */
+  for (guint i = self->n_fields; i > 0; i--)
+    {
+      GomOrdering *ordering = g_ptr_array_index (self->orderings, i - 1);
+      g_autoptr(GomExpression) field_expr = gom_field_expression_new (self->fields[i - 1]);
+      g_autoptr(GomExpression) value_expr = gom_literal_expression_new (&boundary->values[i - 1]);
+      g_autoptr(GomExpression) after = NULL;
+      g_autoptr(GomExpression) equal = NULL;
+      g_autoptr(GomExpression) term = NULL;
+
+      if (gom_ordering_get_direction (ordering) == GOM_SORT_DESCENDING)
+        after = gom_binary_expression_new_less_than (field_expr, value_expr);
+      else
+        after = gom_binary_expression_new_greater_than (field_expr, value_expr);
+
+      if (gom_ordering_get_nulls_mode (ordering) == GOM_NULLS_LAST)
+        {
+          g_autoptr(GomExpression) null_expr = gom_literal_expression_new (NULL);
+          g_autoptr(GomExpression) is_null = gom_binary_expression_new_equal (field_expr, null_expr);
+          GomExpression *after_or_null = gom_binary_expression_new_or (after, is_null);
+
+          g_object_unref (after);
+          after = after_or_null;
+        }
+
+      if (predicate == NULL)
+        {
+          predicate = g_steal_pointer (&after);
+          continue;
+        }
+
+      equal = gom_binary_expression_new_equal (field_expr, value_expr);
+      term = gom_binary_expression_new_and (equal, predicate);
+
+      g_object_unref (predicate);
+      predicate = gom_binary_expression_new_or (after, term);
+    }
+
+  return g_steal_pointer (&predicate);
+}
+
+GomQuery *
+_gom_keyset_dup_page_query (GomKeyset *self,
+                            guint      page_index,
+                            guint      page_size)
+{
+  GomKeysetBoundary *boundary;
+  GomExpression *filter;
+  GomQuery *page;
+  guint64 offset = (guint64)page_index * page_size;
+  guint64 limit = page_size;
+
+  g_return_val_if_fail (self != NULL, NULL);
+  g_return_val_if_fail (page_size > 0, NULL);
+
+  if (page_index > 0 &&
+      (boundary = g_hash_table_lookup (self->boundaries, GUINT_TO_POINTER (page_index - 1))))
+    {
+      g_autoptr(GomExpression) predicate = gom_keyset_build_predicate (self, boundary);
+      g_autoptr(GomExpression) page_filter = NULL;
+
+      /* The predicate already skips the base OFFSET along with the
+       * previous pages, so only the base LIMIT needs to be honored.
+       */
+      if (_gom_query_has_limit (self->query))
+        {
+          guint64 base_limit = _gom_query_get_limit (self->query);
+
+          limit = offset >= base_limit ? 0 : MIN (limit, base_limit - offset);
+        }
+
+      if ((filter = _gom_query_get_filter (self->query)))
+        page_filter = gom_binary_expression_new_and (filter, predicate);
+      else
+        page_filter = g_steal_pointer (&predicate);
+
+      page = _gom_query_new (_gom_query_get_target_entity_type (self->query),
+                             NULL,
+                             NULL,
+                             page_filter,
+                             NULL,
+                             NULL,
+                             self->orderings,
+                             0,
+                             limit,
+                             FALSE,
+                             TRUE,
+                             _gom_query_get_with_count (self->query));
+      _gom_query_set_prefetches (page, _gom_query_get_prefetches (self->query));
+
+      return page;
+    }
+
+  {
+    g_autoptr(GomQuery) ordered = NULL;
+
+    ordered = _gom_query_new (_gom_query_get_target_entity_type (self->query),
+                              NULL,
+                              NULL,
+                              _gom_query_get_filter (self->query),
+                              NULL,
+                              NULL,
+                              self->orderings,
+                              _gom_query_get_offset (self->query),
+                              _gom_query_get_limit (self->query),
+                              _gom_query_has_offset (self->query),
+                              _gom_query_has_limit (self->query),
+                              _gom_query_get_with_count (self->query));
+    _gom_query_set_prefetches (ordered, _gom_query_get_prefetches (self->query));
+
+    return _gom_query_slice (ordered, offset, page_size);
+  }
+}
+
+static gboolean
+gom_keyset_normalize_value (const GValue *value,
+                            GValue       *out)
+{
+  g_assert (value != NULL);
+  g_assert (out != NULL);
+
+  switch (G_TYPE_FUNDAMENTAL (G_VALUE_TYPE (value)))
+    {
+    case G_TYPE_STRING:
+      if (g_value_get_string (value) == NULL)
+        return FALSE;
+      g_value_init (out, G_TYPE_STRING);
+      g_value_set_string (out, g_value_get_string (value));
+      return TRUE;
+
+    case G_TYPE_INT64:
+      g_value_init (out, G_TYPE_INT64);
+      g_value_set_int64 (out, g_value_get_int64 (value));
+      return TRUE;
+
+    case G_TYPE_INT:
+      g_value_init (out, G_TYPE_INT64);
+      g_value_set_int64 (out, g_value_get_int (value));
+      return TRUE;
+
+    case G_TYPE_UINT:
+      g_value_init (out, G_TYPE_INT64);
+      g_value_set_int64 (out, g_value_get_uint (value));
+      return TRUE;
+
+    case G_TYPE_UINT64:
+      if (g_value_get_uint64 (value) > G_MAXINT64)
+        return FALSE;
+      g_value_init (out, G_TYPE_INT64);
+      g_value_set_int64 (out, (gint64)g_value_get_uint64 (value));
+      return TRUE;
+
+    case G_TYPE_BOOLEAN:
+      g_value_init (out, G_TYPE_INT64);
+      g_value_set_int64 (out, g_value_get_boolean (value) ? 1 : 0);
+      return TRUE;
+
+    case G_TYPE_DOUBLE:
+      g_value_init (out, G_TYPE_DOUBLE);
+      g_value_set_double (out, g_value_get_double (value));
+      return TRUE;
+
+    case G_TYPE_FLOAT:
+      g_value_init (out, G_TYPE_DOUBLE);
+      g_value_set_double (out, g_value_get_float (value));
+      return TRUE;
+
+    default:
+      /* NULLs and types without a stable SQL comparison (dates stored as
+       * text, blobs, enums mapped through strings) use OFFSET instead.
+       */
+      return FALSE;
+    }
+}
+
+static gboolean
+gom_keyset_read_field (GObject    *item,
+                       const char *field,
+                       GValue     *out)
+{
+  g_auto(GValue) value = G_VALUE_INIT;
+
+  g_assert (G_IS_OBJECT (item));
+  g_assert (field != NULL);
+  g_assert (out != NULL);
+
+  if (GOM_IS_RECORD (item))
+    {
+      if (!gom_record_get_column_by_name (GOM_RECORD (item), field, &value))
+        return FALSE;
+    }
+  else
+    {
+      const char * const *identity_fields;
+      GParamSpec *pspec;
+
+      if (!(pspec = g_object_class_find_property (G_OBJECT_GET_CLASS (item), field)))
+        return FALSE;
+
+      identity_fields = gom_entity_class_get_identity_fields (GOM_ENTITY_GET_CLASS (item));
+
+      /* Scalar properties cannot represent NULL, so a NULL column would
+       * read back as 0 and become a wrong boundary. Only identity fields
+       * are known to be NOT NULL, other scalars use OFFSET instead.
+       */
+      if (G_TYPE_FUNDAMENTAL (pspec->value_type) != G_TYPE_STRING &&
+          !_gom_strv_contains (identity_fields, field))
+        return FALSE;
+
+      g_value_init (&value, pspec->value_type);
+      g_object_get_property (item, field, &value);
+    }
+
+  return gom_keyset_normalize_value (&value, out);
+}
+
+void
+_gom_keyset_set_page (GomKeyset  *self,
+                      guint       page_index,
+                      guint       page_size,
+                      GListModel *items)
+{
+  g_autoptr(GObject) last = NULL;
+  GomKeysetBoundary *boundary;
+  guint n_items;
+
+  g_return_if_fail (self != NULL);
+  g_return_if_fail (G_IS_LIST_MODEL (items));
+
+  /* A short page is the end of the result set, nothing follows it */
+  n_items = g_list_model_get_n_items (items);
+  if (n_items == 0 || n_items < page_size)
+    return;
+
+  last = g_list_model_get_item (items, n_items - 1);
+
+  boundary = g_new0 (GomKeysetBoundary, 1);
+  boundary->values = g_new0 (GValue, self->n_fields);
+  boundary->n_values = self->n_fields;
+
+  for (guint i = 0; i < self->n_fields; i++)
+    {
+      if (!gom_keyset_read_field (last, self->fields[i], &boundary->values[i]))
+        {
+          gom_keyset_boundary_free (boundary);
+          g_hash_table_remove (self->boundaries, GUINT_TO_POINTER (page_index));
+          return;
+        }
+    }
+
+  g_hash_table_replace (self->boundaries, GUINT_TO_POINTER (page_index), boundary);
+}
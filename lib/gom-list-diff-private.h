@@ -0,0 +1,49 @@
+/* gom-list-diff-private.h
+ *
+ * Copyright 2026 Christian Hergert <christian@sourceandstack.com>
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of the
+ * License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+#define GOM_LIST_DIFF_MAX_EDITS 512
+
+/* A hunk replaces @n_removed items at @old_position of the old list with
+ * @n_added items starting at @new_position of the new list.
+ */
+typedef struct _GomListDiffHunk
+{
+  guint old_position;
+  guint n_removed;
+  guint new_position;
+  guint n_added;
+} GomListDiffHunk;
+
+GArray *_gom_list_diff (gconstpointer const *old_items,
+                        gconstpointer const *old_keys,
+                        guint                n_old,
+                        gconstpointer const *new_items,
+                        gconstpointer const *new_keys,
+                        guint                n_new,
+                        GEqualFunc           key_equal,
+                        guint                max_edits);
+
+G_END_DECLS
@@ -0,0 +1,326 @@
+/* gom-list-diff.c
+ *
+ * Copyright 2026 Christian Hergert <christian@sourceandstack.com>
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of the
+ * License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include "config.h"
+
+#include "gom-list-diff-private.h"
+
+/* _gom_list_diff() finds the hunks that turn one list into another using
+ * the greedy algorithm from Myers' "An O(ND) Difference Algorithm".
+ *
+ * Two items match when they are the same pointer, or when both have a
+ * key and the keys are equal. Matched items that are different instances
+ * are still replaced so the new list ends up with the new instances, but
+ * items that are the same pointer in both lists are never part of a hunk.
+ *
+ * The furthest reaching path for every diagonal is kept for each edit
+ * count so the script can be recovered by walking back from the end. That
+ * costs O(D²) memory, so the search gives up after @max_edits and replaces
+ * everything between the common prefix and suffix instead.
+ */
+
+typedef enum
+{
+  GOM_LIST_DIFF_KEEP,
+  GOM_LIST_DIFF_DELETE,
+  GOM_LIST_DIFF_INSERT,
+} GomListDiffOp;
+
+typedef struct
+{
+  gconstpointer const *old_items;
+  gconstpointer const *old_keys;
+  gconstpointer const *new_items;
+  gconstpointer const *new_keys;
+  GEqualFunc           key_equal;
+  guint                prefix;
+} GomListDiff;
+
+static inline gboolean
+gom_list_diff_match (const GomListDiff *diff,
+                     gint               x,
+                     gint               y)
+{
+  guint i = diff->prefix + x;
+  guint j = diff->prefix + y;
+  gconstpointer old_key;
+  gconstpointer new_key;
+
+  if (diff->old_items[i] == diff->new_items[j])
+    return TRUE;
+
+  if (diff->old_keys == NULL || diff->new_keys == NULL)
+    return FALSE;
+
+  old_key = diff->old_keys[i];
+  new_key = diff->new_keys[j];
+
+  return old_key != NULL && new_key != NULL && diff->key_equal (old_key, new_key);
+}
+
+/* @prev holds the furthest x reached on diagonals -(d-1)..(d-1), or -1
+ * for diagonals that cannot be reached. Returns where diagonal @k starts
+ * with @d edits, before following its snake.
+ */
+static gint
+gom_list_diff_step (const gint *prev,
+                    gint        d,
+                    gint        k,
+                    gint        n,
+                    gint        m,
+                    gint       *from_k)
+{
+  gint x_down = -1;
+  gint x_right = -1;
+
+  if (k + 1 <= d - 1 && prev[k + 1 + d - 1] >= 0)
+    {
+      x_down = prev[k + 1 + d - 1];
+      if (x_down - k > m)
+        x_down = -1;
+    }
+
+  if (k - 1 >= -(d - 1) && prev[k - 1 + d - 1] >= 0)
+    {
+      x_right = prev[k - 1 + d - 1] + 1;
+      if (x_right > n)
+        x_right = -1;
+    }
+
+  if (x_down < 0 && x_right < 0)
+    return -1;
+
+  if (x_down >= x_right)
+    {
+      *from_k = k + 1;
+      return x_down;
+    }
+
+  *from_k = k - 1;
+  return x_right;
+}
+
+static GArray *
+gom_list_diff_script (const GomListDiff *diff,
+                      gint               n,
+                      gint               m,
+                      gint               max_d)
+{
+  g_autoptr(GArray) trace = g_array_new (FALSE, FALSE, sizeof (gint));
+  GArray *ops;
+  gint found = -1;
+  gint x;
+  gint y;
+
+  for (gint d = 0; d <= max_d && found < 0; d++)
+    {
+      const gint *prev;
+      gint *cur;
+
+      g_array_set_size (trace, (d + 1) * (d + 1));
+      prev = d > 0 ? &g_array_index (trace, gint, (d - 1) * (d - 1)) : NULL;
+      cur = &g_array_index (trace, gint, d * d);
+
+      for (gint i = 0; i < 2 * d + 1; i++)
+        cur[i] = -1;
+
+      for (gint k = -d; k <= d; k += 2)
+        {
+          gint from_k;
+
+          if (d == 0)
+            x = 0;
+          else if ((x = gom_list_diff_step (prev, d, k, n, m, &from_k)) < 0)
+            continue;
+
+          y = x - k;
+
+          while (x < n && y < m && gom_list_diff_match (diff, x, y))
+            x++, y++;
+
+          cur[k + d] = x;
+
+          if (x == n && y == m)
+            {
+              found = d;
+              break;
+            }
+        }
+    }
+
+  if (found < 0)
+    return NULL;
+
+  ops = g_array_new (FALSE, FALSE, sizeof (guint8));
+  x = n;
+  y = m;
+
+  for (gint d = found; d > 0; d--)
+    {
+      const gint *prev = &g_array_index (trace, gint, (d - 1) * (d - 1));
+      gint k = x - y;
+      gint from_k = 0;
+      gint start;
+      guint8 op;
+
+      start = gom_list_diff_step (prev, d, k, n, m, &from_k);
+      g_assert (start >= 0);
+
+      for (; x > start; x--, y--)
+        {
+          op = GOM_LIST_DIFF_KEEP;
+          g_array_append_val (ops, op);
+        }
+
+      op = from_k == k + 1 ? GOM_LIST_DIFF_INSERT : GOM_LIST_DIFF_DELETE;
+      g_array_append_val (ops, op);
+
+      x = prev[from_k + d - 1];
+      y = x - from_k;
+    }
+
+  for (; x > 0; x--, y--)
+    {
+      guint8 op = GOM_LIST_DIFF_KEEP;
+      g_array_append_val (ops, op);
+    }
+
+  g_assert (y == 0);
+
+  /* Walked back from the end, so reverse into list order */
+  for (guint i = 0, j = ops->len; i + 1 < j; i++, j--)
+    {
+      guint8 tmp = g_array_index (ops, guint8, i);
+
+      g_array_index (ops, guint8, i) = g_array_index (ops, guint8, j - 1);
+      g_array_index (ops, guint8, j - 1) = tmp;
+    }
+
+  return ops;
+}
+
+static void
+gom_list_diff_push_hunk (GArray          *hunks,
+                         GomListDiffHunk *hunk)
+{
+  if (hunk->n_removed > 0 || hunk->n_added > 0)
+    g_array_append_val (hunks, *hunk);
+
+  hunk->n_removed = 0;
+  hunk->n_added = 0;
+}
+
+/* Returns the hunks, in list order, that turn @old_items into @new_items.
+ * Either key array may be %NULL, and individual keys may be %NULL, in
+ * which case the item only matches itself.
+ */
+GArray *
+_gom_list_diff (gconstpointer const *old_items,
+                gconstpointer const *old_keys,
+                guint                n_old,
+                gconstpointer const *new_items,
+                gconstpointer const *new_keys,
+                guint                n_new,
+                GEqualFunc           key_equal,
+                guint                max_edits)
+{
+  g_autoptr(GArray) ops = NULL;
+  GomListDiffHunk hunk = { 0 };
+  GomListDiff diff;
+  GArray *hunks;
+  guint prefix = 0;
+  guint suffix = 0;
+  guint n;
+  guint m;
+  guint i;
+  guint j;
+
+  g_return_val_if_fail (old_items != NULL || n_old == 0, NULL);
+  g_return_val_if_fail (new_items != NULL || n_new == 0, NULL);
+  g_return_val_if_fail (key_equal != NULL || old_keys == NULL || new_keys == NULL, NULL);
+  g_return_val_if_fail (n_old <= G_MAXINT / 2 && n_new <= G_MAXINT / 2, NULL);
+
+  hunks = g_array_new (FALSE, FALSE, sizeof (GomListDiffHunk));
+
+  while (prefix < n_old && prefix < n_new && old_items[prefix] == new_items[prefix])
+    prefix++;
+
+  while (prefix + suffix < n_old && prefix + suffix < n_new &&
+         old_items[n_old - suffix - 1] == new_items[n_new - suffix - 1])
+    suffix++;
+
+  n = n_old - prefix - suffix;
+  m = n_new - prefix - suffix;
+
+  if (n == 0 && m == 0)
+    return hunks;
+
+  diff.old_items = old_items;
+  diff.old_keys = old_keys;
+  diff.new_items = new_items;
+  diff.new_keys = new_keys;
+  diff.key_equal = key_equal;
+  diff.prefix = prefix;
+
+  if (n == 0 || m == 0 ||
+      !(ops = gom_list_diff_script (&diff, n, m, MIN (n + m, max_edits))))
+    {
+      hunk.old_position = prefix;
+      hunk.n_removed = n;
+      hunk.new_position = prefix;
+      hunk.n_added = m;
+      gom_list_diff_push_hunk (hunks, &hunk);
+      return hunks;
+    }
+
+  i = prefix;
+  j = prefix;
+
+  for (guint o = 0; o < ops->len; o++)
+    {
+      guint8 op = g_array_index (ops, guint8, o);
+
+      if (op == GOM_LIST_DIFF_KEEP && old_items[i] == new_items[j])
+        {
+          gom_list_diff_push_hunk (hunks, &hunk);
+          i++, j++;
+          continue;
+        }
+
+      if (hunk.n_removed == 0 && hunk.n_added == 0)
+        {
+          hunk.old_position = i;
+          hunk.new_position = j;
+        }
+
+      if (op != GOM_LIST_DIFF_INSERT)
+        hunk.n_removed++, i++;
+
+      if (op != GOM_LIST_DIFF_DELETE)
+        hunk.n_added++, j++;
+    }
+
+  gom_list_diff_push_hunk (hunks, &hunk);
+
+  g_assert (i == n_old - suffix);
+  g_assert (j == n_new - suffix);
+
+  return hunks;
+}
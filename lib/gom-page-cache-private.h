@@ -0,0 +1,82 @@
+/* gom-page-cache-private.h
+ *
+ * Copyright 2026 Christian Hergert <christian@sourceandstack.com>
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of the
+ * License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+#define GOM_READ_AHEAD_MAX_PAGES 4
+
+typedef struct _GomPageCache GomPageCache;
+
+/* Tracks the direction and speed pages are requested in, see
+ * _gom_read_ahead_update().
+ */
+typedef struct _GomReadAhead
+{
+  guint last_page;
+  gint  direction;
+  guint streak;
+} GomReadAhead;
+
+/* Called for each page that is about to be evicted. Returning %FALSE keeps
+ * the page in the cache, such as while it is still loading.
+ */
+typedef gboolean (*GomPageCacheEvictFunc) (guint    page_index,
+                                           gpointer page,
+                                           gpointer user_data);
+
+GomPageCache *_gom_page_cache_new            (GDestroyNotify         page_destroy);
+void          _gom_page_cache_free           (GomPageCache          *self);
+guint         _gom_page_cache_get_max_pages  (GomPageCache          *self);
+void          _gom_page_cache_set_max_pages  (GomPageCache          *self,
+                                              guint                  max_pages);
+guint         _gom_page_cache_max_read_ahead (GomPageCache          *self);
+guint         _gom_page_cache_get_size       (GomPageCache          *self);
+gpointer      _gom_page_cache_peek           (GomPageCache          *self,
+                                              guint                  page_index);
+gpointer      _gom_page_cache_lookup         (GomPageCache          *self,
+                                              guint                  page_index);
+void          _gom_page_cache_insert         (GomPageCache          *self,
+                                              guint                  page_index,
+                                              gpointer               page);
+void          _gom_page_cache_remove         (GomPageCache          *self,
+                                              guint                  page_index);
+void          _gom_page_cache_remove_all     (GomPageCache          *self);
+guint         _gom_page_cache_evict          (GomPageCache          *self,
+                                              GomPageCacheEvictFunc  evict,
+                                              gpointer               user_data);
+
+void          _gom_read_ahead_reset          (GomReadAhead          *self);
+gboolean      _gom_read_ahead_update         (GomReadAhead          *self,
+                                              guint                  page_index,
+                                              guint                  n_pages,
+                                              guint                  max_depth,
+                                              guint                 *window,
+                                              guint                 *n_window);
+gboolean      _gom_read_ahead_contains       (const guint           *window,
+                                              guint                  n_window,
+                                              guint                  page_index);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (GomPageCache, _gom_page_cache_free)
+
+G_END_DECLS
@@ -0,0 +1,347 @@
+/* gom-page-cache.c
+ *
+ * Copyright 2026 Christian Hergert <christian@sourceandstack.com>
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of the
+ * License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include "config.h"
+
+#include "gom-page-cache-private.h"
+
+/* GomPageCache holds the loaded pages of the list models in least
+ * recently used order.
+ *
+ * Every lookup from the model moves the page to the front, so the pages
+ * at the back are the ones furthest from where the list was last read.
+ * Once there are more than max_pages pages, _gom_page_cache_evict() drops
+ * them from the back until the cache is within budget again. The most
+ * recently used page is never evicted, and a max_pages of zero disables
+ * eviction entirely.
+ *
+ * GomReadAhead decides which pages to prefetch. It follows the requested
+ * page index and counts how many pages in a row were crossed in the same
+ * direction. That streak is the read-ahead depth, so a slow scroll only
+ * prefetches the next page while a fast one prefetches up to
+ * GOM_READ_AHEAD_MAX_PAGES. Jumping further than that looks like random
+ * access and resets the streak.
+ */
+
+typedef struct
+{
+  GList    link;
+  guint    page_index;
+  gpointer page;
+} GomPageCacheEntry;
+
+struct _GomPageCache
+{
+  GHashTable     *entries;
+  GQueue          lru;
+  GDestroyNotify  page_destroy;
+  guint           max_pages;
+};
+
+static void
+gom_page_cache_entry_free (gpointer data)
+{
+  GomPageCacheEntry *entry = data;
+
+  g_free (entry);
+}
+
+GomPageCache *
+_gom_page_cache_new (GDestroyNotify page_destroy)
+{
+  GomPageCache *self;
+
+  self = g_new0 (GomPageCache, 1);
+  self->entries = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, gom_page_cache_entry_free);
+  self->page_destroy = page_destroy;
+  g_queue_init (&self->lru);
+
+  return self;
+}
+
+void
+_gom_page_cache_free (GomPageCache *self)
+{
+  if (self == NULL)
+    return;
+
+  _gom_page_cache_remove_all (self);
+  g_clear_pointer (&self->entries, g_hash_table_unref);
+  g_free (self);
+}
+
+guint
+_gom_page_cache_get_max_pages (GomPageCache *self)
+{
+  g_return_val_if_fail (self != NULL, 0);
+
+  return self->max_pages;
+}
+
+/* Changing the budget does not evict anything by itself; the owner is
+ * expected to call _gom_page_cache_evict() afterwards.
+ */
+void
+_gom_page_cache_set_max_pages (GomPageCache *self,
+                               guint         max_pages)
+{
+  g_return_if_fail (self != NULL);
+
+  self->max_pages = max_pages;
+}
+
+/* How many pages may be read ahead without pushing the pages being
+ * looked at out of the budget.
+ */
+guint
+_gom_page_cache_max_read_ahead (GomPageCache *self)
+{
+  g_return_val_if_fail (self != NULL, 0);
+
+  if (self->max_pages == 0)
+    return GOM_READ_AHEAD_MAX_PAGES;
+
+  return MIN (GOM_READ_AHEAD_MAX_PAGES, (self->max_pages - 1) / 2);
+}
+
+guint
+_gom_page_cache_get_size (GomPageCache *self)
+{
+  g_return_val_if_fail (self != NULL, 0);
+
+  return self->lru.length;
+}
+
+/* Returns the page without changing its position in the LRU */
+gpointer
+_gom_page_cache_peek (GomPageCache *self,
+                      guint         page_index)
+{
+  GomPageCacheEntry *entry;
+
+  g_return_val_if_fail (self != NULL, NULL);
+
+  if (!(entry = g_hash_table_lookup (self->entries, GUINT_TO_POINTER (page_index))))
+    return NULL;
+
+  return entry->page;
+}
+
+gpointer
+_gom_page_cache_lookup (GomPageCache *self,
+                        guint         page_index)
+{
+  GomPageCacheEntry *entry;
+
+  g_return_val_if_fail (self != NULL, NULL);
+
+  if (!(entry = g_hash_table_lookup (self->entries, GUINT_TO_POINTER (page_index))))
+    return NULL;
+
+  if (self->lru.head != &entry->link)
+    {
+      g_queue_unlink (&self->lru, &entry->link);
+      g_queue_push_head_link (&self->lru, &entry->link);
+    }
+
+  return entry->page;
+}
+
+/* Takes ownership of @page and makes it the most recently used one */
+void
+_gom_page_cache_insert (GomPageCache *self,
+                        guint         page_index,
+                        gpointer      page)
+{
+  GomPageCacheEntry *entry;
+
+  g_return_if_fail (self != NULL);
+  g_return_if_fail (page != NULL);
+
+  _gom_page_cache_remove (self, page_index);
+
+  entry = g_new0 (GomPageCacheEntry, 1);
+  entry->link.data = entry;
+  entry->page_index = page_index;
+  entry->page = page;
+
+  g_queue_push_head_link (&self->lru, &entry->link);
+  g_hash_table_insert (self->entries, GUINT_TO_POINTER (page_index), entry);
+}
+
+static void
+gom_page_cache_remove_entry (GomPageCache      *self,
+                             GomPageCacheEntry *entry)
+{
+  gpointer page = entry->page;
+
+  g_queue_unlink (&self->lru, &entry->link);
+  g_hash_table_remove (self->entries, GUINT_TO_POINTER (entry->page_index));
+
+  if (self->page_destroy != NULL)
+    self->page_destroy (page);
+}
+
+void
+_gom_page_cache_remove (GomPageCache *self,
+                        guint         page_index)
+{
+  GomPageCacheEntry *entry;
+
+  g_return_if_fail (self != NULL);
+
+  if ((entry = g_hash_table_lookup (self->entries, GUINT_TO_POINTER (page_index))))
+    gom_page_cache_remove_entry (self, entry);
+}
+
+void
+_gom_page_cache_remove_all (GomPageCache *self)
+{
+  g_return_if_fail (self != NULL);
+
+  while (self->lru.head != NULL)
+    gom_page_cache_remove_entry (self, self->lru.head->data);
+}
+
+/* Evicts least recently used pages until the cache is within budget or
+ * nothing else may be evicted. Returns the number of pages evicted.
+ */
+guint
+_gom_page_cache_evict (GomPageCache          *self,
+                       GomPageCacheEvictFunc  evict,
+                       gpointer               user_data)
+{
+  guint n_evicted = 0;
+  GList *link;
+
+  g_return_val_if_fail (self != NULL, 0);
+
+  if (self->max_pages == 0)
+    return 0;
+
+  link = self->lru.tail;
+
+  while (link != NULL &&
+         link != self->lru.head &&
+         self->lru.length > self->max_pages)
+    {
+      GomPageCacheEntry *entry = link->data;
+
+      link = link->prev;
+
+      if (evict != NULL && !evict (entry->page_index, entry->page, user_data))
+        continue;
+
+      gom_page_cache_remove_entry (self, entry);
+      n_evicted++;
+    }
+
+  return n_evicted;
+}
+
+void
+_gom_read_ahead_reset (GomReadAhead *self)
+{
+  g_return_if_fail (self != NULL);
+
+  self->last_page = G_MAXUINT;
+  self->direction = 0;
+  self->streak = 0;
+}
+
+/* Records a request for @page_index out of @n_pages. Returns %FALSE and
+ * leaves @window alone if the page did not change. Otherwise @window is
+ * filled with up to GOM_READ_AHEAD_MAX_PAGES pages to prefetch, nearest
+ * first.
+ */
+gboolean
+_gom_read_ahead_update (GomReadAhead *self,
+                        guint         page_index,
+                        guint         n_pages,
+                        guint         max_depth,
+                        guint        *window,
+                        guint        *n_window)
+{
+  guint distance;
+  guint depth;
+  gint direction;
+
+  g_return_val_if_fail (self != NULL, FALSE);
+  g_return_val_if_fail (window != NULL, FALSE);
+  g_return_val_if_fail (n_window != NULL, FALSE);
+
+  if (page_index == self->last_page)
+    return FALSE;
+
+  *n_window = 0;
+
+  if (self->last_page == G_MAXUINT)
+    {
+      self->last_page = page_index;
+      return TRUE;
+    }
+
+  direction = page_index > self->last_page ? 1 : -1;
+  distance = direction > 0 ? page_index - self->last_page : self->last_page - page_index;
+
+  if (distance > GOM_READ_AHEAD_MAX_PAGES)
+    self->streak = 0;
+  else if (direction == self->direction)
+    self->streak = MIN (self->streak + distance, GOM_READ_AHEAD_MAX_PAGES);
+  else
+    self->streak = distance;
+
+  self->direction = direction;
+  self->last_page = page_index;
+
+  depth = MIN (self->streak, MIN (max_depth, GOM_READ_AHEAD_MAX_PAGES));
+
+  for (guint i = 1; i <= depth; i++)
+    {
+      if (direction > 0)
+        {
+          if (page_index + i >= n_pages)
+            break;
+          window[(*n_window)++] = page_index + i;
+        }
+      else
+        {
+          if (i > page_index)
+            break;
+          window[(*n_window)++] = page_index - i;
+        }
+    }
+
+  return TRUE;
+}
+
+gboolean
+_gom_read_ahead_contains (const guint *window,
+                          guint        n_window,
+                          guint        page_index)
+{
+  for (guint i = 0; i < n_window; i++)
+    {
+      if (window[i] == page_index)
+        return TRUE;
+    }
+
+  return FALSE;
+}
@@ -22,6 +22,7 @@
 
 #include <gio/gio.h>
 
+#include "gom-entity-private.h"
 #include "gom-expression.h"
 #include "gom-ordering.h"
 #include "gom-query-builder.h"
@@ -38,6 +39,7 @@ struct _GomQueryBuilder
   GPtrArray     *groupings;
   GomExpression *group_filter;
   GPtrArray     *orderings;
+  GPtrArray     *prefetches;
   guint64        offset;
   guint64        limit;
   guint          has_offset : 1;
@@ -57,6 +59,7 @@ gom_query_builder_finalize (GomQueryBuilder *self)
   g_clear_pointer (&self->groupings, g_ptr_array_unref);
   gom_clear_expression (&self->group_filter);
   g_clear_pointer (&self->orderings, g_ptr_array_unref);
+  g_clear_pointer (&self->prefetches, g_ptr_array_unref);
   g_clear_pointer (&self->target_relation, g_free);
 }
 
@@ -230,6 +233,52 @@ gom_query_builder_clear_orderings (GomQueryBuilder *self)
     g_ptr_array_remove_range (self->orderings, 0, self->orderings->len);
 }
 
+/**
+ * gom_query_builder_add_prefetch:
+ * @self: a [struct@Gom.QueryBuilder]
+ * @relationship_name: a relationship of the target entity type
+ *
+ * Requests that @relationship_name be loaded eagerly for every entity
+ * materialized from the query.
+ *
+ * When the resulting cursor is exhausted into a list, the related rows
+ * for the whole result set are loaded with one query per relationship
+ * (two for join-table relationships) instead of one query per entity.
+ * The related entities are registered with the session, if any, and
+ * [method@Gom.Entity.load_related_entity] and
+ * [method@Gom.Entity.load_related_model] resolve from them without
+ * touching the database.
+ *
+ * The query must target an entity type which defines @relationship_name.
+ */
+void
+gom_query_builder_add_prefetch (GomQueryBuilder *self,
+                                const char      *relationship_name)
+{
+  g_return_if_fail (self != NULL);
+  g_return_if_fail (relationship_name != NULL);
+
+  if (self->prefetches == NULL)
+    self->prefetches = g_ptr_array_new_null_terminated (0, g_free, TRUE);
+
+  for (guint i = 0; i < self->prefetches->len; i++)
+    {
+      if (g_str_equal (g_ptr_array_index (self->prefetches, i), relationship_name))
+        return;
+    }
+
+  g_ptr_array_add (self->prefetches, g_strdup (relationship_name));
+}
+
+void
+gom_query_builder_clear_prefetches (GomQueryBuilder *self)
+{
+  g_return_if_fail (self != NULL);
+
+  if (self->prefetches != NULL && self->prefetches->len > 0)
+    g_ptr_array_remove_range (self->prefetches, 0, self->prefetches->len);
+}
+
 void
 gom_query_builder_set_offset (GomQueryBuilder *self,
                               guint64          offset)
@@ -250,11 +299,53 @@ gom_query_builder_set_limit (GomQueryBuilder *self,
   self->has_limit = TRUE;
 }
 
+static gboolean
+gom_query_builder_validate_prefetches (GomQueryBuilder  *self,
+                                      GError          **error)
+{
+  GomEntityClass *entity_class;
+
+  if (self->prefetches == NULL || self->prefetches->len == 0)
+    return TRUE;
+
+  if (self->target_relation != NULL ||
+      !g_type_is_a (self->target_entity_type, GOM_TYPE_ENTITY))
+    {
+      g_set_error_literal (error,
+                           G_IO_ERROR,
+                           G_IO_ERROR_INVALID_ARGUMENT,
+                           "Prefetching relationships requires a target entity type");
+      return FALSE;
+    }
+
+  entity_class = g_type_class_get (self->target_entity_type);
+
+  for (guint i = 0; i < self->prefetches->len; i++)
+    {
+      const char *name = g_ptr_array_index (self->prefetches, i);
+
+      if (_gom_entity_class_get_relationship (entity_class, name, FALSE) == NULL)
+        {
+          g_set_error (error,
+                       G_IO_ERROR,
+                       G_IO_ERROR_INVALID_ARGUMENT,
+                       "Entity type `%s` does not define relationship `%s`",
+                       g_type_name (self->target_entity_type),
+                       name);
+          return FALSE;
+        }
+    }
+
+  return TRUE;
+}
+
 static GomQuery *
 gom_query_builder_build_internal (GomQueryBuilder  *self,
                                   gboolean          with_count,
                                   GError          **error)
 {
+  GomQuery *query;
+
   if (self->target_entity_type == G_TYPE_INVALID && self->target_relation == NULL)
     {
       g_set_error (error,
@@ -264,18 +355,26 @@ gom_query_builder_build_internal (GomQueryBuilder  *self,
       return NULL;
     }
 
-  return _gom_query_new (self->target_entity_type,
-                         self->target_relation,
-                         self->projections,
-                         self->filter,
-                         self->groupings,
-                         self->group_filter,
-                         self->orderings,
-                         self->offset,
-                         self->limit,
-                         self->has_offset,
-                         self->has_limit,
-                         with_count);
+  if (!gom_query_builder_validate_prefetches (self, error))
+    return NULL;
+
+  query = _gom_query_new (self->target_entity_type,
+                          self->target_relation,
+                          self->projections,
+                          self->filter,
+                          self->groupings,
+                          self->group_filter,
+                          self->orderings,
+                          self->offset,
+                          self->limit,
+                          self->has_offset,
+                          self->has_limit,
+                          with_count);
+
+  if (self->prefetches != NULL && self->prefetches->len > 0)
+    _gom_query_set_prefetches (query, (const char * const *)self->prefetches->pdata);
+
+  return query;
 }
 
 /**
@@ -63,6 +63,11 @@ void             gom_query_builder_add_ordering           (GomQueryBuilder  *sel
 GOM_AVAILABLE_IN_ALL
 void             gom_query_builder_clear_orderings        (GomQueryBuilder  *self);
 GOM_AVAILABLE_IN_ALL
+void             gom_query_builder_add_prefetch           (GomQueryBuilder  *self,
+                                                           const char       *relationship_name);
+GOM_AVAILABLE_IN_ALL
+void             gom_query_builder_clear_prefetches       (GomQueryBuilder  *self);
+GOM_AVAILABLE_IN_ALL
 void             gom_query_builder_set_offset             (GomQueryBuilder  *self,
                                                            guint64           offset);
 GOM_AVAILABLE_IN_ALL
@@ -22,7 +22,10 @@
 
 #include "gom-cursor.h"
 #include "gom-entity.h"
+#include "gom-entity-private.h"
 #include "gom-expression.h"
+#include "gom-identity-key-private.h"
+#include "gom-list-diff-private.h"
 #include "gom-ordering.h"
 #include "gom-query-private.h"
 #include "gom-query-model.h"
@@ -40,6 +43,7 @@ struct _GomQueryModel
   GomQuery      *query;
   GListStore    *items;
   DexFuture     *reload_future;
+  guint          reload_handle;
   guint          loading : 1;
   guint          refresh_pending : 1;
 };
@@ -77,8 +81,7 @@ static void       gom_query_model_items_changed_cb   (GListModel          *list,
                                                       gpointer             user_data);
 static DexFuture *gom_query_model_reload_fiber       (gpointer             user_data);
 static DexFuture *gom_query_model_request_reload     (GomQueryModel       *self);
-static void       gom_query_model_session_changed_cb (GomSession          *session,
-                                                      GomQueryModel       *self);
+static DexFuture *gom_query_model_scheduled_reload   (gpointer             instance);
 
 G_DEFINE_TYPE_WITH_CODE (GomQueryModel,
                          gom_query_model,
@@ -141,6 +144,11 @@ gom_query_model_finalize (GObject *object)
 {
   GomQueryModel *self = GOM_QUERY_MODEL (object);
 
+  if (self->session != NULL && self->reload_handle != 0 &&
+      _gom_session_get_reload_scheduler (self->session) != NULL)
+    _gom_reload_scheduler_remove (_gom_session_get_reload_scheduler (self->session),
+                                  self->reload_handle);
+
   g_clear_object (&self->session);
   g_clear_object (&self->filter);
   g_clear_object (&self->ordering);
@@ -182,12 +190,16 @@ gom_query_model_constructed (GObject *object)
                                     FALSE);
     }
 
-  if (self->session != NULL)
-    g_signal_connect_object (self->session,
-                             "changed",
-                             G_CALLBACK (gom_query_model_session_changed_cb),
-                             self,
-                             0);
+  if (self->session != NULL && self->query != NULL &&
+      _gom_session_get_reload_scheduler (self->session) != NULL)
+    {
+      _gom_session_follow_committed_changes (self->session);
+      self->reload_handle =
+        _gom_reload_scheduler_add (_gom_session_get_reload_scheduler (self->session),
+                                   self,
+                                   _gom_reload_scheduler_query_relation (self->query),
+                                   gom_query_model_scheduled_reload);
+    }
 }
 
 static void
@@ -292,16 +304,28 @@ gom_query_model_list_model_init (GListModelInterface *iface)
   iface->get_item = gom_query_model_get_item_iface;
 }
 
+static void
+gom_query_model_key_free (gpointer data)
+{
+  g_clear_pointer (&data, _gom_identity_key_unref);
+}
+
+/* Applies the smallest set of splices that turns the current items into
+ * @results. Entities are matched by their identity key, so rows that are
+ * still in the result set keep their position and widget even when rows
+ * around them were inserted, removed or moved.
+ */
 static void
 gom_query_model_sync_items (GomQueryModel *self,
                             GListModel    *results)
 {
   g_autoptr(GPtrArray) current_items = NULL;
+  g_autoptr(GPtrArray) current_keys = NULL;
   g_autoptr(GPtrArray) new_items = NULL;
+  g_autoptr(GPtrArray) new_keys = NULL;
+  g_autoptr(GArray) hunks = NULL;
   guint n_current;
   guint n_new;
-  guint prefix = 0;
-  guint suffix = 0;
 
   g_assert (GOM_IS_QUERY_MODEL (self));
   g_assert (G_IS_LIST_MODEL (results));
@@ -309,38 +333,52 @@ gom_query_model_sync_items (GomQueryModel *self,
   n_current = g_list_model_get_n_items (G_LIST_MODEL (self->items));
   n_new = g_list_model_get_n_items (results);
 
-  new_items = g_ptr_array_new_with_free_func (g_object_unref);
-  current_items = g_ptr_array_new_with_free_func (g_object_unref);
+  current_items = g_ptr_array_new_full (n_current, g_object_unref);
+  current_keys = g_ptr_array_new_full (n_current, gom_query_model_key_free);
+  new_items = g_ptr_array_new_full (n_new, g_object_unref);
+  new_keys = g_ptr_array_new_full (n_new, gom_query_model_key_free);
 
   for (guint i = 0; i < n_current; i++)
-    g_ptr_array_add (current_items, g_list_model_get_item (G_LIST_MODEL (self->items), i));
-
-  for (guint i = 0; i < n_new; i++)
-    g_ptr_array_add (new_items, g_list_model_get_item (results, i));
+    {
+      GObject *item = g_list_model_get_item (G_LIST_MODEL (self->items), i);
 
-  while (prefix < n_current && prefix < n_new &&
-         g_ptr_array_index (current_items, prefix) == g_ptr_array_index (new_items, prefix))
-    prefix++;
+      g_ptr_array_add (current_items, item);
+      g_ptr_array_add (current_keys, GOM_IS_ENTITY (item) ? _gom_entity_dup_session_key (GOM_ENTITY (item)) : NULL);
+    }
 
-  while (suffix + prefix < n_current && suffix + prefix < n_new &&
-         g_ptr_array_index (current_items, n_current - suffix - 1) ==
-           g_ptr_array_index (new_items, n_new - suffix - 1))
-    suffix++;
+  for (guint i = 0; i < n_new; i++)
+    {
+      GObject *item = g_list_model_get_item (results, i);
 
-  if (prefix == n_current && n_current == n_new)
-    return;
+      g_ptr_array_add (new_items, item);
+      g_ptr_array_add (new_keys, GOM_IS_ENTITY (item) ? _gom_entity_dup_session_key (GOM_ENTITY (item)) : NULL);
+    }
 
-  if (suffix == 0 && prefix == 0)
+  hunks = _gom_list_diff ((gconstpointer const *)current_items->pdata,
+                          (gconstpointer const *)current_keys->pdata,
+                          n_current,
+                          (gconstpointer const *)new_items->pdata,
+                          (gconstpointer const *)new_keys->pdata,
+                          n_new,
+                          _gom_identity_key_equal,
+                          GOM_LIST_DIFF_MAX_EDITS);
+
+  GOM_TRACE_MARK ("QueryModel",
+                  "sync",
+                  "old=%u new=%u hunks=%u",
+                  n_current, n_new, hunks->len);
+
+  /* Back to front so positions of earlier hunks remain valid */
+  for (guint i = hunks->len; i > 0; i--)
     {
-      g_list_store_splice (self->items, 0, n_current, (gpointer *)new_items->pdata, n_new);
-      return;
-    }
+      const GomListDiffHunk *hunk = &g_array_index (hunks, GomListDiffHunk, i - 1);
 
-  g_list_store_splice (self->items,
-                       prefix,
-                       n_current - prefix - suffix,
-                       (gpointer *)new_items->pdata + prefix,
-                       n_new - prefix - suffix);
+      g_list_store_splice (self->items,
+                           hunk->old_position,
+                           hunk->n_removed,
+                           new_items->pdata + hunk->new_position,
+                           hunk->n_added);
+    }
 }
 
 static void
@@ -441,14 +479,12 @@ gom_query_model_request_reload (GomQueryModel *self)
   return GOM_TRACE_MARKED_FUTURE (future, start_time, "QueryModel", "reload", "session=%p", self->session);
 }
 
-static void
-gom_query_model_session_changed_cb (GomSession    *session,
-                                    GomQueryModel *self)
+static DexFuture *
+gom_query_model_scheduled_reload (gpointer instance)
 {
-  g_assert (GOM_IS_SESSION (session));
-  g_assert (GOM_IS_QUERY_MODEL (self));
+  g_assert (GOM_IS_QUERY_MODEL (instance));
 
-  dex_future_disown (gom_query_model_request_reload (self));
+  return gom_query_model_request_reload (instance);
 }
 
 /**
@@ -466,7 +502,9 @@ gom_query_model_session_changed_cb (GomSession    *session,
  * [method@Gom.Repository.begin_session]. For read-only UI lists, prefer
  * [method@Gom.Repository.list_query] and [class@Gom.EntityListModel].
  *
- * The model reloads automatically when the bound session emits `changed`.
+ * The model reloads automatically when the bound session emits `changed`
+ * and when [signal@Gom.Repository::changes-committed] reports rows of the
+ * relation it reads.
  *
  * Returns: (transfer full): a new [class@Gom.QueryModel]
  */
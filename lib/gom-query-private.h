@@ -73,5 +73,8 @@ guint64        _gom_query_get_offset                 (GomQuery             *self
 gboolean       _gom_query_has_limit                  (GomQuery             *self);
 guint64        _gom_query_get_limit                  (GomQuery             *self);
 gboolean       _gom_query_get_with_count             (GomQuery             *self);
+const char * const *_gom_query_get_prefetches        (GomQuery             *self);
+void           _gom_query_set_prefetches             (GomQuery             *self,
+                                                      const char * const   *prefetches);
 
 G_END_DECLS
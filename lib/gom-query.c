@@ -41,6 +41,7 @@ struct _GomQuery
   GPtrArray     *groupings;
   GomExpression *group_filter;
   GPtrArray     *orderings;
+  char         **prefetches;
   guint64        offset;
   guint64        limit;
   guint          has_offset : 1;
@@ -116,6 +117,7 @@ gom_query_finalize (GObject *object)
   g_clear_pointer (&self->groupings, g_ptr_array_unref);
   gom_clear_expression (&self->group_filter);
   g_clear_pointer (&self->orderings, g_ptr_array_unref);
+  g_clear_pointer (&self->prefetches, g_strfreev);
   g_clear_pointer (&self->target_relation, g_free);
 
   G_OBJECT_CLASS (gom_query_parent_class)->finalize (object);
@@ -507,11 +509,35 @@ _gom_query_get_with_count (GomQuery *self)
   return self->with_count;
 }
 
+/* Relationship names to load eagerly once the query's entities have been
+ * materialized. %NULL when nothing is prefetched.
+ */
+const char * const *
+_gom_query_get_prefetches (GomQuery *self)
+{
+  g_return_val_if_fail (GOM_IS_QUERY (self), NULL);
+
+  return (const char * const *)self->prefetches;
+}
+
+void
+_gom_query_set_prefetches (GomQuery           *self,
+                           const char * const *prefetches)
+{
+  g_return_if_fail (GOM_IS_QUERY (self));
+
+  g_clear_pointer (&self->prefetches, g_strfreev);
+
+  if (prefetches != NULL && prefetches[0] != NULL)
+    self->prefetches = g_strdupv ((char **)prefetches);
+}
+
 GomQuery *
 _gom_query_slice (GomQuery *query,
                   guint64   offset,
                   guint64   length)
 {
+  GomQuery *slice;
   guint64 base_offset;
   guint64 new_offset;
   guint64 new_limit;
@@ -543,16 +569,19 @@ _gom_query_slice (GomQuery *query,
         }
     }
 
-  return _gom_query_new (query->target_entity_type,
-                         query->target_relation,
-                         query->projections,
-                         query->filter,
-                         query->groupings,
-                         query->group_filter,
-                         query->orderings,
-                         new_offset,
-                         new_limit,
-                         has_offset,
-                         has_limit,
-                         query->with_count);
+  slice = _gom_query_new (query->target_entity_type,
+                          query->target_relation,
+                          query->projections,
+                          query->filter,
+                          query->groupings,
+                          query->group_filter,
+                          query->orderings,
+                          new_offset,
+                          new_limit,
+                          has_offset,
+                          has_limit,
+                          query->with_count);
+  _gom_query_set_prefetches (slice, (const char * const *)query->prefetches);
+
+  return slice;
 }
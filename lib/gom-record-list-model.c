@@ -22,15 +22,18 @@
 
 #include "gom-cursor-private.h"
 #include "gom-entity.h"
+#include "gom-keyset-private.h"
+#include "gom-page-cache-private.h"
 #include "gom-query-private.h"
 #include "gom-record.h"
 #include "gom-record-list-item-private.h"
 #include "gom-record-list-model-private.h"
 #include "gom-repository.h"
 #include "gom-trace-private.h"
-#include "gom-session.h"
+#include "gom-session-private.h"
 
 #define GOM_RECORD_LIST_DEFAULT_PAGE_SIZE 64
+#define GOM_RECORD_LIST_DEFAULT_MAX_PAGES 16
 
 typedef enum
 {
@@ -43,7 +46,10 @@ typedef struct
   gatomicrefcount  ref_count;
   guint            index;
   guint64          generation;
+  GListModel      *items;
+  guint            loaded : 1;
   guint            loading : 1;
+  guint            prefetch : 1;
 } GomRecordListPage;
 
 struct _GomRecordListModel
@@ -53,15 +59,22 @@ struct _GomRecordListModel
   GomSession          *session;
   GomRepository       *repository;
   GomQuery            *query;
+  GomKeyset           *keyset;
   GHashTable          *wrappers;
-  GHashTable          *pages;
+  GomPageCache        *pages;
   DexFuture           *reload_future;
+  GArray              *prefetch;
+  GSource             *prefetch_source;
+  GomReadAhead         read_ahead;
+  guint                read_ahead_window[GOM_READ_AHEAD_MAX_PAGES];
+  guint                n_read_ahead_window;
+  guint                n_loading_pages;
   guint                n_items;
   guint                page_size;
   guint64              generation;
   guint                loading : 1;
   guint                refresh_pending : 1;
-  gulong               session_changed_handler;
+  guint                reload_handle;
 };
 
 enum
@@ -71,6 +84,7 @@ enum
   PROP_REPOSITORY,
   PROP_QUERY,
   PROP_LOADING,
+  PROP_MAX_PAGES,
   N_PROPS
 };
 
@@ -90,7 +104,8 @@ static void       gom_record_list_model_set_property        (GObject
 static DexFuture *gom_record_list_model_request_reload      (GomRecordListModel  *self,
                                                              gboolean             invalidate);
 static void       gom_record_list_model_queue_page          (GomRecordListModel  *self,
-                                                             guint                page_index);
+                                                             guint                page_index,
+                                                             gboolean             prefetch);
 
 G_DEFINE_TYPE_WITH_CODE (GomRecordListModel,
                          gom_record_list_model,
@@ -110,6 +125,7 @@ gom_record_list_page_ref (GomRecordListPage *page)
 static void
 gom_record_list_page_free (GomRecordListPage *page)
 {
+  g_clear_object (&page->items);
   g_free (page);
 }
 
@@ -206,6 +222,9 @@ gom_record_list_model_dup_page_query (GomRecordListModel *self,
 {
   guint64 page_offset = (guint64)page_index * self->page_size;
 
+  if (self->keyset != NULL)
+    return _gom_keyset_dup_page_query (self->keyset, page_index, self->page_size);
+
   return _gom_query_slice (self->query, page_offset, self->page_size);
 }
 
@@ -213,7 +232,7 @@ static GomRecordListPage *
 gom_record_list_model_lookup_page (GomRecordListModel *self,
                                    guint               page_index)
 {
-  return g_hash_table_lookup (self->pages, GUINT_TO_POINTER (page_index));
+  return _gom_page_cache_lookup (self->pages, page_index);
 }
 
 static void
@@ -293,7 +312,16 @@ gom_record_list_model_clear_snapshot (GomRecordListModel *self)
     }
 
   if (self->pages != NULL)
-    g_hash_table_remove_all (self->pages);
+    _gom_page_cache_remove_all (self->pages);
+
+  if (self->prefetch != NULL)
+    g_array_set_size (self->prefetch, 0);
+
+  _gom_read_ahead_reset (&self->read_ahead);
+  self->n_read_ahead_window = 0;
+
+  if (self->keyset != NULL)
+    _gom_keyset_reset (self->keyset);
 }
 
 static void
@@ -343,6 +371,55 @@ gom_record_list_model_update_page_wrappers (GomRecordListModel *self,
     }
 }
 
+static gboolean
+gom_record_list_model_evict_page_cb (guint    page_index,
+                                     gpointer data,
+                                     gpointer user_data)
+{
+  GomRecordListModel *self = user_data;
+  GomRecordListPage *page = data;
+  guint start;
+  guint end;
+
+  g_assert (GOM_IS_RECORD_LIST_MODEL (self));
+  g_assert (page != NULL);
+
+  if (page->loading)
+    return FALSE;
+
+  start = page_index * self->page_size;
+  end = MIN (start + self->page_size, self->n_items);
+
+  /* A wrapper that is still alive is bound to a row of a view, which must
+   * never go blank. Such pages stay loaded even past the budget.
+   */
+  for (guint position = start; position < end; position++)
+    {
+      g_autoptr(GomRecordListItem) wrapper = gom_record_list_model_lookup_wrapper (self, position);
+
+      if (wrapper != NULL)
+        return FALSE;
+    }
+
+  for (guint position = start; position < end; position++)
+    g_hash_table_remove (self->wrappers, GUINT_TO_POINTER (position));
+
+  return TRUE;
+}
+
+static void
+gom_record_list_model_evict_pages (GomRecordListModel *self)
+{
+  guint n_evicted;
+
+  g_assert (GOM_IS_RECORD_LIST_MODEL (self));
+
+  n_evicted = _gom_page_cache_evict (self->pages, gom_record_list_model_evict_page_cb, self);
+
+  if (n_evicted > 0)
+    GOM_TRACE_MARK ("RecordListModel", "evict", "n_pages=%u", n_evicted);
+}
+
 static void
 gom_record_list_model_page_started (GomRecordListModel *self,
                                     GomRecordListPage  *page)
@@ -449,11 +526,96 @@ fail:
   return dex_future_new_for_error (g_steal_pointer (&error));
 }
 
+static gboolean
+gom_record_list_model_prefetch_cb (gpointer user_data)
+{
+  GomRecordListModel *self = user_data;
+
+  g_assert (GOM_IS_RECORD_LIST_MODEL (self));
+
+  g_clear_pointer (&self->prefetch_source, g_source_unref);
+
+  while (self->prefetch->len > 0 && self->n_loading_pages == 0)
+    {
+      guint page_index = g_array_index (self->prefetch, guint, 0);
+
+      g_array_remove_index (self->prefetch, 0);
+      gom_record_list_model_queue_page (self, page_index, TRUE);
+    }
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Prefetches only start from a low priority idle once no page is loading,
+ * so they never hold the lease a requested page is waiting for.
+ */
+static void
+gom_record_list_model_schedule_prefetch (GomRecordListModel *self)
+{
+  g_assert (GOM_IS_RECORD_LIST_MODEL (self));
+
+  if (self->prefetch_source != NULL ||
+      self->prefetch->len == 0 ||
+      self->n_loading_pages > 0)
+    return;
+
+  self->prefetch_source = g_idle_source_new ();
+  g_source_set_priority (self->prefetch_source, G_PRIORITY_LOW);
+  g_source_set_static_name (self->prefetch_source, "[gom-record-list-prefetch]");
+  g_source_set_callback (self->prefetch_source, gom_record_list_model_prefetch_cb, self, NULL);
+  g_source_attach (self->prefetch_source, g_main_context_get_thread_default ());
+}
+
+static void
+gom_record_list_model_read_ahead (GomRecordListModel *self,
+                                  guint               page_index)
+{
+  guint64 n_pages;
+
+  g_assert (GOM_IS_RECORD_LIST_MODEL (self));
+
+  n_pages = ((guint64)self->n_items + self->page_size - 1) / self->page_size;
+
+  if (!_gom_read_ahead_update (&self->read_ahead,
+                               page_index,
+                               MIN (n_pages, G_MAXUINT),
+                               _gom_page_cache_max_read_ahead (self->pages),
+                               self->read_ahead_window,
+                               &self->n_read_ahead_window))
+    return;
+
+  /* Queued pages that are no longer ahead of the reader are dropped */
+  g_array_set_size (self->prefetch, 0);
+
+  for (guint i = 0; i < self->n_read_ahead_window; i++)
+    {
+      GomRecordListPage *page = _gom_page_cache_peek (self->pages, self->read_ahead_window[i]);
+
+      if (page == NULL || (!page->loaded && !page->loading))
+        g_array_append_val (self->prefetch, self->read_ahead_window[i]);
+    }
+
+  gom_record_list_model_schedule_prefetch (self);
+}
+
+static gboolean
+gom_record_list_model_prefetch_wanted (GomRecordListModel *self,
+                                       GomRecordListPage  *page)
+{
+  return !page->prefetch ||
+         _gom_read_ahead_contains (self->read_ahead_window,
+                                   self->n_read_ahead_window,
+                                   page->index);
+}
+
 static void
 gom_record_list_model_page_task_free (gpointer data)
 {
   GomRecordListPageTask *task = data;
 
+  task->self->n_loading_pages--;
+  gom_record_list_model_schedule_prefetch (task->self);
+
   g_clear_object (&task->self);
   gom_record_list_page_unref (task->page);
   g_free (task);
@@ -480,6 +642,15 @@ gom_record_list_model_page_fiber (gpointer user_data)
   if (generation != self->generation)
     goto complete;
 
+  /* The reader moved elsewhere before this prefetch got to run */
+  if (!gom_record_list_model_prefetch_wanted (self, page))
+    {
+      page->loading = FALSE;
+      if (_gom_page_cache_peek (self->pages, page->index) == page)
+        _gom_page_cache_remove (self->pages, page->index);
+      goto complete;
+    }
+
   query = gom_record_list_model_dup_page_query (self, page->index);
 
   if (self->source == GOM_RECORD_LIST_SOURCE_SESSION)
@@ -506,9 +677,15 @@ gom_record_list_model_page_fiber (gpointer user_data)
   if (generation != self->generation)
     goto complete;
 
+  page->items = G_LIST_MODEL (g_object_ref (results));
+  page->loaded = TRUE;
   page->loading = FALSE;
   gom_record_list_model_update_page_wrappers (self, page, G_LIST_MODEL (results));
-  g_hash_table_remove (self->pages, GUINT_TO_POINTER (page->index));
+
+  if (self->keyset != NULL)
+    _gom_keyset_set_page (self->keyset, page->index, self->page_size, G_LIST_MODEL (results));
+
+  gom_record_list_model_evict_pages (self);
 
 complete:
   return dex_future_new_true ();
@@ -532,14 +709,15 @@ fail:
   if (generation != self->generation)
     return dex_future_new_true ();
 
-  g_hash_table_remove (self->pages, GUINT_TO_POINTER (page->index));
+  _gom_page_cache_remove (self->pages, page->index);
 
   return dex_future_new_for_error (g_steal_pointer (&error));
 }
 
 static void
 gom_record_list_model_queue_page (GomRecordListModel *self,
-                                  guint               page_index)
+                                  guint               page_index,
+                                  gboolean            prefetch)
 {
   GomRecordListPage *page;
   GomRecordListPageTask *task;
@@ -552,19 +730,31 @@ gom_record_list_model_queue_page (GomRecordListModel *self,
   if (!(page = gom_record_list_model_lookup_page (self, page_index)))
     {
       page = gom_record_list_page_new (page_index, self->generation);
-      g_hash_table_insert (self->pages, GUINT_TO_POINTER (page_index), page);
+      _gom_page_cache_insert (self->pages, page_index, page);
+      gom_record_list_model_evict_pages (self);
     }
 
-  if (page->loading)
+  /* A request for a page being prefetched keeps it from being cancelled */
+  if (!prefetch)
+    page->prefetch = FALSE;
+
+  if (page->loading || page->loaded)
     return;
 
   page->loading = TRUE;
-  gom_record_list_model_page_started (self, page);
+  page->prefetch = !!prefetch;
+
+  if (!prefetch)
+    gom_record_list_model_page_started (self, page);
 
   task = g_new0 (GomRecordListPageTask, 1);
   task->self = g_object_ref (self);
   task->page = gom_record_list_page_ref (page);
 
+  self->n_loading_pages++;
+
+  GOM_TRACE_MARK ("RecordListModel", "queue-page", "page=%u prefetch=%d", page_index, !!prefetch);
+
   dex_future_disown (dex_scheduler_spawn (NULL,
                                           0,
                                           gom_record_list_model_page_fiber,
@@ -617,14 +807,12 @@ gom_record_list_model_request_reload (GomRecordListModel *self,
                                   invalidate);
 }
 
-static void
-gom_record_list_model_session_changed_cb (GomRecordListModel *self,
-                                          GomSession         *session)
+static DexFuture *
+gom_record_list_model_scheduled_reload (gpointer instance)
 {
-  g_assert (GOM_IS_RECORD_LIST_MODEL (self));
-  g_assert (GOM_IS_SESSION (session));
+  g_assert (GOM_IS_RECORD_LIST_MODEL (instance));
 
-  dex_future_disown (gom_record_list_model_request_reload (self, TRUE));
+  return gom_record_list_model_request_reload (instance, TRUE);
 }
 
 static GType
@@ -658,9 +846,32 @@ gom_record_list_model_get_item_iface (GListModel *model,
 
   if (!(record = gom_record_list_item_dup_record (wrapper)))
     {
-      _gom_record_list_item_set_loading (wrapper, TRUE);
-      gom_record_list_model_queue_page (self, page_index);
+      GomRecordListPage *page = gom_record_list_model_lookup_page (self, page_index);
+      guint row = position - (page_index * self->page_size);
+
+      if (page != NULL && page->loaded)
+        {
+          if (row < g_list_model_get_n_items (page->items))
+            {
+              record = g_list_model_get_item (page->items, row);
+              _gom_record_list_item_set_record (wrapper, record);
+            }
+
+          _gom_record_list_item_set_loading (wrapper, FALSE);
+        }
+      else
+        {
+          _gom_record_list_item_set_loading (wrapper, TRUE);
+          gom_record_list_model_queue_page (self, page_index, FALSE);
+        }
     }
+  else
+    {
+      /* Keep the page holding this row at the front of the LRU */
+      gom_record_list_model_lookup_page (self, page_index);
+    }
+
+  gom_record_list_model_read_ahead (self, page_index);
 
   return g_steal_pointer (&wrapper);
 }
@@ -678,15 +889,25 @@ gom_record_list_model_finalize (GObject *object)
 {
   GomRecordListModel *self = GOM_RECORD_LIST_MODEL (object);
 
-  if (self->session != NULL && self->session_changed_handler != 0)
-    g_clear_signal_handler (&self->session_changed_handler, self->session);
+  if (self->session != NULL && self->reload_handle != 0 &&
+      _gom_session_get_reload_scheduler (self->session) != NULL)
+    _gom_reload_scheduler_remove (_gom_session_get_reload_scheduler (self->session),
+                                  self->reload_handle);
 
   g_clear_object (&self->session);
   g_clear_object (&self->repository);
   g_clear_object (&self->query);
+  g_clear_pointer (&self->keyset, _gom_keyset_free);
   g_clear_pointer (&self->wrappers, g_hash_table_unref);
-  g_clear_pointer (&self->pages, g_hash_table_unref);
+  g_clear_pointer (&self->pages, _gom_page_cache_free);
   g_clear_pointer (&self->reload_future, dex_unref);
+  g_clear_pointer (&self->prefetch, g_array_unref);
+
+  if (self->prefetch_source != NULL)
+    {
+      g_source_destroy (self->prefetch_source);
+      g_clear_pointer (&self->prefetch_source, g_source_unref);
+    }
 
   G_OBJECT_CLASS (gom_record_list_model_parent_class)->finalize (object);
 }
@@ -717,6 +938,10 @@ gom_record_list_model_get_property (GObject    *object,
       g_value_set_boolean (value, self->loading);
       break;
 
+    case PROP_MAX_PAGES:
+      g_value_set_uint (value, gom_record_list_model_get_max_pages (self));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
     }
@@ -746,6 +971,10 @@ gom_record_list_model_set_property (GObject      *object,
       g_set_object (&self->query, g_value_get_object (value));
       break;
 
+    case PROP_MAX_PAGES:
+      gom_record_list_model_set_max_pages (self, g_value_get_uint (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
     }
@@ -758,13 +987,19 @@ gom_record_list_model_constructed (GObject *object)
 
   G_OBJECT_CLASS (gom_record_list_model_parent_class)->constructed (object);
 
-  if (self->session != NULL)
-    self->session_changed_handler =
-      g_signal_connect_object (self->session,
-                               "changed",
-                               G_CALLBACK (gom_record_list_model_session_changed_cb),
-                               self,
-                               G_CONNECT_SWAPPED);
+  if (self->session != NULL && self->query != NULL &&
+      _gom_session_get_reload_scheduler (self->session) != NULL)
+    {
+      _gom_session_follow_committed_changes (self->session);
+      self->reload_handle =
+        _gom_reload_scheduler_add (_gom_session_get_reload_scheduler (self->session),
+                                   self,
+                                   _gom_reload_scheduler_query_relation (self->query),
+                                   gom_record_list_model_scheduled_reload);
+    }
+
+  if (self->query != NULL)
+    self->keyset = _gom_keyset_new (self->query);
 
   gom_record_list_model_request_reload (self, FALSE);
 }
@@ -799,6 +1034,21 @@ gom_record_list_model_class_init (GomRecordListModelClass *klass)
                           FALSE,
                           (G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GomRecordListModel:max-pages:
+   *
+   * The number of loaded pages kept in memory, or 0 for no limit.
+   *
+   * Pages furthest from the recently requested positions are released
+   * first. Their rows stay in the model and load again on demand. Pages
+   * holding an item that is still referenced, such as one bound to a
+   * row of a view, are kept even when that exceeds the budget.
+   */
+  properties[PROP_MAX_PAGES] =
+    g_param_spec_uint ("max-pages", NULL, NULL,
+                       0, G_MAXUINT, GOM_RECORD_LIST_DEFAULT_MAX_PAGES,
+                       (G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS));
+
   g_object_class_install_properties (object_class, N_PROPS, properties);
 }
 
@@ -809,10 +1059,10 @@ gom_record_list_model_init (GomRecordListModel *self)
                                           g_direct_equal,
                                           NULL,
                                           (GDestroyNotify)gom_record_list_model_weak_ref_free);
-  self->pages = g_hash_table_new_full (g_direct_hash,
-                                       g_direct_equal,
-                                       NULL,
-                                       (GDestroyNotify)gom_record_list_page_unref);
+  self->pages = _gom_page_cache_new ((GDestroyNotify)gom_record_list_page_unref);
+  _gom_page_cache_set_max_pages (self->pages, GOM_RECORD_LIST_DEFAULT_MAX_PAGES);
+  self->prefetch = g_array_new (FALSE, FALSE, sizeof (guint));
+  _gom_read_ahead_reset (&self->read_ahead);
   self->page_size = GOM_RECORD_LIST_DEFAULT_PAGE_SIZE;
 }
 
@@ -982,3 +1232,40 @@ gom_record_list_model_dup_repository (GomRecordListModel *self)
 
   return self->repository ? g_object_ref (self->repository) : NULL;
 }
+
+/**
+ * gom_record_list_model_get_max_pages:
+ * @self: a [class@Gom.RecordListModel]
+ *
+ * Returns: the number of loaded pages kept in memory, or 0 for no limit
+ */
+guint
+gom_record_list_model_get_max_pages (GomRecordListModel *self)
+{
+  g_return_val_if_fail (GOM_IS_RECORD_LIST_MODEL (self), 0);
+
+  return _gom_page_cache_get_max_pages (self->pages);
+}
+
+/**
+ * gom_record_list_model_set_max_pages:
+ * @self: a [class@Gom.RecordListModel]
+ * @max_pages: the number of pages to keep, or 0 for no limit
+ *
+ * Sets how many loaded pages are kept in memory. Pages over the budget
+ * are released right away, unless they hold an item that is still
+ * referenced.
+ */
+void
+gom_record_list_model_set_max_pages (GomRecordListModel *self,
+                                     guint               max_pages)
+{
+  g_return_if_fail (GOM_IS_RECORD_LIST_MODEL (self));
+
+  if (max_pages == _gom_page_cache_get_max_pages (self->pages))
+    return;
+
+  _gom_page_cache_set_max_pages (self->pages, max_pages);
+  gom_record_list_model_evict_pages (self);
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_MAX_PAGES]);
+}
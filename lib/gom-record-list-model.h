@@ -44,5 +44,10 @@ GOM_AVAILABLE_IN_ALL
 GomSession    *gom_record_list_model_dup_session    (GomRecordListModel *self);
 GOM_AVAILABLE_IN_ALL
 GomRepository *gom_record_list_model_dup_repository (GomRecordListModel *self);
+GOM_AVAILABLE_IN_ALL
+guint          gom_record_list_model_get_max_pages  (GomRecordListModel *self);
+GOM_AVAILABLE_IN_ALL
+void           gom_record_list_model_set_max_pages  (GomRecordListModel *self,
+                                                     guint               max_pages);
 
 G_END_DECLS
@@ -21,14 +21,26 @@
 #pragma once
 
 #include "gom-record.h"
-#include "gom-types.h"
+#include "gom-types-private.h"
 
 G_BEGIN_DECLS
 
-GomRecord *_gom_record_new             (GomCursor           *cursor,
-                                        GError             **error);
-GomRecord *_gom_record_new_from_values (const char * const  *column_names,
-                                        const GValue        *values,
-                                        guint                n_columns);
+GomRecordHeader *_gom_record_header_new           (const char * const  *column_names,
+                                                   guint                n_columns);
+GomRecordHeader *_gom_record_header_ref           (GomRecordHeader     *self);
+void             _gom_record_header_unref         (GomRecordHeader     *self);
+guint            _gom_record_header_get_n_columns (GomRecordHeader     *self);
+GomRecordArena  *_gom_record_arena_new            (GomRecordHeader     *header);
+void             _gom_record_arena_free           (GomRecordArena      *self);
+GomRecordHeader *_gom_record_arena_get_header     (GomRecordArena      *self);
+GomRecord       *_gom_record_arena_read           (GomRecordArena      *self,
+                                                   GomCursor           *cursor,
+                                                   GError             **error);
+GomRecord       *_gom_record_new_from_values      (const char * const  *column_names,
+                                                   const GValue        *values,
+                                                   guint                n_columns);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (GomRecordHeader, _gom_record_header_unref)
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (GomRecordArena, _gom_record_arena_free)
 
 G_END_DECLS
@@ -20,22 +20,255 @@
 
 #include "config.h"
 
+#include <string.h>
+
 #include <gio/gio.h>
 
 #include "gom-cursor-private.h"
 #include "gom-record-private.h"
 
+/* Column names are identical for every row of a result set, so they live
+ * in a single immutable allocation shared by all records of that result.
+ */
+struct _GomRecordHeader
+{
+  guint        n_columns;
+  const char **column_names;
+};
+
+/* A chunk is a bump-allocated block of row values. Records point into
+ * the chunk and hold a reference to it; the chunk is released once the
+ * last record carved from it is finalized. Each record unsets its own
+ * values, the chunk only owns the memory.
+ */
+typedef struct _GomRecordChunk
+{
+  GomRecordHeader *header;
+  guint            capacity;
+  guint            n_rows;
+  GValue           values[];
+} GomRecordChunk;
+
+struct _GomRecordArena
+{
+  GomRecordHeader *header;
+  GomRecordChunk  *chunk;
+  guint            rows_per_chunk;
+};
+
+/* Bound the memory a single surviving record can pin through its chunk */
+#define GOM_RECORD_CHUNK_MAX_BYTES (64 * 1024)
+#define GOM_RECORD_CHUNK_MAX_ROWS  256
+
 struct _GomRecord
 {
   GObject parent_instance;
 
-  guint    n_columns;
-  char   **column_names;
-  GValue  *values;
+  guint               n_columns;
+  const char * const *column_names;
+  GValue             *values;
+  GomRecordChunk     *chunk;
 };
 
 G_DEFINE_FINAL_TYPE (GomRecord, gom_record, G_TYPE_OBJECT)
 
+GomRecordHeader *
+_gom_record_header_new (const char * const *column_names,
+                        guint               n_columns)
+{
+  GomRecordHeader *self;
+  gsize strings_len = 0;
+  char *strings;
+
+  g_return_val_if_fail (n_columns == 0 || column_names != NULL, NULL);
+
+  for (guint i = 0; i < n_columns; i++)
+    {
+      if (column_names[i] != NULL)
+        strings_len += strlen (column_names[i]) + 1;
+    }
+
+  self = g_atomic_rc_box_alloc (sizeof *self +
+                                (sizeof (char *) * (n_columns + 1)) +
+                                strings_len);
+  self->n_columns = n_columns;
+  self->column_names = (const char **)(gpointer)(self + 1);
+  strings = (char *)&self->column_names[n_columns + 1];
+
+  for (guint i = 0; i < n_columns; i++)
+    {
+      gsize len;
+
+      if (column_names[i] == NULL)
+        {
+          self->column_names[i] = NULL;
+          continue;
+        }
+
+      len = strlen (column_names[i]) + 1;
+      memcpy (strings, column_names[i], len);
+      self->column_names[i] = strings;
+      strings += len;
+    }
+
+  self->column_names[n_columns] = NULL;
+
+  return self;
+}
+
+GomRecordHeader *
+_gom_record_header_ref (GomRecordHeader *self)
+{
+  return g_atomic_rc_box_acquire (self);
+}
+
+void
+_gom_record_header_unref (GomRecordHeader *self)
+{
+  g_atomic_rc_box_release (self);
+}
+
+guint
+_gom_record_header_get_n_columns (GomRecordHeader *self)
+{
+  g_return_val_if_fail (self != NULL, 0);
+
+  return self->n_columns;
+}
+
+static void
+gom_record_chunk_clear (gpointer data)
+{
+  GomRecordChunk *chunk = data;
+
+  g_clear_pointer (&chunk->header, _gom_record_header_unref);
+}
+
+static GomRecordChunk *
+gom_record_chunk_new (GomRecordHeader *header,
+                      guint            capacity)
+{
+  GomRecordChunk *chunk;
+
+  g_assert (header != NULL);
+  g_assert (capacity > 0);
+
+  /* rc_box memory is zeroed, which is a valid G_VALUE_INIT for each cell */
+  chunk = g_atomic_rc_box_alloc0 (sizeof *chunk +
+                                  (sizeof (GValue) * header->n_columns * capacity));
+  chunk->header = _gom_record_header_ref (header);
+  chunk->capacity = capacity;
+
+  return chunk;
+}
+
+static void
+gom_record_chunk_unref (GomRecordChunk *chunk)
+{
+  g_atomic_rc_box_release_full (chunk, gom_record_chunk_clear);
+}
+
+/* Carves the next row out of @chunk. The returned record owns a reference
+ * to the chunk, and the values are uninitialized until the caller fills
+ * them in.
+ */
+static GomRecord *
+gom_record_chunk_take_row (GomRecordChunk *chunk)
+{
+  GomRecord *self;
+
+  g_assert (chunk != NULL);
+  g_assert (chunk->n_rows < chunk->capacity);
+
+  self = g_object_new (GOM_TYPE_RECORD, NULL);
+  self->n_columns = chunk->header->n_columns;
+  self->column_names = (const char * const *)chunk->header->column_names;
+  self->values = &chunk->values[chunk->n_rows * chunk->header->n_columns];
+  self->chunk = g_atomic_rc_box_acquire (chunk);
+
+  chunk->n_rows++;
+
+  return self;
+}
+
+GomRecordArena *
+_gom_record_arena_new (GomRecordHeader *header)
+{
+  GomRecordArena *self;
+  gsize row_size;
+
+  g_return_val_if_fail (header != NULL, NULL);
+
+  row_size = MAX (1, header->n_columns) * sizeof (GValue);
+
+  self = g_new0 (GomRecordArena, 1);
+  self->header = _gom_record_header_ref (header);
+  self->rows_per_chunk = CLAMP (GOM_RECORD_CHUNK_MAX_BYTES / row_size, 1, GOM_RECORD_CHUNK_MAX_ROWS);
+
+  return self;
+}
+
+void
+_gom_record_arena_free (GomRecordArena *self)
+{
+  if (self == NULL)
+    return;
+
+  g_clear_pointer (&self->chunk, gom_record_chunk_unref);
+  g_clear_pointer (&self->header, _gom_record_header_unref);
+  g_free (self);
+}
+
+GomRecordHeader *
+_gom_record_arena_get_header (GomRecordArena *self)
+{
+  g_return_val_if_fail (self != NULL, NULL);
+
+  return self->header;
+}
+
+/* Snapshots the current row of @cursor into a record allocated from
+ * @self. Values are read straight into the chunk so that the only per-row
+ * allocation is the record instance itself.
+ */
+GomRecord *
+_gom_record_arena_read (GomRecordArena  *self,
+                        GomCursor       *cursor,
+                        GError         **error)
+{
+  g_autoptr(GomRecord) record = NULL;
+  guint n_columns;
+
+  g_return_val_if_fail (self != NULL, NULL);
+  g_return_val_if_fail (GOM_IS_CURSOR (cursor), NULL);
+
+  if (!(n_columns = self->header->n_columns))
+    return g_object_new (GOM_TYPE_RECORD, NULL);
+
+  if (self->chunk == NULL || self->chunk->n_rows == self->chunk->capacity)
+    {
+      g_clear_pointer (&self->chunk, gom_record_chunk_unref);
+      self->chunk = gom_record_chunk_new (self->header, self->rows_per_chunk);
+    }
+
+  record = gom_record_chunk_take_row (self->chunk);
+
+  for (guint i = 0; i < n_columns; i++)
+    {
+      if (!_gom_cursor_get_column_value (cursor, i, &record->values[i]))
+        {
+          g_set_error (error,
+                       G_IO_ERROR,
+                       G_IO_ERROR_FAILED,
+                       "Failed to read cursor column %u",
+                       i);
+          return NULL;
+        }
+    }
+
+  return g_steal_pointer (&record);
+}
+
 static void
 gom_record_finalize (GObject *object)
 {
@@ -47,10 +280,11 @@ gom_record_finalize (GObject *object)
         if (G_IS_VALUE (&self->values[i]))
           g_value_unset (&self->values[i]);
 
-      g_clear_pointer (&self->values, g_free);
+      self->values = NULL;
     }
 
-  g_clear_pointer (&self->column_names, g_strfreev);
+  self->column_names = NULL;
+  g_clear_pointer (&self->chunk, gom_record_chunk_unref);
 
   G_OBJECT_CLASS (gom_record_parent_class)->finalize (object);
 }
@@ -136,73 +370,28 @@ _gom_record_new_from_values (const char * const *column_names,
                              const GValue       *values,
                              guint               n_columns)
 {
+  GomRecordHeader *header;
+  GomRecordChunk *chunk;
   GomRecord *self;
 
   g_return_val_if_fail (n_columns == 0 || column_names != NULL, NULL);
   g_return_val_if_fail (n_columns == 0 || values != NULL, NULL);
 
-  self = g_object_new (GOM_TYPE_RECORD, NULL);
-
   if (n_columns == 0)
-    return self;
+    return g_object_new (GOM_TYPE_RECORD, NULL);
 
-  self->n_columns = n_columns;
-  self->values = g_new0 (GValue, n_columns);
-  self->column_names = g_new0 (char *, n_columns + 1);
+  header = _gom_record_header_new (column_names, n_columns);
+  chunk = gom_record_chunk_new (header, 1);
+  self = gom_record_chunk_take_row (chunk);
 
   for (guint i = 0; i < n_columns; i++)
     {
-      self->column_names[i] = g_strdup (column_names[i]);
       g_value_init (&self->values[i], G_VALUE_TYPE (&values[i]));
       g_value_copy (&values[i], &self->values[i]);
     }
 
-  return self;
-}
-
-GomRecord *
-_gom_record_new (GomCursor  *cursor,
-                 GError    **error)
-{
-  GomRecord *self = NULL;
-  guint n_columns;
-  const char **column_names = NULL;
-  GValue *values = NULL;
-
-  g_return_val_if_fail (GOM_IS_CURSOR (cursor), NULL);
-
-  if (!(n_columns = gom_cursor_get_n_columns (cursor)))
-    return g_object_new (GOM_TYPE_RECORD, NULL);
-
-  column_names = g_new0 (const char *, n_columns);
-  values = g_new0 (GValue, n_columns);
-
-  for (guint i = 0; i < n_columns; i++)
-    {
-      const char *name = gom_cursor_get_column_name (cursor, i);
-
-      column_names[i] = name;
-
-      if (!GOM_CURSOR_GET_CLASS (cursor)->get_column_value (cursor, i, &values[i]))
-        {
-          g_set_error (error,
-                       G_IO_ERROR,
-                       G_IO_ERROR_FAILED,
-                       "Failed to read cursor column %u",
-                       i);
-          goto cleanup;
-        }
-    }
-
-  self = _gom_record_new_from_values (column_names, values, n_columns);
-
-cleanup:
-  for (guint i = 0; i < n_columns; i++)
-    if (G_IS_VALUE (&values[i]))
-      g_value_unset (&values[i]);
-
-  g_free (column_names);
-  g_free (values);
+  gom_record_chunk_unref (chunk);
+  _gom_record_header_unref (header);
 
   return self;
 }
@@ -0,0 +1,42 @@
+/* gom-related-loader-private.h
+ *
+ * Copyright 2026 Christian Hergert <christian@sourceandstack.com>
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of the
+ * License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include <libdex.h>
+
+#include "gom-types-private.h"
+
+G_BEGIN_DECLS
+
+typedef struct _GomRelatedLoader GomRelatedLoader;
+
+GomRelatedLoader *_gom_related_loader_new   (void);
+GomRelatedLoader *_gom_related_loader_ref   (GomRelatedLoader *self);
+void              _gom_related_loader_unref (GomRelatedLoader *self);
+DexFuture        *_gom_related_loader_load  (GomRelatedLoader *self,
+                                             GomRepository    *repository,
+                                             GomSession       *session,
+                                             GomEntity        *owner,
+                                             const char       *relationship_name) G_GNUC_WARN_UNUSED_RESULT;
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (GomRelatedLoader, _gom_related_loader_unref)
+
+G_END_DECLS
@@ -0,0 +1,252 @@
+/* gom-related-loader.c
+ *
+ * Copyright 2026 Christian Hergert <christian@sourceandstack.com>
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of the
+ * License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include "config.h"
+
+#include <gio/gio.h>
+
+#include "gom-entity-private.h"
+#include "gom-related-loader-private.h"
+#include "gom-repository.h"
+#include "gom-session.h"
+
+/* GomRelatedLoader coalesces related-model loads.
+ *
+ * A list showing many rows, each with its own related model, would
+ * otherwise issue one query per row. Requests for the same relationship
+ * of the same owner type are queued instead, and once the scheduler
+ * that queued them gets back to its pending work the whole group is
+ * loaded with one IN query keyed on the owners' fields. Every request
+ * then resolves to its owner's share of the rows, which are not kept
+ * on the owner.
+ */
+
+typedef struct
+{
+  GomEntity  *owner;
+  DexPromise *promise;
+} GomRelatedLoaderRequest;
+
+typedef struct
+{
+  GomRelatedLoader *loader;
+  DexScheduler     *scheduler;
+  GomRepository    *repository;
+  GomSession       *session;
+  GType             owner_type;
+  char             *relationship_name;
+  GPtrArray        *requests;
+} GomRelatedLoaderBatch;
+
+struct _GomRelatedLoader
+{
+  GMutex      mutex;
+  GHashTable *batches;
+};
+
+static void
+gom_related_loader_request_free (gpointer data)
+{
+  GomRelatedLoaderRequest *request = data;
+
+  g_clear_object (&request->owner);
+  dex_clear (&request->promise);
+  g_free (request);
+}
+
+static void
+gom_related_loader_batch_free (gpointer data)
+{
+  GomRelatedLoaderBatch *batch = data;
+
+  g_clear_pointer (&batch->loader, _gom_related_loader_unref);
+  dex_clear (&batch->scheduler);
+  g_clear_object (&batch->repository);
+  g_clear_object (&batch->session);
+  g_clear_pointer (&batch->relationship_name, g_free);
+  g_clear_pointer (&batch->requests, g_ptr_array_unref);
+  g_free (batch);
+}
+
+GomRelatedLoader *
+_gom_related_loader_new (void)
+{
+  GomRelatedLoader *self;
+
+  self = g_atomic_rc_box_new0 (GomRelatedLoader);
+  g_mutex_init (&self->mutex);
+  self->batches = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+  return self;
+}
+
+GomRelatedLoader *
+_gom_related_loader_ref (GomRelatedLoader *self)
+{
+  return g_atomic_rc_box_acquire (self);
+}
+
+static void
+gom_related_loader_finalize (gpointer data)
+{
+  GomRelatedLoader *self = data;
+
+  g_clear_pointer (&self->batches, g_hash_table_unref);
+  g_mutex_clear (&self->mutex);
+}
+
+void
+_gom_related_loader_unref (GomRelatedLoader *self)
+{
+  g_atomic_rc_box_release_full (self, gom_related_loader_finalize);
+}
+
+static DexFuture *
+gom_related_loader_batch_fiber (gpointer user_data)
+{
+  GomRelatedLoaderBatch *batch = user_data;
+  g_autoptr(GListStore) owners = NULL;
+  g_autoptr(GPtrArray) buckets = NULL;
+  g_autoptr(GError) error = NULL;
+  GomEntityRelationshipInfo *relationship;
+
+  g_assert (batch != NULL);
+
+  owners = g_list_store_new (batch->owner_type);
+
+  for (guint i = 0; i < batch->requests->len; i++)
+    {
+      GomRelatedLoaderRequest *request = g_ptr_array_index (batch->requests, i);
+
+      g_list_store_append (owners, request->owner);
+    }
+
+  relationship = _gom_entity_class_get_relationship (g_type_class_get (batch->owner_type),
+                                                     batch->relationship_name,
+                                                     FALSE);
+
+  buckets = _gom_entity_fetch_related (batch->owner_type,
+                                       G_LIST_MODEL (owners),
+                                       batch->relationship_name,
+                                       batch->repository,
+                                       batch->session,
+                                       &error);
+
+  for (guint i = 0; i < batch->requests->len; i++)
+    {
+      GomRelatedLoaderRequest *request = g_ptr_array_index (batch->requests, i);
+      GPtrArray *related;
+      GListStore *items;
+
+      if (buckets == NULL)
+        {
+          dex_promise_reject (request->promise, g_error_copy (error));
+          continue;
+        }
+
+      related = g_ptr_array_index (buckets, i);
+      items = g_list_store_new (relationship->target_type);
+      g_list_store_splice (items, 0, 0, related->pdata, related->len);
+
+      dex_promise_resolve_object (request->promise, items);
+    }
+
+  return dex_future_new_true ();
+}
+
+static void
+gom_related_loader_dispatch (gpointer user_data)
+{
+  GomRelatedLoaderBatch *batch = user_data;
+  GomRelatedLoader *self = batch->loader;
+  g_autofree char *key = NULL;
+
+  key = g_strdup_printf ("%s\n%s", g_type_name (batch->owner_type), batch->relationship_name);
+
+  g_mutex_lock (&self->mutex);
+  g_hash_table_remove (self->batches, key);
+  g_mutex_unlock (&self->mutex);
+
+  dex_future_disown (dex_scheduler_spawn (batch->scheduler,
+                                          0,
+                                          gom_related_loader_batch_fiber,
+                                          batch,
+                                          gom_related_loader_batch_free));
+}
+
+/* Queues a load of @relationship_name for @owner and returns a future
+ * resolving to a #GListModel of the related entities. @owner must be
+ * bound to @session, or to @repository when @session is %NULL.
+ */
+DexFuture *
+_gom_related_loader_load (GomRelatedLoader *self,
+                          GomRepository    *repository,
+                          GomSession       *session,
+                          GomEntity        *owner,
+                          const char       *relationship_name)
+{
+  GomRelatedLoaderRequest *request;
+  GomRelatedLoaderBatch *batch;
+  g_autofree char *key = NULL;
+  DexFuture *future;
+
+  dex_return_error_if_fail (self != NULL);
+  dex_return_error_if_fail (GOM_IS_REPOSITORY (repository));
+  dex_return_error_if_fail (!session || GOM_IS_SESSION (session));
+  dex_return_error_if_fail (GOM_IS_ENTITY (owner));
+  dex_return_error_if_fail (relationship_name != NULL);
+
+  key = g_strdup_printf ("%s\n%s", G_OBJECT_TYPE_NAME (owner), relationship_name);
+
+  request = g_new0 (GomRelatedLoaderRequest, 1);
+  request->owner = g_object_ref (owner);
+  request->promise = dex_promise_new ();
+  future = dex_ref (DEX_FUTURE (request->promise));
+
+  g_mutex_lock (&self->mutex);
+
+  if (!(batch = g_hash_table_lookup (self->batches, key)))
+    {
+      batch = g_new0 (GomRelatedLoaderBatch, 1);
+      batch->loader = _gom_related_loader_ref (self);
+
+      if (!(batch->scheduler = dex_scheduler_ref_thread_default ()))
+        batch->scheduler = dex_ref (dex_scheduler_get_default ());
+
+      batch->repository = g_object_ref (repository);
+      batch->session = session != NULL ? g_object_ref (session) : NULL;
+      batch->owner_type = G_OBJECT_TYPE (owner);
+      batch->relationship_name = g_strdup (relationship_name);
+      batch->requests = g_ptr_array_new_with_free_func (gom_related_loader_request_free);
+      g_hash_table_insert (self->batches, g_steal_pointer (&key), batch);
+
+      /* Work pushed to the scheduler the request came from runs once
+       * it is done with what it is running now, so everything queued
+       * until then lands in the same batch.
+       */
+      dex_scheduler_push (batch->scheduler, gom_related_loader_dispatch, batch);
+    }
+
+  g_ptr_array_add (batch->requests, request);
+
+  g_mutex_unlock (&self->mutex);
+
+  return future;
+}
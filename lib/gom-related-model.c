@@ -20,15 +20,9 @@
 
 #include "config.h"
 
-#include "gom-related-model.h"
-#include "gom-expression.h"
-#include "gom-ordering.h"
+#include "gom-related-model-private.h"
 #include "gom-entity-private.h"
-#include "gom-cursor-private.h"
 #include "gom-meta-private.h"
-#include "gom-query-private.h"
-#include "gom-record.h"
-#include "gom-driver-private.h"
 #include "gom-repository-private.h"
 #include "gom-session-private.h"
 
@@ -171,15 +165,6 @@ gom_related_model_get_item_type_iface (GListModel *model)
   return relationship->target_type;
 }
 
-static inline guint
-gom_related_model_count_strv (const char * const *strv)
-{
-  if (strv == NULL)
-    return 0;
-
-  return g_strv_length ((char **)strv);
-}
-
 static guint
 gom_related_model_get_n_items_iface (GListModel *model)
 {
@@ -256,242 +241,17 @@ gom_related_model_sync_items (GomRelatedModel *self,
                        n_new - prefix - suffix);
 }
 
-static GomExpression *
-gom_related_model_build_field_filter (GomRelatedModel     *self,
-                                      const char          *relationship_name,
-                                      const char * const  *source_fields,
-                                      const char * const  *target_fields,
-                                      GError             **error)
-{
-  g_autoptr(GomExpression) filter = NULL;
-  GomEntityClass *entity_class;
-  GObjectClass *object_class;
-
-  g_assert (GOM_IS_RELATED_MODEL (self));
-  g_assert (source_fields != NULL);
-  g_assert (target_fields != NULL);
-
-  entity_class = GOM_ENTITY_CLASS (G_OBJECT_GET_CLASS (self->owner));
-  object_class = G_OBJECT_GET_CLASS (self->owner);
-
-  if (source_fields == NULL || source_fields[0] == NULL ||
-      target_fields == NULL || target_fields[0] == NULL)
-    {
-      g_set_error (error,
-                   G_IO_ERROR,
-                   G_IO_ERROR_INVALID_ARGUMENT,
-                   "Relationship `%s` does not provide enough field mapping information",
-                   relationship_name);
-      return NULL;
-    }
-
-  for (guint i = 0; source_fields[i] != NULL && target_fields[i] != NULL; i++)
-    {
-      g_auto(GValue) value = G_VALUE_INIT;
-      g_autoptr(GomExpression) predicate = NULL;
-      g_autoptr(GomExpression) left = NULL;
-      g_autoptr(GomExpression) right = NULL;
-
-      if (!gom_entity_get_property_storage_value (self->owner, entity_class, object_class, source_fields[i], &value, error))
-        return NULL;
-
-      left = gom_field_expression_new (target_fields[i]);
-      right = gom_literal_expression_new (&value);
-      predicate = gom_binary_expression_new_equal (g_steal_pointer (&left),
-                                                   g_steal_pointer (&right));
-
-      if (filter == NULL)
-        filter = g_steal_pointer (&predicate);
-      else
-        filter = gom_binary_expression_new_and (g_steal_pointer (&filter),
-                                                g_steal_pointer (&predicate));
-    }
-
-  if (gom_related_model_count_strv (source_fields) != gom_related_model_count_strv (target_fields))
-    {
-      g_set_error (error,
-                   G_IO_ERROR,
-                   G_IO_ERROR_INVALID_ARGUMENT,
-                   "Relationship `%s` field cardinality does not match",
-                   relationship_name);
-      return NULL;
-    }
-
-  return g_steal_pointer (&filter);
-}
-
-static GomExpression *
-gom_related_model_build_relationship_filter (GomRelatedModel            *self,
-                                             GomEntityRelationshipInfo  *relationship,
-                                             GError                    **error)
-{
-  g_assert (relationship != NULL);
-
-  return gom_related_model_build_field_filter (self,
-                                               self->relationship_name,
-                                               gom_entity_class_get_identity_fields (GOM_ENTITY_CLASS (G_OBJECT_GET_CLASS (self->owner))),
-                                               (const char * const *) relationship->remote_fields,
-                                               error);
-}
-
-static GomExpression *
-gom_related_model_build_record_filter (GomRelatedModel            *self,
-                                       GomEntityRelationshipInfo  *relationship,
-                                       GListModel                 *records,
-                                       GError                    **error)
-{
-  g_autoptr(GomExpression) filter = NULL;
-  GomEntityClass *target_class;
-  const char * const *identity_fields;
-  const char * const *remote_fields;
-  guint n_identity_fields;
-  guint n_remote_fields;
-  guint n_records;
-
-  g_assert (GOM_IS_RELATED_MODEL (self));
-  g_assert (relationship != NULL);
-  g_assert (G_IS_LIST_MODEL (records));
-
-  target_class = g_type_class_get (relationship->target_type);
-  remote_fields = (const char * const *)relationship->join_remote_fields;
-
-  identity_fields = gom_entity_class_get_identity_fields (target_class);
-  if (identity_fields == NULL || identity_fields[0] == NULL)
-    {
-      g_set_error (error,
-                   G_IO_ERROR,
-                   G_IO_ERROR_INVALID_ARGUMENT,
-                   "Target entity type `%s` has no identity fields",
-                   g_type_name (relationship->target_type));
-      return NULL;
-    }
-
-  n_identity_fields = gom_related_model_count_strv (identity_fields);
-  n_remote_fields = gom_related_model_count_strv (remote_fields);
-  if (n_identity_fields != n_remote_fields)
-    {
-      g_set_error (error,
-                   G_IO_ERROR,
-                   G_IO_ERROR_INVALID_ARGUMENT,
-                   "Relationship `%s` field cardinality does not match",
-                   relationship->name);
-      return NULL;
-    }
-
-  if (!(n_records = g_list_model_get_n_items (records)))
-    return gom_literal_expression_new_boolean (FALSE);
-
-  for (guint i = 0; i < n_records; i++)
-    {
-      g_autoptr(GomRecord) record = NULL;
-      g_autoptr(GomExpression) record_filter = NULL;
-
-      if (!(record = g_list_model_get_item (records, i)))
-        {
-          g_set_error_literal (error,
-                               G_IO_ERROR,
-                               G_IO_ERROR_FAILED,
-                               "Failed to read join-table record");
-          return NULL;
-        }
-
-      for (guint j = 0; identity_fields[j] != NULL && remote_fields[j] != NULL; j++)
-        {
-          g_auto(GValue) value = G_VALUE_INIT;
-          g_autoptr(GomExpression) left = NULL;
-          g_autoptr(GomExpression) right = NULL;
-          g_autoptr(GomExpression) predicate = NULL;
-
-          if (!gom_record_get_column_by_name (record, remote_fields[j], &value))
-            {
-              g_set_error (error,
-                           G_IO_ERROR,
-                           G_IO_ERROR_INVALID_ARGUMENT,
-                           "Join record is missing field `%s`",
-                           remote_fields[j]);
-              return NULL;
-            }
-
-          left = gom_field_expression_new (identity_fields[j]);
-          right = gom_literal_expression_new (&value);
-          predicate = gom_binary_expression_new_equal (g_steal_pointer (&left),
-                                                       g_steal_pointer (&right));
-
-          if (record_filter == NULL)
-            record_filter = g_steal_pointer (&predicate);
-          else
-            record_filter = gom_binary_expression_new_and (g_steal_pointer (&record_filter),
-                                                           g_steal_pointer (&predicate));
-        }
-
-      if (filter == NULL)
-        filter = g_steal_pointer (&record_filter);
-      else
-        filter = gom_binary_expression_new_or (g_steal_pointer (&filter),
-                                               g_steal_pointer (&record_filter));
-    }
-
-  return g_steal_pointer (&filter);
-}
-
-static DexFuture *
-gom_related_model_query_cursor (GomRelatedModel           *self,
-                                GomEntityRelationshipInfo *relationship,
-                                GomExpression             *filter)
-{
-  g_autoptr(GomQuery) query = NULL;
-  g_autoptr(GomDriver) driver = NULL;
-  g_autoptr(GomSession) session = NULL;
-  g_autoptr(GomRepository) repository = NULL;
-
-  g_assert (GOM_IS_RELATED_MODEL (self));
-  g_assert (relationship != NULL);
-
-  query = _gom_query_new (G_TYPE_INVALID,
-                          relationship->join_relation,
-                          NULL,
-                          filter,
-                          NULL,
-                          NULL,
-                          NULL,
-                          0,
-                          0,
-                          FALSE,
-                          FALSE,
-                          FALSE);
-
-  if ((session = _gom_entity_dup_session (self->owner)))
-    return _gom_session_query (session, query);
-
-  if ((repository = gom_entity_dup_repository (self->owner)))
-    {
-      driver = gom_repository_dup_driver (repository);
-      return _gom_driver_query (driver,
-                                repository,
-                                query,
-                                GOM_CURSOR_FLAGS_NONE);
-    }
-
-  return dex_future_new_reject (G_IO_ERROR,
-                                G_IO_ERROR_INVALID_ARGUMENT,
-                                "Entity is not bound to a repository");
-}
-
 static DexFuture *
 gom_related_model_reload_fiber (gpointer user_data)
 {
   GomRelatedModel *self = user_data;
   g_autoptr(GomSession) session = NULL;
   g_autoptr(GomRepository) repository = NULL;
-  g_autoptr(GomExpression) filter = NULL;
-  g_autoptr(GomExpression) join_filter = NULL;
   g_autoptr(GError) error = NULL;
-  g_autoptr(GObject) cursor = NULL;
   g_autoptr(GObject) results = NULL;
-  g_autoptr(GObject) records = NULL;
+  GomRelatedLoader *loader;
   GomEntityClass *entity_class;
   GomEntityRelationshipInfo *relationship;
-  const char * const *identity_fields;
 
   g_assert (GOM_IS_RELATED_MODEL (self));
   g_assert (GOM_IS_ENTITY (self->owner));
@@ -526,87 +286,32 @@ gom_related_model_reload_fiber (gpointer user_data)
   session = _gom_entity_dup_session (self->owner);
   repository = gom_entity_dup_repository (self->owner);
 
-  if (relationship->storage == GOM_RELATIONSHIP_STORAGE_FK)
+  if (repository == NULL && session != NULL)
+    repository = _gom_session_dup_repository (session);
+
+  if (repository == NULL)
     {
-      if (!(filter = gom_related_model_build_relationship_filter (self, relationship, &error)))
-        goto fail;
-
-      if (session != NULL)
-        results = dex_await_object (gom_session_list_entities (session, relationship->target_type, filter, NULL), &error);
-      else if (repository != NULL)
-        results = dex_await_object (gom_repository_list_entities (repository, relationship->target_type, filter, NULL), &error);
-      else
-        {
-          g_set_error_literal (&error,
-                               G_IO_ERROR,
-                               G_IO_ERROR_INVALID_ARGUMENT,
-                               "Entity is not bound to a repository");
-          goto fail;
-        }
+      g_set_error_literal (&error,
+                           G_IO_ERROR,
+                           G_IO_ERROR_INVALID_ARGUMENT,
+                           "Entity is not bound to a repository");
+      goto fail;
     }
+
+  /* Sibling models reloading in the same main loop iteration share one
+   * query through the loader of the session or repository.
+   */
+  if (session != NULL)
+    loader = _gom_session_get_related_loader (session);
   else
-    {
-      identity_fields = gom_entity_class_get_identity_fields (entity_class);
-
-      if (identity_fields == NULL || identity_fields[0] == NULL)
-        {
-          g_set_error (&error,
-                       G_IO_ERROR,
-                       G_IO_ERROR_INVALID_ARGUMENT,
-                       "Entity type `%s` has no identity fields",
-                       G_OBJECT_TYPE_NAME (self->owner));
-          goto fail;
-        }
-
-      join_filter = gom_related_model_build_field_filter (self,
-                                                          self->relationship_name,
-                                                          identity_fields,
-                                                          (const char * const *) relationship->join_local_fields,
-                                                          &error);
-      if (join_filter == NULL)
-        goto fail;
-
-      if (relationship->join_relation == NULL || relationship->join_relation[0] == '\0')
-        {
-          g_set_error (&error,
-                       G_IO_ERROR,
-                       G_IO_ERROR_INVALID_ARGUMENT,
-                       "Relationship `%s` is missing a join relation",
-                       self->relationship_name);
-          goto fail;
-        }
-
-      if (session == NULL && repository == NULL)
-        {
-          g_set_error_literal (&error,
-                               G_IO_ERROR,
-                               G_IO_ERROR_INVALID_ARGUMENT,
-                               "Entity is not bound to a repository");
-          goto fail;
-        }
-
-      if (!(cursor = dex_await_object (gom_related_model_query_cursor (self, relationship, join_filter), &error)))
-        goto fail;
-
-      if (!(records = dex_await_object (_gom_cursor_exhaust_to_records (GOM_CURSOR (cursor)), &error)))
-        goto fail;
-
-      if (!(filter = gom_related_model_build_record_filter (self, relationship, G_LIST_MODEL (records), &error)))
-        goto fail;
-
-      if (g_list_model_get_n_items (G_LIST_MODEL (records)) == 0)
-        {
-          g_list_store_remove_all (self->items);
-          self->loading = FALSE;
-          g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_LOADING]);
-          return dex_future_new_take_object (g_object_ref (self));
-        }
-
-      if (session != NULL)
-        results = dex_await_object (gom_session_list_entities (session, relationship->target_type, filter, NULL), &error);
-      else
-        results = dex_await_object (gom_repository_list_entities (repository, relationship->target_type, filter, NULL), &error);
-    }
+    loader = _gom_repository_get_related_loader (repository);
+
+  results = dex_await_object (_gom_related_loader_load (loader,
+                                                        repository,
+                                                        session,
+                                                        self->owner,
+                                                        self->relationship_name),
+                              &error);
 
   if (results == NULL)
     goto fail;
@@ -625,6 +330,24 @@ fail:
   return dex_future_new_for_error (g_steal_pointer (&error));
 }
 
+/* Replaces the contents of @self with @items without querying, used when
+ * the relationship was already prefetched alongside the owner.
+ */
+void
+_gom_related_model_set_items (GomRelatedModel *self,
+                              GPtrArray       *items)
+{
+  g_autoptr(GListStore) store = NULL;
+
+  g_return_if_fail (GOM_IS_RELATED_MODEL (self));
+  g_return_if_fail (items != NULL);
+
+  store = g_list_store_new (GOM_TYPE_ENTITY);
+  g_list_store_splice (store, 0, 0, items->pdata, items->len);
+
+  gom_related_model_sync_items (self, G_LIST_MODEL (store));
+}
+
 /**
  * gom_related_model_new:
  * @owner: a [class@Gom.Entity]
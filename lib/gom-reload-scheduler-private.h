@@ -0,0 +1,56 @@
+/* gom-reload-scheduler-private.h
+ *
+ * Copyright 2026 Christian Hergert <christian@sourceandstack.com>
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of the
+ * License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include <libdex.h>
+
+#include "gom-types-private.h"
+
+G_BEGIN_DECLS
+
+#define GOM_RELOAD_SCHEDULER_DELAY_MSEC      16
+#define GOM_RELOAD_SCHEDULER_MAX_CONCURRENT  2
+
+typedef struct _GomReloadScheduler GomReloadScheduler;
+
+/* Starts a reload of @instance and returns a future that completes with
+ * it, or %NULL if there is nothing to wait for.
+ */
+typedef DexFuture *(*GomReloadFunc) (gpointer instance);
+
+GomReloadScheduler *_gom_reload_scheduler_new            (void);
+GomReloadScheduler *_gom_reload_scheduler_ref            (GomReloadScheduler *self);
+void                _gom_reload_scheduler_unref          (GomReloadScheduler *self);
+guint               _gom_reload_scheduler_add            (GomReloadScheduler *self,
+                                                          gpointer            instance,
+                                                          const char         *relation,
+                                                          GomReloadFunc       reload);
+void                _gom_reload_scheduler_remove         (GomReloadScheduler *self,
+                                                          guint               handle);
+void                _gom_reload_scheduler_queue          (GomReloadScheduler *self,
+                                                          const char         *relation);
+const char         *_gom_reload_scheduler_relation       (GType               entity_type,
+                                                          const char         *relation);
+const char         *_gom_reload_scheduler_query_relation (GomQuery           *query);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (GomReloadScheduler, _gom_reload_scheduler_unref)
+
+G_END_DECLS
@@ -0,0 +1,415 @@
+/* gom-reload-scheduler.c
+ *
+ * Copyright 2026 Christian Hergert <christian@sourceandstack.com>
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of the
+ * License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include "config.h"
+
+#include <gio/gio.h>
+
+#include "gom-entity.h"
+#include "gom-query-private.h"
+#include "gom-reload-scheduler-private.h"
+#include "gom-trace-private.h"
+
+/* GomReloadScheduler coordinates the automatic reloads of the list models
+ * bound to a session.
+ *
+ * Every write through the session used to make each of its models start
+ * a reload right away, and they all competed for the same few pooled
+ * connections. Models now register with the scheduler and changes are
+ * queued against the relation they touched. The session queues the
+ * relations its own mutations write, which are not committed yet, and
+ * every relation in the repository's committed change sets, which also
+ * covers triggers, cascades and other sessions. Only models reading that
+ * relation are marked, and nothing starts until GOM_RELOAD_SCHEDULER_DELAY_MSEC
+ * later so a burst of writes costs one reload per model.
+ *
+ * At most GOM_RELOAD_SCHEDULER_MAX_CONCURRENT reloads run at once. Models
+ * with items-changed handlers, which is how a view attaches to them, are
+ * started before models nobody is watching.
+ */
+
+typedef struct
+{
+  GWeakRef       instance;
+  const char    *relation;
+  GomReloadFunc  reload;
+  guint          handle;
+  guint          pending : 1;
+  guint          running : 1;
+} GomReloadClient;
+
+struct _GomReloadScheduler
+{
+  GMutex     mutex;
+  GPtrArray *clients;
+  GSource   *source;
+  guint      last_handle;
+  guint      n_running;
+};
+
+typedef struct
+{
+  GomReloadScheduler *scheduler;
+  guint               handle;
+} GomReloadTask;
+
+static void gom_reload_scheduler_pump (GomReloadScheduler *self);
+
+static void
+gom_reload_client_free (gpointer data)
+{
+  GomReloadClient *client = data;
+
+  g_weak_ref_clear (&client->instance);
+  g_free (client);
+}
+
+static void
+gom_reload_task_free (gpointer data)
+{
+  GomReloadTask *task = data;
+
+  g_clear_pointer (&task->scheduler, _gom_reload_scheduler_unref);
+  g_free (task);
+}
+
+GomReloadScheduler *
+_gom_reload_scheduler_new (void)
+{
+  GomReloadScheduler *self;
+
+  self = g_atomic_rc_box_new0 (GomReloadScheduler);
+  g_mutex_init (&self->mutex);
+  self->clients = g_ptr_array_new_with_free_func (gom_reload_client_free);
+
+  return self;
+}
+
+GomReloadScheduler *
+_gom_reload_scheduler_ref (GomReloadScheduler *self)
+{
+  return g_atomic_rc_box_acquire (self);
+}
+
+static void
+gom_reload_scheduler_finalize (gpointer data)
+{
+  GomReloadScheduler *self = data;
+
+  /* The pending source holds a reference, so there is none left here */
+  g_assert (self->source == NULL);
+
+  g_clear_pointer (&self->clients, g_ptr_array_unref);
+  g_mutex_clear (&self->mutex);
+}
+
+void
+_gom_reload_scheduler_unref (GomReloadScheduler *self)
+{
+  g_atomic_rc_box_release_full (self, gom_reload_scheduler_finalize);
+}
+
+static GomReloadClient *
+gom_reload_scheduler_lookup_locked (GomReloadScheduler *self,
+                                    guint               handle,
+                                    guint              *index)
+{
+  for (guint i = 0; i < self->clients->len; i++)
+    {
+      GomReloadClient *client = g_ptr_array_index (self->clients, i);
+
+      if (client->handle == handle)
+        {
+          if (index != NULL)
+            *index = i;
+          return client;
+        }
+    }
+
+  return NULL;
+}
+
+/* Registers @instance to be reloaded with @reload when @relation changes.
+ * A %NULL @relation reloads on every change. The scheduler does not keep
+ * @instance alive; it must call _gom_reload_scheduler_remove() with the
+ * returned handle when it goes away.
+ */
+guint
+_gom_reload_scheduler_add (GomReloadScheduler *self,
+                           gpointer            instance,
+                           const char         *relation,
+                           GomReloadFunc       reload)
+{
+  GomReloadClient *client;
+  guint handle;
+
+  g_return_val_if_fail (self != NULL, 0);
+  g_return_val_if_fail (G_IS_OBJECT (instance), 0);
+  g_return_val_if_fail (reload != NULL, 0);
+
+  client = g_new0 (GomReloadClient, 1);
+  g_weak_ref_init (&client->instance, instance);
+  client->relation = g_intern_string (relation);
+  client->reload = reload;
+
+  g_mutex_lock (&self->mutex);
+  handle = client->handle = ++self->last_handle;
+  g_ptr_array_add (self->clients, client);
+  g_mutex_unlock (&self->mutex);
+
+  return handle;
+}
+
+void
+_gom_reload_scheduler_remove (GomReloadScheduler *self,
+                              guint               handle)
+{
+  guint index;
+
+  g_return_if_fail (self != NULL);
+
+  if (handle == 0)
+    return;
+
+  g_mutex_lock (&self->mutex);
+  if (gom_reload_scheduler_lookup_locked (self, handle, &index))
+    g_ptr_array_remove_index (self->clients, index);
+  g_mutex_unlock (&self->mutex);
+}
+
+static gboolean
+gom_reload_scheduler_dispatch (gpointer user_data)
+{
+  GomReloadScheduler *self = user_data;
+
+  g_mutex_lock (&self->mutex);
+  g_clear_pointer (&self->source, g_source_unref);
+  g_mutex_unlock (&self->mutex);
+
+  gom_reload_scheduler_pump (self);
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Marks the models reading @relation, or every model when @relation is
+ * %NULL, to be reloaded once the current burst of changes is over.
+ */
+void
+_gom_reload_scheduler_queue (GomReloadScheduler *self,
+                             const char         *relation)
+{
+  gboolean queued = FALSE;
+
+  g_return_if_fail (self != NULL);
+
+  relation = g_intern_string (relation);
+
+  g_mutex_lock (&self->mutex);
+
+  for (guint i = 0; i < self->clients->len; i++)
+    {
+      GomReloadClient *client = g_ptr_array_index (self->clients, i);
+
+      if (relation != NULL && client->relation != NULL && client->relation != relation)
+        continue;
+
+      client->pending = TRUE;
+      queued = TRUE;
+    }
+
+  if (queued && self->source == NULL)
+    {
+      self->source = g_timeout_source_new (GOM_RELOAD_SCHEDULER_DELAY_MSEC);
+      g_source_set_priority (self->source, G_PRIORITY_DEFAULT);
+      g_source_set_static_name (self->source, "[gom-reload-scheduler]");
+      g_source_set_callback (self->source,
+                             gom_reload_scheduler_dispatch,
+                             _gom_reload_scheduler_ref (self),
+                             (GDestroyNotify)_gom_reload_scheduler_unref);
+      g_source_attach (self->source, g_main_context_get_thread_default ());
+    }
+
+  g_mutex_unlock (&self->mutex);
+
+  GOM_TRACE_MARK ("ReloadScheduler",
+                  "queue",
+                  "relation=%s queued=%d",
+                  relation ? relation : "*",
+                  queued);
+}
+
+static DexFuture *
+gom_reload_scheduler_finished_cb (DexFuture *completed,
+                                  gpointer   user_data)
+{
+  GomReloadTask *task = user_data;
+  GomReloadClient *client;
+
+  g_mutex_lock (&task->scheduler->mutex);
+  if ((client = gom_reload_scheduler_lookup_locked (task->scheduler, task->handle, NULL)))
+    client->running = FALSE;
+  task->scheduler->n_running--;
+  g_mutex_unlock (&task->scheduler->mutex);
+
+  gom_reload_scheduler_pump (task->scheduler);
+
+  return NULL;
+}
+
+static guint
+gom_reload_scheduler_items_changed_signal (void)
+{
+  static gsize signal_id;
+
+  if (g_once_init_enter (&signal_id))
+    g_once_init_leave (&signal_id, g_signal_lookup ("items-changed", G_TYPE_LIST_MODEL));
+
+  return signal_id;
+}
+
+/* Picks the next model to reload, preferring those a view is attached to,
+ * then the ones registered first.
+ */
+static GomReloadClient *
+gom_reload_scheduler_next_locked (GomReloadScheduler  *self,
+                                  GObject            **instance)
+{
+  guint items_changed = gom_reload_scheduler_items_changed_signal ();
+  GomReloadClient *fallback = NULL;
+  g_autoptr(GObject) fallback_instance = NULL;
+
+  for (guint i = 0; i < self->clients->len; i++)
+    {
+      GomReloadClient *client = g_ptr_array_index (self->clients, i);
+      g_autoptr(GObject) object = NULL;
+
+      if (!client->pending || client->running)
+        continue;
+
+      if (!(object = g_weak_ref_get (&client->instance)))
+        {
+          client->pending = FALSE;
+          continue;
+        }
+
+      if (G_IS_LIST_MODEL (object) &&
+          g_signal_has_handler_pending (object, items_changed, 0, FALSE))
+        {
+          *instance = g_steal_pointer (&object);
+          return client;
+        }
+
+      if (fallback == NULL)
+        {
+          fallback = client;
+          fallback_instance = g_steal_pointer (&object);
+        }
+    }
+
+  *instance = g_steal_pointer (&fallback_instance);
+
+  return fallback;
+}
+
+static void
+gom_reload_scheduler_pump (GomReloadScheduler *self)
+{
+  g_assert (self != NULL);
+
+  for (;;)
+    {
+      g_autoptr(GObject) instance = NULL;
+      GomReloadClient *client;
+      GomReloadTask *task;
+      GomReloadFunc reload;
+      DexFuture *future;
+      guint handle;
+
+      g_mutex_lock (&self->mutex);
+
+      if (self->n_running >= GOM_RELOAD_SCHEDULER_MAX_CONCURRENT ||
+          !(client = gom_reload_scheduler_next_locked (self, &instance)))
+        {
+          g_mutex_unlock (&self->mutex);
+          break;
+        }
+
+      client->pending = FALSE;
+      client->running = TRUE;
+      self->n_running++;
+      handle = client->handle;
+      reload = client->reload;
+
+      g_mutex_unlock (&self->mutex);
+
+      if (!(future = reload (instance)))
+        {
+          g_mutex_lock (&self->mutex);
+          if ((client = gom_reload_scheduler_lookup_locked (self, handle, NULL)))
+            client->running = FALSE;
+          self->n_running--;
+          g_mutex_unlock (&self->mutex);
+          continue;
+        }
+
+      task = g_new0 (GomReloadTask, 1);
+      task->scheduler = _gom_reload_scheduler_ref (self);
+      task->handle = handle;
+
+      dex_future_disown (dex_future_finally (future,
+                                             gom_reload_scheduler_finished_cb,
+                                             task,
+                                             gom_reload_task_free));
+    }
+}
+
+/* The relation a model or mutation reads or writes, for matching them up
+ * with _gom_reload_scheduler_queue(). Returns %NULL when it is unknown.
+ */
+const char *
+_gom_reload_scheduler_relation (GType       entity_type,
+                                const char *relation)
+{
+  if (relation != NULL)
+    return g_intern_string (relation);
+
+  if (g_type_is_a (entity_type, GOM_TYPE_ENTITY))
+    return g_intern_string (gom_entity_class_get_relation (g_type_class_get (entity_type)));
+
+  return NULL;
+}
+
+/* The relation a model built on @query reads. Queries over a raw relation
+ * may be reading a view, so models using them reload on every change.
+ */
+const char *
+_gom_reload_scheduler_query_relation (GomQuery *query)
+{
+  GType entity_type;
+
+  g_return_val_if_fail (GOM_IS_QUERY (query), NULL);
+
+  entity_type = _gom_query_get_target_entity_type (query);
+
+  if (!g_type_is_a (entity_type, GOM_TYPE_ENTITY))
+    return NULL;
+
+  return _gom_reload_scheduler_relation (entity_type, _gom_query_get_target_relation (query));
+}
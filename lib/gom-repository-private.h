@@ -22,6 +22,7 @@
 
 #include <libdex.h>
 
+#include "gom-related-loader-private.h"
 #include "gom-repository.h"
 #include "gom-types-private.h"
 
@@ -30,8 +31,12 @@ G_BEGIN_DECLS
 DexFuture   *_gom_repository_migrate                    (GomRepository *self) G_GNUC_WARN_UNUSED_RESULT;
 GomRegistry *_gom_repository_get_registry               (GomRepository *self);
 void         _gom_repository_precompute                 (GomRepository *self);
+GomRelatedLoader *_gom_repository_get_related_loader    (GomRepository *self);
 gboolean     _gom_repository_has_sync_history           (GomRepository *self);
 void         _gom_repository_set_sync_history_available (GomRepository *self,
                                                          gboolean       available);
+void         _gom_repository_emit_changes               (GomRepository *self,
+                                                         GomChangeSet  *changes);
+gboolean     _gom_repository_has_changes_handlers       (GomRepository *self);
 
 G_END_DECLS
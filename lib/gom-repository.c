@@ -26,6 +26,7 @@
 #include "gom-migrator.h"
 #include "gom-mutation.h"
 #include "gom-ordering.h"
+#include "gom-change-set-private.h"
 #include "gom-cursor-private.h"
 #include "gom-deletion-private.h"
 #include "gom-driver-private.h"
@@ -53,6 +54,7 @@ struct _GomRepository
   GomRegistry        *registry;
   GomMigrator        *migrator;
   GomSyncCoordinator *coordinator;
+  GomRelatedLoader   *related_loader;
   guint               dirty : 1;
   guint               sync_history_available : 1;
 };
@@ -66,9 +68,16 @@ enum
   N_PROPS
 };
 
+enum
+{
+  SIGNAL_CHANGES_COMMITTED,
+  N_SIGNALS
+};
+
 G_DEFINE_FINAL_TYPE (GomRepository, gom_repository, G_TYPE_OBJECT)
 
 static GParamSpec *properties[N_PROPS];
+static guint signals[N_SIGNALS];
 
 static gboolean
 gom_repository_relations_have_sync_history (char **relations)
@@ -113,6 +122,17 @@ gom_repository_precompute_locked (GomRepository *self)
                       self->entity_types->len);
 }
 
+/* Coalesces related-model loads of entities bound to the repository
+ * without a session.
+ */
+GomRelatedLoader *
+_gom_repository_get_related_loader (GomRepository *self)
+{
+  g_return_val_if_fail (GOM_IS_REPOSITORY (self), NULL);
+
+  return self->related_loader;
+}
+
 void
 _gom_repository_precompute (GomRepository *self)
 {
@@ -288,6 +308,7 @@ gom_repository_finalize (GObject *object)
   g_clear_object (&self->registry);
   g_clear_object (&self->migrator);
   g_clear_object (&self->coordinator);
+  g_clear_pointer (&self->related_loader, _gom_related_loader_unref);
   g_mutex_clear (&self->mutex);
   g_clear_object (&self->driver);
   gom_trace_counter_add (GOM_TRACE_COUNTER_REPOSITORIES, -1);
@@ -374,6 +395,33 @@ gom_repository_class_init (GomRepositoryClass *klass)
                          (G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS));
 
   g_object_class_install_properties (object_class, N_PROPS, properties);
+
+  /**
+   * GomRepository::changes-committed:
+   * @self: a [class@Gom.Repository]
+   * @changes: the [class@Gom.ChangeSet] of the transaction
+   *
+   * Emitted after a transaction that changed rows has been committed,
+   * whether it was a standalone mutation or a [class@Gom.Session].
+   *
+   * SQLite reports every row written on the connection, including those
+   * written by triggers or custom SQL. PostgreSQL reports the rows
+   * returned by mutations issued through Gom, and only records them for
+   * transactions started while a handler is connected.
+   *
+   * The signal is emitted on the scheduler the repository was created on,
+   * shortly after the transaction commits.
+   */
+  signals[SIGNAL_CHANGES_COMMITTED] =
+    g_signal_new ("changes-committed",
+                  G_TYPE_FROM_CLASS (klass),
+                  G_SIGNAL_RUN_LAST,
+                  0,
+                  NULL, NULL,
+                  NULL,
+                  G_TYPE_NONE,
+                  1,
+                  GOM_TYPE_CHANGE_SET);
 }
 
 static void
@@ -384,6 +432,7 @@ gom_repository_init (GomRepository *self)
   self->registry = NULL;
   self->migrator = NULL;
   self->coordinator = NULL;
+  self->related_loader = _gom_related_loader_new ();
   g_mutex_init (&self->mutex);
   self->dirty = FALSE;
   self->sync_history_available = FALSE;
@@ -522,7 +571,7 @@ gom_repository_new_fiber (gpointer user_data)
                       G_OBJECT_TYPE_NAME (state->driver),
                       n_entities);
 
-  _gom_driver_acquire_repository (self->driver);
+  _gom_driver_acquire_repository (self->driver, self);
   return dex_future_new_take_object (g_steal_pointer (&self));
 }
 
@@ -663,6 +712,84 @@ _gom_repository_get_registry (GomRepository *self)
   return self->registry;
 }
 
+/* SQLite can only report the rowid of a changed row. When the relation is
+ * mapped by an entity with a single integer identity, that column is an
+ * alias for the rowid and therefore the identity too.
+ */
+static void
+gom_repository_resolve_rowid_identities (GomRepository *self,
+                                         GomChangeSet  *changes)
+{
+  guint n_changes = gom_change_set_get_n_changes (changes);
+
+  if (self->registry == NULL)
+    return;
+
+  for (guint i = 0; i < n_changes; i++)
+    {
+      g_auto(GValue) identity = G_VALUE_INIT;
+      const GomPropertySpec *property;
+      const GomEntitySpec *entity;
+      const char * const *identity_fields;
+      GType value_type;
+      gint64 rowid;
+
+      if (!gom_change_set_get_rowid (changes, i, &rowid) ||
+          gom_change_set_get_identity (changes, i, &identity))
+        continue;
+
+      if (!(entity = _gom_registry_lookup_entity_by_table (self->registry,
+                                                           gom_change_set_get_relation (changes, i))))
+        continue;
+
+      identity_fields = gom_entity_spec_get_identity_fields ((GomEntitySpec *)entity);
+      if (identity_fields == NULL || identity_fields[0] == NULL || identity_fields[1] != NULL)
+        continue;
+
+      if (!(property = _gom_entity_spec_lookup_property_by_name ((GomEntitySpec *)entity, identity_fields[0])))
+        continue;
+
+      value_type = gom_property_spec_get_value_type ((GomPropertySpec *)property);
+      if (value_type != G_TYPE_INT &&
+          value_type != G_TYPE_UINT &&
+          value_type != G_TYPE_INT64 &&
+          value_type != G_TYPE_UINT64)
+        continue;
+
+      g_value_init (&identity, G_TYPE_INT64);
+      g_value_set_int64 (&identity, rowid);
+      _gom_change_set_set_identity (changes, i, &identity);
+    }
+}
+
+void
+_gom_repository_emit_changes (GomRepository *self,
+                              GomChangeSet  *changes)
+{
+  g_return_if_fail (GOM_IS_REPOSITORY (self));
+  g_return_if_fail (GOM_IS_CHANGE_SET (changes));
+
+  gom_repository_resolve_rowid_identities (self, changes);
+
+  GOM_TRACE_MARK ("Repository",
+                  "changes-committed",
+                  "changes=%u",
+                  gom_change_set_get_n_changes (changes));
+
+  g_signal_emit (self, signals[SIGNAL_CHANGES_COMMITTED], 0, changes);
+}
+
+/* Whether anything is connected to ::changes-committed, so drivers can
+ * skip recording rows nobody will look at.
+ */
+gboolean
+_gom_repository_has_changes_handlers (GomRepository *self)
+{
+  g_return_val_if_fail (GOM_IS_REPOSITORY (self), FALSE);
+
+  return g_signal_has_handler_pending (self, signals[SIGNAL_CHANGES_COMMITTED], 0, FALSE);
+}
+
 typedef struct
 {
   GomRepository *repository;
@@ -879,10 +1006,11 @@ gom_repository_query (GomRepository *self,
   if (_gom_query_get_with_count (query))
     flags |= GOM_CURSOR_FLAGS_COUNT_ROWS;
 
-  return dex_future_then (_gom_driver_query (self->driver, self, query, flags),
-                          gom_repository_bind_cursor_cb,
-                          g_object_ref (self),
-                          g_object_unref);
+  return _gom_cursor_bind_prefetches (dex_future_then (_gom_driver_query (self->driver, self, query, flags),
+                                                      gom_repository_bind_cursor_cb,
+                                                      g_object_ref (self),
+                                                      g_object_unref),
+                                     query);
 }
 
 /**
@@ -22,19 +22,30 @@
 
 #include <libdex.h>
 
+#include "gom-identity-key-private.h"
+#include "gom-related-loader-private.h"
+#include "gom-reload-scheduler-private.h"
 #include "gom-session.h"
 #include "gom-types-private.h"
 
 G_BEGIN_DECLS
 
+/* Upper bound on the entities a backend writes per statement batch when
+ * flushing a session.
+ */
+#define GOM_SESSION_FLUSH_BATCH_SIZE 1000
+
 struct _GomSession
 {
   GObject parent_instance;
 
-  gint64         id;
-  GomRepository *repository;
-  GPtrArray     *sync_changes;
-  guint          closed : 1;
+  gint64              id;
+  GomRepository      *repository;
+  GPtrArray          *sync_changes;
+  GomRelatedLoader   *related_loader;
+  GomReloadScheduler *reload_scheduler;
+  gulong              changes_committed_handler;
+  guint               closed : 1;
 };
 
 struct _GomSessionClass
@@ -59,16 +70,16 @@ struct _GomSessionClass
                                            GomDelta    *delta);
   void       (*mark_entity_dirty)         (GomSession  *self,
                                            GomEntity   *entity);
-  GomEntity *(*lookup_entity)             (GomSession  *self,
-                                           const char  *entity_key);
-  GomEntity *(*register_entity)           (GomSession  *self,
-                                           GomEntity   *entity,
-                                           char        *entity_key);
+  GomEntity *(*lookup_entity)             (GomSession           *self,
+                                           const GomIdentityKey *entity_key);
+  GomEntity *(*register_entity)           (GomSession           *self,
+                                           GomEntity            *entity,
+                                           GomIdentityKey       *entity_key);
   void       (*unregister_pending_entity) (GomSession  *self,
                                            GomEntity   *entity);
-  gboolean   (*rekey_entity_identity)     (GomSession  *self,
-                                           GomEntity   *entity,
-                                           char        *entity_key);
+  gboolean   (*rekey_entity_identity)     (GomSession           *self,
+                                           GomEntity            *entity,
+                                           GomIdentityKey       *entity_key);
   void       (*unregister_entity)         (GomSession  *self,
                                            GomEntity   *entity);
   void       (*clear_entities)            (GomSession  *self);
@@ -80,14 +91,15 @@ GomRepository *_gom_session_dup_repository            (GomSession    *self);
 void           _gom_session_set_closed                (GomSession    *self,
                                                        gboolean       closed);
 gboolean       _gom_session_is_closed                 (GomSession    *self);
-GomEntity     *_gom_session_lookup_entity             (GomSession    *self,
-                                                       const char    *entity_key) G_GNUC_WARN_UNUSED_RESULT;
-GomEntity     *_gom_session_register_entity           (GomSession    *self,
-                                                       GomEntity     *entity,
-                                                       char          *entity_key) G_GNUC_WARN_UNUSED_RESULT;
-gboolean       _gom_session_rekey_entity_identity     (GomSession    *self,
-                                                       GomEntity     *entity,
-                                                       char          *entity_key) G_GNUC_WARN_UNUSED_RESULT;
+GomRelatedLoader *_gom_session_get_related_loader     (GomSession    *self);
+GomEntity     *_gom_session_lookup_entity             (GomSession           *self,
+                                                       const GomIdentityKey *entity_key) G_GNUC_WARN_UNUSED_RESULT;
+GomEntity     *_gom_session_register_entity           (GomSession           *self,
+                                                       GomEntity            *entity,
+                                                       GomIdentityKey       *entity_key) G_GNUC_WARN_UNUSED_RESULT;
+gboolean       _gom_session_rekey_entity_identity     (GomSession           *self,
+                                                       GomEntity            *entity,
+                                                       GomIdentityKey       *entity_key) G_GNUC_WARN_UNUSED_RESULT;
 void           _gom_session_unregister_entity         (GomSession    *self,
                                                        GomEntity     *entity);
 void           _gom_session_clear_entities            (GomSession    *self);
@@ -116,6 +128,10 @@ void           _gom_session_mark_entity_dirty         (GomSession    *self,
                                                        GomEntity     *entity);
 void           _gom_session_emit_changed              (GomSession    *self);
 DexFuture     *_gom_session_track_mutation_result     (GomSession    *self,
+                                                       GomMutation   *mutation,
                                                        DexFuture     *mutation_result) G_GNUC_WARN_UNUSED_RESULT;
+GomReloadScheduler *
+               _gom_session_get_reload_scheduler      (GomSession    *self);
+void           _gom_session_follow_committed_changes  (GomSession    *self);
 
 G_END_DECLS
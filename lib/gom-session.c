@@ -20,10 +20,13 @@
 
 #include "config.h"
 
+#include "gom-change-set.h"
 #include "gom-delta.h"
 #include "gom-cursor-private.h"
+#include "gom-deletion-private.h"
 #include "gom-driver-private.h"
 #include "gom-entity.h"
+#include "gom-insertion-private.h"
 #include "gom-ordering.h"
 #include "gom-mutation.h"
 #include "gom-query-private.h"
@@ -33,6 +36,7 @@
 #include "gom-session-private.h"
 #include "gom-sync-coordinator.h"
 #include "gom-trace-private.h"
+#include "gom-update-private.h"
 
 /**
  * GomSession:
@@ -92,8 +96,13 @@ gom_session_dispose (GObject *object)
 {
   GomSession *self = GOM_SESSION (object);
 
+  if (self->repository != NULL)
+    g_clear_signal_handler (&self->changes_committed_handler, self->repository);
+
   g_clear_object (&self->repository);
   g_clear_pointer (&self->sync_changes, g_ptr_array_unref);
+  g_clear_pointer (&self->related_loader, _gom_related_loader_unref);
+  g_clear_pointer (&self->reload_scheduler, _gom_reload_scheduler_unref);
   gom_trace_counter_add (GOM_TRACE_COUNTER_SESSIONS, -1);
 
   G_OBJECT_CLASS (gom_session_parent_class)->dispose (object);
@@ -128,15 +137,54 @@ gom_session_init (GomSession *self)
 
   self->id = (gintptr)g_atomic_pointer_add (&next_session_id, (gintptr)1) + 1;
   self->sync_changes = g_ptr_array_new_with_free_func (gom_session_sync_change_free);
+  self->related_loader = _gom_related_loader_new ();
+  self->reload_scheduler = _gom_reload_scheduler_new ();
   gom_trace_counter_add (GOM_TRACE_COUNTER_SESSIONS, 1);
   GOM_TRACE_MARK ("Session", "open", "session=%" G_GINT64_FORMAT, self->id);
 }
 
+typedef struct
+{
+  GomSession *session;
+  const char *relation;
+} GomSessionTrackMutationState;
+
+static void
+gom_session_track_mutation_state_free (gpointer data)
+{
+  GomSessionTrackMutationState *state = data;
+
+  g_clear_object (&state->session);
+  g_free (state);
+}
+
+/* The relation written by @mutation, or %NULL if it cannot be known and
+ * every model has to reload.
+ */
+static const char *
+gom_session_get_mutation_relation (GomMutation *mutation)
+{
+  if (GOM_IS_INSERTION (mutation))
+    return _gom_reload_scheduler_relation (_gom_insertion_get_target_entity_type (GOM_INSERTION (mutation)),
+                                           _gom_insertion_get_target_relation (GOM_INSERTION (mutation)));
+
+  if (GOM_IS_UPDATE (mutation))
+    return _gom_reload_scheduler_relation (_gom_update_get_target_entity_type (GOM_UPDATE (mutation)),
+                                           _gom_update_get_target_relation (GOM_UPDATE (mutation)));
+
+  if (GOM_IS_DELETION (mutation))
+    return _gom_reload_scheduler_relation (_gom_deletion_get_target_entity_type (GOM_DELETION (mutation)),
+                                           _gom_deletion_get_target_relation (GOM_DELETION (mutation)));
+
+  return NULL;
+}
+
 static DexFuture *
 gom_session_track_mutation_result_cb (DexFuture *completed,
                                       gpointer   user_data)
 {
-  GomSession *self = user_data;
+  GomSessionTrackMutationState *state = user_data;
+  GomSession *self = state->session;
   const GValue *value;
   g_autoptr(GError) error = NULL;
   GObject *result;
@@ -157,6 +205,9 @@ gom_session_track_mutation_result_cb (DexFuture *completed,
                                   G_IO_ERROR_FAILED,
                                   "Mutation result did not contain an object");
 
+  if (self->reload_scheduler != NULL)
+    _gom_reload_scheduler_queue (self->reload_scheduler, state->relation);
+
   g_signal_emit (self, signals[SIGNAL_CHANGED], 0);
 
   return dex_future_new_take_object (g_object_ref (result));
@@ -256,6 +307,12 @@ _gom_session_set_repository (GomSession    *self,
   g_return_if_fail (GOM_IS_SESSION (self));
   g_return_if_fail (repository == NULL || GOM_IS_REPOSITORY (repository));
 
+  if (self->repository == repository)
+    return;
+
+  if (self->repository != NULL)
+    g_clear_signal_handler (&self->changes_committed_handler, self->repository);
+
   g_set_object (&self->repository, repository);
 }
 
@@ -303,6 +360,15 @@ _gom_session_is_closed (GomSession *self)
   return self->closed != FALSE;
 }
 
+/* Coalesces related-model loads of entities bound to this session. */
+GomRelatedLoader *
+_gom_session_get_related_loader (GomSession *self)
+{
+  g_return_val_if_fail (GOM_IS_SESSION (self), NULL);
+
+  return self->related_loader;
+}
+
 DexFuture *
 _gom_session_query (GomSession *self,
                     GomQuery   *query)
@@ -503,20 +569,96 @@ _gom_session_emit_changed (GomSession *self)
 {
   g_return_if_fail (GOM_IS_SESSION (self));
 
+  if (self->reload_scheduler != NULL)
+    _gom_reload_scheduler_queue (self->reload_scheduler, NULL);
+
   g_signal_emit (self, signals[SIGNAL_CHANGED], 0);
 }
 
 DexFuture *
-_gom_session_track_mutation_result (GomSession *self,
-                                    DexFuture  *mutation_result)
+_gom_session_track_mutation_result (GomSession  *self,
+                                    GomMutation *mutation,
+                                    DexFuture   *mutation_result)
 {
+  GomSessionTrackMutationState *state;
+
   g_return_val_if_fail (GOM_IS_SESSION (self), NULL);
+  g_return_val_if_fail (GOM_IS_MUTATION (mutation), NULL);
   g_return_val_if_fail (DEX_IS_FUTURE (mutation_result), NULL);
 
+  state = g_new0 (GomSessionTrackMutationState, 1);
+  state->session = g_object_ref (self);
+  state->relation = gom_session_get_mutation_relation (mutation);
+
   return dex_future_then (mutation_result,
                           gom_session_track_mutation_result_cb,
-                          g_object_ref (self),
-                          g_object_unref);
+                          state,
+                          gom_session_track_mutation_state_free);
+}
+
+static void
+gom_session_changes_committed_cb (GomSession    *self,
+                                  GomChangeSet  *changes,
+                                  GomRepository *repository)
+{
+  g_autoptr(GHashTable) seen = NULL;
+  guint n_changes;
+
+  g_assert (GOM_IS_SESSION (self));
+  g_assert (GOM_IS_CHANGE_SET (changes));
+  g_assert (GOM_IS_REPOSITORY (repository));
+
+  if (self->reload_scheduler == NULL)
+    return;
+
+  n_changes = gom_change_set_get_n_changes (changes);
+
+  /* Change sets list one entry per row, so skip relations already queued.
+   * Relations are interned strings, which lets them be compared by pointer.
+   */
+  seen = g_hash_table_new (NULL, NULL);
+
+  for (guint i = 0; i < n_changes; i++)
+    {
+      const char *relation = gom_change_set_get_relation (changes, i);
+
+      if (relation != NULL && g_hash_table_add (seen, (gpointer)relation))
+        _gom_reload_scheduler_queue (self->reload_scheduler, relation);
+    }
+}
+
+/* The scheduler that coalesces the automatic reloads of the list models
+ * bound to @self. Returns %NULL once the session has been disposed.
+ */
+GomReloadScheduler *
+_gom_session_get_reload_scheduler (GomSession *self)
+{
+  g_return_val_if_fail (GOM_IS_SESSION (self), NULL);
+
+  return self->reload_scheduler;
+}
+
+/* Makes the session follow the repository's committed changes, so the
+ * models bound to it also reload for rows written by triggers, cascades
+ * and other sessions that no mutation of @self names. Models call this
+ * when they register with the reload scheduler.
+ */
+void
+_gom_session_follow_committed_changes (GomSession *self)
+{
+  g_return_if_fail (GOM_IS_SESSION (self));
+
+  if (self->reload_scheduler == NULL ||
+      self->repository == NULL ||
+      self->changes_committed_handler != 0)
+    return;
+
+  self->changes_committed_handler =
+    g_signal_connect_object (self->repository,
+                             "changes-committed",
+                             G_CALLBACK (gom_session_changes_committed_cb),
+                             self,
+                             G_CONNECT_SWAPPED);
 }
 
 /**
@@ -527,8 +669,8 @@ _gom_session_track_mutation_result (GomSession *self,
  * Returns: (transfer full) (nullable): a tracked entity
  */
 GomEntity *
-_gom_session_lookup_entity (GomSession *self,
-                            const char *entity_key)
+_gom_session_lookup_entity (GomSession           *self,
+                            const GomIdentityKey *entity_key)
 {
   g_return_val_if_fail (GOM_IS_SESSION (self), NULL);
   g_return_val_if_fail (entity_key != NULL, NULL);
@@ -551,9 +693,9 @@ _gom_session_lookup_entity (GomSession *self,
  * Returns: (transfer full): the tracked entity
  */
 GomEntity *
-_gom_session_register_entity (GomSession *self,
-                              GomEntity  *entity,
-                              char       *entity_key)
+_gom_session_register_entity (GomSession     *self,
+                              GomEntity      *entity,
+                              GomIdentityKey *entity_key)
 {
   g_return_val_if_fail (GOM_IS_SESSION (self), NULL);
   g_return_val_if_fail (GOM_IS_ENTITY (entity), NULL);
@@ -561,7 +703,7 @@ _gom_session_register_entity (GomSession *self,
 
   if (_gom_session_is_closed (self))
     {
-      g_free (entity_key);
+      _gom_identity_key_unref (entity_key);
       return entity;
     }
 
@@ -570,7 +712,7 @@ _gom_session_register_entity (GomSession *self,
                                                           g_steal_pointer (&entity),
                                                           g_steal_pointer (&entity_key));
 
-  g_free (entity_key);
+  _gom_identity_key_unref (entity_key);
   return entity;
 }
 
@@ -583,9 +725,9 @@ _gom_session_register_entity (GomSession *self,
  * Returns: `true` if rekeyed
  */
 gboolean
-_gom_session_rekey_entity_identity (GomSession *self,
-                                    GomEntity  *entity,
-                                    char       *entity_key)
+_gom_session_rekey_entity_identity (GomSession     *self,
+                                    GomEntity      *entity,
+                                    GomIdentityKey *entity_key)
 {
   g_return_val_if_fail (GOM_IS_SESSION (self), FALSE);
   g_return_val_if_fail (GOM_IS_ENTITY (entity), FALSE);
@@ -593,7 +735,7 @@ _gom_session_rekey_entity_identity (GomSession *self,
 
   if (_gom_session_is_closed (self))
     {
-      g_free (entity_key);
+      _gom_identity_key_unref (entity_key);
       return FALSE;
     }
 
@@ -602,7 +744,7 @@ _gom_session_rekey_entity_identity (GomSession *self,
                                                                 g_steal_pointer (&entity),
                                                                 g_steal_pointer (&entity_key));
 
-  g_free (entity_key);
+  _gom_identity_key_unref (entity_key);
   return FALSE;
 }
 
@@ -683,7 +825,7 @@ gom_session_query (GomSession *self,
                   "session=%" G_GINT64_FORMAT " target=%s",
                   self->id,
                   g_type_name (_gom_query_get_target_entity_type (query)));
-  return _gom_session_query (self, query);
+  return _gom_cursor_bind_prefetches (_gom_session_query (self, query), query);
 }
 
 /**
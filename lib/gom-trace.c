@@ -69,6 +69,10 @@ static GomTraceCounterState trace_counters[GOM_TRACE_COUNTER_COUNT] = {
   { GOM_TRACE_GROUP, "cursors", "Active cursors", 0 },
   { GOM_TRACE_GROUP, "identity-entries", "Identity-map entries", 0 },
   { GOM_TRACE_GROUP, "pending-entities", "Pending dirty entities", 0 },
+  { GOM_TRACE_GROUP, "statement-cache-hits", "Prepared statement cache hits", 0 },
+  { GOM_TRACE_GROUP, "statement-cache-misses", "Prepared statement cache misses", 0 },
+  { GOM_TRACE_GROUP, "count-cache-hits", "Row count cache hits", 0 },
+  { GOM_TRACE_GROUP, "count-cache-misses", "Row count cache misses", 0 },
 };
 
 static void
@@ -28,8 +28,11 @@ typedef struct _GomEntityClassInfo        GomEntityClassInfo;
 typedef struct _GomEntityPropertyInfo     GomEntityPropertyInfo;
 typedef struct _GomEntityRelationshipInfo GomEntityRelationshipInfo;
 typedef struct _GomEntityDiff             GomEntityDiff;
+typedef struct _GomIdentityKey            GomIdentityKey;
 typedef struct _GomIndexDiff              GomIndexDiff;
 typedef struct _GomPropertyDiff           GomPropertyDiff;
+typedef struct _GomRecordArena            GomRecordArena;
+typedef struct _GomRecordHeader           GomRecordHeader;
 typedef struct _GomRegistryDiff           GomRegistryDiff;
 typedef struct _GomSqliteConnection       GomSqliteConnection;
 typedef struct _GomSqliteLease            GomSqliteLease;
@@ -78,6 +81,10 @@ typedef enum
   GOM_TRACE_COUNTER_CURSORS,
   GOM_TRACE_COUNTER_IDENTITY_ENTRIES,
   GOM_TRACE_COUNTER_PENDING_ENTITIES,
+  GOM_TRACE_COUNTER_STATEMENT_CACHE_HITS,
+  GOM_TRACE_COUNTER_STATEMENT_CACHE_MISSES,
+  GOM_TRACE_COUNTER_COUNT_CACHE_HITS,
+  GOM_TRACE_COUNTER_COUNT_CACHE_MISSES,
   GOM_TRACE_COUNTER_COUNT,
 } GomTraceCounter;
 
@@ -65,6 +65,7 @@ G_BEGIN_DECLS
     return G_TYPE_INSTANCE_GET_CLASS (ptr, module_obj_name##_get_type (), ModuleObjName##Class); }    \
   G_GNUC_END_IGNORE_DEPRECATIONS
 
+typedef struct _GomChangeSet                GomChangeSet;
 typedef struct _GomCursor                   GomCursor;
 typedef struct _GomCustomMigration          GomCustomMigration;
 typedef struct _GomCustomMigrator           GomCustomMigrator;
@@ -263,6 +264,22 @@ typedef enum _GomRepositoryFeature
   GOM_REPOSITORY_FEATURE_VECTOR_SEARCH = 0,
 } GomRepositoryFeature;
 
+/**
+ * GomTempStore:
+ * @GOM_TEMP_STORE_DEFAULT: Use the backend default for temporary storage.
+ * @GOM_TEMP_STORE_FILE: Keep temporary tables and indices in files.
+ * @GOM_TEMP_STORE_MEMORY: Keep temporary tables and indices in memory.
+ *
+ * Where a backend keeps temporary tables and indices, as configured with
+ * [method@Gom.DriverOptions.set_temp_store].
+ */
+typedef enum _GomTempStore
+{
+  GOM_TEMP_STORE_DEFAULT = 0,
+  GOM_TEMP_STORE_FILE    = 1,
+  GOM_TEMP_STORE_MEMORY  = 2,
+} GomTempStore;
+
 /**
  * GomDeltaKind:
  * @GOM_DELTA_KIND_UPDATE: The delta updates an existing record.
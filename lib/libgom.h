@@ -27,6 +27,7 @@
 #include "gom-version-macros.h"
 
 #define GOM_INSIDE
+#include "gom-change-set.h"
 #include "gom-delta.h"
 #include "gom-cursor.h"
 #include "gom-custom-migration.h"
@@ -37,6 +37,11 @@ struct _GomPgsqlCursor
   gboolean     closed;
   guint64      count;
   guint        has_count : 1;
+
+  /* Decoded bytea values handed out by peek_column_bytes(), one
+   * GByteArray per column, reused from row to row.
+   */
+  GPtrArray   *peek_buffers;
 };
 
 struct _GomPgsqlCursorClass
@@ -44,6 +49,8 @@ struct _GomPgsqlCursorClass
   GomCursorClass parent_class;
 };
 
+static gboolean               gom_pgsql_decode_bytea_hex         (const char  *text,
+                                                                  GByteArray  *out_data);
 static gboolean               gom_pgsql_parse_bytea_hex          (const char  *text,
                                                                   GBytes     **out_bytes);
 static void                   gom_pgsql_cursor_finalize          (GObject     *object);
@@ -56,6 +63,8 @@ static gboolean               gom_pgsql_cursor_get_column_value  (GomCursor   *c
 static const char            *gom_pgsql_cursor_get_column_string (GomCursor   *cursor,
                                                                   guint        column);
 static DexFuture             *gom_pgsql_cursor_next              (GomCursor   *cursor);
+static DexFuture             *gom_pgsql_cursor_next_batch        (GomCursor   *cursor,
+                                                                  guint        n_rows);
 static DexFuture             *gom_pgsql_cursor_close             (GomCursor   *cursor);
 static DexFuture             *gom_pgsql_cursor_exhaust           (GomCursor   *cursor);
 static DexFuture             *gom_pgsql_cursor_rewind            (GomCursor   *cursor);
@@ -65,22 +74,25 @@ static DexFuture             *gom_pgsql_cursor_move_relative     (GomCursor   *c
                                                                   gint64       offset);
 static GomCursorCapabilities  gom_pgsql_cursor_get_capabilities  (GomCursor   *cursor);
 static guint64                gom_pgsql_cursor_get_count         (GomCursor   *cursor);
+static gboolean               gom_pgsql_cursor_peek_column_bytes (GomCursor     *cursor,
+                                                                  guint          column,
+                                                                  const guint8 **data,
+                                                                  gsize         *len);
+static gboolean               gom_pgsql_cursor_get_column_int64  (GomCursor   *cursor,
+                                                                  guint        column,
+                                                                  gint64      *value);
+static gboolean               gom_pgsql_cursor_get_column_uint64 (GomCursor   *cursor,
+                                                                  guint        column,
+                                                                  guint64     *value);
 
 G_DEFINE_FINAL_TYPE (GomPgsqlCursor, gom_pgsql_cursor, GOM_TYPE_CURSOR)
 
 static gboolean
-gom_pgsql_parse_bytea_hex (const char  *text,
-                           GBytes     **out_bytes)
+gom_pgsql_decode_bytea_hex (const char *text,
+                            GByteArray *out_data)
 {
   gsize offset = 0;
   gsize len;
-  guint8 *data;
-
-  if (text == NULL)
-    {
-      *out_bytes = NULL;
-      return TRUE;
-    }
 
   if (g_str_has_prefix (text, "\\x"))
     offset = 2;
@@ -89,22 +101,43 @@ gom_pgsql_parse_bytea_hex (const char  *text,
   if (len % 2 != 0)
     return FALSE;
 
-  data = g_new0 (guint8, len / 2);
+  g_byte_array_set_size (out_data, len / 2);
+
   for (gsize i = 0; i < len / 2; i++)
     {
       int hi = g_ascii_xdigit_value (text[offset + i * 2]);
       int lo = g_ascii_xdigit_value (text[offset + i * 2 + 1]);
 
       if (hi < 0 || lo < 0)
-        {
-          g_free (data);
-          return FALSE;
-        }
+        return FALSE;
+
+      out_data->data[i] = (guint8)((hi << 4) | lo);
+    }
+
+  return TRUE;
+}
+
+static gboolean
+gom_pgsql_parse_bytea_hex (const char  *text,
+                           GBytes     **out_bytes)
+{
+  GByteArray *data;
 
-      data[i] = (guint8)((hi << 4) | lo);
+  if (text == NULL)
+    {
+      *out_bytes = NULL;
+      return TRUE;
     }
 
-  *out_bytes = g_bytes_new_take (data, len / 2);
+  data = g_byte_array_new ();
+
+  if (!gom_pgsql_decode_bytea_hex (text, data))
+    {
+      g_byte_array_unref (data);
+      return FALSE;
+    }
+
+  *out_bytes = g_byte_array_free_to_bytes (data);
   return TRUE;
 }
 
@@ -181,6 +214,7 @@ gom_pgsql_cursor_finalize (GObject *object)
   GomPgsqlCursor *self = GOM_PGSQL_CURSOR (object);
 
   g_clear_object (&self->result);
+  g_clear_pointer (&self->peek_buffers, g_ptr_array_unref);
 
   G_OBJECT_CLASS (gom_pgsql_cursor_parent_class)->finalize (object);
 }
@@ -197,6 +231,7 @@ gom_pgsql_cursor_class_init (GomPgsqlCursorClass *klass)
   cursor_class->get_column_value = gom_pgsql_cursor_get_column_value;
   cursor_class->get_column_string = gom_pgsql_cursor_get_column_string;
   cursor_class->next = gom_pgsql_cursor_next;
+  cursor_class->next_batch = gom_pgsql_cursor_next_batch;
   cursor_class->close = gom_pgsql_cursor_close;
   cursor_class->exhaust = gom_pgsql_cursor_exhaust;
   cursor_class->rewind = gom_pgsql_cursor_rewind;
@@ -204,6 +239,9 @@ gom_pgsql_cursor_class_init (GomPgsqlCursorClass *klass)
   cursor_class->move_relative = gom_pgsql_cursor_move_relative;
   cursor_class->get_capabilities = gom_pgsql_cursor_get_capabilities;
   cursor_class->get_count = gom_pgsql_cursor_get_count;
+  cursor_class->peek_column_bytes = gom_pgsql_cursor_peek_column_bytes;
+  cursor_class->get_column_int64 = gom_pgsql_cursor_get_column_int64;
+  cursor_class->get_column_uint64 = gom_pgsql_cursor_get_column_uint64;
 }
 
 static void
@@ -257,6 +295,145 @@ gom_pgsql_cursor_get_column_string (GomCursor *cursor,
            : pgsql_result_get_value (self->result, (guint)self->position, column);
 }
 
+static gboolean
+gom_pgsql_cursor_peek_column_bytes (GomCursor     *cursor,
+                                    guint          column,
+                                    const guint8 **data,
+                                    gsize         *len)
+{
+  GomPgsqlCursor *self = GOM_PGSQL_CURSOR (cursor);
+  GByteArray *buffer;
+  const char *text;
+
+  if (self->closed || self->result == NULL || !self->on_row)
+    return FALSE;
+
+  if (column >= pgsql_result_get_n_fields (self->result))
+    return FALSE;
+
+  if (!(text = pgsql_result_get_value (self->result, (guint)self->position, column)))
+    return FALSE;
+
+  switch (pgsql_result_get_field_type (self->result, column))
+    {
+    case PGSQL_VALUE_TYPE_BOOL:
+    case PGSQL_VALUE_TYPE_INT2:
+    case PGSQL_VALUE_TYPE_INT4:
+    case PGSQL_VALUE_TYPE_INT8:
+    case PGSQL_VALUE_TYPE_FLOAT4:
+    case PGSQL_VALUE_TYPE_FLOAT8:
+      return FALSE;
+
+    case PGSQL_VALUE_TYPE_BYTEA:
+      /* Results arrive in text format, so bytea must be decoded. Reuse a
+       * per-column buffer so that iterating rows does not allocate.
+       */
+      if (self->peek_buffers == NULL)
+        self->peek_buffers = g_ptr_array_new_with_free_func ((GDestroyNotify)g_byte_array_unref);
+
+      while (self->peek_buffers->len <= column)
+        g_ptr_array_add (self->peek_buffers, NULL);
+
+      if (!(buffer = g_ptr_array_index (self->peek_buffers, column)))
+        {
+          buffer = g_byte_array_new ();
+          g_ptr_array_index (self->peek_buffers, column) = buffer;
+        }
+
+      if (!gom_pgsql_decode_bytea_hex (text, buffer))
+        return FALSE;
+
+      *data = buffer->data;
+      *len = buffer->len;
+      return TRUE;
+
+    default:
+      *data = (const guint8 *)text;
+      *len = strlen (text);
+      return TRUE;
+    }
+}
+
+static gboolean
+gom_pgsql_cursor_get_column_int64 (GomCursor *cursor,
+                                   guint      column,
+                                   gint64    *value)
+{
+  GomPgsqlCursor *self = GOM_PGSQL_CURSOR (cursor);
+  const char *text;
+
+  if (self->closed || self->result == NULL || !self->on_row)
+    return FALSE;
+
+  if (column >= pgsql_result_get_n_fields (self->result))
+    return FALSE;
+
+  if (!(text = pgsql_result_get_value (self->result, (guint)self->position, column)))
+    return FALSE;
+
+  switch (pgsql_result_get_field_type (self->result, column))
+    {
+    case PGSQL_VALUE_TYPE_BYTEA:
+      return FALSE;
+
+    case PGSQL_VALUE_TYPE_BOOL:
+      *value = g_strcmp0 (text, "t") == 0 || g_strcmp0 (text, "true") == 0 || g_strcmp0 (text, "1") == 0;
+      return TRUE;
+
+    case PGSQL_VALUE_TYPE_FLOAT4:
+    case PGSQL_VALUE_TYPE_FLOAT8:
+      *value = (gint64)g_ascii_strtod (text, NULL);
+      return TRUE;
+
+    default:
+      *value = g_ascii_strtoll (text, NULL, 10);
+      return TRUE;
+    }
+}
+
+static gboolean
+gom_pgsql_cursor_get_column_uint64 (GomCursor *cursor,
+                                    guint      column,
+                                    guint64   *value)
+{
+  GomPgsqlCursor *self = GOM_PGSQL_CURSOR (cursor);
+  const char *text;
+
+  if (self->closed || self->result == NULL || !self->on_row)
+    return FALSE;
+
+  if (column >= pgsql_result_get_n_fields (self->result))
+    return FALSE;
+
+  if (!(text = pgsql_result_get_value (self->result, (guint)self->position, column)))
+    return FALSE;
+
+  switch (pgsql_result_get_field_type (self->result, column))
+    {
+    case PGSQL_VALUE_TYPE_BYTEA:
+      return FALSE;
+
+    case PGSQL_VALUE_TYPE_BOOL:
+      *value = g_strcmp0 (text, "t") == 0 || g_strcmp0 (text, "true") == 0 || g_strcmp0 (text, "1") == 0;
+      return TRUE;
+
+    case PGSQL_VALUE_TYPE_FLOAT4:
+    case PGSQL_VALUE_TYPE_FLOAT8:
+      *value = (guint64)g_ascii_strtod (text, NULL);
+      return TRUE;
+
+    case PGSQL_VALUE_TYPE_INT2:
+    case PGSQL_VALUE_TYPE_INT4:
+    case PGSQL_VALUE_TYPE_INT8:
+      *value = (guint64)g_ascii_strtoll (text, NULL, 10);
+      return TRUE;
+
+    default:
+      *value = g_ascii_strtoull (text, NULL, 10);
+      return TRUE;
+    }
+}
+
 static DexFuture *
 gom_pgsql_cursor_next (GomCursor *cursor)
 {
@@ -277,6 +454,54 @@ gom_pgsql_cursor_next (GomCursor *cursor)
   return self->on_row ? dex_future_new_true () : dex_future_new_false ();
 }
 
+static DexFuture *
+gom_pgsql_cursor_next_batch (GomCursor *cursor,
+                             guint      n_rows)
+{
+  GomPgsqlCursor *self = GOM_PGSQL_CURSOR (cursor);
+  g_autoptr(GomCursorBatch) batch = NULL;
+  guint n_result_rows;
+  guint n_fetched;
+  gint64 start_time = GOM_TRACE_BEGIN_MARK ();
+
+  if (self->closed || self->result == NULL)
+    {
+      GOM_TRACE_END_MARK (start_time, "Cursor", "next-batch", "pgsql closed");
+      return dex_future_new_for_uint (0);
+    }
+
+  /* The result set is already resident, so this is a copy out of the
+   * PgsqlResult rather than additional round-trips to the server.
+   */
+  n_result_rows = pgsql_result_get_n_rows (self->result);
+
+  while ((batch == NULL || batch->n_rows < n_rows) &&
+         self->position + 1 < (gint64)n_result_rows)
+    {
+      self->position++;
+      self->on_row = TRUE;
+
+      if (batch == NULL)
+        batch = _gom_cursor_batch_new (cursor, n_rows);
+
+      _gom_cursor_batch_append (batch, cursor);
+    }
+
+  if (batch == NULL)
+    {
+      self->position = (gint64)n_result_rows;
+      self->on_row = FALSE;
+    }
+
+  n_fetched = batch != NULL ? batch->n_rows : 0;
+
+  GOM_TRACE_END_MARK (start_time, "Cursor", "next-batch", "pgsql rows=%u", n_fetched);
+
+  _gom_cursor_take_batch (cursor, g_steal_pointer (&batch));
+
+  return dex_future_new_for_uint (n_fetched);
+}
+
 static DexFuture *
 gom_pgsql_cursor_close (GomCursor *cursor)
 {
@@ -47,6 +47,7 @@ DexFuture *gom_pgsql_query_on_executor  (GomRepository        *repository,
                                          GomPgsqlQueryRunner   runner) G_GNUC_WARN_UNUSED_RESULT;
 DexFuture *gom_pgsql_mutate_on_executor (GomRegistry          *registry,
                                          GomMutation          *mutation,
+                                         GomChangeSet         *changes,
                                          gpointer              executor,
                                          GomPgsqlQueryRunner   runner) G_GNUC_WARN_UNUSED_RESULT;
 G_END_DECLS
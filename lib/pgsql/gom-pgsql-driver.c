@@ -20,6 +20,7 @@
 
 #include "config.h"
 
+#include <math.h>
 #include <string.h>
 #include <gmodule.h>
 
@@ -28,6 +29,7 @@
 #include <pgsql-transaction.h>
 
 #include "gom-mutation.h"
+#include "gom-change-set-private.h"
 #include "gom-cursor-private.h"
 #include "gom-driver-private.h"
 #include "gom-entity-private.h"
@@ -514,6 +516,176 @@ gom_pgsql_append_uint64_binding (GPtrArray  *bindings,
   return TRUE;
 }
 
+static const char *
+gom_pgsql_in_element_type (const GValue *value)
+{
+  if (G_VALUE_HOLDS_BOOLEAN (value))
+    return "boolean";
+  if (G_VALUE_HOLDS_INT (value) || G_VALUE_HOLDS_UINT (value) ||
+      G_VALUE_HOLDS_INT64 (value) || G_VALUE_HOLDS_UINT64 (value) ||
+      G_VALUE_HOLDS_ENUM (value) || G_VALUE_HOLDS_FLAGS (value))
+    return "bigint";
+  if (G_VALUE_HOLDS_DOUBLE (value) || G_VALUE_HOLDS_FLOAT (value))
+    return "float8";
+  if (G_VALUE_HOLDS_STRING (value) || G_VALUE_HOLDS (value, G_TYPE_GTYPE))
+    return "text";
+  if (G_VALUE_HOLDS (value, G_TYPE_DATE_TIME))
+    return "timestamptz";
+
+  return NULL;
+}
+
+static void
+gom_pgsql_array_append_quoted (GString    *array,
+                               const char *str)
+{
+  g_string_append_c (array, '"');
+
+  for (const char *iter = str; *iter; iter++)
+    {
+      if (*iter == '"' || *iter == '\\')
+        g_string_append_c (array, '\\');
+      g_string_append_c (array, *iter);
+    }
+
+  g_string_append_c (array, '"');
+}
+
+/* Encodes the values of an IN expression as a PostgreSQL array literal
+ * so the set can be sent as one text parameter and cast to an array of
+ * @out_element_type on the server. pgsql-glib has no array parameters,
+ * but the text form round-trips every scalar type we bind.
+ *
+ * Returns %NULL if the values do not share a single element type, in
+ * which case the caller binds them individually.
+ */
+static char *
+gom_pgsql_encode_in_values (GArray      *values,
+                            const char **out_element_type)
+{
+  g_autoptr(GString) array = g_string_new ("{");
+  const char *element_type = NULL;
+
+  for (guint i = 0; i < values->len; i++)
+    {
+      const GValue *value = &g_array_index (values, GValue, i);
+      const char *value_type;
+
+      if (i > 0)
+        g_string_append_c (array, ',');
+
+      if (G_VALUE_TYPE (value) == G_TYPE_INVALID ||
+          (G_VALUE_HOLDS_STRING (value) && g_value_get_string (value) == NULL) ||
+          (G_VALUE_HOLDS (value, G_TYPE_DATE_TIME) && g_value_get_boxed (value) == NULL))
+        {
+          g_string_append (array, "NULL");
+          continue;
+        }
+
+      if (!(value_type = gom_pgsql_in_element_type (value)))
+        return NULL;
+
+      if (element_type == NULL)
+        element_type = value_type;
+      else if (g_strcmp0 (element_type, value_type) != 0)
+        return NULL;
+
+      if (G_VALUE_HOLDS_BOOLEAN (value))
+        g_string_append_c (array, g_value_get_boolean (value) ? 't' : 'f');
+      else if (G_VALUE_HOLDS_INT (value))
+        g_string_append_printf (array, "%d", g_value_get_int (value));
+      else if (G_VALUE_HOLDS_UINT (value))
+        g_string_append_printf (array, "%u", g_value_get_uint (value));
+      else if (G_VALUE_HOLDS_INT64 (value))
+        g_string_append_printf (array, "%" G_GINT64_FORMAT, g_value_get_int64 (value));
+      else if (G_VALUE_HOLDS_UINT64 (value))
+        {
+          if (g_value_get_uint64 (value) > G_MAXINT64)
+            return NULL;
+
+          g_string_append_printf (array, "%" G_GUINT64_FORMAT, g_value_get_uint64 (value));
+        }
+      else if (G_VALUE_HOLDS_ENUM (value))
+        g_string_append_printf (array, "%d", g_value_get_enum (value));
+      else if (G_VALUE_HOLDS_FLAGS (value))
+        g_string_append_printf (array, "%u", g_value_get_flags (value));
+      else if (G_VALUE_HOLDS_DOUBLE (value) || G_VALUE_HOLDS_FLOAT (value))
+        {
+          char buf[G_ASCII_DTOSTR_BUF_SIZE];
+          double v;
+
+          if (G_VALUE_HOLDS_DOUBLE (value))
+            v = g_value_get_double (value);
+          else
+            v = g_value_get_float (value);
+
+          if (isnan (v))
+            g_string_append (array, "NaN");
+          else if (isinf (v))
+            g_string_append (array, v > 0 ? "Infinity" : "-Infinity");
+          else
+            g_string_append (array, g_ascii_dtostr (buf, sizeof buf, v));
+        }
+      else if (G_VALUE_HOLDS_STRING (value))
+        gom_pgsql_array_append_quoted (array, g_value_get_string (value));
+      else if (G_VALUE_HOLDS (value, G_TYPE_GTYPE))
+        gom_pgsql_array_append_quoted (array, g_type_name (g_value_get_gtype (value)));
+      else if (G_VALUE_HOLDS (value, G_TYPE_DATE_TIME))
+        {
+          g_autofree char *iso8601 = g_date_time_format_iso8601 (g_value_get_boxed (value));
+
+          if (iso8601 == NULL)
+            return NULL;
+
+          gom_pgsql_array_append_quoted (array, iso8601);
+        }
+    }
+
+  if (element_type == NULL)
+    return NULL;
+
+  g_string_append_c (array, '}');
+
+  *out_element_type = element_type;
+
+  return g_string_free (g_steal_pointer (&array), FALSE);
+}
+
+static const char *gom_pgsql_sql_type_for_gtype (GType type);
+
+/* Returns the type the target column of an IN expression is declared
+ * with when the entity mapping tells us, so the array can be cast to it.
+ * Text properties are left out since the table may declare them as uuid,
+ * citext, an enum or any other type with a text representation.
+ */
+static const char *
+gom_pgsql_in_target_type (GomExpression                   *target,
+                          const GomPgsqlExpressionContext *context)
+{
+  const GomPropertySpec *property;
+  const char *field;
+  const char *sql_type;
+
+  if (context == NULL || context->entity == NULL || !GOM_IS_FIELD_EXPRESSION (target))
+    return NULL;
+
+  if (!(field = _gom_field_expression_get_field (GOM_FIELD_EXPRESSION (target))))
+    return NULL;
+
+  if (!(property = _gom_entity_spec_lookup_property_by_name (context->entity, field)) &&
+      !(property = _gom_entity_spec_lookup_property_by_field (context->entity, field)))
+    return NULL;
+
+  sql_type = gom_pgsql_sql_type_for_gtype (gom_property_spec_get_value_type ((GomPropertySpec *)property));
+
+  if (g_str_equal (sql_type, "text") ||
+      g_str_equal (sql_type, "text[]") ||
+      g_str_equal (sql_type, "bytea"))
+    return NULL;
+
+  return sql_type;
+}
+
 static gboolean
 gom_pgsql_append_expression_with_context (GomExpression                    *expression,
                                           GString                          *sql,
@@ -612,6 +784,77 @@ gom_pgsql_append_expression_with_context (GomExpression                    *expr
       return FALSE;
     }
 
+  if (GOM_IS_IN_EXPRESSION (expression))
+    {
+      GomExpression *target = _gom_in_expression_get_target (GOM_IN_EXPRESSION (expression));
+      GArray *values = _gom_in_expression_get_values (GOM_IN_EXPRESSION (expression));
+      const char *element_type = NULL;
+      const char *column_type;
+      g_autofree char *array = NULL;
+
+      if (target == NULL)
+        {
+          g_set_error_literal (error,
+                               G_IO_ERROR,
+                               G_IO_ERROR_INVALID_ARGUMENT,
+                               "IN expression requires a target");
+          return FALSE;
+        }
+
+      /* PostgreSQL rejects an empty IN list and an empty array has no
+       * element type to compare against, so short-circuit instead.
+       */
+      if (values->len == 0)
+        {
+          g_string_append (sql, "FALSE");
+          return TRUE;
+        }
+
+      g_string_append_c (sql, '(');
+
+      if (!gom_pgsql_append_expression_with_context (target, sql, bindings, error, context))
+        return FALSE;
+
+      column_type = gom_pgsql_in_target_type (target, context);
+
+      /* Without a declared column type, strings are bound one by one so
+       * the server infers each parameter's type from the column instead
+       * of comparing it against text.
+       */
+      if ((array = gom_pgsql_encode_in_values (values, &element_type)) &&
+          column_type == NULL &&
+          g_str_equal (element_type, "text"))
+        g_clear_pointer (&array, g_free);
+
+      if (array != NULL)
+        {
+          g_auto(GValue) binding_value = G_VALUE_INIT;
+
+          g_string_append_printf (sql, " = ANY(?::%s[])", column_type ? column_type : element_type);
+          g_value_init (&binding_value, G_TYPE_STRING);
+          g_value_take_string (&binding_value, g_steal_pointer (&array));
+          g_ptr_array_add (bindings, gom_pgsql_binding_new (&binding_value));
+        }
+      else
+        {
+          g_string_append (sql, " IN (");
+
+          for (guint i = 0; i < values->len; i++)
+            {
+              if (i > 0)
+                g_string_append (sql, ", ");
+
+              g_string_append_c (sql, '?');
+              g_ptr_array_add (bindings, gom_pgsql_binding_new (&g_array_index (values, GValue, i)));
+            }
+
+          g_string_append_c (sql, ')');
+        }
+
+      g_string_append_c (sql, ')');
+      return TRUE;
+    }
+
   if (GOM_IS_SEARCH_EXPRESSION (expression))
     {
       GomExpression *target = _gom_search_expression_get_target (GOM_SEARCH_EXPRESSION (expression));
@@ -907,6 +1150,64 @@ gom_pgsql_result_to_mutation_result (PgsqlResult *result)
   return dex_future_new_take_object (g_steal_pointer (&mutation_result));
 }
 
+/* Records the rows returned by a mutation in @changes. The identity is
+ * only known when @entity has a single identity property whose column
+ * is part of the returned row.
+ */
+static void
+gom_pgsql_record_changes (GomChangeSet        *changes,
+                          const GomEntitySpec *entity,
+                          const char          *base_relation,
+                          GomDeltaKind         kind,
+                          PgsqlResult         *result)
+{
+  const char *identity_column = NULL;
+  guint n_fields;
+  int column = -1;
+
+  if (changes == NULL)
+    return;
+
+  if (entity != NULL)
+    {
+      const char * const *identity_fields = gom_entity_spec_get_identity_fields ((GomEntitySpec *)entity);
+
+      if (identity_fields != NULL && identity_fields[0] != NULL && identity_fields[1] == NULL)
+        {
+          const GomPropertySpec *property;
+
+          if ((property = _gom_entity_spec_lookup_property_by_name ((GomEntitySpec *)entity, identity_fields[0])))
+            identity_column = gom_property_spec_get_field ((GomPropertySpec *)property);
+        }
+    }
+
+  n_fields = pgsql_result_get_n_fields (result);
+
+  for (guint i = 0; identity_column != NULL && i < n_fields; i++)
+    {
+      if (g_strcmp0 (pgsql_result_get_field_name (result, i), identity_column) == 0)
+        {
+          column = (int)i;
+          break;
+        }
+    }
+
+  for (guint i = 0; i < pgsql_result_get_n_rows (result); i++)
+    {
+      g_auto(GValue) identity = G_VALUE_INIT;
+
+      if (column >= 0 &&
+          !gom_pgsql_cursor_set_value (result, i, column, &identity) &&
+          G_IS_VALUE (&identity))
+        g_value_unset (&identity);
+
+      _gom_change_set_add (changes,
+                           base_relation,
+                           kind,
+                           G_IS_VALUE (&identity) ? &identity : NULL);
+    }
+}
+
 static const char *
 gom_pgsql_resolve_relation_name (GomRegistry          *registry,
                                  GType                 entity_type,
@@ -2521,6 +2822,7 @@ gom_pgsql_describe_relation (GomDriver   *driver,
 DexFuture *
 gom_pgsql_mutate_on_executor (GomRegistry         *registry,
                               GomMutation         *mutation,
+                              GomChangeSet        *changes,
                               gpointer             executor,
                               GomPgsqlQueryRunner  runner)
 {
@@ -2601,6 +2903,8 @@ gom_pgsql_mutate_on_executor (GomRegistry         *registry,
           if (!(pgresult = dex_await_object (runner (executor, sql_to_run, params), &error)))
             return dex_future_new_for_error (g_steal_pointer (&error));
 
+          gom_pgsql_record_changes (changes, entity, base_relation, GOM_DELTA_KIND_INSERT, pgresult);
+
           {
             g_autoptr(GomMutationResult) one_result = NULL;
             g_autoptr(GomRecord) appended_record = NULL;
@@ -2747,6 +3051,8 @@ gom_pgsql_mutate_on_executor (GomRegistry         *registry,
       if (!(pgresult = dex_await_object (runner (executor, sql_to_run, params), &error)))
         return dex_future_new_for_error (g_steal_pointer (&error));
 
+      gom_pgsql_record_changes (changes, entity, base_relation, GOM_DELTA_KIND_UPDATE, pgresult);
+
       return gom_pgsql_result_to_mutation_result (pgresult);
     }
 
@@ -2830,6 +3136,8 @@ gom_pgsql_mutate_on_executor (GomRegistry         *registry,
       if (!(pgresult = dex_await_object (runner (executor, sql_to_run, params), &error)))
         return dex_future_new_for_error (g_steal_pointer (&error));
 
+      gom_pgsql_record_changes (changes, entity, base_relation, GOM_DELTA_KIND_DELETE, pgresult);
+
       return gom_pgsql_result_to_mutation_result (pgresult);
     }
 
@@ -2866,12 +3174,18 @@ gom_pgsql_mutate_fiber (gpointer user_data)
   g_autoptr(GError) error = NULL;
   g_autoptr(PgsqlTransaction) transaction = NULL;
   g_autoptr(GomMutationResult) result = NULL;
+  g_autoptr(GomChangeSet) changes = NULL;
 
   if (!(transaction = dex_await_object (pgsql_transaction_new (request->connection), &error)))
     return dex_future_new_for_error (g_steal_pointer (&error));
 
+  /* RETURNING rows are only kept when a repository will receive them */
+  if (_gom_driver_wants_changes (GOM_DRIVER (request->self)))
+    changes = _gom_change_set_new ();
+
   result = dex_await_object (gom_pgsql_mutate_on_executor (request->registry,
                                                            request->mutation,
+                                                           changes,
                                                            transaction,
                                                            (GomPgsqlQueryRunner)pgsql_transaction_query),
                              &error);
@@ -2884,6 +3198,9 @@ gom_pgsql_mutate_fiber (gpointer user_data)
   if (!dex_await (pgsql_transaction_commit (transaction), &error))
     return dex_future_new_for_error (g_steal_pointer (&error));
 
+  if (changes != NULL)
+    _gom_driver_post_changes (GOM_DRIVER (request->self), changes);
+
   return dex_future_new_take_object (g_steal_pointer (&result));
 }
 
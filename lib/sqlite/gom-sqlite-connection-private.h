@@ -29,12 +29,65 @@ G_BEGIN_DECLS
 
 #define GOM_TYPE_SQLITE_CONNECTION (gom_sqlite_connection_get_type())
 
+#define GOM_SQLITE_CONNECTION_STATEMENT_CACHE_SIZE 64
+#define GOM_SQLITE_CONNECTION_COUNT_CACHE_SIZE 64
+#define GOM_SQLITE_CONNECTION_WAL_AUTOCHECKPOINT 1
+
+/* Per-connection tuning applied right after open. Negative sizes and a
+ * zero cache_size/temp_store leave the SQLite default in place.
+ */
+typedef struct _GomSqliteConnectionConfig
+{
+  gint64 mmap_size;
+  guint  busy_timeout_msec;
+  int    cache_size;
+  int    temp_store;
+  int    wal_autocheckpoint;
+  guint  cursor_spool_rows;
+} GomSqliteConnectionConfig;
+
+#define GOM_SQLITE_CONNECTION_CONFIG_INIT \
+  { -1, 0, 0, 0, GOM_SQLITE_CONNECTION_WAL_AUTOCHECKPOINT, 0 }
+
 G_DECLARE_FINAL_TYPE (GomSqliteConnection, gom_sqlite_connection, GOM, SQLITE_CONNECTION, GObject)
 
-DexFuture *gom_sqlite_connection_new        (const char          *uri,
-                                             GBytes              *encryption_key,
-                                             DexThreadPool       *thread_pool,
-                                             DexLimiter          *open_limiter);
-sqlite3   *gom_sqlite_connection_get_native (GomSqliteConnection *self);
+typedef void (*GomSqliteConnectionFunc) (gpointer user_data);
+
+DexFuture    *gom_sqlite_connection_new                   (const char                      *uri,
+                                                           GBytes                          *encryption_key,
+                                                           const GomSqliteConnectionConfig *config,
+                                                           gboolean                         read_only,
+                                                           DexThreadPool                   *thread_pool,
+                                                           DexLimiter                      *open_limiter);
+sqlite3      *gom_sqlite_connection_get_native            (GomSqliteConnection             *self);
+gboolean      gom_sqlite_connection_is_read_only          (GomSqliteConnection             *self);
+gboolean      gom_sqlite_connection_is_shared             (GomSqliteConnection             *self);
+guint         gom_sqlite_connection_get_cursor_spool_rows (GomSqliteConnection             *self);
+sqlite3_stmt *gom_sqlite_connection_steal_statement       (GomSqliteConnection             *self,
+                                                           const char                      *sql);
+void          gom_sqlite_connection_cache_statement       (GomSqliteConnection             *self,
+                                                           const char                      *sql,
+                                                           sqlite3_stmt                    *stmt);
+void          gom_sqlite_connection_clear_statements      (GomSqliteConnection             *self);
+void          gom_sqlite_connection_set_schema_generation (GomSqliteConnection             *self,
+                                                           guint                            schema_generation);
+gboolean      gom_sqlite_connection_lookup_count          (GomSqliteConnection             *self,
+                                                           const char                      *key,
+                                                           gint64                           data_version,
+                                                           guint64                         *count);
+void          gom_sqlite_connection_cache_count           (GomSqliteConnection             *self,
+                                                           const char                      *key,
+                                                           gint64                           data_version,
+                                                           guint64                          count);
+gboolean      gom_sqlite_connection_run                   (GomSqliteConnection             *self,
+                                                           GomSqliteConnectionFunc          func,
+                                                           gpointer                         user_data,
+                                                           GError                         **error);
+void          gom_sqlite_connection_set_capture_changes   (GomSqliteConnection             *self,
+                                                           gboolean                         capture_changes);
+guint         gom_sqlite_connection_get_change_mark       (GomSqliteConnection             *self);
+void          gom_sqlite_connection_discard_changes       (GomSqliteConnection             *self,
+                                                           guint                            mark);
+GomChangeSet *gom_sqlite_connection_steal_changes         (GomSqliteConnection             *self);
 
 G_END_DECLS
@@ -26,30 +26,85 @@
 
 #include <gio/gio.h>
 
+#include "gom-change-set-private.h"
 #include "gom-sqlite-connection-private.h"
 #include "gom-sqlite-driver-private.h"
 #include "gom-trace-private.h"
 
-#define GOM_SQLITE_BUSY_TIMEOUT_MS 0
-
 #if HAVE_SQLITE_VEC1
 extern int sqlite3_extension_init (sqlite3                     *db,
                                    char                       **pzErrMsg,
                                    const sqlite3_api_routines  *pApi);
 #endif
 
+typedef struct
+{
+  GList         link;
+  char         *sql;
+  sqlite3_stmt *stmt;
+} GomSqliteCachedStatement;
+
+typedef struct
+{
+  GomSqliteConnectionFunc func;
+  gpointer                user_data;
+} GomSqliteConnectionWork;
+
+#define GOM_SQLITE_CONNECTION_STOP_WORK ((gpointer) GINT_TO_POINTER (1))
+
+typedef struct
+{
+  gint64  data_version;
+  gint64  total_changes;
+  guint64 count;
+} GomSqliteCachedCount;
+
 struct _GomSqliteConnection
 {
-  GObject  parent_instance;
-  sqlite3 *native;
-  char    *uri;
-  GBytes  *encryption_key;
+  GObject     parent_instance;
+  sqlite3    *native;
+  char       *uri;
+  GBytes     *encryption_key;
+  guint       cursor_spool_rows;
+  guint       read_only : 1;
+
+  /* Work for the connection runs on a thread that lives as long as the
+   * connection, so leasing it from the pool does not spawn a thread.
+   */
+  GMutex       worker_mutex;
+  GAsyncQueue *worker_queue;
+
+  /* Prepared statements keyed by SQL text. Statements are removed while
+   * checked out so a single sqlite3_stmt is never shared between users.
+   * The head of @statements_lru is the most recently returned statement.
+   */
+  GMutex      statements_mutex;
+  GHashTable *statements;
+  GQueue      statements_lru;
+  guint       schema_generation;
+
+  /* Row counts keyed by count SQL and bindings. Each entry remembers the
+   * data_version and total change count it was computed at, so commits
+   * from other connections or writes on this one invalidate it.
+   */
+  GHashTable *counts;
+
+  /* Rows written by the open transaction are collected in
+   * @pending_changes by the update hook and moved to @committed_changes
+   * by the commit hook, but only while @capture_changes is set. All of
+   * them are only touched from the thread running work for the connection.
+   */
+  GomChangeSet *pending_changes;
+  GomChangeSet *committed_changes;
+  gboolean      capture_changes;
 };
 
 typedef struct
 {
-  char   *uri;
-  GBytes *encryption_key;
+  char                      *uri;
+  GBytes                    *encryption_key;
+  GomSqliteConnectionConfig  config;
+  guint                      read_only : 1;
 } GomSqliteConnectionNewState;
 
 struct _GomSqliteConnectionClass
@@ -59,11 +114,62 @@ struct _GomSqliteConnectionClass
 
 G_DEFINE_FINAL_TYPE (GomSqliteConnection, gom_sqlite_connection, G_TYPE_OBJECT)
 
+static void
+gom_sqlite_cached_statement_free (GomSqliteCachedStatement *cached)
+{
+  g_assert (cached != NULL);
+  g_assert (cached->link.prev == NULL);
+  g_assert (cached->link.next == NULL);
+
+  g_clear_pointer (&cached->stmt, sqlite3_finalize);
+  g_clear_pointer (&cached->sql, g_free);
+  g_free (cached);
+}
+
+static void
+gom_sqlite_connection_clear_statements_locked (GomSqliteConnection *self)
+{
+  GomSqliteCachedStatement *cached;
+
+  g_assert (GOM_IS_SQLITE_CONNECTION (self));
+
+  while ((cached = g_queue_peek_head (&self->statements_lru)))
+    {
+      g_queue_unlink (&self->statements_lru, &cached->link);
+      g_hash_table_remove (self->statements, cached->sql);
+      gom_sqlite_cached_statement_free (cached);
+    }
+
+  g_hash_table_remove_all (self->counts);
+}
+
 static void
 gom_sqlite_connection_finalize (GObject *object)
 {
   GomSqliteConnection *self = (GomSqliteConnection *)object;
 
+  /* Cached statements must be finalized before the handle is closed or
+   * sqlite3_close_v2() will leave the connection as a zombie.
+   */
+  gom_sqlite_connection_clear_statements_locked (self);
+  g_clear_pointer (&self->statements, g_hash_table_unref);
+  g_clear_pointer (&self->counts, g_hash_table_unref);
+  g_mutex_clear (&self->statements_mutex);
+
+  g_clear_object (&self->pending_changes);
+  g_clear_object (&self->committed_changes);
+
+  /* Work holds a reference to the connection so the queue is drained by
+   * now. The worker may be the thread finalizing us, so it is never
+   * joined and exits once it sees the stop marker.
+   */
+  if (self->worker_queue != NULL)
+    {
+      g_async_queue_push (self->worker_queue, GOM_SQLITE_CONNECTION_STOP_WORK);
+      g_clear_pointer (&self->worker_queue, g_async_queue_unref);
+    }
+  g_mutex_clear (&self->worker_mutex);
+
   if (self->native != NULL)
     {
       sqlite3_close_v2 (self->native);
@@ -86,16 +192,28 @@ gom_sqlite_connection_class_init (GomSqliteConnectionClass *klass)
 static void
 gom_sqlite_connection_init (GomSqliteConnection *self)
 {
+  g_mutex_init (&self->statements_mutex);
+  g_mutex_init (&self->worker_mutex);
+  self->statements = g_hash_table_new (g_str_hash, g_str_equal);
+  self->counts = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
 }
 
 static gboolean
-gom_sqlite_connection_configure (sqlite3  *db,
-                                 GError  **error)
+gom_sqlite_connection_configure (sqlite3                          *db,
+                                 const GomSqliteConnectionConfig  *config,
+                                 gboolean                          read_only,
+                                 GError                          **error)
 {
+  g_autofree char *wal_autocheckpoint_sql = NULL;
+
   g_assert (db != NULL);
+  g_assert (config != NULL);
 
-  /* Keep lock waiting in gom-sqlite-driver.c so errors and trace marks are consistent. */
-  if (sqlite3_busy_timeout (db, GOM_SQLITE_BUSY_TIMEOUT_MS) != SQLITE_OK)
+  /* Keep lock waiting in gom-sqlite-driver.c so errors and trace marks are
+   * consistent. A configured busy timeout only adds SQLite's own wait in
+   * front of that.
+   */
+  if (sqlite3_busy_timeout (db, (int)config->busy_timeout_msec) != SQLITE_OK)
     {
       g_set_error (error,
                    GOM_ERROR,
@@ -105,14 +223,24 @@ gom_sqlite_connection_configure (sqlite3  *db,
       return FALSE;
     }
 
+  /* The journal mode is persistent and set up by the writer, and readers
+   * never commit, so they only need the per-connection tuning below.
+   */
+  if (read_only)
+    goto tuning;
+
   if (!gom_sqlite_driver_exec_sql (db,
                                    "PRAGMA journal_mode = WAL",
                                    "configure SQLite WAL mode",
                                    error))
     return FALSE;
 
+  wal_autocheckpoint_sql = g_strdup_printf ("PRAGMA wal_autocheckpoint = %d",
+                                            config->wal_autocheckpoint >= 0 ?
+                                              config->wal_autocheckpoint :
+                                              GOM_SQLITE_CONNECTION_WAL_AUTOCHECKPOINT);
   if (!gom_sqlite_driver_exec_sql (db,
-                                   "PRAGMA wal_autocheckpoint = 1",
+                                   wal_autocheckpoint_sql,
                                    "configure SQLite WAL autocheckpoint",
                                    error))
     return FALSE;
@@ -123,9 +251,107 @@ gom_sqlite_connection_configure (sqlite3  *db,
                                    error))
     return FALSE;
 
+tuning:
+  if (config->mmap_size >= 0)
+    {
+      g_autofree char *sql = g_strdup_printf ("PRAGMA mmap_size = %" G_GINT64_FORMAT,
+                                              config->mmap_size);
+
+      if (!gom_sqlite_driver_exec_sql (db, sql, "configure SQLite mmap size", error))
+        return FALSE;
+    }
+
+  if (config->cache_size != 0)
+    {
+      g_autofree char *sql = g_strdup_printf ("PRAGMA cache_size = %d", config->cache_size);
+
+      if (!gom_sqlite_driver_exec_sql (db, sql, "configure SQLite cache size", error))
+        return FALSE;
+    }
+
+  if (config->temp_store > 0)
+    {
+      g_autofree char *sql = g_strdup_printf ("PRAGMA temp_store = %d", config->temp_store);
+
+      if (!gom_sqlite_driver_exec_sql (db, sql, "configure SQLite temp store", error))
+        return FALSE;
+    }
+
   return TRUE;
 }
 
+static void
+gom_sqlite_connection_update_hook (void          *user_data,
+                                   int            op,
+                                   const char    *db_name,
+                                   const char    *table_name,
+                                   sqlite3_int64  rowid)
+{
+  GomSqliteConnection *self = user_data;
+  g_autofree char *qualified = NULL;
+  GomDeltaKind kind;
+
+  g_assert (GOM_IS_SQLITE_CONNECTION (self));
+
+  if (!self->capture_changes || g_strcmp0 (db_name, "temp") == 0)
+    return;
+
+  if (op == SQLITE_INSERT)
+    kind = GOM_DELTA_KIND_INSERT;
+  else if (op == SQLITE_DELETE)
+    kind = GOM_DELTA_KIND_DELETE;
+  else
+    kind = GOM_DELTA_KIND_UPDATE;
+
+  if (g_strcmp0 (db_name, "main") != 0)
+    qualified = g_strdup_printf ("%s.%s", db_name, table_name);
+
+  if (self->pending_changes == NULL)
+    self->pending_changes = _gom_change_set_new ();
+
+  _gom_change_set_add_rowid (self->pending_changes,
+                             qualified != NULL ? qualified : table_name,
+                             kind,
+                             rowid);
+}
+
+static int
+gom_sqlite_connection_commit_hook (void *user_data)
+{
+  GomSqliteConnection *self = user_data;
+
+  g_assert (GOM_IS_SQLITE_CONNECTION (self));
+
+  /* COMMIT may still fail with SQLITE_BUSY after this returns, in which
+   * case listeners see changes that did not land. That only costs them a
+   * reload, so it is not worth tracking.
+   */
+  if (self->pending_changes == NULL)
+    return 0;
+
+  if (self->committed_changes == NULL)
+    {
+      self->committed_changes = g_steal_pointer (&self->pending_changes);
+    }
+  else
+    {
+      _gom_change_set_append (self->committed_changes, self->pending_changes);
+      g_clear_object (&self->pending_changes);
+    }
+
+  return 0;
+}
+
+static void
+gom_sqlite_connection_rollback_hook (void *user_data)
+{
+  GomSqliteConnection *self = user_data;
+
+  g_assert (GOM_IS_SQLITE_CONNECTION (self));
+
+  g_clear_object (&self->pending_changes);
+}
+
 static DexFuture *
 gom_sqlite_connection_new_thread (gpointer user_data)
 {
@@ -143,7 +369,10 @@ gom_sqlite_connection_new_thread (gpointer user_data)
 
   uri = state->uri;
 
-  flags = SQLITE_OPEN_CREATE | SQLITE_OPEN_READWRITE | SQLITE_OPEN_URI;
+  if (state->read_only)
+    flags = SQLITE_OPEN_READONLY | SQLITE_OPEN_URI;
+  else
+    flags = SQLITE_OPEN_CREATE | SQLITE_OPEN_READWRITE | SQLITE_OPEN_URI;
 
   if (sqlite3_initialize () != SQLITE_OK)
     return dex_future_new_reject (GOM_ERROR,
@@ -226,7 +455,7 @@ gom_sqlite_connection_new_thread (gpointer user_data)
   }
 #endif
 
-  if (!gom_sqlite_connection_configure (db, &error))
+  if (!gom_sqlite_connection_configure (db, &state->config, state->read_only, &error))
     {
       sqlite3_close_v2 (db);
       return dex_future_new_for_error (g_steal_pointer (&error));
@@ -237,6 +466,15 @@ gom_sqlite_connection_new_thread (gpointer user_data)
   self->uri = g_strdup (uri);
   if (state->encryption_key != NULL)
     self->encryption_key = g_bytes_ref (state->encryption_key);
+  self->cursor_spool_rows = state->config.cursor_spool_rows;
+  self->read_only = !!state->read_only;
+
+  if (!self->read_only)
+    {
+      sqlite3_update_hook (self->native, gom_sqlite_connection_update_hook, self);
+      sqlite3_commit_hook (self->native, gom_sqlite_connection_commit_hook, self);
+      sqlite3_rollback_hook (self->native, gom_sqlite_connection_rollback_hook, self);
+    }
 
   return dex_future_new_take_object (g_steal_pointer (&self));
 }
@@ -255,11 +493,14 @@ gom_sqlite_connection_new_state_free (gpointer data)
 }
 
 DexFuture *
-gom_sqlite_connection_new (const char    *uri,
-                           GBytes        *encryption_key,
-                           DexThreadPool *thread_pool,
-                           DexLimiter    *open_limiter)
+gom_sqlite_connection_new (const char                      *uri,
+                           GBytes                          *encryption_key,
+                           const GomSqliteConnectionConfig *config,
+                           gboolean                         read_only,
+                           DexThreadPool                   *thread_pool,
+                           DexLimiter                      *open_limiter)
 {
+  static const GomSqliteConnectionConfig default_config = GOM_SQLITE_CONNECTION_CONFIG_INIT;
   GomSqliteConnectionNewState *state;
 
   dex_return_error_if_fail (uri != NULL);
@@ -270,6 +511,8 @@ gom_sqlite_connection_new (const char    *uri,
   state->uri = g_strdup (uri);
   if (encryption_key != NULL)
     state->encryption_key = g_bytes_ref (encryption_key);
+  state->config = config != NULL ? *config : default_config;
+  state->read_only = !!read_only;
 
   return dex_limiter_run_on_pool (open_limiter,
                                   thread_pool,
@@ -285,3 +528,313 @@ gom_sqlite_connection_get_native (GomSqliteConnection *connection)
 
   return connection->native;
 }
+
+/* Connections opened read-only are used by the pool for queries and are
+ * never handed to sessions or mutations.
+ */
+gboolean
+gom_sqlite_connection_is_read_only (GomSqliteConnection *connection)
+{
+  g_return_val_if_fail (GOM_IS_SQLITE_CONNECTION (connection), FALSE);
+
+  return connection->read_only;
+}
+
+/* Whether the database lives in a file other connections can open, as
+ * opposed to a private in-memory or temporary database.
+ */
+gboolean
+gom_sqlite_connection_is_shared (GomSqliteConnection *connection)
+{
+  const char *filename;
+
+  g_return_val_if_fail (GOM_IS_SQLITE_CONNECTION (connection), FALSE);
+
+  filename = sqlite3_db_filename (connection->native, "main");
+
+  return filename != NULL && filename[0] != 0;
+}
+
+guint
+gom_sqlite_connection_get_cursor_spool_rows (GomSqliteConnection *connection)
+{
+  g_return_val_if_fail (GOM_IS_SQLITE_CONNECTION (connection), 0);
+
+  return connection->cursor_spool_rows;
+}
+
+/* Checks out a reset statement for @sql, if one is cached. The caller owns
+ * it until it is handed back with gom_sqlite_connection_cache_statement().
+ */
+sqlite3_stmt *
+gom_sqlite_connection_steal_statement (GomSqliteConnection *self,
+                                       const char          *sql)
+{
+  GomSqliteCachedStatement *cached;
+  sqlite3_stmt *stmt = NULL;
+
+  g_return_val_if_fail (GOM_IS_SQLITE_CONNECTION (self), NULL);
+  g_return_val_if_fail (sql != NULL, NULL);
+
+  g_mutex_lock (&self->statements_mutex);
+  if ((cached = g_hash_table_lookup (self->statements, sql)))
+    {
+      g_queue_unlink (&self->statements_lru, &cached->link);
+      g_hash_table_remove (self->statements, cached->sql);
+      stmt = g_steal_pointer (&cached->stmt);
+      gom_sqlite_cached_statement_free (cached);
+    }
+  g_mutex_unlock (&self->statements_mutex);
+
+  if (stmt != NULL)
+    gom_trace_counter_add (GOM_TRACE_COUNTER_STATEMENT_CACHE_HITS, 1);
+  else
+    gom_trace_counter_add (GOM_TRACE_COUNTER_STATEMENT_CACHE_MISSES, 1);
+
+  return stmt;
+}
+
+void
+gom_sqlite_connection_cache_statement (GomSqliteConnection *self,
+                                       const char          *sql,
+                                       sqlite3_stmt        *stmt)
+{
+  GomSqliteCachedStatement *cached;
+  GomSqliteCachedStatement *evicted = NULL;
+
+  g_return_if_fail (GOM_IS_SQLITE_CONNECTION (self));
+  g_return_if_fail (sql != NULL);
+  g_return_if_fail (stmt != NULL);
+
+  sqlite3_reset (stmt);
+  sqlite3_clear_bindings (stmt);
+
+  g_mutex_lock (&self->statements_mutex);
+
+  if (g_hash_table_contains (self->statements, sql))
+    {
+      g_mutex_unlock (&self->statements_mutex);
+      sqlite3_finalize (stmt);
+      return;
+    }
+
+  cached = g_new0 (GomSqliteCachedStatement, 1);
+  cached->link.data = cached;
+  cached->sql = g_strdup (sql);
+  cached->stmt = stmt;
+
+  g_hash_table_insert (self->statements, cached->sql, cached);
+  g_queue_push_head_link (&self->statements_lru, &cached->link);
+
+  if (self->statements_lru.length > GOM_SQLITE_CONNECTION_STATEMENT_CACHE_SIZE)
+    {
+      evicted = g_queue_peek_tail (&self->statements_lru);
+      g_queue_unlink (&self->statements_lru, &evicted->link);
+      g_hash_table_remove (self->statements, evicted->sql);
+    }
+
+  g_mutex_unlock (&self->statements_mutex);
+
+  if (evicted != NULL)
+    gom_sqlite_cached_statement_free (evicted);
+}
+
+void
+gom_sqlite_connection_clear_statements (GomSqliteConnection *self)
+{
+  g_return_if_fail (GOM_IS_SQLITE_CONNECTION (self));
+
+  g_mutex_lock (&self->statements_mutex);
+  gom_sqlite_connection_clear_statements_locked (self);
+  g_mutex_unlock (&self->statements_mutex);
+}
+
+void
+gom_sqlite_connection_set_schema_generation (GomSqliteConnection *self,
+                                             guint                schema_generation)
+{
+  g_return_if_fail (GOM_IS_SQLITE_CONNECTION (self));
+
+  g_mutex_lock (&self->statements_mutex);
+  if (self->schema_generation != schema_generation)
+    {
+      gom_sqlite_connection_clear_statements_locked (self);
+      self->schema_generation = schema_generation;
+    }
+  g_mutex_unlock (&self->statements_mutex);
+}
+
+/* Looks up a row count previously stored with
+ * gom_sqlite_connection_cache_count(). @data_version must have been read
+ * within the transaction the caller is about to query in.
+ */
+gboolean
+gom_sqlite_connection_lookup_count (GomSqliteConnection *self,
+                                    const char          *key,
+                                    gint64               data_version,
+                                    guint64             *count)
+{
+  GomSqliteCachedCount *cached;
+  gboolean ret = FALSE;
+
+  g_return_val_if_fail (GOM_IS_SQLITE_CONNECTION (self), FALSE);
+  g_return_val_if_fail (key != NULL, FALSE);
+  g_return_val_if_fail (count != NULL, FALSE);
+
+  g_mutex_lock (&self->statements_mutex);
+  if ((cached = g_hash_table_lookup (self->counts, key)) &&
+      cached->data_version == data_version &&
+      cached->total_changes == (gint64)sqlite3_total_changes64 (self->native))
+    {
+      *count = cached->count;
+      ret = TRUE;
+    }
+  g_mutex_unlock (&self->statements_mutex);
+
+  if (ret)
+    gom_trace_counter_add (GOM_TRACE_COUNTER_COUNT_CACHE_HITS, 1);
+  else
+    gom_trace_counter_add (GOM_TRACE_COUNTER_COUNT_CACHE_MISSES, 1);
+
+  return ret;
+}
+
+void
+gom_sqlite_connection_cache_count (GomSqliteConnection *self,
+                                   const char          *key,
+                                   gint64               data_version,
+                                   guint64              count)
+{
+  GomSqliteCachedCount *cached;
+
+  g_return_if_fail (GOM_IS_SQLITE_CONNECTION (self));
+  g_return_if_fail (key != NULL);
+
+  cached = g_new0 (GomSqliteCachedCount, 1);
+  cached->data_version = data_version;
+  cached->total_changes = (gint64)sqlite3_total_changes64 (self->native);
+  cached->count = count;
+
+  g_mutex_lock (&self->statements_mutex);
+  /* Entries go stale together on any write, so start over when full */
+  if (g_hash_table_size (self->counts) >= GOM_SQLITE_CONNECTION_COUNT_CACHE_SIZE &&
+      !g_hash_table_contains (self->counts, key))
+    g_hash_table_remove_all (self->counts);
+  g_hash_table_replace (self->counts, g_strdup (key), cached);
+  g_mutex_unlock (&self->statements_mutex);
+}
+
+static gpointer
+gom_sqlite_connection_worker_thread (gpointer data)
+{
+  g_autoptr(GAsyncQueue) queue = data;
+
+  for (;;)
+    {
+      GomSqliteConnectionWork *work = g_async_queue_pop (queue);
+
+      if (work == GOM_SQLITE_CONNECTION_STOP_WORK)
+        break;
+
+      work->func (work->user_data);
+      g_free (work);
+    }
+
+  return NULL;
+}
+
+/* Queues @func to run on the worker thread of @self, starting it on first
+ * use. Work runs in the order it was queued. The caller must keep @self
+ * alive until @func has run.
+ */
+gboolean
+gom_sqlite_connection_run (GomSqliteConnection      *self,
+                           GomSqliteConnectionFunc   func,
+                           gpointer                  user_data,
+                           GError                  **error)
+{
+  GomSqliteConnectionWork *work;
+
+  g_return_val_if_fail (GOM_IS_SQLITE_CONNECTION (self), FALSE);
+  g_return_val_if_fail (func != NULL, FALSE);
+
+  g_mutex_lock (&self->worker_mutex);
+
+  if (self->worker_queue == NULL)
+    {
+      g_autoptr(GAsyncQueue) queue = g_async_queue_new ();
+      GThread *thread;
+
+      if (!(thread = g_thread_try_new ("[gom-sqlite-worker]",
+                                       gom_sqlite_connection_worker_thread,
+                                       g_async_queue_ref (queue),
+                                       error)))
+        {
+          g_async_queue_unref (queue);
+          g_mutex_unlock (&self->worker_mutex);
+          return FALSE;
+        }
+
+      g_thread_unref (thread);
+      self->worker_queue = g_steal_pointer (&queue);
+    }
+
+  work = g_new0 (GomSqliteConnectionWork, 1);
+  work->func = func;
+  work->user_data = user_data;
+  g_async_queue_push (self->worker_queue, work);
+
+  g_mutex_unlock (&self->worker_mutex);
+
+  return TRUE;
+}
+
+/* Sets whether the update hook records written rows. Nothing listens for
+ * them most of the time, and a bulk write would otherwise hold on to
+ * every row it touched. Must be called from the thread running work for
+ * the connection.
+ */
+void
+gom_sqlite_connection_set_capture_changes (GomSqliteConnection *self,
+                                           gboolean             capture_changes)
+{
+  g_return_if_fail (GOM_IS_SQLITE_CONNECTION (self));
+
+  self->capture_changes = !!capture_changes;
+}
+
+/* Returns a mark for the rows written so far by the open transaction,
+ * to be passed to gom_sqlite_connection_discard_changes() when work
+ * started after it is rolled back to a savepoint or fails part way.
+ */
+guint
+gom_sqlite_connection_get_change_mark (GomSqliteConnection *self)
+{
+  g_return_val_if_fail (GOM_IS_SQLITE_CONNECTION (self), 0);
+
+  if (self->pending_changes == NULL)
+    return 0;
+
+  return gom_change_set_get_n_changes (self->pending_changes);
+}
+
+void
+gom_sqlite_connection_discard_changes (GomSqliteConnection *self,
+                                       guint                mark)
+{
+  g_return_if_fail (GOM_IS_SQLITE_CONNECTION (self));
+
+  if (self->pending_changes != NULL)
+    _gom_change_set_truncate (self->pending_changes, mark);
+}
+
+/* Takes the rows written by transactions committed since the last call,
+ * or %NULL if there were none.
+ */
+GomChangeSet *
+gom_sqlite_connection_steal_changes (GomSqliteConnection *self)
+{
+  g_return_val_if_fail (GOM_IS_SQLITE_CONNECTION (self), NULL);
+
+  return g_steal_pointer (&self->committed_changes);
+}
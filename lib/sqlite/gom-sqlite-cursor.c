@@ -42,8 +42,17 @@ struct _GomSqliteCursor
   gboolean            closed;
   gboolean            on_row;
   guint64             count;
+
+  /* Rows already read from the statement, when spooling is enabled. The
+   * statement is always positioned on the last spooled row, so rows
+   * before it are replayed from the spool instead of re-executing.
+   */
+  GomCursorBatch     *spool;
+  guint               spool_limit;
+
   guint               has_count : 1;
   guint               owns_transaction : 1;
+  guint               spool_done : 1;
 };
 
 struct _GomSqliteCursorClass
@@ -56,6 +65,129 @@ G_DEFINE_FINAL_TYPE (GomSqliteCursor, gom_sqlite_cursor, GOM_TYPE_CURSOR)
 static DexFuture *gom_sqlite_cursor_move_absolute (GomCursor *cursor,
                                                    guint64    position);
 
+static inline gboolean
+gom_sqlite_cursor_is_done (GomSqliteCursor *self)
+{
+  return self->position >= 0 && !self->on_row;
+}
+
+static inline gboolean
+gom_sqlite_cursor_get_spooled_row (GomSqliteCursor *self,
+                                   guint           *row)
+{
+  if (self->spool == NULL ||
+      !self->on_row ||
+      self->position >= (gint64)self->spool->n_rows)
+    return FALSE;
+
+  *row = (guint)self->position;
+
+  return TRUE;
+}
+
+static void
+gom_sqlite_cursor_spool_row (GomSqliteCursor *self)
+{
+  g_assert (GOM_IS_SQLITE_CURSOR (self));
+  g_assert (self->on_row);
+
+  if (self->spool_limit == 0)
+    return;
+
+  if (self->spool == NULL)
+    {
+      /* Only a spool starting at the first row can replay seeks */
+      if (self->position != 0)
+        return;
+
+      self->spool = _gom_cursor_batch_new (GOM_CURSOR (self),
+                                           MIN (self->spool_limit, GOM_CURSOR_BATCH_SIZE));
+    }
+
+  /* Past the limit, fall back to re-executing for backwards seeks */
+  if (self->spool->n_rows >= self->spool_limit)
+    {
+      GOM_TRACE_MARK ("Cursor", "spool", "sqlite dropped rows=%u", self->spool->n_rows);
+      g_clear_pointer (&self->spool, _gom_cursor_batch_free);
+      self->spool_limit = 0;
+      return;
+    }
+
+  if (self->spool->n_rows == self->spool->capacity)
+    _gom_cursor_batch_grow (self->spool,
+                            (guint)MIN ((guint64)self->spool->capacity * 2, self->spool_limit));
+
+  _gom_cursor_batch_append (self->spool, GOM_CURSOR (self));
+}
+
+/* Advances by one row, replaying from the spool when possible and
+ * stepping the statement otherwise. Position and row state are updated
+ * for SQLITE_ROW and SQLITE_DONE.
+ */
+static int
+gom_sqlite_cursor_step (GomSqliteCursor  *self,
+                        sqlite3_stmt     *stmt,
+                        const char       *context,
+                        GError          **error)
+{
+  int rc;
+
+  g_assert (GOM_IS_SQLITE_CURSOR (self));
+  g_assert (stmt != NULL);
+
+  if (self->spool != NULL)
+    {
+      if (self->position + 1 < (gint64)self->spool->n_rows)
+        {
+          self->position++;
+          self->on_row = TRUE;
+          return SQLITE_ROW;
+        }
+
+      if (self->spool_done)
+        {
+          self->position = self->spool->n_rows;
+          self->on_row = FALSE;
+          return SQLITE_DONE;
+        }
+    }
+
+  rc = gom_sqlite_driver_step (stmt, context, error);
+
+  if (rc == SQLITE_ROW)
+    {
+      self->position++;
+      self->on_row = TRUE;
+      gom_sqlite_cursor_spool_row (self);
+    }
+  else if (rc == SQLITE_DONE)
+    {
+      self->position = MAX (self->position + 1, 0);
+      self->on_row = FALSE;
+      self->spool_done = TRUE;
+    }
+
+  return rc;
+}
+
+/* Moves before the first row. With a spool the statement is left where
+ * it is so that the spooled rows can be replayed.
+ */
+static void
+gom_sqlite_cursor_reset (GomSqliteCursor *self)
+{
+  g_assert (GOM_IS_SQLITE_CURSOR (self));
+
+  if (self->spool == NULL && self->statement != NULL)
+    {
+      gom_sqlite_statement_reset (self->statement);
+      self->spool_done = FALSE;
+    }
+
+  self->position = -1;
+  self->on_row = FALSE;
+}
+
 static guint
 gom_sqlite_cursor_get_n_columns (GomCursor *cursor)
 {
@@ -93,12 +225,29 @@ gom_sqlite_cursor_get_column_value (GomCursor *cursor,
 {
   GomSqliteCursor *self = GOM_SQLITE_CURSOR (cursor);
   sqlite3_stmt *stmt;
+  guint row;
   int type;
   int col;
 
   if (self->closed || self->statement == NULL || value == NULL)
     return FALSE;
 
+  if (gom_sqlite_cursor_get_spooled_row (self, &row))
+    {
+      const GValue *src;
+
+      if (column >= self->spool->n_columns)
+        return FALSE;
+
+      src = _gom_cursor_batch_get_value (self->spool, row, column);
+      if (G_VALUE_TYPE (src) == G_TYPE_INVALID)
+        return FALSE;
+
+      g_value_init (value, G_VALUE_TYPE (src));
+      g_value_copy (src, value);
+      return TRUE;
+    }
+
   stmt = gom_sqlite_statement_get_native (self->statement);
   if (stmt == NULL || (int)column >= sqlite3_column_count (stmt))
     return FALSE;
@@ -149,10 +298,14 @@ gom_sqlite_cursor_get_column_string (GomCursor *cursor,
   GomSqliteCursor *self = GOM_SQLITE_CURSOR (cursor);
   sqlite3_stmt *stmt;
   const unsigned char *text;
+  guint row;
 
   if (self->closed || self->statement == NULL)
     return NULL;
 
+  if (gom_sqlite_cursor_get_spooled_row (self, &row))
+    return _gom_cursor_batch_get_string (self->spool, row, column);
+
   stmt = gom_sqlite_statement_get_native (self->statement);
   if (stmt == NULL || (int)column >= sqlite3_column_count (stmt))
     return NULL;
@@ -163,6 +316,119 @@ gom_sqlite_cursor_get_column_string (GomCursor *cursor,
   return (const char *)text;
 }
 
+static gboolean
+gom_sqlite_cursor_peek_column_bytes (GomCursor     *cursor,
+                                     guint          column,
+                                     const guint8 **data,
+                                     gsize         *len)
+{
+  GomSqliteCursor *self = GOM_SQLITE_CURSOR (cursor);
+  sqlite3_stmt *stmt;
+  guint row;
+  int col;
+
+  if (self->closed || self->statement == NULL)
+    return FALSE;
+
+  if (gom_sqlite_cursor_get_spooled_row (self, &row))
+    return _gom_cursor_batch_peek_bytes (self->spool, row, column, data, len);
+
+  stmt = gom_sqlite_statement_get_native (self->statement);
+  if (stmt == NULL || (int)column >= sqlite3_column_count (stmt))
+    return FALSE;
+
+  col = (int)column;
+
+  /* sqlite3_column_bytes() must be called after the pointer accessor
+   * so that it reports the size of the representation we return.
+   */
+  switch (sqlite3_column_type (stmt, col))
+    {
+    case SQLITE_BLOB:
+      *data = sqlite3_column_blob (stmt, col);
+      *len = sqlite3_column_bytes (stmt, col);
+      return TRUE;
+
+    case SQLITE_TEXT:
+      *data = sqlite3_column_text (stmt, col);
+      *len = sqlite3_column_bytes (stmt, col);
+      return TRUE;
+
+    default:
+      return FALSE;
+    }
+}
+
+static sqlite3_stmt *
+gom_sqlite_cursor_get_live_stmt (GomSqliteCursor *self,
+                                 guint            column)
+{
+  sqlite3_stmt *stmt;
+  guint row;
+
+  if (self->closed || self->statement == NULL)
+    return NULL;
+
+  /* Spooled rows are read through the generic path */
+  if (gom_sqlite_cursor_get_spooled_row (self, &row))
+    return NULL;
+
+  stmt = gom_sqlite_statement_get_native (self->statement);
+  if (stmt == NULL || (int)column >= sqlite3_column_count (stmt))
+    return NULL;
+
+  return stmt;
+}
+
+static gboolean
+gom_sqlite_cursor_get_column_int64 (GomCursor *cursor,
+                                    guint      column,
+                                    gint64    *value)
+{
+  GomSqliteCursor *self = GOM_SQLITE_CURSOR (cursor);
+  sqlite3_stmt *stmt;
+
+  if (!(stmt = gom_sqlite_cursor_get_live_stmt (self, column)))
+    return FALSE;
+
+  switch (sqlite3_column_type (stmt, (int)column))
+    {
+    case SQLITE_INTEGER:
+    case SQLITE_FLOAT:
+      *value = sqlite3_column_int64 (stmt, (int)column);
+      return TRUE;
+
+    default:
+      return FALSE;
+    }
+}
+
+static gboolean
+gom_sqlite_cursor_get_column_uint64 (GomCursor *cursor,
+                                     guint      column,
+                                     guint64   *value)
+{
+  GomSqliteCursor *self = GOM_SQLITE_CURSOR (cursor);
+  sqlite3_stmt *stmt;
+
+  if (!(stmt = gom_sqlite_cursor_get_live_stmt (self, column)))
+    return FALSE;
+
+  switch (sqlite3_column_type (stmt, (int)column))
+    {
+    case SQLITE_INTEGER:
+      *value = (guint64)sqlite3_column_int64 (stmt, (int)column);
+      return TRUE;
+
+    case SQLITE_FLOAT:
+      *value = (guint64)sqlite3_column_double (stmt, (int)column);
+      return TRUE;
+
+    default:
+      return FALSE;
+    }
+}
+
 static DexFuture *
 gom_sqlite_cursor_next (GomCursor *cursor)
 {
@@ -178,18 +444,18 @@ gom_sqlite_cursor_next (GomCursor *cursor)
   if (!(stmt = gom_sqlite_statement_get_native (self->statement)))
     return dex_future_new_false ();
 
-  rc = gom_sqlite_driver_step (stmt, "step cursor", &error);
+  /* Stepping past SQLITE_DONE would implicitly reset the statement */
+  if (gom_sqlite_cursor_is_done (self))
+    return dex_future_new_false ();
+
+  rc = gom_sqlite_cursor_step (self, stmt, "step cursor", &error);
   if (rc == SQLITE_ROW)
     {
-      self->position++;
-      self->on_row = TRUE;
       GOM_TRACE_END_MARK (start_time, "Cursor", "next", "sqlite row");
       return dex_future_new_true ();
     }
   if (rc == SQLITE_DONE)
     {
-      self->position = MAX (self->position + 1, 0);
-      self->on_row = FALSE;
       GOM_TRACE_END_MARK (start_time, "Cursor", "next", "sqlite done");
       return dex_future_new_false ();
     }
@@ -204,6 +470,103 @@ gom_sqlite_cursor_next (GomCursor *cursor)
                                 sqlite3_errmsg (sqlite3_db_handle (stmt)));
 }
 
+typedef struct _NextBatch
+{
+  GomSqliteCursor *self;
+  guint            n_rows;
+} NextBatch;
+
+static void
+next_batch_free (NextBatch *state)
+{
+  g_clear_object (&state->self);
+  g_free (state);
+}
+
+static DexFuture *
+gom_sqlite_cursor_next_batch_thread (gpointer user_data)
+{
+  NextBatch *state = user_data;
+  GomSqliteCursor *self = state->self;
+  g_autoptr(GomCursorBatch) batch = NULL;
+  g_autoptr(GError) error = NULL;
+  sqlite3_stmt *stmt;
+  guint n_rows;
+  int rc = SQLITE_DONE;
+  gint64 start_time = GOM_TRACE_BEGIN_MARK ();
+
+  if (self->closed || self->statement == NULL)
+    return dex_future_new_for_uint (0);
+
+  if (!(stmt = gom_sqlite_statement_get_native (self->statement)))
+    return dex_future_new_for_uint (0);
+
+  if (gom_sqlite_cursor_is_done (self))
+    return dex_future_new_for_uint (0);
+
+  while (batch == NULL || batch->n_rows < state->n_rows)
+    {
+      rc = gom_sqlite_cursor_step (self, stmt, "step cursor batch", &error);
+
+      if (rc != SQLITE_ROW)
+        break;
+
+      if (batch == NULL)
+        batch = _gom_cursor_batch_new (GOM_CURSOR (self), state->n_rows);
+
+      _gom_cursor_batch_append (batch, GOM_CURSOR (self));
+    }
+
+  if (rc != SQLITE_ROW && rc != SQLITE_DONE)
+    {
+      GOM_TRACE_END_MARK (start_time, "Cursor", "next-batch", "sqlite error");
+
+      if (error != NULL)
+        return dex_future_new_for_error (g_steal_pointer (&error));
+
+      return dex_future_new_reject (G_IO_ERROR,
+                                    G_IO_ERROR_FAILED,
+                                    "SQLite step failed: %s",
+                                    sqlite3_errmsg (sqlite3_db_handle (stmt)));
+    }
+
+  /* SQLITE_DONE leaves the statement one past the last buffered row */
+  if (batch != NULL && rc == SQLITE_DONE)
+    batch->past_end = TRUE;
+
+  n_rows = batch != NULL ? batch->n_rows : 0;
+
+  GOM_TRACE_END_MARK (start_time, "Cursor", "next-batch", "sqlite rows=%u", n_rows);
+
+  _gom_cursor_take_batch (GOM_CURSOR (self), g_steal_pointer (&batch));
+
+  return dex_future_new_for_uint (n_rows);
+}
+
+static DexFuture *
+gom_sqlite_cursor_next_batch (GomCursor *cursor,
+                              guint      n_rows)
+{
+  GomSqliteCursor *self = GOM_SQLITE_CURSOR (cursor);
+  GomSqliteLeaseState *state;
+  NextBatch *next_batch;
+
+  if (self->closed || self->statement == NULL)
+    return dex_future_new_for_uint (0);
+
+  state = gom_sqlite_statement_get_state (self->statement);
+
+  next_batch = g_new0 (NextBatch, 1);
+  next_batch->self = g_object_ref (self);
+  next_batch->n_rows = n_rows;
+
+  return gom_sqlite_lease_state_invoke (state,
+                                        "[gom-sqlite-next-batch]",
+                                        gom_sqlite_cursor_next_batch_thread,
+                                        next_batch,
+                                        (GDestroyNotify)next_batch_free);
+}
+
 static gboolean
 gom_sqlite_cursor_commit_transaction (GomSqliteCursor  *self,
                                       GError          **error)
@@ -248,6 +611,7 @@ gom_sqlite_cursor_close (GomCursor *cursor)
   self->closed = TRUE;
   self->on_row = FALSE;
   g_clear_object (&self->statement);
+  g_clear_pointer (&self->spool, _gom_cursor_batch_free);
   GOM_TRACE_END_MARK (start_time, "Cursor", "close", "sqlite closed");
   return dex_future_new_true ();
 }
@@ -282,6 +646,7 @@ gom_sqlite_cursor_exhaust_thread (gpointer user_data)
 
   stmt = NULL;
   g_clear_object (&self->statement);
+  g_clear_pointer (&self->spool, _gom_cursor_batch_free);
   self->closed = TRUE;
 
   if (error == NULL)
@@ -310,11 +675,7 @@ gom_sqlite_cursor_rewind (GomCursor *cursor)
 {
   GomSqliteCursor *self = GOM_SQLITE_CURSOR (cursor);
 
-  if (self->statement != NULL)
-    gom_sqlite_statement_reset (self->statement);
-
-  self->position = -1;
-  self->on_row = FALSE;
+  gom_sqlite_cursor_reset (self);
 
   return dex_future_new_true ();
 }
@@ -341,27 +702,40 @@ gom_sqlite_cursor_move_absolute (GomCursor *cursor,
   if (!(stmt = gom_sqlite_statement_get_native (self->statement)))
     return dex_future_new_false ();
 
-  gom_sqlite_statement_reset (self->statement);
-  self->position = -1;
-  self->on_row = FALSE;
+  if (self->spool != NULL)
+    {
+      /* Spooled rows are addressable directly. Anything beyond them is
+       * reached by resuming from the last spooled row, which is where the
+       * statement is positioned.
+       */
+      if (target < (gint64)self->spool->n_rows)
+        {
+          self->position = target;
+          self->on_row = TRUE;
+          return dex_future_new_true ();
+        }
+
+      self->position = (gint64)self->spool->n_rows - 1;
+      self->on_row = TRUE;
+    }
+  else if (target < self->position)
+    {
+      gom_sqlite_cursor_reset (self);
+    }
+
+  /* Forward seeks resume from the current row rather than re-executing */
+  if (gom_sqlite_cursor_is_done (self) && self->position <= target)
+    return dex_future_new_false ();
 
   while (self->position < target)
     {
-      rc = gom_sqlite_driver_step (stmt, "move cursor", &error);
+      rc = gom_sqlite_cursor_step (self, stmt, "move cursor", &error);
 
       if (rc == SQLITE_ROW)
-        {
-          self->position++;
-          self->on_row = TRUE;
-          continue;
-        }
+        continue;
 
       if (rc == SQLITE_DONE)
-        {
-          self->position = MAX (self->position + 1, 0);
-          self->on_row = FALSE;
-          return dex_future_new_false ();
-        }
+        return dex_future_new_false ();
 
       if (error != NULL)
         return dex_future_new_for_error (g_steal_pointer (&error));
@@ -398,9 +772,7 @@ gom_sqlite_cursor_move_relative (GomCursor *cursor,
 
   if (target < 0)
     {
-      gom_sqlite_statement_reset (self->statement);
-      self->position = -1;
-      self->on_row = FALSE;
+      gom_sqlite_cursor_reset (self);
       return dex_future_new_false ();
     }
 
@@ -446,6 +818,7 @@ gom_sqlite_cursor_finalize (GObject *object)
     gom_sqlite_cursor_commit_transaction (self, NULL);
 
   g_clear_object (&self->statement);
+  g_clear_pointer (&self->spool, _gom_cursor_batch_free);
   g_clear_pointer (&self->sql, g_free);
 
   G_OBJECT_CLASS (gom_sqlite_cursor_parent_class)->finalize (object);
@@ -471,6 +844,10 @@ gom_sqlite_cursor_class_init (GomSqliteCursorClass *klass)
   cursor_class->move_relative = gom_sqlite_cursor_move_relative;
   cursor_class->get_capabilities = gom_sqlite_cursor_get_capabilities;
   cursor_class->get_count = gom_sqlite_cursor_get_count;
+  cursor_class->next_batch = gom_sqlite_cursor_next_batch;
+  cursor_class->peek_column_bytes = gom_sqlite_cursor_peek_column_bytes;
+  cursor_class->get_column_int64 = gom_sqlite_cursor_get_column_int64;
+  cursor_class->get_column_uint64 = gom_sqlite_cursor_get_column_uint64;
 }
 
 static void
@@ -489,6 +866,7 @@ gom_sqlite_cursor_new (GomSqliteStatement *statement,
                        gboolean            owns_transaction,
                        GType               entity_type)
 {
+  GomSqliteLeaseState *state;
   GomSqliteCursor *self;
 
   g_return_val_if_fail (GOM_IS_SQLITE_STATEMENT (statement), NULL);
@@ -504,6 +882,9 @@ gom_sqlite_cursor_new (GomSqliteStatement *statement,
   self->has_count = !!has_count;
   self->owns_transaction = !!owns_transaction;
 
+  if ((state = gom_sqlite_statement_get_state (statement)))
+    self->spool_limit = gom_sqlite_connection_get_cursor_spool_rows (gom_sqlite_lease_state_get_connection (state));
+
   GOM_CURSOR (self)->entity_type = entity_type;
   _gom_cursor_set_repository (GOM_CURSOR (self), repository);
 
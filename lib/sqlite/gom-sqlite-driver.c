@@ -22,10 +22,12 @@
 
 #include <gmodule.h>
 #include <errno.h>
+#include <math.h>
 #include <sqlite3mc.h>
 #include <string.h>
 
 #include "gom-mutation.h"
+#include "gom-change-set.h"
 #include "gom-cursor-private.h"
 #include "gom-deletion-private.h"
 #include "gom-driver-private.h"
@@ -129,13 +131,21 @@
  * follows Gom's SQLite conventions or integrate tightly with the driver's
  * schema and entity layout.
  */
+#define GOM_SQLITE_GROUP_COMMIT_DEFAULT_SIZE 128
+
+typedef struct _GomSqliteGroupCommit GomSqliteGroupCommit;
+
 struct _GomSqliteDriver
 {
-  GomDriver      parent_instance;
-  GomSqlitePool *pool;
-  DexLimiter    *write_limiter;
-  char          *uri;
-  GBytes        *encryption_key;
+  GomDriver             parent_instance;
+  GomSqlitePool        *pool;
+  DexLimiter           *write_limiter;
+  char                 *uri;
+  GBytes               *encryption_key;
+  GMutex                group_commit_mutex;
+  GomSqliteGroupCommit *group_commit;
+  guint                 group_commit_window_msec;
+  guint                 group_commit_size;
 };
 
 struct _GomSqliteDriverClass
@@ -260,6 +270,27 @@ typedef struct
   } request;
 } GomSqliteWriteState;
 
+typedef struct
+{
+  GomSqliteMutationRequest *request;
+  DexPromise               *promise;
+  GomMutationResult        *result;
+  GError                   *error;
+} GomSqliteGroupCommitItem;
+
+/* Mutations collected into one transaction while the write lock is held.
+ * Items are only appended while the group is the driver's open group;
+ * after it is closed the fiber and lease thread own it exclusively.
+ */
+struct _GomSqliteGroupCommit
+{
+  GomSqliteDriver     *driver;
+  DexFuture           *acquire;
+  DexPromise          *full;
+  GPtrArray           *items;
+  GomSqliteLeaseState *lease_state;
+};
+
 typedef struct
 {
   GomSqlitePool           *pool;
@@ -603,21 +634,21 @@ gom_sqlite_driver_write_acquired_cb (DexFuture *completed,
   switch (state->operation)
     {
     case GOM_SQLITE_WRITE_MUTATE:
-      future = dex_future_then (gom_sqlite_pool_acquire (state->driver->pool),
+      future = dex_future_then (gom_sqlite_pool_acquire_writer (state->driver->pool),
                                 gom_sqlite_driver_mutate_cb,
                                 g_steal_pointer (&state->request.mutation),
                                 gom_sqlite_mutation_request_free);
       break;
 
     case GOM_SQLITE_WRITE_MIGRATE:
-      future = dex_future_then (gom_sqlite_pool_acquire (state->driver->pool),
+      future = dex_future_then (gom_sqlite_pool_acquire_writer (state->driver->pool),
                                 gom_sqlite_driver_migrate_cb,
                                 g_steal_pointer (&state->request.migrate),
                                 gom_sqlite_migrate_request_free);
       break;
 
     case GOM_SQLITE_WRITE_EXECUTE_SQL:
-      future = dex_future_then (gom_sqlite_pool_acquire (state->driver->pool),
+      future = dex_future_then (gom_sqlite_pool_acquire_writer (state->driver->pool),
                                 gom_sqlite_driver_execute_sql_cb,
                                 g_steal_pointer (&state->request.execute),
                                 gom_sqlite_execute_request_free);
@@ -630,7 +661,7 @@ gom_sqlite_driver_write_acquired_cb (DexFuture *completed,
         rekey_task = g_new0 (GomSqliteRekeyTask, 1);
         rekey_task->driver = g_object_ref (state->driver);
         rekey_task->encryption_key = g_steal_pointer (&state->request.rekey);
-        future = dex_future_then (gom_sqlite_pool_acquire (state->driver->pool),
+        future = dex_future_then (gom_sqlite_pool_acquire_writer (state->driver->pool),
                                   gom_sqlite_driver_rekey_cb,
                                   rekey_task,
                                   NULL);
@@ -852,6 +883,11 @@ gom_sqlite_driver_rekey_thread (gpointer user_data)
                                   G_IO_ERROR_BUSY,
                                   "Cannot rekey while a transaction is active");
 
+  /* Idle cached statements are not "active" from the caller's point of
+   * view, so drop them before looking for statements that are.
+   */
+  gom_sqlite_connection_clear_statements (connection);
+
   for (stmt = sqlite3_next_stmt (db, NULL); stmt != NULL; stmt = sqlite3_next_stmt (db, stmt))
     {
       return dex_future_new_reject (G_IO_ERROR,
@@ -1235,6 +1271,31 @@ gom_sqlite_driver_prepare (sqlite3       *db,
   return rc;
 }
 
+/* Like gom_sqlite_driver_prepare() but checks the connection's statement
+ * cache first. Callers hand the statement back with
+ * gom_sqlite_connection_cache_statement() once they are done with it.
+ */
+static int
+gom_sqlite_driver_prepare_cached (GomSqliteConnection  *connection,
+                                  const char           *sql,
+                                  sqlite3_stmt        **stmt,
+                                  const char           *action,
+                                  GError              **error)
+{
+  g_assert (GOM_IS_SQLITE_CONNECTION (connection));
+  g_assert (sql != NULL);
+  g_assert (stmt != NULL);
+
+  if ((*stmt = gom_sqlite_connection_steal_statement (connection, sql)))
+    return SQLITE_OK;
+
+  return gom_sqlite_driver_prepare (gom_sqlite_connection_get_native (connection),
+                                    sql,
+                                    stmt,
+                                    action,
+                                    error);
+}
+
 static gboolean
 gom_sqlite_driver_exec_sql_full (sqlite3     *db,
                                  const char  *sql,
@@ -2499,6 +2560,204 @@ failed:
   return FALSE;
 }
 
+/* Builds a key identifying @sql with @bindings for the count cache. Each
+ * value is tagged with how it binds so that distinct values never share
+ * a key. Returns %NULL for bindings without a stable encoding, in which
+ * case the count is not cached.
+ */
+static char *
+gom_sqlite_driver_dup_count_key (const char *sql,
+                                 GPtrArray  *bindings)
+{
+  g_autoptr(GString) key = NULL;
+
+  g_assert (sql != NULL);
+
+  key = g_string_new (sql);
+
+  for (guint i = 0; bindings != NULL && i < bindings->len; i++)
+    {
+      GomSqliteBinding *binding = g_ptr_array_index (bindings, i);
+      const GValue *value;
+
+      g_string_append_c (key, '\x1f');
+
+      if (binding == NULL || !binding->has_value)
+        {
+          g_string_append_c (key, 'N');
+          continue;
+        }
+
+      value = &binding->value;
+
+      if (G_VALUE_HOLDS_BOOLEAN (value))
+        g_string_append_printf (key, "i%d", g_value_get_boolean (value) ? 1 : 0);
+      else if (G_VALUE_HOLDS_INT (value))
+        g_string_append_printf (key, "i%d", g_value_get_int (value));
+      else if (G_VALUE_HOLDS_UINT (value))
+        g_string_append_printf (key, "i%u", g_value_get_uint (value));
+      else if (G_VALUE_HOLDS_INT64 (value))
+        g_string_append_printf (key, "i%" G_GINT64_FORMAT, g_value_get_int64 (value));
+      else if (G_VALUE_HOLDS_UINT64 (value))
+        g_string_append_printf (key, "i%" G_GUINT64_FORMAT, g_value_get_uint64 (value));
+      else if (G_VALUE_HOLDS_ENUM (value))
+        g_string_append_printf (key, "i%d", g_value_get_enum (value));
+      else if (G_VALUE_HOLDS_DOUBLE (value))
+        g_string_append_printf (key, "d%a", g_value_get_double (value));
+      else if (G_VALUE_HOLDS_FLOAT (value))
+        g_string_append_printf (key, "d%a", (double)g_value_get_float (value));
+      else if (G_VALUE_HOLDS_STRING (value))
+        {
+          const char *str = g_value_get_string (value);
+
+          if (str == NULL)
+            g_string_append_c (key, 'N');
+          else
+            g_string_append_printf (key, "s%zu:%s", strlen (str), str);
+        }
+      else if (G_VALUE_HOLDS (value, G_TYPE_STRV) && g_value_get_boxed (value) != NULL)
+        {
+          g_autofree char *encoded = _gom_strv_to_text (g_value_get_boxed (value));
+
+          g_string_append_printf (key, "s%zu:%s", strlen (encoded), encoded);
+        }
+      else if (G_VALUE_HOLDS (value, G_TYPE_BYTES) && g_value_get_boxed (value) != NULL)
+        {
+          GBytes *bytes = g_value_get_boxed (value);
+          gsize size = 0;
+          const guint8 *data = g_bytes_get_data (bytes, &size);
+          g_autofree char *encoded = g_base64_encode (data, size);
+
+          g_string_append_printf (key, "b%s", encoded);
+        }
+      else if (G_VALUE_HOLDS_POINTER (value) && g_value_get_pointer (value) == NULL)
+        g_string_append_c (key, 'N');
+      else
+        return NULL;
+    }
+
+  return g_string_free (g_steal_pointer (&key), FALSE);
+}
+
+/* Reads PRAGMA data_version, which changes whenever another connection
+ * commits. It opens a read transaction, so when called inside BEGIN the
+ * value matches the snapshot later statements in that transaction see.
+ */
+static gboolean
+gom_sqlite_driver_get_data_version (GomSqliteConnection  *connection,
+                                    gint64               *data_version,
+                                    GError              **error)
+{
+  static const char sql[] = "PRAGMA data_version";
+  g_autoptr(GError) local_error = NULL;
+  sqlite3_stmt *stmt = NULL;
+  sqlite3 *db;
+  int rc;
+
+  g_assert (GOM_IS_SQLITE_CONNECTION (connection));
+  g_assert (data_version != NULL);
+
+  db = gom_sqlite_connection_get_native (connection);
+
+  rc = gom_sqlite_driver_prepare_cached (connection, sql, &stmt, "prepare data_version", &local_error);
+  if (rc != SQLITE_OK)
+    {
+      if (local_error == NULL)
+        g_set_error (&local_error,
+                     GOM_ERROR,
+                     GOM_ERROR_PREPARE_FAILED,
+                     "Failed to prepare data_version: %s",
+                     sqlite3_errmsg (db));
+      g_propagate_error (error, g_steal_pointer (&local_error));
+      return FALSE;
+    }
+
+  rc = gom_sqlite_driver_step (stmt, "step data_version", &local_error);
+  if (rc != SQLITE_ROW)
+    {
+      sqlite3_finalize (stmt);
+      if (local_error == NULL)
+        g_set_error (&local_error,
+                     GOM_ERROR,
+                     GOM_ERROR_FAILED,
+                     "SQLite data_version failed: %s",
+                     sqlite3_errmsg (db));
+      g_propagate_error (error, g_steal_pointer (&local_error));
+      return FALSE;
+    }
+
+  *data_version = sqlite3_column_int64 (stmt, 0);
+
+  gom_sqlite_connection_cache_statement (connection, sql, stmt);
+
+  return TRUE;
+}
+
+static gboolean
+gom_sqlite_driver_count_rows (GomSqliteConnection  *connection,
+                              const char           *sql,
+                              GPtrArray            *bindings,
+                              guint64              *count,
+                              GError              **error)
+{
+  g_autoptr(GError) local_error = NULL;
+  sqlite3_stmt *stmt = NULL;
+  sqlite3 *db;
+  int rc;
+
+  g_assert (GOM_IS_SQLITE_CONNECTION (connection));
+  g_assert (sql != NULL);
+  g_assert (count != NULL);
+
+  db = gom_sqlite_connection_get_native (connection);
+
+  rc = gom_sqlite_driver_prepare_cached (connection,
+                                         sql,
+                                         &stmt,
+                                         "prepare count statement",
+                                         &local_error);
+  if (rc != SQLITE_OK)
+    {
+      if (local_error == NULL)
+        g_set_error (&local_error,
+                     GOM_ERROR,
+                     GOM_ERROR_PREPARE_FAILED,
+                     "Failed to prepare count statement: %s",
+                     sqlite3_errmsg (db));
+      g_propagate_error (error, g_steal_pointer (&local_error));
+      return FALSE;
+    }
+
+  for (guint i = 0; bindings != NULL && i < bindings->len; i++)
+    {
+      if (!gom_sqlite_driver_bind_value (stmt, i + 1, g_ptr_array_index (bindings, i), error))
+        {
+          sqlite3_finalize (stmt);
+          return FALSE;
+        }
+    }
+
+  rc = gom_sqlite_driver_step (stmt, "step count statement", &local_error);
+  if (rc != SQLITE_ROW)
+    {
+      sqlite3_finalize (stmt);
+      if (local_error == NULL)
+        g_set_error (&local_error,
+                     GOM_ERROR,
+                     GOM_ERROR_FAILED,
+                     "SQLite count failed: %s",
+                     sqlite3_errmsg (db));
+      g_propagate_error (error, g_steal_pointer (&local_error));
+      return FALSE;
+    }
+
+  *count = (guint64)sqlite3_column_int64 (stmt, 0);
+
+  gom_sqlite_connection_cache_statement (connection, sql, stmt);
+
+  return TRUE;
+}
+
 static gboolean
 gom_sqlite_driver_collect_table_info (sqlite3     *db,
                                       const char  *relation,
@@ -2957,6 +3216,10 @@ gom_sqlite_driver_expression_requires_fts (GomExpression *expression,
     return gom_sqlite_driver_expression_requires_fts (_gom_unary_expression_get_operand (GOM_UNARY_EXPRESSION (expression)),
                                                       entity);
 
+  if (GOM_IS_IN_EXPRESSION (expression))
+    return gom_sqlite_driver_expression_requires_fts (_gom_in_expression_get_target (GOM_IN_EXPRESSION (expression)),
+                                                      entity);
+
   if (GOM_IS_BINARY_EXPRESSION (expression))
     {
       if (gom_sqlite_driver_expression_requires_fts (_gom_binary_expression_get_left (GOM_BINARY_EXPRESSION (expression)),
@@ -2996,6 +3259,9 @@ gom_sqlite_driver_expression_contains_search (GomExpression *expression)
   if (GOM_IS_UNARY_EXPRESSION (expression))
     return gom_sqlite_driver_expression_contains_search (_gom_unary_expression_get_operand (GOM_UNARY_EXPRESSION (expression)));
 
+  if (GOM_IS_IN_EXPRESSION (expression))
+    return gom_sqlite_driver_expression_contains_search (_gom_in_expression_get_target (GOM_IN_EXPRESSION (expression)));
+
   if (GOM_IS_BINARY_EXPRESSION (expression))
     {
       if (gom_sqlite_driver_expression_contains_search (_gom_binary_expression_get_left (GOM_BINARY_EXPRESSION (expression))))
@@ -3212,6 +3478,138 @@ gom_sqlite_driver_resolve_entity_field (GomEntitySpec  *entity,
   return NULL;
 }
 
+static void
+gom_sqlite_json_append_string (GString    *json,
+                               const char *str)
+{
+  g_string_append_c (json, '"');
+
+  for (const char *iter = str; *iter; iter++)
+    {
+      guchar ch = *iter;
+
+      switch (ch)
+        {
+        case '"':
+          g_string_append (json, "\\\"");
+          break;
+
+        case '\\':
+          g_string_append (json, "\\\\");
+          break;
+
+        default:
+          if (ch < 0x20)
+            g_string_append_printf (json, "\\u%04x", ch);
+          else
+            g_string_append_c (json, ch);
+          break;
+        }
+    }
+
+  g_string_append_c (json, '"');
+}
+
+/* Encodes the values of an IN expression as a JSON array so that the
+ * whole set can be bound to a single parameter and expanded again with
+ * json_each(). json_each() yields integers, reals, text and NULL with
+ * the same storage classes that gom_sqlite_driver_bind_value() would use
+ * for each value, so comparisons behave as if every value were bound on
+ * its own.
+ *
+ * Returns %NULL if a value has no faithful JSON representation (blobs,
+ * non-finite doubles, invalid UTF-8), in which case the caller should
+ * bind the values individually.
+ */
+static char *
+gom_sqlite_driver_encode_in_values (GArray *values)
+{
+  g_autoptr(GString) json = g_string_new ("[");
+
+  for (guint i = 0; i < values->len; i++)
+    {
+      const GValue *value = &g_array_index (values, GValue, i);
+
+      if (i > 0)
+        g_string_append_c (json, ',');
+
+      if (G_VALUE_TYPE (value) == G_TYPE_INVALID)
+        g_string_append (json, "null");
+      else if (G_VALUE_HOLDS_BOOLEAN (value))
+        g_string_append_c (json, g_value_get_boolean (value) ? '1' : '0');
+      else if (G_VALUE_HOLDS_INT (value))
+        g_string_append_printf (json, "%d", g_value_get_int (value));
+      else if (G_VALUE_HOLDS_UINT (value))
+        g_string_append_printf (json, "%u", g_value_get_uint (value));
+      else if (G_VALUE_HOLDS_INT64 (value))
+        g_string_append_printf (json, "%" G_GINT64_FORMAT, g_value_get_int64 (value));
+      else if (G_VALUE_HOLDS_UINT64 (value))
+        {
+          if (g_value_get_uint64 (value) > G_MAXINT64)
+            return NULL;
+
+          g_string_append_printf (json, "%" G_GUINT64_FORMAT, g_value_get_uint64 (value));
+        }
+      else if (G_VALUE_HOLDS_DOUBLE (value) || G_VALUE_HOLDS_FLOAT (value))
+        {
+          char buf[G_ASCII_DTOSTR_BUF_SIZE];
+          double v;
+
+          if (G_VALUE_HOLDS_DOUBLE (value))
+            v = g_value_get_double (value);
+          else
+            v = g_value_get_float (value);
+
+          if (!isfinite (v))
+            return NULL;
+
+          g_string_append (json, g_ascii_dtostr (buf, sizeof buf, v));
+        }
+      else if (G_VALUE_HOLDS_ENUM (value))
+        g_string_append_printf (json, "%d", g_value_get_enum (value));
+      else if (G_VALUE_HOLDS_STRING (value))
+        {
+          const char *str = g_value_get_string (value);
+
+          if (str == NULL)
+            g_string_append (json, "null");
+          else if (!g_utf8_validate (str, -1, NULL))
+            return NULL;
+          else
+            gom_sqlite_json_append_string (json, str);
+        }
+      else if (G_VALUE_HOLDS (value, G_TYPE_DATE_TIME))
+        {
+          GDateTime *dt = g_value_get_boxed (value);
+          g_autofree char *iso8601 = NULL;
+
+          if (dt == NULL)
+            g_string_append (json, "null");
+          else if (!(iso8601 = g_date_time_format_iso8601 (dt)))
+            return NULL;
+          else
+            gom_sqlite_json_append_string (json, iso8601);
+        }
+      else if (G_VALUE_HOLDS (value, G_TYPE_GTYPE))
+        {
+          const char *type_name = g_type_name (g_value_get_gtype (value));
+
+          if (type_name == NULL || *type_name == '\0')
+            g_string_append (json, "null");
+          else
+            gom_sqlite_json_append_string (json, type_name);
+        }
+      else if (G_VALUE_HOLDS_POINTER (value) && g_value_get_pointer (value) == NULL)
+        g_string_append (json, "null");
+      else
+        return NULL;
+    }
+
+  g_string_append_c (json, ']');
+
+  return g_string_free (g_steal_pointer (&json), FALSE);
+}
+
 static gboolean
 gom_sqlite_driver_append_expression_with_context (GomExpression                     *expression,
                                                   GString                           *sql,
@@ -3372,6 +3770,58 @@ gom_sqlite_driver_append_expression_with_context (GomExpression
 #endif
     }
 
+  if (GOM_IS_IN_EXPRESSION (expression))
+    {
+      GomExpression *target = _gom_in_expression_get_target (GOM_IN_EXPRESSION (expression));
+      GArray *values = _gom_in_expression_get_values (GOM_IN_EXPRESSION (expression));
+      g_autofree char *json = NULL;
+
+      if (target == NULL)
+        {
+          g_set_error_literal (error,
+                               G_IO_ERROR,
+                               G_IO_ERROR_INVALID_ARGUMENT,
+                               "IN expression requires a target");
+          return FALSE;
+        }
+
+      g_string_append_c (sql, '(');
+
+      if (!gom_sqlite_driver_append_expression_with_context (target, sql, bindings, error, context))
+        return FALSE;
+
+      /* The set travels as one JSON array so the statement text does not
+       * depend on the number of values and stays in the statement cache.
+       */
+      if ((json = gom_sqlite_driver_encode_in_values (values)))
+        {
+          g_auto(GValue) binding_value = G_VALUE_INIT;
+
+          g_string_append (sql, " IN (SELECT value FROM json_each(?))");
+          g_value_init (&binding_value, G_TYPE_STRING);
+          g_value_take_string (&binding_value, g_steal_pointer (&json));
+          g_ptr_array_add (bindings, gom_sqlite_binding_new (&binding_value));
+        }
+      else
+        {
+          g_string_append (sql, " IN (");
+
+          for (guint i = 0; i < values->len; i++)
+            {
+              if (i > 0)
+                g_string_append (sql, ", ");
+
+              g_string_append_c (sql, '?');
+              g_ptr_array_add (bindings, gom_sqlite_binding_new (&g_array_index (values, GValue, i)));
+            }
+
+          g_string_append_c (sql, ')');
+        }
+
+      g_string_append_c (sql, ')');
+      return TRUE;
+    }
+
   if (GOM_IS_SEARCH_EXPRESSION (expression))
     {
       GomExpression *target = _gom_search_expression_get_target (GOM_SEARCH_EXPRESSION (expression));
@@ -3833,6 +4283,7 @@ gom_sqlite_driver_query_thread (gpointer user_data)
   g_autoptr(GomSqliteStatement) statement = NULL;
   g_autoptr(GPtrArray) bindings = NULL;
   g_autoptr(GPtrArray) count_bindings = NULL;
+  g_autofree char *count_key = NULL;
   GomSqliteConnection *connection;
   GomExpression *filter;
   GomExpression *group_filter;
@@ -3851,9 +4302,9 @@ gom_sqlite_driver_query_thread (gpointer user_data)
   gboolean use_fts = FALSE;
   gboolean relation_is_fts = FALSE;
   sqlite3 *db = NULL;
-  sqlite3_stmt *count_stmt = NULL;
   sqlite3_stmt *stmt = NULL;
   int rc;
+  gint64 data_version = 0;
   guint64 count = 0;
   gboolean has_count = FALSE;
   gboolean owns_transaction = FALSE;
@@ -3947,57 +4398,35 @@ gom_sqlite_driver_query_thread (gpointer user_data)
           owns_transaction = TRUE;
         }
 
-      rc = gom_sqlite_driver_prepare (db,
-                                      count_sql->str,
-                                      &count_stmt,
-                                      "prepare count statement",
-                                      &error);
-      if (rc != SQLITE_OK)
+      /* Counting runs the whole query a second time, so reuse an earlier
+       * count when nothing has been committed or written since.
+       */
+      count_key = gom_sqlite_driver_dup_count_key (count_sql->str, count_bindings);
+
+      if (count_key != NULL &&
+          !gom_sqlite_driver_get_data_version (connection, &data_version, &error))
         {
           gom_sqlite_driver_exec_sql (db, "ROLLBACK", "rollback query transaction", NULL);
-          if (error != NULL)
-            return dex_future_new_for_error (g_steal_pointer (&error));
-
-          return dex_future_new_reject (GOM_ERROR,
-                                        GOM_ERROR_PREPARE_FAILED,
-                                        "Failed to prepare count statement: %s",
-                                        sqlite3_errmsg (db));
+          return dex_future_new_for_error (g_steal_pointer (&error));
         }
 
-      for (guint i = 0; i < count_bindings->len; i++)
+      if (count_key != NULL &&
+          gom_sqlite_connection_lookup_count (connection, count_key, data_version, &count))
         {
-          if (!gom_sqlite_driver_bind_value (count_stmt,
-                                             i + 1,
-                                             g_ptr_array_index (count_bindings, i),
-                                             &error))
-            {
-              sqlite3_finalize (count_stmt);
-              gom_sqlite_driver_exec_sql (db, "ROLLBACK", "rollback query transaction", NULL);
-              return dex_future_new_for_error (g_steal_pointer (&error));
-            }
+          has_count = TRUE;
         }
-
-      rc = gom_sqlite_driver_step (count_stmt, "step count statement", &error);
-      if (rc == SQLITE_ROW)
+      else if (gom_sqlite_driver_count_rows (connection, count_sql->str, count_bindings, &count, &error))
         {
-          count = (guint64)sqlite3_column_int64 (count_stmt, 0);
           has_count = TRUE;
+
+          if (count_key != NULL)
+            gom_sqlite_connection_cache_count (connection, count_key, data_version, count);
         }
       else
         {
-          sqlite3_finalize (count_stmt);
           gom_sqlite_driver_exec_sql (db, "ROLLBACK", "rollback query transaction", NULL);
-          if (error != NULL)
-            return dex_future_new_for_error (g_steal_pointer (&error));
-
-          return dex_future_new_reject (GOM_ERROR,
-                                        GOM_ERROR_FAILED,
-                                        "SQLite count failed: %s",
-                                        sqlite3_errmsg (db));
+          return dex_future_new_for_error (g_steal_pointer (&error));
         }
-
-      sqlite3_finalize (count_stmt);
-      count_stmt = NULL;
     }
 
   if (!gom_sqlite_driver_build_query_sql (task->query,
@@ -4025,7 +4454,7 @@ gom_sqlite_driver_query_thread (gpointer user_data)
       db = gom_sqlite_connection_get_native (connection);
     }
 
-  rc = gom_sqlite_driver_prepare (db, sql->str, &stmt, "prepare query statement", &error);
+  rc = gom_sqlite_driver_prepare_cached (connection, sql->str, &stmt, "prepare query statement", &error);
   if (rc != SQLITE_OK)
     {
       if (owns_transaction)
@@ -4054,7 +4483,7 @@ gom_sqlite_driver_query_thread (gpointer user_data)
         }
     }
 
-  statement = gom_sqlite_statement_new (task->lease_state, g_steal_pointer (&stmt));
+  statement = gom_sqlite_statement_new (task->lease_state, g_steal_pointer (&stmt), sql->str);
   GOM_TRACE_END_MARK (start_time,
                       "Query",
                       "execute",
@@ -4120,7 +4549,7 @@ gom_sqlite_driver_query (GomDriver      *driver,
   request->repository = g_object_ref (repository);
   request->flags = flags;
 
-  return dex_future_then (gom_sqlite_pool_acquire (self->pool),
+  return dex_future_then (gom_sqlite_pool_acquire_reader (self->pool),
                           gom_sqlite_driver_query_cb,
                           request,
                           gom_sqlite_query_request_free);
@@ -4174,7 +4603,7 @@ gom_sqlite_driver_describe_relation (GomDriver   *driver,
   if (entity != NULL && gom_entity_spec_get_table ((GomEntitySpec *)entity) != NULL)
     resolved_relation = gom_entity_spec_get_table ((GomEntitySpec *)entity);
 
-  return dex_future_then (gom_sqlite_pool_acquire (self->pool),
+  return dex_future_then (gom_sqlite_pool_acquire_reader (self->pool),
                           gom_sqlite_driver_describe_cb,
                           g_strdup (resolved_relation),
                           g_free);
@@ -4283,7 +4712,7 @@ gom_sqlite_driver_list_relations (GomDriver   *driver,
 
   g_assert (GOM_IS_REGISTRY (registry));
 
-  return dex_future_then (gom_sqlite_pool_acquire (self->pool),
+  return dex_future_then (gom_sqlite_pool_acquire_reader (self->pool),
                           gom_sqlite_driver_list_relations_cb,
                           NULL,
                           NULL);
@@ -4369,7 +4798,7 @@ gom_sqlite_driver_query_version (GomDriver *driver)
 {
   GomSqliteDriver *self = GOM_SQLITE_DRIVER (driver);
 
-  return dex_future_then (gom_sqlite_pool_acquire (self->pool),
+  return dex_future_then (gom_sqlite_pool_acquire_reader (self->pool),
                           gom_sqlite_driver_query_version_cb,
                           NULL,
                           NULL);
@@ -4420,6 +4849,9 @@ gom_sqlite_driver_migrate_thread (gpointer user_data)
       return dex_future_new_for_error (g_steal_pointer (&error));
     }
 
+  gom_sqlite_connection_clear_statements (connection);
+  gom_sqlite_pool_invalidate_statements (gom_sqlite_lease_state_get_pool (task->lease_state));
+
   GOM_TRACE_END_MARK (start_time,
                       "Migration",
                       "apply",
@@ -4535,6 +4967,9 @@ gom_sqlite_driver_execute_sql_thread (gpointer user_data)
       return dex_future_new_for_error (g_steal_pointer (&error));
     }
 
+  gom_sqlite_connection_clear_statements (connection);
+  gom_sqlite_pool_invalidate_statements (gom_sqlite_lease_state_get_pool (task->lease_state));
+
   GOM_TRACE_END_MARK (start_time, "SQLite", "execute", "script");
   return dex_future_new_true ();
 }
@@ -4704,7 +5139,7 @@ gom_sqlite_driver_begin_session_acquired_cb (DexFuture *completed,
     return dex_future_new_for_error (g_steal_pointer (&error));
 
   write_limiter = dex_ref (request->write_limiter);
-  future = dex_future_then (gom_sqlite_pool_acquire (state->pool),
+  future = dex_future_then (gom_sqlite_pool_acquire_writer (state->pool),
                             gom_sqlite_driver_begin_session_cb,
                             g_steal_pointer (&state->request),
                             gom_sqlite_session_request_free);
@@ -4992,6 +5427,10 @@ gom_sqlite_driver_insertion_thread (GomSqliteMutationTask *task)
   GomInsertion *insertion;
   g_autoptr(GError) error = NULL;
   g_autoptr(GomMutationResult) result = NULL;
+  g_autoptr(GString) prefix_sql = NULL;
+  g_autoptr(GString) row_sql = NULL;
+  g_autoptr(GString) stmt_sql = NULL;
+  g_autoptr(GPtrArray) column_bindings = NULL;
   g_autofree char *relation = NULL;
   const GomEntitySpec *entity = NULL;
   GomSqliteExpressionContext expression_context = { 0 };
@@ -5003,6 +5442,7 @@ gom_sqlite_driver_insertion_thread (GomSqliteMutationTask *task)
   GomRegistry *registry;
   sqlite3 *db;
   sqlite3_stmt *stmt = NULL;
+  guint n_prepared = 0;
   int rc;
   gint64 start_time = GOM_TRACE_BEGIN_MARK ();
 
@@ -5065,10 +5505,31 @@ gom_sqlite_driver_insertion_thread (GomSqliteMutationTask *task)
                                    &error))
     return dex_future_new_for_error (g_steal_pointer (&error));
 
+  /* The column list is identical for every row, so render it once. Rows
+   * bind their values as parameters and therefore almost always render to
+   * the same SQL text, which lets us keep a single prepared statement and
+   * only rebind it per row. A new statement is prepared only when a row
+   * renders differently (e.g. a non-literal expression in one of them).
+   */
+  prefix_sql = g_string_new ("INSERT INTO ");
+  column_bindings = g_ptr_array_new_with_free_func (gom_sqlite_binding_free);
+  gom_sqlite_driver_append_quoted_identifier_path (prefix_sql, relation);
+
+  g_string_append (prefix_sql, " (");
+  if (!gom_sqlite_driver_append_expression_list_with_context (columns,
+                                                              prefix_sql,
+                                                              column_bindings,
+                                                              &error,
+                                                              expression_context_ptr))
+    goto rollback_insert;
+  g_string_append (prefix_sql, ") VALUES (");
+
+  row_sql = g_string_new (NULL);
+  stmt_sql = g_string_new (NULL);
+
   for (guint i = 0; i < rows->len; i++)
     {
       GPtrArray *row = g_ptr_array_index (rows, i);
-      g_autoptr(GString) row_sql = NULL;
       g_autoptr(GPtrArray) row_bindings = NULL;
 
       if (row->len != columns->len)
@@ -5080,57 +5541,64 @@ gom_sqlite_driver_insertion_thread (GomSqliteMutationTask *task)
           goto rollback_insert;
         }
 
-      row_sql = g_string_new ("INSERT INTO ");
+      g_string_truncate (row_sql, 0);
+      g_string_append_len (row_sql, prefix_sql->str, prefix_sql->len);
       row_bindings = g_ptr_array_new_with_free_func (gom_sqlite_binding_free);
-      gom_sqlite_driver_append_quoted_identifier_path (row_sql, relation);
-
-      g_string_append (row_sql, " (");
-      if (!gom_sqlite_driver_append_expression_list_with_context (columns,
-                                                                  row_sql,
-                                                                  row_bindings,
-                                                                  &error,
-                                                                  expression_context_ptr))
-        goto rollback_insert;
-      g_string_append (row_sql, ") VALUES (");
 
       if (!gom_sqlite_driver_append_expression_list (row, row_sql, row_bindings, &error))
         goto rollback_insert;
 
       g_string_append_c (row_sql, ')');
 
-      rc = gom_sqlite_driver_prepare (db, row_sql->str, &stmt, "prepare insert statement", &error);
-      if (rc != SQLITE_OK)
+      if (stmt != NULL && g_string_equal (row_sql, stmt_sql))
         {
-          if (error != NULL)
-            goto rollback_insert;
+          sqlite3_reset (stmt);
+          sqlite3_clear_bindings (stmt);
+        }
+      else
+        {
+          if (stmt != NULL)
+            gom_sqlite_connection_cache_statement (connection, stmt_sql->str, g_steal_pointer (&stmt));
 
-          g_set_error (&error,
-                       GOM_ERROR,
-                       GOM_ERROR_PREPARE_FAILED,
-                       "Failed to prepare statement: %s",
-                       sqlite3_errmsg (db));
-          goto rollback_insert;
+          rc = gom_sqlite_driver_prepare_cached (connection, row_sql->str, &stmt, "prepare insert statement", &error);
+          if (rc != SQLITE_OK)
+            {
+              if (error != NULL)
+                goto rollback_insert;
+
+              g_set_error (&error,
+                           GOM_ERROR,
+                           GOM_ERROR_PREPARE_FAILED,
+                           "Failed to prepare statement: %s",
+                           sqlite3_errmsg (db));
+              goto rollback_insert;
+            }
+
+          g_string_assign (stmt_sql, row_sql->str);
+          n_prepared++;
         }
 
-      for (guint j = 0; j < row_bindings->len; j++)
+      for (guint j = 0; j < column_bindings->len; j++)
         {
           if (!gom_sqlite_driver_bind_value (stmt,
                                              j + 1,
+                                             g_ptr_array_index (column_bindings, j),
+                                             &error))
+            goto rollback_insert;
+        }
+
+      for (guint j = 0; j < row_bindings->len; j++)
+        {
+          if (!gom_sqlite_driver_bind_value (stmt,
+                                             column_bindings->len + j + 1,
                                              g_ptr_array_index (row_bindings, j),
                                              &error))
-            {
-              sqlite3_finalize (stmt);
-              stmt = NULL;
-              goto rollback_insert;
-            }
+            goto rollback_insert;
         }
 
       rc = gom_sqlite_driver_step (stmt, "step insert statement", &error);
       if (rc != SQLITE_DONE)
         {
-          sqlite3_finalize (stmt);
-          stmt = NULL;
-
           if (error == NULL)
             {
               if ((rc & 0xff) == SQLITE_CONSTRAINT)
@@ -5150,17 +5618,13 @@ gom_sqlite_driver_insertion_thread (GomSqliteMutationTask *task)
           goto rollback_insert;
         }
 
-      if (stmt != NULL)
-        {
-          sqlite3_finalize (stmt);
-          stmt = NULL;
-        }
-
       gom_sqlite_driver_mutation_result_append_changes_rowid (result,
                                                               (guint64) sqlite3_changes (db),
                                                               (gint64) sqlite3_last_insert_rowid (db));
     }
 
+  gom_sqlite_connection_cache_statement (connection, stmt_sql->str, g_steal_pointer (&stmt));
+
   if (!gom_sqlite_driver_exec_sql (db,
                                    "RELEASE SAVEPOINT gom_sqlite_insert",
                                    "commit insert transaction",
@@ -5170,7 +5634,13 @@ gom_sqlite_driver_insertion_thread (GomSqliteMutationTask *task)
       return dex_future_new_for_error (g_steal_pointer (&error));
     }
 
-  GOM_TRACE_END_MARK (start_time, "Mutation", "insert", "relation=%s rows=%u", relation, rows->len);
+  GOM_TRACE_END_MARK (start_time,
+                      "Mutation",
+                      "insert",
+                      "relation=%s rows=%u statements=%u",
+                      relation,
+                      rows->len,
+                      n_prepared);
   return dex_future_new_take_object (g_steal_pointer (&result));
 
 rollback_insert:
@@ -5336,7 +5806,7 @@ gom_sqlite_driver_update_thread (GomSqliteMutationTask *task)
   connection = gom_sqlite_lease_state_get_connection (task->lease_state);
   db = gom_sqlite_connection_get_native (connection);
 
-  rc = gom_sqlite_driver_prepare (db, sql->str, &stmt, "prepare update statement", &error);
+  rc = gom_sqlite_driver_prepare_cached (connection, sql->str, &stmt, "prepare update statement", &error);
   if (rc != SQLITE_OK)
     {
       GOM_TRACE_END_MARK (start_time, "Mutation", "update", "prepare failed");
@@ -5372,11 +5842,7 @@ gom_sqlite_driver_update_thread (GomSqliteMutationTask *task)
                                     sqlite3_errmsg (db));
     }
 
-  if (stmt != NULL)
-    {
-      sqlite3_finalize (stmt);
-      stmt = NULL;
-    }
+  gom_sqlite_connection_cache_statement (connection, sql->str, g_steal_pointer (&stmt));
   result = _gom_mutation_result_new ();
   gom_sqlite_driver_mutation_result_append_changes_only (result, (guint64)sqlite3_changes (db));
   GOM_TRACE_END_MARK (start_time, "Mutation", "update", "relation=%s", relation);
@@ -5481,7 +5947,7 @@ gom_sqlite_driver_deletion_thread (GomSqliteMutationTask *task)
   connection = gom_sqlite_lease_state_get_connection (task->lease_state);
   db = gom_sqlite_connection_get_native (connection);
 
-  rc = gom_sqlite_driver_prepare (db, sql->str, &stmt, "prepare delete statement", &error);
+  rc = gom_sqlite_driver_prepare_cached (connection, sql->str, &stmt, "prepare delete statement", &error);
   if (rc != SQLITE_OK)
     {
       GOM_TRACE_END_MARK (start_time, "Mutation", "delete", "prepare failed");
@@ -5517,11 +5983,7 @@ gom_sqlite_driver_deletion_thread (GomSqliteMutationTask *task)
                                     sqlite3_errmsg (db));
     }
 
-  if (stmt != NULL)
-    {
-      sqlite3_finalize (stmt);
-      stmt = NULL;
-    }
+  gom_sqlite_connection_cache_statement (connection, sql->str, g_steal_pointer (&stmt));
   result = _gom_mutation_result_new ();
   gom_sqlite_driver_mutation_result_append_changes_only (result, (guint64)sqlite3_changes (db));
   GOM_TRACE_END_MARK (start_time, "Mutation", "delete", "relation=%s", relation);
@@ -5529,10 +5991,8 @@ gom_sqlite_driver_deletion_thread (GomSqliteMutationTask *task)
 }
 
 static DexFuture *
-gom_sqlite_driver_mutate_thread (gpointer user_data)
+gom_sqlite_driver_apply_mutation (GomSqliteMutationTask *task)
 {
-  GomSqliteMutationTask *task = user_data;
-
   g_assert (task != NULL);
   g_assert (task->lease_state != NULL);
   g_assert (GOM_IS_MUTATION (task->mutation));
@@ -5555,6 +6015,31 @@ gom_sqlite_driver_mutate_thread (gpointer user_data)
                                 G_OBJECT_TYPE_NAME (task->mutation));
 }
 
+static DexFuture *
+gom_sqlite_driver_mutate_thread (gpointer user_data)
+{
+  GomSqliteMutationTask *task = user_data;
+  GomSqliteConnection *connection;
+  DexFuture *future;
+  guint change_mark;
+
+  g_assert (task != NULL);
+  g_assert (task->lease_state != NULL);
+
+  connection = gom_sqlite_lease_state_get_connection (task->lease_state);
+  change_mark = gom_sqlite_connection_get_change_mark (connection);
+
+  future = gom_sqlite_driver_apply_mutation (task);
+
+  /* A failed statement, or ROLLBACK TO the savepoint the caller wrapped
+   * us in, undoes rows the update hook already reported.
+   */
+  if (dex_future_is_rejected (future))
+    gom_sqlite_connection_discard_changes (connection, change_mark);
+
+  return future;
+}
+
 static DexFuture *
 gom_sqlite_driver_mutate_cb (DexFuture *completed,
                              gpointer   user_data)
@@ -5582,6 +6067,245 @@ gom_sqlite_driver_mutate_cb (DexFuture *completed,
   }
 }
 
+static void
+gom_sqlite_group_commit_item_free (gpointer data)
+{
+  GomSqliteGroupCommitItem *item = data;
+
+  g_clear_pointer (&item->request, gom_sqlite_mutation_request_free);
+  dex_clear (&item->promise);
+  g_clear_object (&item->result);
+  g_clear_error (&item->error);
+  g_free (item);
+}
+
+static void
+gom_sqlite_group_commit_free (GomSqliteGroupCommit *group)
+{
+  g_clear_object (&group->driver);
+  dex_clear (&group->acquire);
+  dex_clear (&group->full);
+  g_clear_pointer (&group->items, g_ptr_array_unref);
+  g_clear_pointer (&group->lease_state, gom_sqlite_lease_state_unref);
+  g_free (group);
+}
+
+static void
+gom_sqlite_driver_close_group_commit (GomSqliteDriver      *self,
+                                      GomSqliteGroupCommit *group)
+{
+  g_mutex_lock (&self->group_commit_mutex);
+  if (self->group_commit == group)
+    self->group_commit = NULL;
+  g_mutex_unlock (&self->group_commit_mutex);
+}
+
+static DexFuture *
+gom_sqlite_driver_group_commit_thread (gpointer user_data)
+{
+  GomSqliteGroupCommit *group = user_data;
+  g_autoptr(GError) error = NULL;
+  GomSqliteConnection *connection;
+  guint n_failed = 0;
+  sqlite3 *db;
+  gint64 start_time = GOM_TRACE_BEGIN_MARK ();
+
+  g_assert (group != NULL);
+  g_assert (group->lease_state != NULL);
+
+  connection = gom_sqlite_lease_state_get_connection (group->lease_state);
+  db = gom_sqlite_connection_get_native (connection);
+
+  if (!gom_sqlite_driver_exec_sql (db,
+                                   "BEGIN IMMEDIATE TRANSACTION",
+                                   "begin group commit transaction",
+                                   &error))
+    return dex_future_new_for_error (g_steal_pointer (&error));
+
+  /* Each mutation runs under its own savepoint so a failure only rolls
+   * back that mutation. The mutation threads complete synchronously, so
+   * their futures are already resolved when they return.
+   */
+  for (guint i = 0; i < group->items->len; i++)
+    {
+      GomSqliteGroupCommitItem *item = g_ptr_array_index (group->items, i);
+      GomSqliteMutationTask task = {
+        .lease_state = group->lease_state,
+        .mutation = item->request->mutation,
+        .registry = item->request->registry,
+      };
+      g_autoptr(DexFuture) future = NULL;
+      const GValue *value;
+
+      if (!gom_sqlite_driver_exec_sql (db,
+                                       "SAVEPOINT gom_sqlite_group_commit",
+                                       "begin group commit mutation",
+                                       &item->error))
+        {
+          n_failed++;
+          continue;
+        }
+
+      future = gom_sqlite_driver_mutate_thread (&task);
+
+      if ((value = dex_future_get_value (future, &item->error)))
+        {
+          item->result = g_value_dup_object (value);
+          gom_sqlite_driver_exec_sql (db,
+                                      "RELEASE SAVEPOINT gom_sqlite_group_commit",
+                                      "release group commit mutation",
+                                      NULL);
+          continue;
+        }
+
+      n_failed++;
+
+      /* Some errors (such as SQLITE_FULL or SQLITE_IOERR) make SQLite roll
+       * back the whole transaction, taking earlier mutations with it.
+       */
+      if (sqlite3_get_autocommit (db))
+        return dex_future_new_reject (GOM_ERROR,
+                                      GOM_ERROR_FAILED,
+                                      "Group commit transaction was rolled back: %s",
+                                      item->error->message);
+
+      gom_sqlite_driver_exec_sql (db,
+                                  "ROLLBACK TO SAVEPOINT gom_sqlite_group_commit",
+                                  "rollback group commit mutation",
+                                  NULL);
+      gom_sqlite_driver_exec_sql (db,
+                                  "RELEASE SAVEPOINT gom_sqlite_group_commit",
+                                  "release group commit mutation",
+                                  NULL);
+    }
+
+  if (!gom_sqlite_driver_exec_sql (db, "COMMIT", "commit group commit transaction", &error))
+    {
+      gom_sqlite_driver_exec_sql (db, "ROLLBACK", "rollback group commit transaction", NULL);
+      return dex_future_new_for_error (g_steal_pointer (&error));
+    }
+
+  GOM_TRACE_END_MARK (start_time,
+                      "Mutation",
+                      "group-commit",
+                      "mutations=%u failed=%u",
+                      group->items->len,
+                      n_failed);
+
+  return dex_future_new_true ();
+}
+
+static DexFuture *
+gom_sqlite_driver_group_commit_fiber (gpointer user_data)
+{
+  GomSqliteGroupCommit *group = user_data;
+  g_autoptr(GomSqliteLease) lease = NULL;
+  g_autoptr(GError) error = NULL;
+  GomSqliteDriver *self;
+
+  g_assert (group != NULL);
+  g_assert (GOM_IS_SQLITE_DRIVER (group->driver));
+
+  self = group->driver;
+
+  if (dex_await (dex_ref (group->acquire), &error))
+    {
+      dex_await (dex_future_first (dex_timeout_new_msec (self->group_commit_window_msec),
+                                   dex_ref (group->full),
+                                   NULL),
+                 NULL);
+
+      gom_sqlite_driver_close_group_commit (self, group);
+
+      if ((lease = dex_await_object (gom_sqlite_pool_acquire_writer (self->pool), &error)))
+        {
+          group->lease_state = gom_sqlite_lease_ref_state (lease);
+          dex_await (gom_sqlite_lease_state_invoke (group->lease_state,
+                                                    "[gom-sqlite-group-commit]",
+                                                    gom_sqlite_driver_group_commit_thread,
+                                                    group,
+                                                    NULL),
+                     &error);
+        }
+
+      g_clear_pointer (&group->lease_state, gom_sqlite_lease_state_unref);
+      g_clear_object (&lease);
+      dex_limiter_release (self->write_limiter);
+    }
+  else
+    {
+      gom_sqlite_driver_close_group_commit (self, group);
+    }
+
+  for (guint i = 0; i < group->items->len; i++)
+    {
+      GomSqliteGroupCommitItem *item = g_ptr_array_index (group->items, i);
+
+      if (error != NULL)
+        dex_promise_reject (item->promise, g_error_copy (error));
+      else if (item->error != NULL)
+        dex_promise_reject (item->promise, g_steal_pointer (&item->error));
+      else
+        dex_promise_resolve_object (item->promise, g_steal_pointer (&item->result));
+    }
+
+  return dex_future_new_true ();
+}
+
+/* Queues @request on the open group, starting a new group if there is
+ * none. The write lock is requested when the group starts so it keeps
+ * its place in line relative to other writers.
+ */
+static DexFuture *
+gom_sqlite_driver_group_commit (GomSqliteDriver          *self,
+                                GomSqliteMutationRequest *request)
+{
+  GomSqliteGroupCommitItem *item;
+  GomSqliteGroupCommit *group;
+  GomSqliteGroupCommit *spawn = NULL;
+  DexFuture *future;
+
+  g_assert (GOM_IS_SQLITE_DRIVER (self));
+  g_assert (request != NULL);
+
+  item = g_new0 (GomSqliteGroupCommitItem, 1);
+  item->request = request;
+  item->promise = dex_promise_new ();
+  future = dex_ref (DEX_FUTURE (item->promise));
+
+  g_mutex_lock (&self->group_commit_mutex);
+
+  if (self->group_commit == NULL)
+    {
+      group = g_new0 (GomSqliteGroupCommit, 1);
+      group->driver = g_object_ref (self);
+      group->acquire = dex_limiter_acquire (self->write_limiter);
+      group->full = dex_promise_new ();
+      group->items = g_ptr_array_new_with_free_func (gom_sqlite_group_commit_item_free);
+      self->group_commit = spawn = group;
+    }
+
+  group = self->group_commit;
+  g_ptr_array_add (group->items, item);
+
+  if (group->items->len >= self->group_commit_size)
+    {
+      self->group_commit = NULL;
+      dex_promise_resolve_boolean (group->full, TRUE);
+    }
+
+  g_mutex_unlock (&self->group_commit_mutex);
+
+  if (spawn != NULL)
+    dex_future_disown (dex_scheduler_spawn (NULL,
+                                            0,
+                                            gom_sqlite_driver_group_commit_fiber,
+                                            spawn,
+                                            (GDestroyNotify)gom_sqlite_group_commit_free));
+
+  return future;
+}
+
 static DexFuture *
 gom_sqlite_driver_mutate (GomDriver   *driver,
                           GomRegistry *registry,
@@ -5598,6 +6322,9 @@ gom_sqlite_driver_mutate (GomDriver   *driver,
   request->mutation = g_object_ref (mutation);
   request->registry = g_object_ref (registry);
 
+  if (self->group_commit_window_msec > 0)
+    return gom_sqlite_driver_group_commit (self, request);
+
   state = g_new0 (GomSqliteWriteState, 1);
   state->driver = g_object_ref (self);
   state->operation = GOM_SQLITE_WRITE_MUTATE;
@@ -5668,6 +6395,7 @@ gom_sqlite_driver_finalize (GObject *object)
   dex_clear (&self->write_limiter);
   g_clear_pointer (&self->encryption_key, g_bytes_unref);
   g_clear_pointer (&self->uri, g_free);
+  g_mutex_clear (&self->group_commit_mutex);
 
   G_OBJECT_CLASS (gom_sqlite_driver_parent_class)->finalize (object);
 }
@@ -5706,6 +6434,32 @@ static void
 gom_sqlite_driver_init (GomSqliteDriver *self)
 {
   self->write_limiter = dex_limiter_new (1);
+  g_mutex_init (&self->group_commit_mutex);
+}
+
+static void
+gom_sqlite_driver_weak_ref_free (GWeakRef *weak_ref)
+{
+  g_weak_ref_clear (weak_ref);
+  g_free (weak_ref);
+}
+
+static gboolean
+gom_sqlite_driver_wants_changes_func (gpointer user_data)
+{
+  g_autoptr(GomDriver) driver = g_weak_ref_get (user_data);
+
+  return driver != NULL && _gom_driver_wants_changes (driver);
+}
+
+static void
+gom_sqlite_driver_changes_func (GomChangeSet *changes,
+                                gpointer      user_data)
+{
+  g_autoptr(GomDriver) driver = g_weak_ref_get (user_data);
+
+  if (driver != NULL)
+    _gom_driver_post_changes (driver, changes);
 }
 
 G_MODULE_EXPORT GomDriver *
@@ -5715,13 +6469,43 @@ _gom_sqlite_driver_new (const char        *uri,
 {
   g_autoptr(GUri) guri = NULL;
   g_autoptr(GBytes) encryption_key = NULL;
+  GomSqliteConnectionConfig config = GOM_SQLITE_CONNECTION_CONFIG_INIT;
   GomSqliteDriver *self;
+  GWeakRef *weak_ref;
+  guint max_connections = 0;
+  guint max_concurrent_opens = 0;
+  guint checkpoint_interval = 0;
+  guint group_commit_window = 0;
+  guint group_commit_size = 0;
+  gint64 wal_size_limit = 0;
 
   if (uri == NULL || !(guri = g_uri_parse (uri, G_URI_FLAGS_NONE, error)))
     return NULL;
 
   if (options != NULL)
-    encryption_key = gom_driver_options_dup_encryption_key (options);
+    {
+      encryption_key = gom_driver_options_dup_encryption_key (options);
+      max_connections = gom_driver_options_get_max_connections (options);
+      max_concurrent_opens = gom_driver_options_get_max_concurrent_opens (options);
+
+      config.mmap_size = gom_driver_options_get_mmap_size (options);
+      config.busy_timeout_msec = gom_driver_options_get_busy_timeout (options);
+      config.cache_size = gom_driver_options_get_cache_size (options);
+      config.temp_store = (int)gom_driver_options_get_temp_store (options);
+      config.wal_autocheckpoint = gom_driver_options_get_wal_autocheckpoint (options);
+      config.cursor_spool_rows = gom_driver_options_get_cursor_spool_rows (options);
+
+      checkpoint_interval = gom_driver_options_get_checkpoint_interval (options);
+      wal_size_limit = gom_driver_options_get_wal_size_limit (options);
+      group_commit_window = gom_driver_options_get_group_commit_window (options);
+      group_commit_size = gom_driver_options_get_group_commit_size (options);
+
+      /* The background checkpointer replaces checkpoints on commit unless
+       * the caller explicitly asked for both.
+       */
+      if (checkpoint_interval > 0 && config.wal_autocheckpoint < 0)
+        config.wal_autocheckpoint = 0;
+    }
 
   if (sqlite3_initialize () != SQLITE_OK)
     {
@@ -5734,9 +6518,26 @@ _gom_sqlite_driver_new (const char        *uri,
 
   self = g_object_new (GOM_TYPE_SQLITE_DRIVER, NULL);
   self->uri = g_strdup (uri);
+  self->group_commit_window_msec = group_commit_window;
+  self->group_commit_size = group_commit_size ? group_commit_size : GOM_SQLITE_GROUP_COMMIT_DEFAULT_SIZE;
   if (encryption_key != NULL)
     self->encryption_key = g_bytes_ref (encryption_key);
-  self->pool = gom_sqlite_pool_new (uri, encryption_key);
+  self->pool = gom_sqlite_pool_new (uri,
+                                   encryption_key,
+                                   max_connections,
+                                   max_concurrent_opens,
+                                   &config);
+
+  if (checkpoint_interval > 0)
+    gom_sqlite_pool_start_checkpointer (self->pool, checkpoint_interval, wal_size_limit);
+
+  weak_ref = g_new0 (GWeakRef, 1);
+  g_weak_ref_init (weak_ref, self);
+  gom_sqlite_pool_set_changes_func (self->pool,
+                                    gom_sqlite_driver_wants_changes_func,
+                                    gom_sqlite_driver_changes_func,
+                                    weak_ref,
+                                    (GDestroyNotify)gom_sqlite_driver_weak_ref_free);
 
   return GOM_DRIVER (g_steal_pointer (&self));
 }
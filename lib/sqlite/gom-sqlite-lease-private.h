@@ -37,6 +37,7 @@ GomSqliteLeaseState *gom_sqlite_lease_state_ref            (GomSqliteLeaseState
 GomSqliteLeaseState *gom_sqlite_lease_ref_state            (GomSqliteLease      *self);
 void                 gom_sqlite_lease_state_unref          (GomSqliteLeaseState *state);
 GomSqliteConnection *gom_sqlite_lease_state_get_connection (GomSqliteLeaseState *state);
+GomSqlitePool       *gom_sqlite_lease_state_get_pool       (GomSqliteLeaseState *state);
 DexFuture           *gom_sqlite_lease_state_invoke         (GomSqliteLeaseState *state,
                                                             const char          *thread_name,
                                                             DexThreadFunc        thread_func,
@@ -23,30 +23,31 @@
 #include <glib.h>
 #include <gio/gio.h>
 
+#include "gom-change-set.h"
 #include "gom-sqlite-connection-private.h"
 #include "gom-sqlite-lease-private.h"
 #include "gom-sqlite-pool-private.h"
+#include "gom-trace-private.h"
 
+/* Work for a lease runs on the worker thread of the leased connection.
+ * Each message holds a reference to the lease state so the connection
+ * is not returned to the pool while work for it is still queued.
+ */
 typedef struct
 {
-  DexThreadFunc   thread_func;
-  gpointer        user_data;
-  GDestroyNotify  user_data_destroy;
-  DexPromise     *promise;
+  GomSqliteLeaseState *state;
+  const char          *name;
+  DexThreadFunc        thread_func;
+  gpointer             user_data;
+  GDestroyNotify       user_data_destroy;
+  DexPromise          *promise;
 } GomSqliteLeaseInvokeMessage;
 
-#define GOM_SQLITE_LEASE_STOP_MESSAGE ((gpointer) GINT_TO_POINTER (1))
-
 struct _GomSqliteLeaseState
 {
   gatomicrefcount      ref_count;
-  GMutex               mutex;
-  GAsyncQueue         *queue;
   GomSqliteConnection *connection;
   GomSqlitePool       *pool;
-  gboolean             worker_started;
-  gboolean             shutting_down;
-  gboolean             disposed;
 };
 
 struct _GomSqliteLease
@@ -61,14 +62,13 @@ struct _GomSqliteLeaseClass
 };
 
 static GomSqliteLeaseState *gom_sqlite_lease_state_ref_internal (GomSqliteLeaseState *state);
-static gpointer             gom_sqlite_lease_worker_thread      (gpointer             user_data);
 
 static void
 gom_sqlite_lease_invoke_message_free (gpointer data)
 {
   GomSqliteLeaseInvokeMessage *message = data;
 
-  if (message == NULL || message == GOM_SQLITE_LEASE_STOP_MESSAGE)
+  if (message == NULL)
     return;
 
   if (message->user_data_destroy != NULL)
@@ -76,14 +76,21 @@ gom_sqlite_lease_invoke_message_free (gpointer data)
 
   if (message->promise != NULL)
     dex_unref (message->promise);
+
+  /* Last, as this may return the connection to the pool */
+  if (message->state != NULL)
+    gom_sqlite_lease_state_unref (message->state);
+
   g_free (message);
 }
 
 static void
 gom_sqlite_lease_invoke_message_complete (GomSqliteLeaseInvokeMessage *message)
 {
+  g_autoptr(GomChangeSet) changes = NULL;
   g_autoptr(GError) error = NULL;
   DexFuture *future;
+  gboolean succeeded;
 
   g_assert (message != NULL);
   g_assert (DEX_IS_PROMISE (message->promise));
@@ -98,6 +105,12 @@ gom_sqlite_lease_invoke_message_complete (GomSqliteLeaseInvokeMessage *message)
       return;
     }
 
+  /* Written rows are only recorded while a repository listens for them */
+  if (!gom_sqlite_connection_is_read_only (message->state->connection))
+    gom_sqlite_connection_set_capture_changes (message->state->connection,
+                                               message->state->pool != NULL &&
+                                               gom_sqlite_pool_wants_changes (message->state->pool));
+
   if (!(future = message->thread_func (message->user_data)))
     {
       if (message->user_data_destroy != NULL)
@@ -116,8 +129,13 @@ gom_sqlite_lease_invoke_message_complete (GomSqliteLeaseInvokeMessage *message)
     }
 
   future = dex_ref (future);
+  succeeded = dex_thread_wait_for (future, &error);
+
+  /* Post what the work committed before the caller is woken up */
+  if ((changes = gom_sqlite_connection_steal_changes (message->state->connection)))
+    gom_sqlite_pool_post_changes (message->state->pool, changes);
 
-  if (!dex_thread_wait_for (future, &error))
+  if (!succeeded)
     {
       if (message->user_data_destroy != NULL)
         {
@@ -154,57 +172,17 @@ gom_sqlite_lease_invoke_message_complete (GomSqliteLeaseInvokeMessage *message)
   dex_clear (&future);
 }
 
-static gboolean
-gom_sqlite_lease_state_ensure_worker_locked (GomSqliteLeaseState  *state,
-                                             const char           *thread_name,
-                                             GError              **error)
-{
-  GThread *thread;
-  GomSqliteLeaseState *thread_state;
-
-  g_assert (state != NULL);
-
-  if (state->queue == NULL)
-    state->queue = g_async_queue_new_full (gom_sqlite_lease_invoke_message_free);
-
-  if (state->worker_started)
-    return TRUE;
-
-  thread_state = gom_sqlite_lease_state_ref_internal (state);
-  thread = g_thread_try_new (thread_name != NULL ? thread_name : "[gom-sqlite-lease]",
-                             gom_sqlite_lease_worker_thread,
-                             thread_state,
-                             error);
-
-  if (thread == NULL)
-    {
-      gom_sqlite_lease_state_unref (thread_state);
-      g_clear_pointer (&state->queue, g_async_queue_unref);
-      return FALSE;
-    }
-
-  state->worker_started = TRUE;
-  g_thread_unref (thread);
-  return TRUE;
-}
-
 static void
-gom_sqlite_lease_state_shutdown (GomSqliteLeaseState *state)
+gom_sqlite_lease_invoke_message_run (gpointer data)
 {
-  g_assert (state != NULL);
-
-  g_mutex_lock (&state->mutex);
-  state->shutting_down = TRUE;
+  GomSqliteLeaseInvokeMessage *message = data;
+  gint64 start_time = GOM_TRACE_BEGIN_MARK ();
 
-  if (!state->disposed &&
-      state->queue != NULL &&
-      g_atomic_int_get ((gint *)&state->ref_count) == 2)
-    {
-      state->disposed = TRUE;
-      g_async_queue_push (state->queue, GOM_SQLITE_LEASE_STOP_MESSAGE);
-    }
+  g_assert (message != NULL);
 
-  g_mutex_unlock (&state->mutex);
+  gom_sqlite_lease_invoke_message_complete (message);
+  GOM_TRACE_END_MARK (start_time, "SQLite", "invoke", "%s", message->name);
+  gom_sqlite_lease_invoke_message_free (message);
 }
 
 static void
@@ -215,10 +193,8 @@ gom_sqlite_lease_state_free (GomSqliteLeaseState *state)
   if (state->connection != NULL && state->pool != NULL)
     gom_sqlite_pool_return_connection (state->pool, state->connection);
 
-  g_clear_pointer (&state->queue, g_async_queue_unref);
   g_clear_object (&state->connection);
   g_clear_object (&state->pool);
-  g_mutex_clear (&state->mutex);
   g_free (state);
 }
 
@@ -233,7 +209,6 @@ gom_sqlite_lease_state_new (GomSqliteConnection *connection,
 
   state = g_new0 (GomSqliteLeaseState, 1);
   g_atomic_ref_count_init (&state->ref_count);
-  g_mutex_init (&state->mutex);
   state->connection = g_object_ref (connection);
   state->pool = g_object_ref (pool);
 
@@ -273,24 +248,8 @@ gom_sqlite_lease_ref_state (GomSqliteLease *self)
 void
 gom_sqlite_lease_state_unref (GomSqliteLeaseState *state)
 {
-  gboolean should_stop = FALSE;
-
   g_return_if_fail (state != NULL);
 
-  g_mutex_lock (&state->mutex);
-  if (!state->disposed &&
-      state->shutting_down &&
-      g_atomic_int_get ((gint *)&state->ref_count) == 2 &&
-      state->queue != NULL)
-    {
-      state->disposed = TRUE;
-      should_stop = TRUE;
-    }
-  g_mutex_unlock (&state->mutex);
-
-  if (should_stop)
-    g_async_queue_push (state->queue, GOM_SQLITE_LEASE_STOP_MESSAGE);
-
   if (g_atomic_ref_count_dec (&state->ref_count))
     gom_sqlite_lease_state_free (state);
 }
@@ -303,6 +262,14 @@ gom_sqlite_lease_state_get_connection (GomSqliteLeaseState *state)
   return state->connection;
 }
 
+GomSqlitePool *
+gom_sqlite_lease_state_get_pool (GomSqliteLeaseState *state)
+{
+  g_return_val_if_fail (state != NULL, NULL);
+
+  return state->pool;
+}
+
 static void
 gom_sqlite_lease_dispose (GObject *object)
 {
@@ -312,10 +279,7 @@ gom_sqlite_lease_dispose (GObject *object)
   state = g_steal_pointer (&self->state);
 
   if (state != NULL)
-    {
-      gom_sqlite_lease_state_shutdown (state);
-      gom_sqlite_lease_state_unref (state);
-    }
+    gom_sqlite_lease_state_unref (state);
 
   G_OBJECT_CLASS (gom_sqlite_lease_parent_class)->dispose (object);
 }
@@ -359,29 +323,6 @@ gom_sqlite_lease_get_connection (GomSqliteLease *lease)
   return state != NULL ? state->connection : NULL;
 }
 
-static gpointer
-gom_sqlite_lease_worker_thread (gpointer user_data)
-{
-  GomSqliteLeaseState *state = user_data;
-
-  g_assert (state != NULL);
-
-  for (;;)
-    {
-      GomSqliteLeaseInvokeMessage *message;
-
-      message = g_async_queue_pop (state->queue);
-      if (message == GOM_SQLITE_LEASE_STOP_MESSAGE)
-        break;
-
-      gom_sqlite_lease_invoke_message_complete (message);
-      gom_sqlite_lease_invoke_message_free (message);
-    }
-
-  gom_sqlite_lease_state_unref (state);
-  return NULL;
-}
-
 DexFuture *
 gom_sqlite_lease_state_invoke (GomSqliteLeaseState *state,
                                const char          *thread_name,
@@ -392,43 +333,29 @@ gom_sqlite_lease_state_invoke (GomSqliteLeaseState *state,
   GomSqliteLeaseInvokeMessage *message;
   DexPromise *promise;
   g_autoptr(GError) error = NULL;
-  DexFuture *future;
 
   g_return_val_if_fail (state != NULL, NULL);
 
   promise = dex_promise_new ();
 
-  g_mutex_lock (&state->mutex);
-
-  if (state->disposed)
-    {
-      g_mutex_unlock (&state->mutex);
-      g_set_error_literal (&error,
-                           G_IO_ERROR,
-                           G_IO_ERROR_CLOSED,
-                           "SQLite lease has been closed");
-      dex_promise_reject (promise, g_steal_pointer (&error));
-      return DEX_FUTURE (promise);
-    }
-
-  if (!gom_sqlite_lease_state_ensure_worker_locked (state, thread_name, &error))
-    {
-      g_mutex_unlock (&state->mutex);
-      dex_promise_reject (promise, g_steal_pointer (&error));
-      return DEX_FUTURE (promise);
-    }
-
   message = g_new0 (GomSqliteLeaseInvokeMessage, 1);
+  message->state = gom_sqlite_lease_state_ref_internal (state);
+  message->name = thread_name != NULL ? thread_name : "[gom-sqlite-lease]";
   message->thread_func = thread_func;
   message->user_data = user_data;
   message->user_data_destroy = user_data_destroy;
   message->promise = dex_ref (promise);
 
-  g_async_queue_push (state->queue, message);
-  g_mutex_unlock (&state->mutex);
+  if (!gom_sqlite_connection_run (state->connection,
+                                  gom_sqlite_lease_invoke_message_run,
+                                  message,
+                                  &error))
+    {
+      gom_sqlite_lease_invoke_message_free (message);
+      dex_promise_reject (promise, g_steal_pointer (&error));
+    }
 
-  future = DEX_FUTURE (promise);
-  return future;
+  return DEX_FUTURE (promise);
 }
 
 DexFuture *
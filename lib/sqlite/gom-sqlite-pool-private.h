@@ -24,23 +24,45 @@
 
 #include "gom-types-private.h"
 
+#include "gom-sqlite-connection-private.h"
+
 G_BEGIN_DECLS
 
 #define GOM_TYPE_SQLITE_POOL (gom_sqlite_pool_get_type())
 
 #define GOM_SQLITE_POOL_MAX_LEASES 4
-#define GOM_SQLITE_POOL_OPEN_THREADS 2
 #define GOM_SQLITE_POOL_MAX_CONNECTION_OPENS 2
+#define GOM_SQLITE_POOL_WAL_SIZE_LIMIT (G_GINT64_CONSTANT (64) * 1024 * 1024)
 
 G_DECLARE_FINAL_TYPE (GomSqlitePool, gom_sqlite_pool, GOM, SQLITE_POOL, GObject)
 
-GomSqlitePool *gom_sqlite_pool_new                (const char          *uri,
-                                                   GBytes              *encryption_key);
-DexFuture     *gom_sqlite_pool_acquire            (GomSqlitePool       *self);
-void           gom_sqlite_pool_clear_idle         (GomSqlitePool       *self);
-void           gom_sqlite_pool_return_connection  (GomSqlitePool       *self,
-                                                   GomSqliteConnection *connection);
-void           gom_sqlite_pool_set_encryption_key (GomSqlitePool       *self,
-                                                   GBytes              *encryption_key);
+typedef gboolean (*GomSqlitePoolWantsChangesFunc) (gpointer      user_data);
+typedef void     (*GomSqlitePoolChangesFunc)      (GomChangeSet *changes,
+                                                   gpointer      user_data);
+
+GomSqlitePool *gom_sqlite_pool_new                   (const char                      *uri,
+                                                      GBytes                          *encryption_key,
+                                                      guint                            max_leases,
+                                                      guint                            max_opens,
+                                                      const GomSqliteConnectionConfig *config);
+DexFuture     *gom_sqlite_pool_acquire_reader        (GomSqlitePool                   *self);
+DexFuture     *gom_sqlite_pool_acquire_writer        (GomSqlitePool                   *self);
+void           gom_sqlite_pool_clear_idle            (GomSqlitePool                   *self);
+void           gom_sqlite_pool_invalidate_statements (GomSqlitePool                   *self);
+void           gom_sqlite_pool_return_connection     (GomSqlitePool                   *self,
+                                                      GomSqliteConnection             *connection);
+void           gom_sqlite_pool_set_encryption_key    (GomSqlitePool                   *self,
+                                                      GBytes                          *encryption_key);
+void           gom_sqlite_pool_start_checkpointer    (GomSqlitePool                   *self,
+                                                      guint                            interval_msec,
+                                                      gint64                           wal_size_limit);
+void           gom_sqlite_pool_set_changes_func      (GomSqlitePool                   *self,
+                                                      GomSqlitePoolWantsChangesFunc    wants_changes_func,
+                                                      GomSqlitePoolChangesFunc         changes_func,
+                                                      gpointer                         changes_data,
+                                                      GDestroyNotify                   changes_data_destroy);
+gboolean       gom_sqlite_pool_wants_changes         (GomSqlitePool                   *self);
+void           gom_sqlite_pool_post_changes          (GomSqlitePool                   *self,
+                                                      GomChangeSet                    *changes);
 
 G_END_DECLS
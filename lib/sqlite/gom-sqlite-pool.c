@@ -20,22 +20,82 @@
 
 #include "config.h"
 
+#include <glib/gstdio.h>
+#include <sqlite3.h>
+
+#include "gom-change-set.h"
 #include "gom-sqlite-connection-private.h"
 #include "gom-sqlite-lease-private.h"
 #include "gom-sqlite-pool-private.h"
+#include "gom-trace-private.h"
+
+typedef struct
+{
+  GPtrArray  *idle;
+  DexLimiter *limiter;
+  guint       read_only : 1;
+} GomSqlitePoolSlot;
 
 struct _GomSqlitePool
 {
-  GObject        parent_instance;
-  char          *uri;
-  GBytes        *encryption_key;
-  GMutex         mutex;
-  GPtrArray     *idle_connections;
-  DexThreadPool *thread_pool;
-  DexLimiter    *lease_limiter;
-  DexLimiter    *open_limiter;
+  GObject           parent_instance;
+  char             *uri;
+  GBytes           *encryption_key;
+  GMutex            mutex;
+  DexThreadPool    *thread_pool;
+  DexLimiter       *open_limiter;
+  DexPromise       *checkpoint_cancel;
+  guint             schema_generation;
+  guint             idle_generation;
+
+  /* A single read-write connection is used for sessions and mutations,
+   * while queries use read-only connections. With WAL, readers never take
+   * the write lock, so long cursors do not hold up the writer.
+   */
+  GomSqlitePoolSlot writer;
+  GomSqlitePoolSlot readers;
+
+  /* The checkpointer uses a read-write connection of its own, outside of
+   * the writer slot, so passive checkpoints do not hold up sessions and
+   * mutations. It is discarded along with the idle connections.
+   */
+  GomSqliteConnection *checkpoint_connection;
+
+  /* Readers are only opened once the writer has created the database and
+   * switched it to WAL, and never for private in-memory databases.
+   */
+  guint             readers_enabled : 1;
+
+  GomSqliteConnectionConfig config;
+
+  /* Receives rows committed on the writer, guarded by @mutex */
+  GomSqlitePoolWantsChangesFunc wants_changes_func;
+  GomSqlitePoolChangesFunc  changes_func;
+  gpointer                  changes_data;
+  GDestroyNotify            changes_data_destroy;
 };
 
+typedef struct
+{
+  GomSqlitePool     *pool;
+  GomSqlitePoolSlot *slot;
+} GomSqlitePoolAcquire;
+
+typedef struct
+{
+  GWeakRef    pool;
+  DexFuture  *cancel;
+  guint       interval_msec;
+  gint64      wal_size_limit;
+} GomSqlitePoolCheckpointer;
+
+typedef struct
+{
+  GomSqliteConnection *connection;
+  gint64               wal_size_limit;
+  guint                truncate : 1;
+} GomSqlitePoolCheckpointTask;
+
 struct _GomSqlitePoolClass
 {
   GObjectClass parent_class;
@@ -58,8 +118,14 @@ gom_sqlite_pool_finalize (GObject *object)
   GomSqlitePool *self = (GomSqlitePool *)object;
   g_autoptr(DexFuture) close_future = NULL;
 
-  if (self->lease_limiter != NULL)
-    dex_limiter_close (self->lease_limiter);
+  if (self->checkpoint_cancel != NULL)
+    dex_promise_resolve_boolean (self->checkpoint_cancel, TRUE);
+
+  if (self->writer.limiter != NULL)
+    dex_limiter_close (self->writer.limiter);
+
+  if (self->readers.limiter != NULL)
+    dex_limiter_close (self->readers.limiter);
 
   if (self->open_limiter != NULL)
     dex_limiter_close (self->open_limiter);
@@ -69,9 +135,16 @@ gom_sqlite_pool_finalize (GObject *object)
 
   g_mutex_clear (&self->mutex);
 
-  g_clear_pointer (&self->idle_connections, g_ptr_array_unref);
+  if (self->changes_data_destroy != NULL)
+    g_clear_pointer (&self->changes_data, self->changes_data_destroy);
+
+  g_clear_pointer (&self->writer.idle, g_ptr_array_unref);
+  g_clear_pointer (&self->readers.idle, g_ptr_array_unref);
+  g_clear_object (&self->checkpoint_connection);
+  dex_clear (&self->checkpoint_cancel);
   dex_clear (&self->open_limiter);
-  dex_clear (&self->lease_limiter);
+  dex_clear (&self->writer.limiter);
+  dex_clear (&self->readers.limiter);
   dex_clear (&self->thread_pool);
   g_clear_pointer (&self->encryption_key, g_bytes_unref);
   g_clear_pointer (&self->uri, g_free);
@@ -139,65 +212,123 @@ gom_sqlite_pool_init (GomSqlitePool *self)
 {
   g_mutex_init (&self->mutex);
 
-  self->idle_connections = g_ptr_array_new_with_free_func (g_object_unref);
-  self->thread_pool = dex_thread_pool_new (GOM_SQLITE_POOL_OPEN_THREADS);
-  self->lease_limiter = dex_limiter_new (GOM_SQLITE_POOL_MAX_LEASES);
-  self->open_limiter = dex_limiter_new (GOM_SQLITE_POOL_MAX_CONNECTION_OPENS);
+  self->writer.idle = g_ptr_array_new_with_free_func (g_object_unref);
+  self->readers.idle = g_ptr_array_new_with_free_func (g_object_unref);
+  self->readers.read_only = TRUE;
+  self->config = (GomSqliteConnectionConfig) GOM_SQLITE_CONNECTION_CONFIG_INIT;
 }
 
+/* @max_leases bounds the number of concurrent readers, in addition to the
+ * single writer. @max_leases and @max_opens of 0 select
+ * GOM_SQLITE_POOL_MAX_LEASES and GOM_SQLITE_POOL_MAX_CONNECTION_OPENS.
+ * @config may be %NULL for defaults.
+ */
 GomSqlitePool *
-gom_sqlite_pool_new (const char *uri,
-                     GBytes     *encryption_key)
+gom_sqlite_pool_new (const char                      *uri,
+                     GBytes                          *encryption_key,
+                     guint                            max_leases,
+                     guint                            max_opens,
+                     const GomSqliteConnectionConfig *config)
 {
   GomSqlitePool *self;
 
   g_return_val_if_fail (uri != NULL, NULL);
 
+  if (max_leases == 0)
+    max_leases = GOM_SQLITE_POOL_MAX_LEASES;
+
+  if (max_opens == 0)
+    max_opens = GOM_SQLITE_POOL_MAX_CONNECTION_OPENS;
+
   self = g_object_new (GOM_TYPE_SQLITE_POOL,
                        "uri", uri,
                        NULL);
   if (encryption_key != NULL)
     self->encryption_key = g_bytes_ref (encryption_key);
+  if (config != NULL)
+    self->config = *config;
+
+  /* Opens are bounded by open_limiter, so there is no point in having
+   * more threads than concurrent opens.
+   */
+  self->thread_pool = dex_thread_pool_new (max_opens);
+  self->writer.limiter = dex_limiter_new (1);
+  self->readers.limiter = dex_limiter_new (max_leases);
+  self->open_limiter = dex_limiter_new (max_opens);
+
   return self;
 }
 
+static void
+gom_sqlite_pool_acquire_free (gpointer data)
+{
+  GomSqlitePoolAcquire *acquire = data;
+
+  g_clear_object (&acquire->pool);
+  g_free (acquire);
+}
+
 void
 gom_sqlite_pool_return_connection (GomSqlitePool       *self,
                                    GomSqliteConnection *connection)
 {
+  GomSqlitePoolSlot *slot;
+
   g_return_if_fail (GOM_IS_SQLITE_POOL (self));
   g_return_if_fail (GOM_IS_SQLITE_CONNECTION (connection));
 
+  if (gom_sqlite_connection_is_read_only (connection))
+    slot = &self->readers;
+  else
+    slot = &self->writer;
+
   g_mutex_lock (&self->mutex);
-  g_ptr_array_add (self->idle_connections, g_object_ref (connection));
+  g_ptr_array_add (slot->idle, g_object_ref (connection));
   g_mutex_unlock (&self->mutex);
 
-  dex_limiter_release (self->lease_limiter);
+  dex_limiter_release (slot->limiter);
 }
 
 static DexFuture *
 gom_sqlite_pool_open_complete_cb (DexFuture *completed,
                                   gpointer   user_data)
 {
-  GomSqlitePool *self = user_data;
+  GomSqlitePoolAcquire *acquire = user_data;
+  GomSqlitePool *self;
+  GomSqliteConnection *connection;
   g_autoptr(GError) error = NULL;
   GomSqliteLease *lease;
   const GValue *value;
 
   g_assert (DEX_IS_FUTURE (completed));
-  g_assert (GOM_IS_SQLITE_POOL (self));
+  g_assert (acquire != NULL);
+  g_assert (GOM_IS_SQLITE_POOL (acquire->pool));
+
+  self = acquire->pool;
 
   if (!(value = dex_future_get_value (completed, &error)))
     {
-      dex_limiter_release (self->lease_limiter);
+      dex_limiter_release (acquire->slot->limiter);
       return dex_future_new_for_error (g_steal_pointer (&error));
     }
 
   g_assert (G_VALUE_HOLDS (value, GOM_TYPE_SQLITE_CONNECTION));
 
-  if (!(lease = gom_sqlite_lease_new (g_value_get_object (value), self)))
+  connection = g_value_get_object (value);
+
+  if (!acquire->slot->read_only && gom_sqlite_connection_is_shared (connection))
     {
-      dex_limiter_release (self->lease_limiter);
+      g_mutex_lock (&self->mutex);
+      self->readers_enabled = TRUE;
+      g_mutex_unlock (&self->mutex);
+    }
+
+  gom_sqlite_connection_set_schema_generation (connection,
+                                               g_atomic_int_get (&self->schema_generation));
+
+  if (!(lease = gom_sqlite_lease_new (connection, self)))
+    {
+      dex_limiter_release (acquire->slot->limiter);
       return dex_future_new_reject (G_IO_ERROR,
                                     G_IO_ERROR_FAILED,
                                     "Failed to create SQLite lease");
@@ -210,28 +341,38 @@ static DexFuture *
 gom_sqlite_pool_acquire_permit_cb (DexFuture *completed,
                                    gpointer   user_data)
 {
-  GomSqlitePool *self = user_data;
+  GomSqlitePoolAcquire *acquire = user_data;
+  GomSqlitePool *self;
   g_autoptr(GError) error = NULL;
   g_autoptr(GomSqliteConnection) connection = NULL;
+  GomSqlitePoolAcquire *open;
   GomSqliteLease *lease;
   const GValue *value;
+  GPtrArray *idle;
 
   g_assert (DEX_IS_FUTURE (completed));
-  g_assert (GOM_IS_SQLITE_POOL (self));
+  g_assert (acquire != NULL);
+  g_assert (GOM_IS_SQLITE_POOL (acquire->pool));
+
+  self = acquire->pool;
+  idle = acquire->slot->idle;
 
   if (!(value = dex_future_get_value (completed, &error)))
     return dex_future_new_for_error (g_steal_pointer (&error));
 
   g_mutex_lock (&self->mutex);
-  if (self->idle_connections->len > 0)
-    connection = g_ptr_array_steal_index (self->idle_connections, self->idle_connections->len - 1);
+  if (idle->len > 0)
+    connection = g_ptr_array_steal_index (idle, idle->len - 1);
   g_mutex_unlock (&self->mutex);
 
   if (connection != NULL)
     {
+      gom_sqlite_connection_set_schema_generation (connection,
+                                                   g_atomic_int_get (&self->schema_generation));
+
       if (!(lease = gom_sqlite_lease_new (connection, self)))
         {
-          dex_limiter_release (self->lease_limiter);
+          dex_limiter_release (acquire->slot->limiter);
           return dex_future_new_reject (G_IO_ERROR,
                                         G_IO_ERROR_FAILED,
                                         "Failed to create SQLite lease");
@@ -240,24 +381,70 @@ gom_sqlite_pool_acquire_permit_cb (DexFuture *completed,
       return dex_future_new_take_object (lease);
     }
 
+  open = g_new0 (GomSqlitePoolAcquire, 1);
+  open->pool = g_object_ref (self);
+  open->slot = acquire->slot;
+
   return dex_future_finally (gom_sqlite_connection_new (self->uri,
                                                         self->encryption_key,
+                                                        &self->config,
+                                                        acquire->slot->read_only,
                                                         self->thread_pool,
                                                         self->open_limiter),
                              gom_sqlite_pool_open_complete_cb,
-                             g_object_ref (self),
-                             g_object_unref);
+                             open,
+                             gom_sqlite_pool_acquire_free);
+}
+
+static DexFuture *
+gom_sqlite_pool_acquire_slot (GomSqlitePool     *self,
+                              GomSqlitePoolSlot *slot)
+{
+  GomSqlitePoolAcquire *acquire;
+
+  g_assert (GOM_IS_SQLITE_POOL (self));
+  g_assert (slot == &self->writer || slot == &self->readers);
+
+  acquire = g_new0 (GomSqlitePoolAcquire, 1);
+  acquire->pool = g_object_ref (self);
+  acquire->slot = slot;
+
+  return dex_future_then (dex_limiter_acquire (slot->limiter),
+                          gom_sqlite_pool_acquire_permit_cb,
+                          acquire,
+                          gom_sqlite_pool_acquire_free);
 }
 
+/* Leases the read-write connection. There is only one, so this waits for
+ * any session or mutation that currently holds it.
+ */
 DexFuture *
-gom_sqlite_pool_acquire (GomSqlitePool *self)
+gom_sqlite_pool_acquire_writer (GomSqlitePool *self)
 {
   dex_return_error_if_fail (GOM_IS_SQLITE_POOL (self));
 
-  return dex_future_then (dex_limiter_acquire (self->lease_limiter),
-                          gom_sqlite_pool_acquire_permit_cb,
-                          g_object_ref (self),
-                          g_object_unref);
+  return gom_sqlite_pool_acquire_slot (self, &self->writer);
+}
+
+/* Leases a read-only connection for queries. Until the writer has opened
+ * the database, or if it is a private in-memory database that other
+ * connections cannot see, this falls back to leasing the writer.
+ */
+DexFuture *
+gom_sqlite_pool_acquire_reader (GomSqlitePool *self)
+{
+  gboolean readers_enabled;
+
+  dex_return_error_if_fail (GOM_IS_SQLITE_POOL (self));
+
+  g_mutex_lock (&self->mutex);
+  readers_enabled = self->readers_enabled;
+  g_mutex_unlock (&self->mutex);
+
+  if (!readers_enabled)
+    return gom_sqlite_pool_acquire_slot (self, &self->writer);
+
+  return gom_sqlite_pool_acquire_slot (self, &self->readers);
 }
 
 void
@@ -266,10 +453,24 @@ gom_sqlite_pool_clear_idle (GomSqlitePool *self)
   g_return_if_fail (GOM_IS_SQLITE_POOL (self));
 
   g_mutex_lock (&self->mutex);
-  g_ptr_array_set_size (self->idle_connections, 0);
+  g_ptr_array_set_size (self->writer.idle, 0);
+  g_ptr_array_set_size (self->readers.idle, 0);
+  g_clear_object (&self->checkpoint_connection);
+  self->idle_generation++;
   g_mutex_unlock (&self->mutex);
 }
 
+/* Bumps the schema generation so every pooled connection drops its prepared
+ * statement cache the next time it is leased.
+ */
+void
+gom_sqlite_pool_invalidate_statements (GomSqlitePool *self)
+{
+  g_return_if_fail (GOM_IS_SQLITE_POOL (self));
+
+  g_atomic_int_inc (&self->schema_generation);
+}
+
 void
 gom_sqlite_pool_set_encryption_key (GomSqlitePool *self,
                                     GBytes        *encryption_key)
@@ -282,7 +483,305 @@ gom_sqlite_pool_set_encryption_key (GomSqlitePool *self,
   if (encryption_key != NULL)
     self->encryption_key = g_bytes_ref (encryption_key);
 
-  g_ptr_array_set_size (self->idle_connections, 0);
+  g_ptr_array_set_size (self->writer.idle, 0);
+  g_ptr_array_set_size (self->readers.idle, 0);
+  g_clear_object (&self->checkpoint_connection);
+  self->idle_generation++;
+
+  g_mutex_unlock (&self->mutex);
+}
+
+/* Sets the function that receives the rows committed on the writer, and
+ * the one deciding whether they are recorded at all. Both are called from
+ * the connection worker thread.
+ */
+void
+gom_sqlite_pool_set_changes_func (GomSqlitePool                 *self,
+                                  GomSqlitePoolWantsChangesFunc  wants_changes_func,
+                                  GomSqlitePoolChangesFunc       changes_func,
+                                  gpointer                       changes_data,
+                                  GDestroyNotify                 changes_data_destroy)
+{
+  gpointer old_data = NULL;
+  GDestroyNotify old_data_destroy = NULL;
+
+  g_return_if_fail (GOM_IS_SQLITE_POOL (self));
+
+  g_mutex_lock (&self->mutex);
+  old_data = g_steal_pointer (&self->changes_data);
+  old_data_destroy = self->changes_data_destroy;
+  self->wants_changes_func = wants_changes_func;
+  self->changes_func = changes_func;
+  self->changes_data = changes_data;
+  self->changes_data_destroy = changes_data_destroy;
+  g_mutex_unlock (&self->mutex);
+
+  if (old_data_destroy != NULL)
+    old_data_destroy (old_data);
+}
+
+gboolean
+gom_sqlite_pool_wants_changes (GomSqlitePool *self)
+{
+  GomSqlitePoolWantsChangesFunc wants_changes_func;
+  gpointer changes_data;
+
+  g_return_val_if_fail (GOM_IS_SQLITE_POOL (self), FALSE);
+
+  g_mutex_lock (&self->mutex);
+  wants_changes_func = self->wants_changes_func;
+  changes_data = self->changes_data;
+  g_mutex_unlock (&self->mutex);
+
+  if (wants_changes_func == NULL)
+    return FALSE;
 
+  return wants_changes_func (changes_data);
+}
+
+void
+gom_sqlite_pool_post_changes (GomSqlitePool *self,
+                              GomChangeSet  *changes)
+{
+  GomSqlitePoolChangesFunc changes_func;
+  gpointer changes_data;
+
+  g_return_if_fail (GOM_IS_SQLITE_POOL (self));
+  g_return_if_fail (GOM_IS_CHANGE_SET (changes));
+
+  /* Called unlocked so the function may use the pool */
+  g_mutex_lock (&self->mutex);
+  changes_func = self->changes_func;
+  changes_data = self->changes_data;
   g_mutex_unlock (&self->mutex);
+
+  if (changes_func != NULL)
+    changes_func (changes, changes_data);
+}
+
+static void
+gom_sqlite_pool_checkpointer_free (gpointer data)
+{
+  GomSqlitePoolCheckpointer *checkpointer = data;
+
+  g_weak_ref_clear (&checkpointer->pool);
+  dex_clear (&checkpointer->cancel);
+  g_free (checkpointer);
+}
+
+static void
+gom_sqlite_pool_checkpoint_task_free (gpointer data)
+{
+  GomSqlitePoolCheckpointTask *task = data;
+
+  g_clear_object (&task->connection);
+  g_free (task);
+}
+
+static gint64
+gom_sqlite_pool_get_wal_size (sqlite3 *db)
+{
+  const char *filename;
+  const char *wal_filename;
+  GStatBuf st;
+
+  if (!(filename = sqlite3_db_filename (db, "main")) || filename[0] == 0)
+    return 0;
+
+  if (!(wal_filename = sqlite3_filename_wal (filename)))
+    return 0;
+
+  if (g_stat (wal_filename, &st) != 0)
+    return 0;
+
+  return st.st_size;
+}
+
+/* Resolves to %TRUE when the WAL has grown past the limit and a passive
+ * checkpoint was not attempted, in which case the caller is expected to
+ * run a truncating one while holding the writer.
+ */
+static DexFuture *
+gom_sqlite_pool_checkpoint_thread (gpointer user_data)
+{
+  GomSqlitePoolCheckpointTask *task = user_data;
+  const char *mode_name = "passive";
+  gint64 start_time = GOM_TRACE_BEGIN_MARK ();
+  gint64 wal_size;
+  sqlite3 *db;
+  int mode = SQLITE_CHECKPOINT_PASSIVE;
+  int n_log = 0;
+  int n_checkpointed = 0;
+  int rc;
+
+  g_assert (task != NULL);
+  g_assert (GOM_IS_SQLITE_CONNECTION (task->connection));
+
+  db = gom_sqlite_connection_get_native (task->connection);
+  wal_size = gom_sqlite_pool_get_wal_size (db);
+
+  if (wal_size == 0)
+    return dex_future_new_false ();
+
+  /* A passive checkpoint never blocks readers or writers. Once the log has
+   * grown past the limit, try to also reset and truncate it so it does not
+   * keep growing while there is continuous write traffic.
+   */
+  if (wal_size >= task->wal_size_limit)
+    {
+      if (!task->truncate)
+        return dex_future_new_true ();
+
+      mode = SQLITE_CHECKPOINT_TRUNCATE;
+      mode_name = "truncate";
+    }
+
+  rc = sqlite3_wal_checkpoint_v2 (db, NULL, mode, &n_log, &n_checkpointed);
+
+  if (rc == SQLITE_BUSY && mode != SQLITE_CHECKPOINT_PASSIVE)
+    {
+      mode = SQLITE_CHECKPOINT_PASSIVE;
+      mode_name = "passive-fallback";
+      rc = sqlite3_wal_checkpoint_v2 (db, NULL, mode, &n_log, &n_checkpointed);
+    }
+
+  GOM_TRACE_END_MARK (start_time,
+                      "SQLite",
+                      "checkpoint",
+                      "mode=%s rc=%d wal-size=%" G_GINT64_FORMAT " log=%d checkpointed=%d",
+                      mode_name,
+                      rc,
+                      wal_size,
+                      n_log,
+                      n_checkpointed);
+
+  return dex_future_new_false ();
+}
+
+static DexFuture *
+gom_sqlite_pool_run_checkpoint (GomSqlitePool       *self,
+                                GomSqliteConnection *connection,
+                                gint64               wal_size_limit,
+                                gboolean             truncate)
+{
+  GomSqlitePoolCheckpointTask *task;
+
+  task = g_new0 (GomSqlitePoolCheckpointTask, 1);
+  task->connection = g_object_ref (connection);
+  task->wal_size_limit = wal_size_limit;
+  task->truncate = !!truncate;
+
+  return dex_limiter_run_on_pool (self->open_limiter,
+                                  self->thread_pool,
+                                  gom_sqlite_pool_checkpoint_thread,
+                                  task,
+                                  gom_sqlite_pool_checkpoint_task_free);
+}
+
+static DexFuture *
+gom_sqlite_pool_checkpoint_fiber (gpointer user_data)
+{
+  GomSqlitePoolCheckpointer *checkpointer = user_data;
+
+  g_assert (checkpointer != NULL);
+
+  for (;;)
+    {
+      g_autoptr(GomSqlitePool) self = NULL;
+      g_autoptr(GomSqliteConnection) connection = NULL;
+      gboolean readers_enabled;
+      guint idle_generation;
+
+      dex_await (dex_future_first (dex_timeout_new_msec (checkpointer->interval_msec),
+                                   dex_ref (checkpointer->cancel),
+                                   NULL),
+                 NULL);
+
+      if (dex_future_get_status (checkpointer->cancel) != DEX_FUTURE_STATUS_PENDING)
+        break;
+
+      if (!(self = g_weak_ref_get (&checkpointer->pool)))
+        break;
+
+      g_mutex_lock (&self->mutex);
+      readers_enabled = self->readers_enabled;
+      connection = g_steal_pointer (&self->checkpoint_connection);
+      idle_generation = self->idle_generation;
+      g_mutex_unlock (&self->mutex);
+
+      /* Until the writer has opened the database there is nothing to
+       * checkpoint, and private in-memory databases have no WAL.
+       */
+      if (!readers_enabled)
+        continue;
+
+      if (connection == NULL &&
+          !(connection = dex_await_object (gom_sqlite_connection_new (self->uri,
+                                                                      self->encryption_key,
+                                                                      &self->config,
+                                                                      FALSE,
+                                                                      self->thread_pool,
+                                                                      self->open_limiter),
+                                           NULL)))
+        continue;
+
+      if (dex_await_boolean (gom_sqlite_pool_run_checkpoint (self, connection, checkpointer->wal_size_limit, FALSE), NULL))
+        {
+          /* Truncating has to wait for writers, so take the writer permit
+           * like any other lease. Sessions and mutations only queue behind
+           * the checkpointer once the WAL has grown past the limit.
+           */
+          if (!dex_await (dex_limiter_acquire (self->writer.limiter), NULL))
+            break;
+
+          dex_await (gom_sqlite_pool_run_checkpoint (self, connection, checkpointer->wal_size_limit, TRUE), NULL);
+
+          dex_limiter_release (self->writer.limiter);
+        }
+
+      /* Drop the connection if the idle set was discarded meanwhile (e.g.
+       * by a rekey) rather than keep a stale handle.
+       */
+      g_mutex_lock (&self->mutex);
+      if (idle_generation == self->idle_generation && self->checkpoint_connection == NULL)
+        self->checkpoint_connection = g_steal_pointer (&connection);
+      g_mutex_unlock (&self->mutex);
+    }
+
+  return dex_future_new_true ();
+}
+
+/* Starts a fiber that periodically checkpoints the WAL on a connection of
+ * its own, so committing writers do not have to. Checkpoints are PASSIVE
+ * until the WAL reaches @wal_size_limit bytes, at which point the log is
+ * restarted and truncated while holding the writer, when no reader is in
+ * the way.
+ */
+void
+gom_sqlite_pool_start_checkpointer (GomSqlitePool *self,
+                                    guint          interval_msec,
+                                    gint64         wal_size_limit)
+{
+  GomSqlitePoolCheckpointer *checkpointer;
+
+  g_return_if_fail (GOM_IS_SQLITE_POOL (self));
+  g_return_if_fail (interval_msec > 0);
+  g_return_if_fail (self->checkpoint_cancel == NULL);
+
+  if (wal_size_limit <= 0)
+    wal_size_limit = GOM_SQLITE_POOL_WAL_SIZE_LIMIT;
+
+  self->checkpoint_cancel = dex_promise_new ();
+
+  checkpointer = g_new0 (GomSqlitePoolCheckpointer, 1);
+  g_weak_ref_init (&checkpointer->pool, self);
+  checkpointer->cancel = dex_ref (DEX_FUTURE (self->checkpoint_cancel));
+  checkpointer->interval_msec = interval_msec;
+  checkpointer->wal_size_limit = wal_size_limit;
+
+  dex_future_disown (dex_scheduler_spawn (NULL,
+                                          0,
+                                          gom_sqlite_pool_checkpoint_fiber,
+                                          checkpointer,
+                                          gom_sqlite_pool_checkpointer_free));
 }
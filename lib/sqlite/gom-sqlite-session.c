@@ -24,6 +24,7 @@
 
 #include "gom-cursor-private.h"
 #include "gom-entity-private.h"
+#include "gom-identity-key-private.h"
 #include "gom-query-private.h"
 #include "gom-repository-private.h"
 #include "gom-sqlite-connection-private.h"
@@ -69,15 +70,15 @@ typedef struct
 
 static void       gom_sqlite_session_finalize                  (GObject                    *object);
 static GomEntity *gom_sqlite_session_lookup_entity             (GomSession                 *session,
-                                                                const char                 *entity_key);
+                                                                const GomIdentityKey       *entity_key);
 static GomEntity *gom_sqlite_session_register_entity           (GomSession                 *session,
                                                                 GomEntity                  *entity,
-                                                                char                       *entity_key);
+                                                                GomIdentityKey             *entity_key);
 static void       gom_sqlite_session_unregister_pending_entity (GomSession                 *session,
                                                                 GomEntity                  *entity);
 static gboolean   gom_sqlite_session_rekey_entity_identity     (GomSession                 *session,
                                                                 GomEntity                  *entity,
-                                                                char                       *entity_key);
+                                                                GomIdentityKey             *entity_key);
 static void       gom_sqlite_session_unregister_entity         (GomSession                 *session,
                                                                 GomEntity                  *entity);
 static void       gom_sqlite_session_clear_entities_vfunc      (GomSession                 *session);
@@ -147,7 +148,7 @@ gom_sqlite_session_clear_entities (GomSqliteSession *self)
       GList *link = self->all_entities.head;
       GomEntity *entity = link->data;
       gboolean was_pending = FALSE;
-      g_autofree char *entity_key = NULL;
+      g_autoptr(GomIdentityKey) entity_key = NULL;
 
       g_queue_unlink (&self->all_entities, link);
 
@@ -234,7 +235,10 @@ gom_sqlite_session_init (GomSqliteSession *self)
   g_queue_init (&self->all_entities);
   g_queue_init (&self->pending_entities);
   g_queue_init (&self->dirty_entities);
-  self->entities_by_key = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, g_object_unref);
+  self->entities_by_key = g_hash_table_new_full (_gom_identity_key_hash,
+                                                 _gom_identity_key_equal,
+                                                 (GDestroyNotify)_gom_identity_key_unref,
+                                                 g_object_unref);
 }
 
 static void
@@ -275,8 +279,8 @@ gom_sqlite_session_finalize (GObject *object)
 }
 
 static GomEntity *
-gom_sqlite_session_lookup_entity (GomSession *session,
-                                  const char *entity_key)
+gom_sqlite_session_lookup_entity (GomSession           *session,
+                                  const GomIdentityKey *entity_key)
 {
   GomSqliteSession *self = GOM_SQLITE_SESSION (session);
   GomEntity *entity;
@@ -288,9 +292,9 @@ gom_sqlite_session_lookup_entity (GomSession *session,
 }
 
 static GomEntity *
-gom_sqlite_session_register_entity (GomSession *session,
-                                    GomEntity  *entity,
-                                    char       *entity_key)
+gom_sqlite_session_register_entity (GomSession     *session,
+                                    GomEntity      *entity,
+                                    GomIdentityKey *entity_key)
 {
   GomSqliteSession *self = GOM_SQLITE_SESSION (session);
   GomSession *entity_session;
@@ -302,7 +306,7 @@ gom_sqlite_session_register_entity (GomSession *session,
 
   if ((existing = g_hash_table_lookup (self->entities_by_key, entity_key)))
     {
-      g_free (entity_key);
+      _gom_identity_key_unref (entity_key);
       return g_object_ref (existing);
     }
 
@@ -316,7 +320,9 @@ gom_sqlite_session_register_entity (GomSession *session,
     gom_entity_set_repository (entity, self->parent_instance.repository);
 
   g_queue_push_tail_link (&self->all_entities, _gom_entity_get_session_link (entity));
-  g_hash_table_insert (self->entities_by_key, entity_key, g_object_ref (entity));
+  g_hash_table_insert (self->entities_by_key,
+                       _gom_identity_key_ref (entity_key),
+                       g_object_ref (entity));
 
   gom_sqlite_session_track_entity_changes (session, entity);
 
@@ -415,7 +421,7 @@ gom_sqlite_session_persist_impl (GomSession *session,
   g_autoptr(GomRepository) entity_repository = NULL;
   GomExpression *identity_value = NULL;
   g_autoptr(GError) error = NULL;
-  g_autofree char *entity_key = NULL;
+  g_autoptr(GomIdentityKey) entity_key = NULL;
   gboolean identity_ready = FALSE;
   GomEntity *existing = NULL;
 
@@ -510,6 +516,7 @@ gom_sqlite_session_unregister_pending_entity (GomSession *session,
                                               GomEntity  *entity)
 {
   GomSqliteSession *self = GOM_SQLITE_SESSION (session);
+  g_autoptr(GomIdentityKey) entity_key = NULL;
 
   g_assert (GOM_IS_SQLITE_SESSION (self));
   g_assert (GOM_IS_ENTITY (entity));
@@ -520,7 +527,9 @@ gom_sqlite_session_unregister_pending_entity (GomSession *session,
   _gom_entity_set_pending (entity, FALSE);
   gom_trace_counter_add (GOM_TRACE_COUNTER_PENDING_ENTITIES, -1);
 
-  if (_gom_entity_dup_session_key (entity) != NULL)
+  entity_key = _gom_entity_dup_session_key (entity);
+
+  if (entity_key != NULL)
     gom_sqlite_session_track_entity_changes (session, entity);
 
   if (self->flushing)
@@ -531,12 +540,12 @@ gom_sqlite_session_unregister_pending_entity (GomSession *session,
 }
 
 static gboolean
-gom_sqlite_session_rekey_entity_identity (GomSession *session,
-                                          GomEntity  *entity,
-                                          char       *entity_key)
+gom_sqlite_session_rekey_entity_identity (GomSession     *session,
+                                          GomEntity      *entity,
+                                          GomIdentityKey *entity_key)
 {
   GomSqliteSession *self = GOM_SQLITE_SESSION (session);
-  g_autofree char *old_key = NULL;
+  g_autoptr(GomIdentityKey) old_key = NULL;
   gboolean was_tracked;
   GomEntity *existing;
 
@@ -546,26 +555,26 @@ gom_sqlite_session_rekey_entity_identity (GomSession *session,
 
   if (!(old_key = _gom_entity_dup_session_key (entity)))
     {
-      g_free (entity_key);
+      _gom_identity_key_unref (entity_key);
       return FALSE;
     }
 
   existing = g_hash_table_lookup (self->entities_by_key, entity_key);
   if (existing != NULL && existing != entity)
     {
-      g_free (entity_key);
+      _gom_identity_key_unref (entity_key);
       return FALSE;
     }
 
   was_tracked = g_hash_table_contains (self->entities_by_key, old_key);
 
-  if (g_strcmp0 (old_key, entity_key) == 0 && was_tracked)
+  if (_gom_identity_key_equal (old_key, entity_key) && was_tracked)
     {
-      g_free (entity_key);
+      _gom_identity_key_unref (entity_key);
       return TRUE;
     }
 
-  g_hash_table_steal (self->entities_by_key, old_key);
+  g_hash_table_remove (self->entities_by_key, old_key);
   _gom_entity_attach (entity, GOM_SESSION (self), entity_key);
   g_hash_table_insert (self->entities_by_key,
                        _gom_entity_dup_session_key (entity),
@@ -600,7 +609,7 @@ gom_sqlite_session_unregister_entity (GomSession *session,
   g_queue_unlink (&self->all_entities, _gom_entity_get_session_link (entity));
 
   {
-    g_autofree char *entity_key = _gom_entity_dup_session_key (entity);
+    g_autoptr(GomIdentityKey) entity_key = _gom_entity_dup_session_key (entity);
 
     if (entity_key != NULL)
       {
@@ -653,43 +662,68 @@ gom_sqlite_session_flush_state_unref (GomSqliteSessionFlushState *state)
 }
 
 static DexFuture *
-gom_sqlite_session_flush_step_cb (DexFuture *completed,
-                                  gpointer   user_data)
+gom_sqlite_session_flush_fiber (gpointer user_data)
 {
   GomSqliteSessionFlushState *state = user_data;
-  g_autoptr(GError) error = NULL;
-  const GValue *value;
-  GomEntity *entity;
+  GomSqliteSession *self;
 
-  g_assert (DEX_IS_FUTURE (completed));
   g_assert (state != NULL);
   g_assert (GOM_IS_SQLITE_SESSION (state->session));
 
-  if (!(value = dex_future_get_value (completed, &error)))
-    return dex_future_new_for_error (g_steal_pointer (&error));
+  self = state->session;
 
-  if (!g_queue_is_empty (&state->session->pending_entities))
+  /* Pending entities are inserted a batch of rows at a time. Backfilling
+   * identities unregisters them from the session, but while flushing they
+   * stay linked until the whole batch is done.
+   */
+  while (!g_queue_is_empty (&self->pending_entities))
     {
-      if (!(entity = g_queue_peek_head (&state->session->pending_entities)))
-        return dex_future_new_true ();
+      g_autoptr(GPtrArray) batch = NULL;
+      g_autoptr(GError) error = NULL;
 
-      if (_gom_entity_is_pending (entity))
-        gom_trace_counter_add (GOM_TRACE_COUNTER_PENDING_ENTITIES, -1);
-      g_queue_unlink (&state->session->pending_entities, _gom_entity_get_pending_link (entity));
-      _gom_entity_set_pending (entity, FALSE);
-      g_object_unref (entity);
-      return gom_sqlite_session_flush_next (state);
+      batch = _gom_entity_collect_insert_batch (&self->pending_entities,
+                                                GOM_SESSION_FLUSH_BATCH_SIZE);
+
+      if (!dex_await (_gom_entity_insert_batch (batch), &error))
+        return dex_future_new_for_error (g_steal_pointer (&error));
+
+      for (guint i = 0; i < batch->len; i++)
+        {
+          GomEntity *entity = g_ptr_array_index (batch, i);
+
+          if (_gom_entity_is_pending (entity))
+            gom_trace_counter_add (GOM_TRACE_COUNTER_PENDING_ENTITIES, -1);
+          g_queue_unlink (&self->pending_entities, _gom_entity_get_pending_link (entity));
+          _gom_entity_set_pending (entity, FALSE);
+          g_object_unref (entity);
+        }
     }
 
-  if (!g_queue_is_empty (&state->session->dirty_entities))
+  /* Accepting the changes of an update already unlinks the entity from
+   * the dirty queue, so only entities that are still dirty are dropped.
+   */
+  while (!g_queue_is_empty (&self->dirty_entities))
     {
-      if (!(entity = g_queue_peek_head (&state->session->dirty_entities)))
-        return dex_future_new_true ();
+      g_autoptr(GPtrArray) batch = NULL;
+      g_autoptr(GError) error = NULL;
 
-      g_queue_unlink (&state->session->dirty_entities, _gom_entity_get_dirty_link (entity));
-      _gom_entity_set_dirty (entity, FALSE);
-      g_object_unref (entity);
-      return gom_sqlite_session_flush_next (state);
+      batch = _gom_entity_collect_update_batch (&self->dirty_entities,
+                                                GOM_SESSION_FLUSH_BATCH_SIZE);
+
+      if (!dex_await (_gom_entity_update_batch (batch), &error))
+        return dex_future_new_for_error (g_steal_pointer (&error));
+
+      for (guint i = 0; i < batch->len; i++)
+        {
+          GomEntity *entity = g_ptr_array_index (batch, i);
+
+          if (!_gom_entity_is_dirty (entity))
+            continue;
+
+          g_queue_unlink (&self->dirty_entities, _gom_entity_get_dirty_link (entity));
+          _gom_entity_set_dirty (entity, FALSE);
+          g_object_unref (entity);
+        }
     }
 
   return dex_future_new_true ();
@@ -698,34 +732,14 @@ gom_sqlite_session_flush_step_cb (DexFuture *completed,
 static DexFuture *
 gom_sqlite_session_flush_next (GomSqliteSessionFlushState *state)
 {
-  GomEntity *entity;
-
   g_assert (state != NULL);
   g_assert (GOM_IS_SQLITE_SESSION (state->session));
 
-  if (!g_queue_is_empty (&state->session->pending_entities))
-    {
-      if (!(entity = g_queue_peek_head (&state->session->pending_entities)))
-        return dex_future_new_true ();
-
-      return dex_future_then (gom_entity_insert (entity),
-                              gom_sqlite_session_flush_step_cb,
-                              gom_sqlite_session_flush_state_ref (state),
-                              (GDestroyNotify)gom_sqlite_session_flush_state_unref);
-    }
-
-  if (!g_queue_is_empty (&state->session->dirty_entities))
-    {
-      if (!(entity = g_queue_peek_head (&state->session->dirty_entities)))
-        return dex_future_new_true ();
-
-      return dex_future_then (gom_entity_update (entity),
-                              gom_sqlite_session_flush_step_cb,
+  return dex_scheduler_spawn (NULL,
+                              0,
+                              gom_sqlite_session_flush_fiber,
                               gom_sqlite_session_flush_state_ref (state),
                               (GDestroyNotify)gom_sqlite_session_flush_state_unref);
-    }
-
-  return dex_future_new_true ();
 }
 
 static DexFuture *
@@ -820,6 +834,7 @@ gom_sqlite_session_mutate (GomSession  *session,
 
   registry = _gom_repository_get_registry (self->parent_instance.repository);
   return _gom_session_track_mutation_result (session,
+                                             mutation,
                                              gom_sqlite_driver_mutate_on_lease (self->lease_state,
                                                                                 registry,
                                                                                 mutation));
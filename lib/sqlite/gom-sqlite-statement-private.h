@@ -31,7 +31,8 @@ G_BEGIN_DECLS
 G_DECLARE_FINAL_TYPE (GomSqliteStatement, gom_sqlite_statement, GOM, SQLITE_STATEMENT, GObject)
 
 GomSqliteStatement  *gom_sqlite_statement_new        (GomSqliteLeaseState *state,
-                                                      sqlite3_stmt        *stmt);
+                                                      sqlite3_stmt        *stmt,
+                                                      const char          *cache_key);
 GomSqliteLeaseState *gom_sqlite_statement_get_state  (GomSqliteStatement  *self);
 sqlite3_stmt        *gom_sqlite_statement_get_native (GomSqliteStatement  *self);
 void                 gom_sqlite_statement_reset      (GomSqliteStatement  *self);
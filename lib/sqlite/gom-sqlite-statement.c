@@ -22,6 +22,7 @@
 
 #include <sqlite3.h>
 
+#include "gom-sqlite-connection-private.h"
 #include "gom-sqlite-lease-private.h"
 #include "gom-sqlite-statement-private.h"
 #include "gom-trace-private.h"
@@ -31,6 +32,7 @@ struct _GomSqliteStatement
   GObject              parent_instance;
   GomSqliteLeaseState *state;
   sqlite3_stmt        *stmt;
+  char                *cache_key;
 };
 
 struct _GomSqliteStatementClass
@@ -47,9 +49,19 @@ gom_sqlite_statement_finalize (GObject *object)
 
   if (self->stmt != NULL)
     {
-      sqlite3_finalize (self->stmt);
+      /* Hand the statement back to the connection while the lease state
+       * (and therefore exclusive use of the connection) is still held.
+       */
+      if (self->cache_key != NULL && self->state != NULL)
+        gom_sqlite_connection_cache_statement (gom_sqlite_lease_state_get_connection (self->state),
+                                               self->cache_key,
+                                               g_steal_pointer (&self->stmt));
+      else
+        sqlite3_finalize (self->stmt);
+
       self->stmt = NULL;
     }
+  g_clear_pointer (&self->cache_key, g_free);
   if (self->state != NULL)
     gom_sqlite_lease_state_unref (self->state);
 
@@ -71,7 +83,8 @@ gom_sqlite_statement_init (GomSqliteStatement *self)
 
 GomSqliteStatement *
 gom_sqlite_statement_new (GomSqliteLeaseState *state,
-                          sqlite3_stmt        *stmt)
+                          sqlite3_stmt        *stmt,
+                          const char          *cache_key)
 {
   GomSqliteStatement *self;
 
@@ -81,6 +94,7 @@ gom_sqlite_statement_new (GomSqliteLeaseState *state,
   self = g_object_new (GOM_TYPE_SQLITE_STATEMENT, NULL);
   self->state = gom_sqlite_lease_state_ref (state);
   self->stmt = stmt;
+  self->cache_key = g_strdup (cache_key);
 
   return self;
 }
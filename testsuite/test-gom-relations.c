@@ -25,6 +25,10 @@
 
 #include <libgom.h>
 
+#include "lib/gom-change-set-private.h"
+#include "lib/gom-entity-private.h"
+#include "lib/gom-repository-private.h"
+#include "lib/gom-trace-private.h"
 #include "test-util.h"
 
 typedef struct _TestRelationAuthor      TestRelationAuthor;
@@ -33,6 +37,8 @@ typedef struct _TestRelationBook        TestRelationBook;
 typedef struct _TestRelationBookClass   TestRelationBookClass;
 typedef struct _TestRelationTag         TestRelationTag;
 typedef struct _TestRelationTagClass    TestRelationTagClass;
+typedef struct _TestRelationSection      TestRelationSection;
+typedef struct _TestRelationSectionClass TestRelationSectionClass;
 
 struct _TestRelationAuthor
 {
@@ -71,6 +77,19 @@ struct _TestRelationTagClass
   GomEntityClass parent_class;
 };
 
+struct _TestRelationSection
+{
+  GomEntity  parent_instance;
+  gint64     id;
+  gint64     parent_id;
+  char      *name;
+};
+
+struct _TestRelationSectionClass
+{
+  GomEntityClass parent_class;
+};
+
 enum {
   TEST_RELATION_AUTHOR_PROP_0,
   TEST_RELATION_AUTHOR_PROP_ID,
@@ -93,21 +112,33 @@ enum {
   TEST_RELATION_TAG_N_PROPS
 };
 
+enum {
+  TEST_RELATION_SECTION_PROP_0,
+  TEST_RELATION_SECTION_PROP_ID,
+  TEST_RELATION_SECTION_PROP_PARENT_ID,
+  TEST_RELATION_SECTION_PROP_NAME,
+  TEST_RELATION_SECTION_N_PROPS
+};
+
 static GParamSpec *test_relation_author_properties[TEST_RELATION_AUTHOR_N_PROPS];
 static GParamSpec *test_relation_book_properties[TEST_RELATION_BOOK_N_PROPS];
 static GParamSpec *test_relation_tag_properties[TEST_RELATION_TAG_N_PROPS];
+static GParamSpec *test_relation_section_properties[TEST_RELATION_SECTION_N_PROPS];
 
 static GType test_relation_author_get_type (void) G_GNUC_CONST;
 static GType test_relation_book_get_type   (void) G_GNUC_CONST;
 static GType test_relation_tag_get_type    (void) G_GNUC_CONST;
+static GType test_relation_section_get_type (void) G_GNUC_CONST;
 
 #define TEST_RELATION_AUTHOR_TYPE (test_relation_author_get_type ())
 #define TEST_RELATION_BOOK_TYPE (test_relation_book_get_type ())
 #define TEST_RELATION_TAG_TYPE (test_relation_tag_get_type ())
+#define TEST_RELATION_SECTION_TYPE (test_relation_section_get_type ())
 
 G_DEFINE_TYPE (TestRelationAuthor, test_relation_author, GOM_TYPE_ENTITY)
 G_DEFINE_TYPE (TestRelationBook, test_relation_book, GOM_TYPE_ENTITY)
 G_DEFINE_TYPE (TestRelationTag, test_relation_tag, GOM_TYPE_ENTITY)
+G_DEFINE_TYPE (TestRelationSection, test_relation_section, GOM_TYPE_ENTITY)
 
 static void
 test_relation_author_finalize (GObject *object)
@@ -401,6 +432,115 @@ test_relation_tag_init (TestRelationTag *self)
 {
 }
 
+static void
+test_relation_section_finalize (GObject *object)
+{
+  TestRelationSection *self = (TestRelationSection *)object;
+
+  g_clear_pointer (&self->name, g_free);
+
+  G_OBJECT_CLASS (test_relation_section_parent_class)->finalize (object);
+}
+
+static void
+test_relation_section_get_property (GObject    *object,
+                                    guint       prop_id,
+                                    GValue     *value,
+                                    GParamSpec *pspec)
+{
+  TestRelationSection *self = (TestRelationSection *)object;
+
+  switch (prop_id)
+    {
+    case TEST_RELATION_SECTION_PROP_ID:
+      g_value_set_int64 (value, self->id);
+      break;
+
+    case TEST_RELATION_SECTION_PROP_PARENT_ID:
+      g_value_set_int64 (value, self->parent_id);
+      break;
+
+    case TEST_RELATION_SECTION_PROP_NAME:
+      g_value_set_string (value, self->name);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+test_relation_section_set_property (GObject      *object,
+                                    guint         prop_id,
+                                    const GValue *value,
+                                    GParamSpec   *pspec)
+{
+  TestRelationSection *self = (TestRelationSection *)object;
+
+  switch (prop_id)
+    {
+    case TEST_RELATION_SECTION_PROP_ID:
+      self->id = g_value_get_int64 (value);
+      break;
+
+    case TEST_RELATION_SECTION_PROP_PARENT_ID:
+      self->parent_id = g_value_get_int64 (value);
+      break;
+
+    case TEST_RELATION_SECTION_PROP_NAME:
+      g_set_str (&self->name, g_value_get_string (value));
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+test_relation_section_class_init (TestRelationSectionClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+  GomEntityClass *entity_class = GOM_ENTITY_CLASS (klass);
+
+  object_class->finalize = test_relation_section_finalize;
+  object_class->get_property = test_relation_section_get_property;
+  object_class->set_property = test_relation_section_set_property;
+
+  test_relation_section_properties[TEST_RELATION_SECTION_PROP_ID] =
+    g_param_spec_int64 ("id", NULL, NULL,
+                        G_MININT64, G_MAXINT64, 0,
+                        (G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  test_relation_section_properties[TEST_RELATION_SECTION_PROP_PARENT_ID] =
+    g_param_spec_int64 ("parent-id", NULL, NULL,
+                        G_MININT64, G_MAXINT64, 0,
+                        (G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  test_relation_section_properties[TEST_RELATION_SECTION_PROP_NAME] =
+    g_param_spec_string ("name", NULL, NULL,
+                         NULL,
+                         (G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_properties (object_class,
+                                     TEST_RELATION_SECTION_N_PROPS,
+                                     test_relation_section_properties);
+
+  gom_entity_class_set_relation (entity_class, "sections");
+  gom_entity_class_set_identity_field (entity_class, "id");
+  gom_entity_class_set_version_added (entity_class, 1);
+  gom_entity_class_property_set_mapped (entity_class, "id", TRUE);
+  gom_entity_class_property_set_mapped (entity_class, "parent-id", TRUE);
+  gom_entity_class_property_set_field_name (entity_class, "parent-id", "parent_id");
+  gom_entity_class_property_set_mapped (entity_class, "name", TRUE);
+  gom_entity_class_add_one_to_many (entity_class, "children", TEST_RELATION_SECTION_TYPE, "parent_id", "parent");
+  gom_entity_class_add_many_to_one (entity_class, "parent", TEST_RELATION_SECTION_TYPE, "parent_id", "children");
+}
+
+static void
+test_relation_section_init (TestRelationSection *self)
+{
+}
+
 static GomRegistry *
 test_relations_create_registry_with_book_author_delete_rule (GomRelationshipDeleteRule delete_rule)
 {
@@ -468,6 +608,24 @@ test_relations_create_registry (void)
   return test_relations_get_cached_registry_with_delete_rule (GOM_RELATIONSHIP_DELETE_NULLIFY);
 }
 
+/* The book and author relationships live on the classes, so this only
+ * needs the shared registry to have been built once before.
+ */
+static GomRegistry *
+test_relations_create_section_registry (void)
+{
+  g_autoptr(GomRegistryBuilder) builder = NULL;
+  g_autoptr(GomRegistry) relations_registry = test_relations_create_registry ();
+
+  builder = gom_registry_builder_new ();
+  gom_registry_builder_add_entity_type (builder, TEST_RELATION_AUTHOR_TYPE);
+  gom_registry_builder_add_entity_type (builder, TEST_RELATION_BOOK_TYPE);
+  gom_registry_builder_add_entity_type (builder, TEST_RELATION_TAG_TYPE);
+  gom_registry_builder_add_entity_type (builder, TEST_RELATION_SECTION_TYPE);
+
+  return gom_registry_builder_build (builder);
+}
+
 static gint64 test_sqlite_query_int64 (sqlite3    *db,
                                        const char *sql);
 
@@ -495,6 +653,20 @@ test_relations_delete_rule_cascade_assert (const char *db_path)
   test_sqlite_close (db);
 }
 
+static void
+test_relations_delete_rule_cascade_graph_assert (const char *db_path)
+{
+  sqlite3 *db = NULL;
+
+  test_sqlite_open (db_path, &db);
+  g_assert_cmpint (test_sqlite_query_int64 (db, "SELECT COUNT(*) FROM authors"), ==, 1);
+  g_assert_cmpint (test_sqlite_query_int64 (db, "SELECT COUNT(*) FROM books"), ==, 1);
+  g_assert_cmpint (test_sqlite_query_int64 (db, "SELECT COUNT(*) FROM book_tags"), ==, 1);
+  g_assert_cmpint (test_sqlite_query_int64 (db, "SELECT book_id FROM book_tags"), ==, 5000);
+  g_assert_cmpint (test_sqlite_query_int64 (db, "SELECT COUNT(*) FROM tags"), ==, 2);
+  test_sqlite_close (db);
+}
+
 static void
 test_relations_delete_rule_deny_assert (const char *db_path)
 {
@@ -587,6 +759,19 @@ test_query_model_items_changed_cb (GListModel *model,
   (*changed_count)++;
 }
 
+static void
+test_query_model_notify_loading_cb (GObject    *object,
+                                    GParamSpec *pspec,
+                                    gpointer    user_data)
+{
+  guint *loading_count = user_data;
+
+  g_assert_true (GOM_IS_QUERY_MODEL (object));
+
+  if (gom_query_model_get_loading (GOM_QUERY_MODEL (object)))
+    (*loading_count)++;
+}
+
 static gint64
 test_sqlite_query_int64 (sqlite3    *db,
                          const char *sql)
@@ -648,6 +833,41 @@ test_relations_delete_rule_cascade (void)
                                   test_relations_delete_rule_cascade_assert);
 }
 
+static void
+test_relations_delete_rule_cascade_graph (void)
+{
+  /* Enough books that their join-table rows span several batches */
+  test_relations_delete_rule_case ("gom-relations-delete-cascade-graph-XXXXXX",
+                                  "CREATE TABLE authors ("
+                                  "  id INTEGER PRIMARY KEY,"
+                                  "  name TEXT NOT NULL"
+                                  ");"
+                                  "CREATE TABLE books ("
+                                  "  id INTEGER PRIMARY KEY,"
+                                  "  author_id INTEGER NOT NULL,"
+                                  "  title TEXT NOT NULL"
+                                  ");"
+                                  "CREATE TABLE tags ("
+                                  "  id INTEGER PRIMARY KEY,"
+                                  "  name TEXT NOT NULL"
+                                  ");"
+                                  "CREATE TABLE book_tags ("
+                                  "  book_id INTEGER NOT NULL,"
+                                  "  tag_id INTEGER NOT NULL"
+                                  ");"
+                                  "INSERT INTO authors (id, name) VALUES (1, 'Ada'), (2, 'Grace');"
+                                  "INSERT INTO tags (id, name) VALUES (100, 'gtk'), (101, 'sqlite');"
+                                  "WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < 1200) "
+                                  "INSERT INTO books (id, author_id, title) SELECT i, 1, 'Book ' || i FROM n;"
+                                  "INSERT INTO books (id, author_id, title) VALUES (5000, 2, 'Other');"
+                                  "INSERT INTO book_tags (book_id, tag_id) SELECT id, 100 FROM books WHERE author_id = 1;"
+                                  "INSERT INTO book_tags (book_id, tag_id) SELECT id, 101 FROM books WHERE author_id = 1;"
+                                  "INSERT INTO book_tags (book_id, tag_id) VALUES (5000, 100);",
+                                  GOM_RELATIONSHIP_DELETE_CASCADE,
+                                  FALSE,
+                                  test_relations_delete_rule_cascade_graph_assert);
+}
+
 static void
 test_relations_delete_rule_deny (void)
 {
@@ -926,24 +1146,22 @@ test_relations_repository_load (void)
 }
 
 static void
-test_relations_session_flush_relationship_change (void)
+test_relations_prefetch (void)
 {
   g_autoptr(GError) error = NULL;
   g_autoptr(GomRegistry) registry = NULL;
   g_autoptr(GomRepository) repository = NULL;
   g_autoptr(GomSession) session = NULL;
+  g_autoptr(GomQueryBuilder) builder = NULL;
+  g_autoptr(GomQuery) query = NULL;
+  g_autoptr(GomCursor) cursor = NULL;
   g_autoptr(GObject) books = NULL;
   g_autoptr(GObject) authors = NULL;
-  g_autoptr(GomEntity) book = NULL;
-  g_autoptr(GomEntity) author1 = NULL;
-  g_autoptr(GomEntity) author2 = NULL;
-  g_autoptr(GomRelatedModel) related_books = NULL;
-  g_autoptr(GomRelatedModel) related_books_for_new_author = NULL;
+  g_autoptr(GomEntity) first_author = NULL;
   g_auto(TestSqliteContext) context = {0};
   sqlite3 *db = NULL;
-  guint session_changed_count = 0;
 
-  g_assert_true (test_sqlite_context_init (&context, "gom-relations-session-flush-XXXXXX", &error));
+  g_assert_true (test_sqlite_context_init (&context, "gom-relations-prefetch-XXXXXX", &error));
 
   test_sqlite_open (context.db_path, &db);
   test_sqlite_exec_ok (db,
@@ -964,91 +1182,142 @@ test_relations_session_flush_relationship_change (void)
                        "  book_id INTEGER NOT NULL,"
                        "  tag_id INTEGER NOT NULL"
                        ");"
-                       "INSERT INTO authors (id, name) VALUES "
-                       "  (1, 'Ada'),"
-                       "  (2, 'Bea');"
-                       "INSERT INTO books (id, author_id, title) VALUES (10, 1, 'First');");
+                       "INSERT INTO authors (id, name) VALUES (1, 'Ada'), (2, 'Grace'), (3, 'Edsger');"
+                       "INSERT INTO books (id, author_id, title) VALUES "
+                       "  (10, 1, 'First'),"
+                       "  (11, 1, 'Second'),"
+                       "  (12, 2, 'Third');"
+                       "INSERT INTO tags (id, name) VALUES "
+                       "  (100, 'gtk'),"
+                       "  (101, 'sqlite');"
+                       "INSERT INTO book_tags (book_id, tag_id) VALUES "
+                       "  (10, 100),"
+                       "  (10, 101),"
+                       "  (12, 101);");
   test_sqlite_close (db);
 
   registry = test_relations_create_registry ();
   repository = test_sqlite_context_create_repository (&context, registry, &error);
   g_assert_no_error (error);
+  g_assert_nonnull (repository);
 
   session = dex_await_object (gom_repository_begin_session (repository), &error);
   g_assert_no_error (error);
   g_assert_nonnull (session);
-  g_signal_connect (session,
-                    "changed",
-                    G_CALLBACK (test_relation_session_changed_cb),
-                    &session_changed_count);
 
-  authors = dex_await_object (gom_session_list_entities (session,
-                                                         TEST_RELATION_AUTHOR_TYPE,
-                                                         gom_binary_expression_new_equal (gom_field_expression_new ("id"), gom_literal_expression_new_int64 (1)),
-                                                         NULL),
-                              &error);
-  g_assert_no_error (error);
-  g_assert_nonnull (authors);
-  author1 = g_list_model_get_item (G_LIST_MODEL (authors), 0);
-  g_assert_nonnull (author1);
+  builder = gom_query_builder_new ();
+  gom_query_builder_set_target_entity_type (builder, TEST_RELATION_BOOK_TYPE);
+  gom_query_builder_add_prefetch (builder, "does-not-exist");
+  query = gom_query_builder_build (builder, &error);
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT);
+  g_assert_null (query);
+  g_clear_error (&error);
 
-  authors = dex_await_object (gom_session_list_entities (session,
-                                                         TEST_RELATION_AUTHOR_TYPE,
-                                                         gom_binary_expression_new_equal (gom_field_expression_new ("id"), gom_literal_expression_new_int64 (2)),
-                                                         NULL),
-                              &error);
+  gom_query_builder_clear_prefetches (builder);
+  gom_query_builder_add_prefetch (builder, "author");
+  gom_query_builder_add_prefetch (builder, "tags");
+  gom_query_builder_add_ordering (builder, gom_ordering_new (gom_field_expression_new ("id"), GOM_SORT_ASCENDING));
+  query = gom_query_builder_build (builder, &error);
   g_assert_no_error (error);
-  g_assert_nonnull (authors);
-  author2 = g_list_model_get_item (G_LIST_MODEL (authors), 0);
-  g_assert_nonnull (author2);
+  g_assert_nonnull (query);
 
-  books = dex_await_object (gom_session_list_entities (session,
-                                                       TEST_RELATION_BOOK_TYPE,
-                                                       gom_binary_expression_new_equal (gom_field_expression_new ("id"), gom_literal_expression_new_int64 (10)),
-                                                       NULL),
-                            &error);
+  cursor = dex_await_object (gom_session_query (session, query), &error);
   g_assert_no_error (error);
-  g_assert_nonnull (books);
-  book = g_list_model_get_item (G_LIST_MODEL (books), 0);
-  g_assert_nonnull (book);
+  g_assert_nonnull (cursor);
+  books = dex_await_object (gom_cursor_exhaust_to_list (cursor), &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (books)), ==, 3);
 
-  related_books = dex_await_object (gom_entity_load_related_model (author1, "books"), &error);
+  g_clear_object (&builder);
+  g_clear_object (&query);
+  g_clear_object (&cursor);
+
+  builder = gom_query_builder_new ();
+  gom_query_builder_set_target_entity_type (builder, TEST_RELATION_AUTHOR_TYPE);
+  gom_query_builder_add_prefetch (builder, "books");
+  gom_query_builder_add_ordering (builder, gom_ordering_new (gom_field_expression_new ("id"), GOM_SORT_ASCENDING));
+  query = gom_query_builder_build (builder, &error);
   g_assert_no_error (error);
-  g_assert_nonnull (related_books);
-  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (related_books)), ==, 1);
 
-  related_books_for_new_author = dex_await_object (gom_entity_load_related_model (author2,
-                                                                                  "books"),
-                                                   &error);
+  cursor = dex_await_object (gom_session_query (session, query), &error);
   g_assert_no_error (error);
-  g_assert_nonnull (related_books_for_new_author);
-  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (related_books_for_new_author)), ==, 0);
+  authors = dex_await_object (gom_cursor_exhaust_to_list (cursor), &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (authors)), ==, 3);
 
-  g_object_set (book,
-                "author-id", (gint64) 2,
-                NULL);
-  dex_await (gom_session_flush (session), &error);
+  /* Related lookups must not touch the database anymore, even once the
+   * session that loaded them is gone.
+   */
+  g_assert_true (dex_await (gom_session_rollback (session), &error));
   g_assert_no_error (error);
-  g_assert_cmpuint (session_changed_count, >, 0);
 
+  test_sqlite_open (context.db_path, &db);
+  test_sqlite_exec_ok (db, "DROP TABLE book_tags; ALTER TABLE books RENAME TO old_books;");
+  test_sqlite_close (db);
+
+  for (guint i = 0; i < 3; i++)
+    {
+      static const gint64 expected_author[] = { 1, 1, 2 };
+      static const guint expected_tags[] = { 2, 0, 1 };
+      g_autoptr(GomEntity) book = g_list_model_get_item (G_LIST_MODEL (books), i);
+      g_autoptr(GomEntity) author = NULL;
+      g_autoptr(GomRelatedModel) tags = NULL;
+
+      author = dex_await_object (gom_entity_load_related_entity (book, "author"), &error);
+      g_assert_no_error (error);
+      g_assert_nonnull (author);
+      g_assert_cmpint (((TestRelationAuthor *)author)->id, ==, expected_author[i]);
+
+      if (first_author == NULL)
+        first_author = g_object_ref (author);
+      else if (expected_author[i] == 1)
+        g_assert_true (first_author == author);
+
+      tags = dex_await_object (gom_entity_load_related_model (book, "tags"), &error);
+      g_assert_no_error (error);
+      g_assert_nonnull (tags);
+      g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (tags)), ==, expected_tags[i]);
+    }
+
+  for (guint i = 0; i < 3; i++)
+    {
+      static const guint expected_books[] = { 2, 1, 0 };
+      g_autoptr(GomEntity) author = g_list_model_get_item (G_LIST_MODEL (authors), i);
+      g_autoptr(GomRelatedModel) related_books = NULL;
+
+      related_books = dex_await_object (gom_entity_load_related_model (author, "books"), &error);
+      g_assert_no_error (error);
+      g_assert_nonnull (related_books);
+      g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (related_books)), ==, expected_books[i]);
+    }
+
+  /* The authors were already seeded into the session by the books query. */
+  {
+    g_autoptr(GomEntity) author = g_list_model_get_item (G_LIST_MODEL (authors), 0);
+
+    g_assert_true (author == first_author);
+  }
 }
 
 static void
-test_relations_query_model_refreshes_on_session_change (void)
+test_relations_prefetch_reload_sees_new_children (void)
 {
   g_autoptr(GError) error = NULL;
   g_autoptr(GomRegistry) registry = NULL;
   g_autoptr(GomRepository) repository = NULL;
   g_autoptr(GomSession) session = NULL;
-  g_autoptr(GomQueryModel) model = NULL;
-  g_autoptr(GObject) books = NULL;
+  g_autoptr(GomQueryBuilder) builder = NULL;
+  g_autoptr(GomQuery) query = NULL;
+  g_autoptr(GomCursor) cursor = NULL;
+  g_autoptr(GObject) authors = NULL;
+  g_autoptr(GomEntity) author = NULL;
   g_autoptr(GomEntity) book = NULL;
-  guint *items_changed_count = NULL;
+  g_autoptr(GomRelatedModel) books = NULL;
   g_auto(TestSqliteContext) context = {0};
+  gboolean found = FALSE;
   sqlite3 *db = NULL;
-  guint initial_items_changed_count = 0;
 
-  g_assert_true (test_sqlite_context_init (&context, "gom-relations-query-model-XXXXXX", &error));
+  g_assert_true (test_sqlite_context_init (&context, "gom-relations-prefetch-reload-XXXXXX", &error));
 
   test_sqlite_open (context.db_path, &db);
   test_sqlite_exec_ok (db,
@@ -1069,9 +1338,7 @@ test_relations_query_model_refreshes_on_session_change (void)
                        "  book_id INTEGER NOT NULL,"
                        "  tag_id INTEGER NOT NULL"
                        ");"
-                       "INSERT INTO authors (id, name) VALUES "
-                       "  (1, 'Ada'),"
-                       "  (2, 'Bea');"
+                       "INSERT INTO authors (id, name) VALUES (1, 'Ada'), (2, 'Grace');"
                        "INSERT INTO books (id, author_id, title) VALUES "
                        "  (10, 1, 'First'),"
                        "  (11, 1, 'Second');");
@@ -1083,18 +1350,474 @@ test_relations_query_model_refreshes_on_session_change (void)
 
   session = dex_await_object (gom_repository_begin_session (repository), &error);
   g_assert_no_error (error);
-  g_assert_nonnull (session);
 
-  model = gom_query_model_new (session,
-                               TEST_RELATION_BOOK_TYPE,
-                               gom_binary_expression_new_equal (gom_field_expression_new ("author-id"),
-                                                                gom_literal_expression_new_int64 (1)),
-                               gom_ordering_new (gom_field_expression_new ("id"), GOM_SORT_ASCENDING));
-  g_assert_nonnull (model);
-  items_changed_count = g_new0 (guint, 1);
-  g_signal_connect_data (model,
-                         "items-changed",
-                         G_CALLBACK (test_query_model_items_changed_cb),
+  builder = gom_query_builder_new ();
+  gom_query_builder_set_target_entity_type (builder, TEST_RELATION_AUTHOR_TYPE);
+  gom_query_builder_add_prefetch (builder, "books");
+  gom_query_builder_add_ordering (builder, gom_ordering_new (gom_field_expression_new ("id"), GOM_SORT_ASCENDING));
+  query = gom_query_builder_build (builder, &error);
+  g_assert_no_error (error);
+
+  cursor = dex_await_object (gom_session_query (session, query), &error);
+  g_assert_no_error (error);
+  authors = dex_await_object (gom_cursor_exhaust_to_list (cursor), &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (authors)), ==, 2);
+
+  author = g_list_model_get_item (G_LIST_MODEL (authors), 0);
+
+  books = dex_await_object (gom_entity_load_related_model (author, "books"), &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (books)), ==, 2);
+  g_clear_object (&books);
+
+  book = g_object_new (TEST_RELATION_BOOK_TYPE,
+                       "id", (gint64)12,
+                       "author-id", (gint64)1,
+                       "title", "Third",
+                       NULL);
+  gom_entity_set_repository (book, repository);
+  g_assert_true (dex_await (gom_session_persist (session, book), &error));
+  g_assert_no_error (error);
+  g_assert_true (dex_await (gom_session_flush (session), &error));
+  g_assert_no_error (error);
+
+  /* The prefetched rows were used up by the first load, so this one
+   * must query again and find the new child.
+   */
+  books = dex_await_object (gom_entity_load_related_model (author, "books"), &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (books)), ==, 3);
+
+  for (guint i = 0; i < 3; i++)
+    {
+      g_autoptr(GomEntity) item = g_list_model_get_item (G_LIST_MODEL (books), i);
+
+      if (((TestRelationBook *)item)->id == 12)
+        found = TRUE;
+    }
+
+  g_assert_true (found);
+}
+
+static void
+test_relations_related_model_batched_reload (void)
+{
+  g_autoptr(GError) error = NULL;
+  g_autoptr(GomRegistry) registry = NULL;
+  g_autoptr(GomRepository) repository = NULL;
+  g_autoptr(GomSession) session = NULL;
+  g_autoptr(GPtrArray) models = NULL;
+  g_autoptr(GObject) authors = NULL;
+  g_auto(TestSqliteContext) context = {0};
+  static const guint expected_books[] = { 2, 1, 0 };
+  sqlite3 *db = NULL;
+  int statements_before;
+  int statements_after;
+
+  g_assert_true (test_sqlite_context_init (&context, "gom-relations-batched-XXXXXX", &error));
+
+  test_sqlite_open (context.db_path, &db);
+  test_sqlite_exec_ok (db,
+                       "CREATE TABLE authors ("
+                       "  id INTEGER PRIMARY KEY,"
+                       "  name TEXT NOT NULL"
+                       ");"
+                       "CREATE TABLE books ("
+                       "  id INTEGER PRIMARY KEY,"
+                       "  author_id INTEGER NOT NULL,"
+                       "  title TEXT NOT NULL"
+                       ");"
+                       "CREATE TABLE tags ("
+                       "  id INTEGER PRIMARY KEY,"
+                       "  name TEXT NOT NULL"
+                       ");"
+                       "CREATE TABLE book_tags ("
+                       "  book_id INTEGER NOT NULL,"
+                       "  tag_id INTEGER NOT NULL"
+                       ");"
+                       "INSERT INTO authors (id, name) VALUES (1, 'Ada'), (2, 'Grace'), (3, 'Edsger');"
+                       "INSERT INTO books (id, author_id, title) VALUES "
+                       "  (10, 1, 'First'),"
+                       "  (11, 1, 'Second'),"
+                       "  (12, 2, 'Third');");
+  test_sqlite_close (db);
+
+  registry = test_relations_create_registry ();
+  repository = test_sqlite_context_create_repository (&context, registry, &error);
+  g_assert_no_error (error);
+  g_assert_nonnull (repository);
+
+  session = dex_await_object (gom_repository_begin_session (repository), &error);
+  g_assert_no_error (error);
+  g_assert_nonnull (session);
+
+  authors = dex_await_object (gom_session_list_entities (session,
+                                                         TEST_RELATION_AUTHOR_TYPE,
+                                                         NULL,
+                                                         gom_ordering_new (gom_field_expression_new ("id"), GOM_SORT_ASCENDING)),
+                              &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (authors)), ==, 3);
+
+  models = g_ptr_array_new_with_free_func (g_object_unref);
+
+  for (guint i = 0; i < 3; i++)
+    {
+      g_autoptr(GomEntity) author = g_list_model_get_item (G_LIST_MODEL (authors), i);
+
+      g_ptr_array_add (models, gom_related_model_new (author, "books"));
+    }
+
+  /* All three reloads are queued in the same main loop iteration and
+   * must be answered by a shared query.
+   */
+  statements_before = gom_trace_counter_get (GOM_TRACE_COUNTER_STATEMENT_CACHE_HITS) +
+                      gom_trace_counter_get (GOM_TRACE_COUNTER_STATEMENT_CACHE_MISSES);
+
+  g_assert_true (dex_await (dex_future_all (gom_related_model_reload (g_ptr_array_index (models, 0)),
+                                            gom_related_model_reload (g_ptr_array_index (models, 1)),
+                                            gom_related_model_reload (g_ptr_array_index (models, 2)),
+                                            NULL),
+                            &error));
+  g_assert_no_error (error);
+
+  statements_after = gom_trace_counter_get (GOM_TRACE_COUNTER_STATEMENT_CACHE_HITS) +
+                     gom_trace_counter_get (GOM_TRACE_COUNTER_STATEMENT_CACHE_MISSES);
+  g_assert_cmpint (statements_after - statements_before, <, 3);
+
+  for (guint i = 0; i < 3; i++)
+    {
+      GListModel *books = g_ptr_array_index (models, i);
+      g_autoptr(GomEntity) author = g_list_model_get_item (G_LIST_MODEL (authors), i);
+
+      g_assert_cmpuint (g_list_model_get_n_items (books), ==, expected_books[i]);
+
+      for (guint j = 0; j < expected_books[i]; j++)
+        {
+          g_autoptr(GomEntity) book = g_list_model_get_item (books, j);
+
+          g_assert_cmpint (((TestRelationBook *)book)->author_id, ==, ((TestRelationAuthor *)author)->id);
+        }
+    }
+}
+
+static GomEntity *
+test_relations_persist_new (GomSession    *session,
+                            GomRepository *repository,
+                            GType          entity_type,
+                            const char    *first_property_name,
+                            ...)
+{
+  g_autoptr(GomEntity) entity = NULL;
+  g_autoptr(GError) error = NULL;
+  va_list args;
+
+  va_start (args, first_property_name);
+  entity = GOM_ENTITY (g_object_new_valist (entity_type, first_property_name, args));
+  va_end (args);
+
+  gom_entity_set_repository (entity, repository);
+  g_assert_true (dex_await (gom_session_persist (session, entity), &error));
+  g_assert_no_error (error);
+
+  return g_steal_pointer (&entity);
+}
+
+static void
+test_relations_session_flush_batches_related_types (void)
+{
+  g_autoptr(GError) error = NULL;
+  g_autoptr(GomRegistry) registry = NULL;
+  g_autoptr(GomRepository) repository = NULL;
+  g_autoptr(GomSession) session = NULL;
+  g_autoptr(GPtrArray) entities = NULL;
+  g_autoptr(GPtrArray) batch = NULL;
+  g_auto(TestSqliteContext) context = {0};
+  GQueue queue = G_QUEUE_INIT;
+  sqlite3 *db = NULL;
+
+  g_assert_true (test_sqlite_context_init (&context, "gom-relations-flush-batches-XXXXXX", &error));
+
+  test_sqlite_open (context.db_path, &db);
+  test_sqlite_exec_ok (db,
+                       "CREATE TABLE authors ("
+                       "  id INTEGER PRIMARY KEY,"
+                       "  name TEXT NOT NULL"
+                       ");"
+                       "CREATE TABLE books ("
+                       "  id INTEGER PRIMARY KEY,"
+                       "  author_id INTEGER NOT NULL,"
+                       "  title TEXT NOT NULL"
+                       ");"
+                       "CREATE TABLE tags ("
+                       "  id INTEGER PRIMARY KEY,"
+                       "  name TEXT NOT NULL"
+                       ");"
+                       "CREATE TABLE book_tags ("
+                       "  book_id INTEGER NOT NULL,"
+                       "  tag_id INTEGER NOT NULL"
+                       ");"
+                       "CREATE TABLE sections ("
+                       "  id INTEGER PRIMARY KEY,"
+                       "  parent_id INTEGER,"
+                       "  name TEXT NOT NULL"
+                       ");");
+  test_sqlite_close (db);
+
+  registry = test_relations_create_section_registry ();
+  repository = test_sqlite_context_create_repository (&context, registry, &error);
+  g_assert_no_error (error);
+
+  session = dex_await_object (gom_repository_begin_session (repository), &error);
+  g_assert_no_error (error);
+  g_assert_nonnull (session);
+
+  /* Parents, children and a self-referencing tree persisted interleaved */
+  entities = g_ptr_array_new_with_free_func (g_object_unref);
+  g_ptr_array_add (entities, test_relations_persist_new (session, repository, TEST_RELATION_AUTHOR_TYPE,
+                                                         "id", (gint64)1, "name", "Ada", NULL));
+  g_ptr_array_add (entities, test_relations_persist_new (session, repository, TEST_RELATION_AUTHOR_TYPE,
+                                                         "id", (gint64)2, "name", "Grace", NULL));
+  g_ptr_array_add (entities, test_relations_persist_new (session, repository, TEST_RELATION_SECTION_TYPE,
+                                                         "id", (gint64)1, "name", "Root", NULL));
+  g_ptr_array_add (entities, test_relations_persist_new (session, repository, TEST_RELATION_BOOK_TYPE,
+                                                         "id", (gint64)10, "author-id", (gint64)1, "title", "First", NULL));
+  g_ptr_array_add (entities, test_relations_persist_new (session, repository, TEST_RELATION_SECTION_TYPE,
+                                                         "id", (gint64)2, "parent-id", (gint64)1, "name", "Child", NULL));
+  g_ptr_array_add (entities, test_relations_persist_new (session, repository, TEST_RELATION_AUTHOR_TYPE,
+                                                         "id", (gint64)3, "name", "Barbara", NULL));
+  g_ptr_array_add (entities, test_relations_persist_new (session, repository, TEST_RELATION_BOOK_TYPE,
+                                                         "id", (gint64)11, "author-id", (gint64)3, "title", "Second", NULL));
+  g_ptr_array_add (entities, test_relations_persist_new (session, repository, TEST_RELATION_SECTION_TYPE,
+                                                         "id", (gint64)3, "parent-id", (gint64)2, "name", "Grandchild", NULL));
+  g_ptr_array_add (entities, test_relations_persist_new (session, repository, TEST_RELATION_BOOK_TYPE,
+                                                         "id", (gint64)12, "author-id", (gint64)2, "title", "Third", NULL));
+
+  /* Batches skip unrelated types but stop at a related one, and a type
+   * that references itself is never batched.
+   */
+  for (guint i = 0; i < entities->len; i++)
+    g_queue_push_tail (&queue, g_ptr_array_index (entities, i));
+
+  batch = _gom_entity_collect_insert_batch (&queue, 64);
+  g_assert_cmpuint (batch->len, ==, 2);
+  g_assert_true (g_ptr_array_index (batch, 0) == g_ptr_array_index (entities, 0));
+  g_assert_true (g_ptr_array_index (batch, 1) == g_ptr_array_index (entities, 1));
+  g_clear_pointer (&batch, g_ptr_array_unref);
+
+  g_queue_pop_head (&queue);
+  g_queue_pop_head (&queue);
+  batch = _gom_entity_collect_insert_batch (&queue, 64);
+  g_assert_cmpuint (batch->len, ==, 1);
+  g_assert_true (g_ptr_array_index (batch, 0) == g_ptr_array_index (entities, 2));
+  g_clear_pointer (&batch, g_ptr_array_unref);
+
+  g_queue_pop_head (&queue);
+  batch = _gom_entity_collect_insert_batch (&queue, 64);
+  g_assert_cmpuint (batch->len, ==, 1);
+  g_assert_true (g_ptr_array_index (batch, 0) == g_ptr_array_index (entities, 3));
+  g_clear_pointer (&batch, g_ptr_array_unref);
+
+  g_queue_clear (&queue);
+
+  /* Every row checks its references before it is written, so the flush
+   * only succeeds if each parent was inserted ahead of its children.
+   */
+  g_assert_true (dex_await (gom_session_flush (session), &error));
+  g_assert_no_error (error);
+
+  for (guint i = 0; i < entities->len; i++)
+    g_assert_cmpint (gom_entity_get_lifecycle (g_ptr_array_index (entities, i)), ==, GOM_ENTITY_LIFECYCLE_PERSISTENT);
+
+  g_assert_true (dex_await (gom_session_commit (session), &error));
+  g_assert_no_error (error);
+
+  test_sqlite_open (context.db_path, &db);
+  g_assert_cmpint (test_sqlite_query_int64 (db, "SELECT COUNT(*) FROM authors"), ==, 3);
+  g_assert_cmpint (test_sqlite_query_int64 (db,
+                                            "SELECT COUNT(*) FROM books "
+                                            "JOIN authors ON authors.id = books.author_id"),
+                   ==, 3);
+  g_assert_cmpint (test_sqlite_query_int64 (db, "SELECT author_id FROM books WHERE id = 12"), ==, 2);
+  g_assert_cmpint (test_sqlite_query_int64 (db,
+                                            "SELECT COUNT(*) FROM sections AS child "
+                                            "JOIN sections AS parent ON parent.id = child.parent_id"),
+                   ==, 2);
+  g_assert_cmpint (test_sqlite_query_int64 (db, "SELECT parent_id FROM sections WHERE id = 3"), ==, 2);
+  test_sqlite_close (db);
+}
+
+static void
+test_relations_session_flush_relationship_change (void)
+{
+  g_autoptr(GError) error = NULL;
+  g_autoptr(GomRegistry) registry = NULL;
+  g_autoptr(GomRepository) repository = NULL;
+  g_autoptr(GomSession) session = NULL;
+  g_autoptr(GObject) books = NULL;
+  g_autoptr(GObject) authors = NULL;
+  g_autoptr(GomEntity) book = NULL;
+  g_autoptr(GomEntity) author1 = NULL;
+  g_autoptr(GomEntity) author2 = NULL;
+  g_autoptr(GomRelatedModel) related_books = NULL;
+  g_autoptr(GomRelatedModel) related_books_for_new_author = NULL;
+  g_auto(TestSqliteContext) context = {0};
+  sqlite3 *db = NULL;
+  guint session_changed_count = 0;
+
+  g_assert_true (test_sqlite_context_init (&context, "gom-relations-session-flush-XXXXXX", &error));
+
+  test_sqlite_open (context.db_path, &db);
+  test_sqlite_exec_ok (db,
+                       "CREATE TABLE authors ("
+                       "  id INTEGER PRIMARY KEY,"
+                       "  name TEXT NOT NULL"
+                       ");"
+                       "CREATE TABLE books ("
+                       "  id INTEGER PRIMARY KEY,"
+                       "  author_id INTEGER NOT NULL,"
+                       "  title TEXT NOT NULL"
+                       ");"
+                       "CREATE TABLE tags ("
+                       "  id INTEGER PRIMARY KEY,"
+                       "  name TEXT NOT NULL"
+                       ");"
+                       "CREATE TABLE book_tags ("
+                       "  book_id INTEGER NOT NULL,"
+                       "  tag_id INTEGER NOT NULL"
+                       ");"
+                       "INSERT INTO authors (id, name) VALUES "
+                       "  (1, 'Ada'),"
+                       "  (2, 'Bea');"
+                       "INSERT INTO books (id, author_id, title) VALUES (10, 1, 'First');");
+  test_sqlite_close (db);
+
+  registry = test_relations_create_registry ();
+  repository = test_sqlite_context_create_repository (&context, registry, &error);
+  g_assert_no_error (error);
+
+  session = dex_await_object (gom_repository_begin_session (repository), &error);
+  g_assert_no_error (error);
+  g_assert_nonnull (session);
+  g_signal_connect (session,
+                    "changed",
+                    G_CALLBACK (test_relation_session_changed_cb),
+                    &session_changed_count);
+
+  authors = dex_await_object (gom_session_list_entities (session,
+                                                         TEST_RELATION_AUTHOR_TYPE,
+                                                         gom_binary_expression_new_equal (gom_field_expression_new ("id"), gom_literal_expression_new_int64 (1)),
+                                                         NULL),
+                              &error);
+  g_assert_no_error (error);
+  g_assert_nonnull (authors);
+  author1 = g_list_model_get_item (G_LIST_MODEL (authors), 0);
+  g_assert_nonnull (author1);
+
+  authors = dex_await_object (gom_session_list_entities (session,
+                                                         TEST_RELATION_AUTHOR_TYPE,
+                                                         gom_binary_expression_new_equal (gom_field_expression_new ("id"), gom_literal_expression_new_int64 (2)),
+                                                         NULL),
+                              &error);
+  g_assert_no_error (error);
+  g_assert_nonnull (authors);
+  author2 = g_list_model_get_item (G_LIST_MODEL (authors), 0);
+  g_assert_nonnull (author2);
+
+  books = dex_await_object (gom_session_list_entities (session,
+                                                       TEST_RELATION_BOOK_TYPE,
+                                                       gom_binary_expression_new_equal (gom_field_expression_new ("id"), gom_literal_expression_new_int64 (10)),
+                                                       NULL),
+                            &error);
+  g_assert_no_error (error);
+  g_assert_nonnull (books);
+  book = g_list_model_get_item (G_LIST_MODEL (books), 0);
+  g_assert_nonnull (book);
+
+  related_books = dex_await_object (gom_entity_load_related_model (author1, "books"), &error);
+  g_assert_no_error (error);
+  g_assert_nonnull (related_books);
+  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (related_books)), ==, 1);
+
+  related_books_for_new_author = dex_await_object (gom_entity_load_related_model (author2,
+                                                                                  "books"),
+                                                   &error);
+  g_assert_no_error (error);
+  g_assert_nonnull (related_books_for_new_author);
+  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (related_books_for_new_author)), ==, 0);
+
+  g_object_set (book,
+                "author-id", (gint64) 2,
+                NULL);
+  dex_await (gom_session_flush (session), &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (session_changed_count, >, 0);
+
+}
+
+static void
+test_relations_query_model_refreshes_on_session_change (void)
+{
+  g_autoptr(GError) error = NULL;
+  g_autoptr(GomRegistry) registry = NULL;
+  g_autoptr(GomRepository) repository = NULL;
+  g_autoptr(GomSession) session = NULL;
+  g_autoptr(GomQueryModel) model = NULL;
+  g_autoptr(GObject) books = NULL;
+  g_autoptr(GomEntity) book = NULL;
+  guint *items_changed_count = NULL;
+  g_auto(TestSqliteContext) context = {0};
+  sqlite3 *db = NULL;
+  guint initial_items_changed_count = 0;
+
+  g_assert_true (test_sqlite_context_init (&context, "gom-relations-query-model-XXXXXX", &error));
+
+  test_sqlite_open (context.db_path, &db);
+  test_sqlite_exec_ok (db,
+                       "CREATE TABLE authors ("
+                       "  id INTEGER PRIMARY KEY,"
+                       "  name TEXT NOT NULL"
+                       ");"
+                       "CREATE TABLE books ("
+                       "  id INTEGER PRIMARY KEY,"
+                       "  author_id INTEGER NOT NULL,"
+                       "  title TEXT NOT NULL"
+                       ");"
+                       "CREATE TABLE tags ("
+                       "  id INTEGER PRIMARY KEY,"
+                       "  name TEXT NOT NULL"
+                       ");"
+                       "CREATE TABLE book_tags ("
+                       "  book_id INTEGER NOT NULL,"
+                       "  tag_id INTEGER NOT NULL"
+                       ");"
+                       "INSERT INTO authors (id, name) VALUES "
+                       "  (1, 'Ada'),"
+                       "  (2, 'Bea');"
+                       "INSERT INTO books (id, author_id, title) VALUES "
+                       "  (10, 1, 'First'),"
+                       "  (11, 1, 'Second');");
+  test_sqlite_close (db);
+
+  registry = test_relations_create_registry ();
+  repository = test_sqlite_context_create_repository (&context, registry, &error);
+  g_assert_no_error (error);
+
+  session = dex_await_object (gom_repository_begin_session (repository), &error);
+  g_assert_no_error (error);
+  g_assert_nonnull (session);
+
+  model = gom_query_model_new (session,
+                               TEST_RELATION_BOOK_TYPE,
+                               gom_binary_expression_new_equal (gom_field_expression_new ("author-id"),
+                                                                gom_literal_expression_new_int64 (1)),
+                               gom_ordering_new (gom_field_expression_new ("id"), GOM_SORT_ASCENDING));
+  g_assert_nonnull (model);
+  items_changed_count = g_new0 (guint, 1);
+  g_signal_connect_data (model,
+                         "items-changed",
+                         G_CALLBACK (test_query_model_items_changed_cb),
                          items_changed_count,
                          (GClosureNotify) g_free,
                          0);
@@ -1129,6 +1852,170 @@ test_relations_query_model_refreshes_on_session_change (void)
 
 }
 
+static void
+test_relations_query_model_reloads_committed_relation (void)
+{
+  g_autoptr(GError) error = NULL;
+  g_autoptr(GomRegistry) registry = NULL;
+  g_autoptr(GomRepository) repository = NULL;
+  g_autoptr(GomSession) session = NULL;
+  g_autoptr(GomQueryModel) books_model = NULL;
+  g_autoptr(GomQueryModel) authors_model = NULL;
+  g_autoptr(GomChangeSet) changes = NULL;
+  g_auto(TestSqliteContext) context = {0};
+  sqlite3 *db = NULL;
+  guint books_loading = 0;
+  guint authors_loading = 0;
+
+  g_assert_true (test_sqlite_context_init (&context, "gom-relations-reload-committed-XXXXXX", &error));
+
+  test_sqlite_open (context.db_path, &db);
+  test_sqlite_exec_ok (db,
+                       "CREATE TABLE authors ("
+                       "  id INTEGER PRIMARY KEY,"
+                       "  name TEXT NOT NULL"
+                       ");"
+                       "CREATE TABLE books ("
+                       "  id INTEGER PRIMARY KEY,"
+                       "  author_id INTEGER NOT NULL,"
+                       "  title TEXT NOT NULL"
+                       ");"
+                       "INSERT INTO authors (id, name) VALUES (1, 'Ada');"
+                       "INSERT INTO books (id, author_id, title) VALUES (10, 1, 'First');");
+  test_sqlite_close (db);
+
+  registry = test_relations_create_registry ();
+  repository = test_sqlite_context_create_repository (&context, registry, &error);
+  g_assert_no_error (error);
+
+  session = dex_await_object (gom_repository_begin_session (repository), &error);
+  g_assert_no_error (error);
+
+  books_model = gom_query_model_new (session, TEST_RELATION_BOOK_TYPE, NULL, NULL);
+  authors_model = gom_query_model_new (session, TEST_RELATION_AUTHOR_TYPE, NULL, NULL);
+
+  dex_await (gom_query_model_reload (books_model), &error);
+  g_assert_no_error (error);
+  dex_await (gom_query_model_reload (authors_model), &error);
+  g_assert_no_error (error);
+
+  g_signal_connect (books_model, "notify::loading", G_CALLBACK (test_query_model_notify_loading_cb), &books_loading);
+  g_signal_connect (authors_model, "notify::loading", G_CALLBACK (test_query_model_notify_loading_cb), &authors_loading);
+
+  /* Rows written by a trigger, a cascade or another session only show up
+   * in the committed change sets, never in a mutation of this session.
+   */
+  changes = _gom_change_set_new ();
+  _gom_change_set_add_rowid (changes, "books", GOM_DELTA_KIND_INSERT, 11);
+  _gom_change_set_add_rowid (changes, "books", GOM_DELTA_KIND_INSERT, 12);
+  _gom_repository_emit_changes (repository, changes);
+
+  for (guint i = 0; i < 100 && (books_loading == 0 || gom_query_model_get_loading (books_model)); i++)
+    dex_await (dex_timeout_new_msec (10), NULL);
+
+  g_assert_cmpuint (books_loading, >, 0);
+  g_assert_cmpuint (authors_loading, ==, 0);
+}
+
+static void
+test_relations_query_model_reloads_touched_relation (void)
+{
+  g_autoptr(GError) error = NULL;
+  g_autoptr(GomRegistry) registry = NULL;
+  g_autoptr(GomRepository) repository = NULL;
+  g_autoptr(GomSession) session = NULL;
+  g_autoptr(GomQueryModel) books_model = NULL;
+  g_autoptr(GomQueryModel) authors_model = NULL;
+  g_autoptr(GObject) books = NULL;
+  g_autoptr(GomEntity) first = NULL;
+  g_autoptr(GomEntity) second = NULL;
+  g_auto(TestSqliteContext) context = {0};
+  sqlite3 *db = NULL;
+  guint books_loading = 0;
+  guint authors_loading = 0;
+  guint books_changed = 0;
+  guint authors_changed = 0;
+
+  g_assert_true (test_sqlite_context_init (&context, "gom-relations-reload-scheduler-XXXXXX", &error));
+
+  test_sqlite_open (context.db_path, &db);
+  test_sqlite_exec_ok (db,
+                       "CREATE TABLE authors ("
+                       "  id INTEGER PRIMARY KEY,"
+                       "  name TEXT NOT NULL"
+                       ");"
+                       "CREATE TABLE books ("
+                       "  id INTEGER PRIMARY KEY,"
+                       "  author_id INTEGER NOT NULL,"
+                       "  title TEXT NOT NULL"
+                       ");"
+                       "INSERT INTO authors (id, name) VALUES "
+                       "  (1, 'Ada'),"
+                       "  (2, 'Bea');"
+                       "INSERT INTO books (id, author_id, title) VALUES "
+                       "  (10, 1, 'First'),"
+                       "  (11, 1, 'Second');");
+  test_sqlite_close (db);
+
+  registry = test_relations_create_registry ();
+  repository = test_sqlite_context_create_repository (&context, registry, &error);
+  g_assert_no_error (error);
+
+  session = dex_await_object (gom_repository_begin_session (repository), &error);
+  g_assert_no_error (error);
+  g_assert_nonnull (session);
+
+  books_model = gom_query_model_new (session,
+                                     TEST_RELATION_BOOK_TYPE,
+                                     gom_binary_expression_new_equal (gom_field_expression_new ("author-id"),
+                                                                      gom_literal_expression_new_int64 (1)),
+                                     gom_ordering_new (gom_field_expression_new ("id"), GOM_SORT_ASCENDING));
+  authors_model = gom_query_model_new (session,
+                                       TEST_RELATION_AUTHOR_TYPE,
+                                       NULL,
+                                       gom_ordering_new (gom_field_expression_new ("id"), GOM_SORT_ASCENDING));
+
+  dex_await (gom_query_model_reload (books_model), &error);
+  g_assert_no_error (error);
+  dex_await (gom_query_model_reload (authors_model), &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (books_model)), ==, 2);
+  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (authors_model)), ==, 2);
+
+  g_signal_connect (books_model, "notify::loading", G_CALLBACK (test_query_model_notify_loading_cb), &books_loading);
+  g_signal_connect (authors_model, "notify::loading", G_CALLBACK (test_query_model_notify_loading_cb), &authors_loading);
+  g_signal_connect (books_model, "items-changed", G_CALLBACK (test_query_model_items_changed_cb), &books_changed);
+  g_signal_connect (authors_model, "items-changed", G_CALLBACK (test_query_model_items_changed_cb), &authors_changed);
+
+  books = dex_await_object (gom_session_list_entities (session,
+                                                       TEST_RELATION_BOOK_TYPE,
+                                                       NULL,
+                                                       gom_ordering_new (gom_field_expression_new ("id"), GOM_SORT_ASCENDING)),
+                            &error);
+  g_assert_no_error (error);
+  g_assert_nonnull (books);
+
+  first = g_list_model_get_item (G_LIST_MODEL (books), 0);
+  second = g_list_model_get_item (G_LIST_MODEL (books), 1);
+  g_assert_nonnull (first);
+  g_assert_nonnull (second);
+
+  g_object_set (first, "author-id", (gint64) 2, NULL);
+  g_object_set (second, "author-id", (gint64) 2, NULL);
+  dex_await (gom_session_flush (session), &error);
+  g_assert_no_error (error);
+
+  for (guint i = 0; i < 100 && (books_loading == 0 || gom_query_model_get_loading (books_model)); i++)
+    dex_await (dex_timeout_new_msec (10), NULL);
+
+  g_assert_cmpuint (books_loading, >, 0);
+  g_assert_cmpuint (books_changed, >, 0);
+  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (books_model)), ==, 0);
+
+  g_assert_cmpuint (authors_loading, ==, 0);
+  g_assert_cmpuint (authors_changed, ==, 0);
+}
+
 static void
 test_relation_wait_for_item_load (GomEntityListItem *item)
 {
@@ -1279,6 +2166,112 @@ test_relations_entity_list_model_lazy_loading (void)
 
 }
 
+static void
+test_relations_entity_list_model_page_budget (void)
+{
+  g_autoptr(GError) error = NULL;
+  g_autoptr(GomRegistry) registry = NULL;
+  g_autoptr(GomRepository) repository = NULL;
+  g_autoptr(GomSession) session = NULL;
+  g_autoptr(GomQueryBuilder) builder = NULL;
+  g_autoptr(GomQuery) query = NULL;
+  g_autoptr(DexFuture) future = NULL;
+  g_autoptr(GomEntityListModel) model = NULL;
+  g_autoptr(GomEntityListItem) first = NULL;
+  g_autoptr(GomEntityListItem) last = NULL;
+  g_autoptr(GomEntityListItem) middle = NULL;
+  g_autoptr(GomEntityListItem) again = NULL;
+  g_autoptr(GomEntity) entity = NULL;
+  g_auto(TestSqliteContext) context = {0};
+  sqlite3 *db = NULL;
+
+  g_assert_true (test_sqlite_context_init (&context, "gom-relations-entity-list-budget-XXXXXX", &error));
+
+  test_sqlite_open (context.db_path, &db);
+  test_sqlite_exec_ok (db,
+                       "CREATE TABLE authors ("
+                       "  id INTEGER PRIMARY KEY,"
+                       "  name TEXT NOT NULL"
+                       ");"
+                       "CREATE TABLE books ("
+                       "  id INTEGER PRIMARY KEY,"
+                       "  author_id INTEGER NOT NULL,"
+                       "  title TEXT NOT NULL"
+                       ");"
+                       "INSERT INTO authors (id, name) VALUES (1, 'Ada');"
+                       "WITH RECURSIVE n(x) AS (SELECT 1 UNION ALL SELECT x + 1 FROM n WHERE x < 200) "
+                       "INSERT INTO books (id, author_id, title) SELECT x, 1, 'Book ' || x FROM n;");
+  test_sqlite_close (db);
+
+  registry = test_relations_create_registry ();
+  repository = test_sqlite_context_create_repository (&context, registry, &error);
+  g_assert_no_error (error);
+
+  session = dex_await_object (gom_repository_begin_session (repository), &error);
+  g_assert_no_error (error);
+  g_assert_nonnull (session);
+
+  builder = gom_query_builder_new ();
+  gom_query_builder_set_target_entity_type (builder, TEST_RELATION_BOOK_TYPE);
+  gom_query_builder_add_ordering (builder, gom_ordering_new (gom_field_expression_new ("id"), GOM_SORT_ASCENDING));
+  query = gom_query_builder_build (builder, &error);
+  g_assert_no_error (error);
+
+  future = gom_session_list_query (session, query);
+  model = dex_await_object (g_steal_pointer (&future), &error);
+  g_assert_no_error (error);
+  g_assert_nonnull (model);
+
+  dex_await (gom_entity_list_model_reload (model), &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (model)), ==, 200);
+
+  g_assert_cmpuint (gom_entity_list_model_get_max_pages (model), >, 0);
+  gom_entity_list_model_set_max_pages (model, 1);
+  g_assert_cmpuint (gom_entity_list_model_get_max_pages (model), ==, 1);
+
+  first = g_list_model_get_item (G_LIST_MODEL (model), 0);
+  g_assert_nonnull (first);
+  test_relation_wait_for_item_load (first);
+  entity = gom_entity_list_item_dup_item (first);
+  g_assert_nonnull (entity);
+  g_clear_object (&entity);
+
+  /* The first page still holds a referenced item, so loading a far
+   * away page must not release it even though that exceeds the budget.
+   */
+  last = g_list_model_get_item (G_LIST_MODEL (model), 199);
+  g_assert_nonnull (last);
+  test_relation_wait_for_item_load (last);
+  entity = gom_entity_list_item_dup_item (last);
+  g_assert_nonnull (entity);
+  g_clear_object (&entity);
+
+  entity = gom_entity_list_item_dup_item (first);
+  g_assert_nonnull (entity);
+  g_clear_object (&entity);
+  g_assert_false (gom_entity_list_item_get_loading (first));
+
+  /* Once nothing references it, the first page is released by the
+   * next load and its items load again on demand.
+   */
+  g_clear_object (&first);
+
+  middle = g_list_model_get_item (G_LIST_MODEL (model), 100);
+  g_assert_nonnull (middle);
+  test_relation_wait_for_item_load (middle);
+  entity = gom_entity_list_item_dup_item (middle);
+  g_assert_nonnull (entity);
+  g_clear_object (&entity);
+
+  again = g_list_model_get_item (G_LIST_MODEL (model), 0);
+  g_assert_nonnull (again);
+  g_assert_true (gom_entity_list_item_get_loading (again));
+  test_relation_wait_for_item_load (again);
+  entity = gom_entity_list_item_dup_item (again);
+  g_assert_nonnull (entity);
+}
+
 static void
 test_relations_entity_list_model_refreshes_snapshot (void)
 {
@@ -1368,6 +2361,106 @@ test_relations_entity_list_model_refreshes_snapshot (void)
 
 }
 
+static void
+test_relations_entity_list_model_keyset_paging (void)
+{
+  g_autoptr(GError) error = NULL;
+  g_autoptr(GomRegistry) registry = NULL;
+  g_autoptr(GomRepository) repository = NULL;
+  g_autoptr(GomSession) session = NULL;
+  g_autoptr(GomQueryBuilder) builder = NULL;
+  g_autoptr(GomQuery) query = NULL;
+  g_autoptr(DexFuture) future = NULL;
+  g_autoptr(GomEntityListModel) model = NULL;
+  g_autoptr(GString) sql = NULL;
+  g_auto(TestSqliteContext) context = {0};
+  g_autofree char *last_title = NULL;
+  gint64 last_id = G_MININT64;
+  sqlite3 *db = NULL;
+  guint n_books = 150;
+
+  g_assert_true (test_sqlite_context_init (&context, "gom-relations-entity-list-keyset-XXXXXX", &error));
+
+  /* Enough rows to span several pages with many ties on the sort key so
+   * that the seek predicate has to fall back to the identity tie-breaker.
+   * Scalar columns cannot tell NULL from 0 once read back, so the sort key
+   * is a string column for the boundaries to be used at all.
+   */
+  sql = g_string_new ("INSERT INTO books (id, author_id, title) VALUES ");
+  for (guint i = 1; i <= n_books; i++)
+    g_string_append_printf (sql, "%s(%u, %u, 'Volume %u')", i > 1 ? ", " : "", i, i % 3 + 1, i % 3 + 1);
+  g_string_append_c (sql, ';');
+
+  test_sqlite_open (context.db_path, &db);
+  test_sqlite_exec_ok (db,
+                       "CREATE TABLE authors ("
+                       "  id INTEGER PRIMARY KEY,"
+                       "  name TEXT NOT NULL"
+                       ");"
+                       "CREATE TABLE books ("
+                       "  id INTEGER PRIMARY KEY,"
+                       "  author_id INTEGER NOT NULL,"
+                       "  title TEXT NOT NULL"
+                       ");"
+                       "INSERT INTO authors (id, name) VALUES (1, 'Ada'), (2, 'Grace'), (3, 'Barbara');");
+  test_sqlite_exec_ok (db, sql->str);
+  test_sqlite_close (db);
+
+  registry = test_relations_create_registry ();
+  repository = test_sqlite_context_create_repository (&context, registry, &error);
+  g_assert_no_error (error);
+
+  session = dex_await_object (gom_repository_begin_session (repository), &error);
+  g_assert_no_error (error);
+  g_assert_nonnull (session);
+
+  builder = gom_query_builder_new ();
+  gom_query_builder_set_target_entity_type (builder, TEST_RELATION_BOOK_TYPE);
+  gom_query_builder_add_ordering (builder, gom_ordering_new_full (gom_field_expression_new ("title"), GOM_NULLS_LAST));
+  query = gom_query_builder_build (builder, &error);
+  g_assert_no_error (error);
+  g_assert_nonnull (query);
+
+  future = gom_session_list_query (session, query);
+  model = dex_await_object (g_steal_pointer (&future), &error);
+  g_assert_no_error (error);
+  g_assert_nonnull (model);
+
+  dex_await (gom_entity_list_model_reload (model), &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (model)), ==, n_books);
+
+  /* Walk sequentially so each page after the first is fetched by seeking
+   * past the last row of the previous one.
+   */
+  for (guint i = 0; i < n_books; i++)
+    {
+      g_autoptr(GomEntityListItem) item = g_list_model_get_item (G_LIST_MODEL (model), i);
+      g_autoptr(GomEntity) book = NULL;
+      TestRelationBook *typed_book;
+
+      g_assert_nonnull (item);
+
+      if (!(book = gom_entity_list_item_dup_item (item)))
+        {
+          test_relation_wait_for_item_load (item);
+          book = gom_entity_list_item_dup_item (item);
+        }
+
+      g_assert_nonnull (book);
+
+      typed_book = (TestRelationBook *)book;
+
+      if (g_strcmp0 (typed_book->title, last_title) == 0)
+        g_assert_cmpint (typed_book->id, >, last_id);
+      else
+        g_assert_cmpint (g_strcmp0 (typed_book->title, last_title), >, 0);
+
+      g_set_str (&last_title, typed_book->title);
+      last_id = typed_book->id;
+    }
+}
+
 static void
 test_relations_entity_list_model_wrapper_outlives_model (void)
 {
@@ -1566,14 +2659,23 @@ main (int   argc,
 {
   g_test_init (&argc, &argv, NULL);
   _g_test_add_func ("/Gom/Sqlite/relations-load", test_relations_repository_load);
+  _g_test_add_func ("/Gom/Sqlite/relations-prefetch", test_relations_prefetch);
+  _g_test_add_func ("/Gom/Sqlite/relations-prefetch-reload-sees-new-children", test_relations_prefetch_reload_sees_new_children);
+  _g_test_add_func ("/Gom/Sqlite/relations-related-model-batched-reload", test_relations_related_model_batched_reload);
   _g_test_add_func ("/Gom/Sqlite/relations-session-flush-relationship-change", test_relations_session_flush_relationship_change);
+  _g_test_add_func ("/Gom/Sqlite/relations-session-flush-batches-related-types", test_relations_session_flush_batches_related_types);
   _g_test_add_func ("/Gom/Sqlite/relations-query-model-refreshes-on-session-change", test_relations_query_model_refreshes_on_session_change);
+  _g_test_add_func ("/Gom/Sqlite/relations-query-model-reloads-touched-relation", test_relations_query_model_reloads_touched_relation);
+  _g_test_add_func ("/Gom/Sqlite/relations-query-model-reloads-committed-relation", test_relations_query_model_reloads_committed_relation);
   _g_test_add_func ("/Gom/Sqlite/entity-list-model/query-validation", test_relations_entity_list_model_query_validation);
   _g_test_add_func ("/Gom/Sqlite/entity-list-model/lazy-loading", test_relations_entity_list_model_lazy_loading);
+  _g_test_add_func ("/Gom/Sqlite/entity-list-model/page-budget", test_relations_entity_list_model_page_budget);
   _g_test_add_func ("/Gom/Sqlite/entity-list-model/refreshes-snapshot", test_relations_entity_list_model_refreshes_snapshot);
+  _g_test_add_func ("/Gom/Sqlite/entity-list-model/keyset-paging", test_relations_entity_list_model_keyset_paging);
   _g_test_add_func ("/Gom/Sqlite/entity-list-model/wrapper-outlives-model", test_relations_entity_list_model_wrapper_outlives_model);
   _g_test_add_func ("/Gom/Sqlite/relations-delete-rule-nullify", test_relations_delete_rule_nullify);
   _g_test_add_func ("/Gom/Sqlite/relations-delete-rule-cascade", test_relations_delete_rule_cascade);
+  _g_test_add_func ("/Gom/Sqlite/relations-delete-rule-cascade-graph", test_relations_delete_rule_cascade_graph);
   _g_test_add_func ("/Gom/Sqlite/relations-delete-rule-deny", test_relations_delete_rule_deny);
   _g_test_add_func ("/Gom/Sqlite/relations-insert-missing-target", test_relations_insert_rejects_missing_foreign_key_target);
   _g_test_add_func ("/Gom/Sqlite/relations-update-missing-target", test_relations_update_rejects_missing_foreign_key_target);
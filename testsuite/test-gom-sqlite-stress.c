@@ -1253,21 +1253,25 @@ assert_no_retry_futures_complete (GPtrArray  *fibers,
 }
 
 static void
-test_sqlite_assert_pool_lease_limit (GomRepository *repository)
+test_sqlite_assert_pool_lease_limit (GomRepository *repository,
+                                     guint          max_leases)
 {
   g_autoptr(GomQuery) query = NULL;
   g_autoptr(DexFuture) pending_query = NULL;
   g_autoptr(GomCursor) blocked_cursor = NULL;
   g_autoptr(GError) error = NULL;
-  GomCursor *held_cursors[GOM_SQLITE_POOL_MAX_LEASES] = {NULL};
+  g_autofree GomCursor **held_cursors = NULL;
 
   g_assert_true (GOM_IS_REPOSITORY (repository));
+  g_assert_cmpuint (max_leases, >, 0);
+
+  held_cursors = g_new0 (GomCursor *, max_leases);
 
   query = stress_item_query_new (&error);
   g_assert_no_error (error);
   g_assert_true (GOM_IS_QUERY (query));
 
-  for (guint i = 0; i < GOM_SQLITE_POOL_MAX_LEASES; i++)
+  for (guint i = 0; i < max_leases; i++)
     {
       held_cursors[i] = dex_await_object (gom_repository_query (repository, query), &error);
       g_assert_no_error (error);
@@ -1290,7 +1294,7 @@ test_sqlite_assert_pool_lease_limit (GomRepository *repository)
   g_assert_no_error (error);
   g_clear_object (&blocked_cursor);
 
-  for (guint i = 1; i < GOM_SQLITE_POOL_MAX_LEASES; i++)
+  for (guint i = 1; i < max_leases; i++)
     {
       g_assert_true (dex_await (gom_cursor_close (held_cursors[i]), &error));
       g_assert_no_error (error);
@@ -1675,7 +1679,7 @@ test_sqlite_limiter_concurrency_no_retry (void)
   g_assert_cmpuint (test_sqlite_count_stress_items (context.db_path),
                     ==,
                     expected_count);
-  test_sqlite_assert_pool_lease_limit (repository);
+  test_sqlite_assert_pool_lease_limit (repository, GOM_SQLITE_POOL_MAX_LEASES);
 
   g_clear_pointer (&fibers, g_ptr_array_unref);
   dex_clear (&start_promise);
@@ -1855,6 +1859,83 @@ test_sqlite_long_read_cursor_queues_writes (void)
   test_trace_counters_assert_equal (&baseline);
 }
 
+static void
+test_sqlite_readers_do_not_block_writer (void)
+{
+  g_auto(TestSqliteContext) context = {0};
+  g_autoptr(GomRepository) repository = NULL;
+  g_autoptr(GomQuery) query = NULL;
+  g_autoptr(GomEntity) write_entity = NULL;
+  g_autoptr(GomMutationResult) result = NULL;
+  g_autoptr(GError) error = NULL;
+  GomCursor *held_cursors[GOM_SQLITE_POOL_MAX_LEASES] = {NULL};
+  TraceCounters baseline;
+
+  test_trace_counters_snapshot (&baseline);
+
+  g_assert_true (test_sqlite_context_init (&context,
+                                           "gom-sqlite-readers-writer-test-XXXXXX",
+                                           &error));
+  g_assert_no_error (error);
+
+  test_sqlite_create_stress_table (context.db_path);
+
+  repository = test_sqlite_stress_open_repository (&context, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_true (GOM_IS_REPOSITORY (repository));
+
+  for (guint i = 0; i < LONG_READ_SEED_COUNT; i++)
+    {
+      g_autoptr(GomEntity) entity = NULL;
+
+      entity = insert_stress_item (repository, 5100, i, &error);
+      g_assert_no_error (error);
+      g_assert_true (GOM_IS_ENTITY (entity));
+    }
+
+  query = stress_item_query_new (&error);
+  g_assert_no_error (error);
+  g_assert_true (GOM_IS_QUERY (query));
+
+  /* Every reader is leased with an open read transaction, yet the writer
+   * is a separate connection and must not wait for any of them.
+   */
+  for (guint i = 0; i < GOM_SQLITE_POOL_MAX_LEASES; i++)
+    {
+      held_cursors[i] = dex_await_object (gom_repository_query (repository, query), &error);
+      g_assert_no_error (error);
+      g_assert_true (GOM_IS_CURSOR (held_cursors[i]));
+      g_assert_true (dex_await_boolean (gom_cursor_next (held_cursors[i]), &error));
+      g_assert_no_error (error);
+    }
+
+  write_entity = stress_item_new (6100, 0);
+  gom_entity_set_repository (write_entity, repository);
+
+  result = dex_await_object (dex_future_with_timeout_msec (gom_entity_insert (write_entity), 1000),
+                             &error);
+  g_assert_no_error (error);
+  g_assert_true (GOM_IS_MUTATION_RESULT (result));
+  g_assert_cmpuint (gom_mutation_result_get_affected_rows (result), ==, 1);
+
+  for (guint i = 0; i < GOM_SQLITE_POOL_MAX_LEASES; i++)
+    {
+      g_assert_true (dex_await (gom_cursor_close (held_cursors[i]), &error));
+      g_assert_no_error (error);
+      g_clear_object (&held_cursors[i]);
+    }
+
+  g_assert_cmpuint (test_sqlite_count_stress_items (context.db_path),
+                    ==,
+                    LONG_READ_SEED_COUNT + 1);
+
+  g_clear_object (&result);
+  g_clear_object (&write_entity);
+  g_clear_object (&query);
+  g_clear_object (&repository);
+  test_trace_counters_assert_equal (&baseline);
+}
+
 static void
 test_sqlite_migration_open_contention (void)
 {
@@ -1971,6 +2052,466 @@ test_sqlite_cursor_close_releases_lease (void)
   test_trace_counters_assert_equal (&baseline);
 }
 
+/* Reads a pragma back through its table-valued function, so the value
+ * comes from a connection leased out of the repository's pool.
+ */
+static gint64
+test_sqlite_read_pragma (GomRepository *repository,
+                         const char    *pragma)
+{
+  g_autoptr(GomQueryBuilder) builder = gom_query_builder_new ();
+  g_autofree char *relation = g_strdup_printf ("pragma_%s", pragma);
+  g_autoptr(GomCursor) cursor = NULL;
+  g_autoptr(GomQuery) query = NULL;
+  g_autoptr(GError) error = NULL;
+  gint64 value;
+
+  gom_query_builder_set_target_relation (builder, relation);
+  query = gom_query_builder_build (builder, &error);
+  g_assert_no_error (error);
+
+  cursor = dex_await_object (gom_repository_query (repository, query), &error);
+  g_assert_no_error (error);
+  g_assert_true (GOM_IS_CURSOR (cursor));
+
+  g_assert_true (dex_await_boolean (gom_cursor_next (cursor), &error));
+  g_assert_no_error (error);
+  value = gom_cursor_get_column_int64 (cursor, 0);
+
+  g_assert_true (dex_await (gom_cursor_close (cursor), &error));
+  g_assert_no_error (error);
+
+  return value;
+}
+
+static void
+test_sqlite_driver_options_pool_size (void)
+{
+  g_auto(TestSqliteContext) context = {0};
+  g_autoptr(GomDriverOptions) options = NULL;
+  g_autoptr(GomDriver) driver = NULL;
+  g_autoptr(GomRegistry) registry = NULL;
+  g_autoptr(GomRepository) repository = NULL;
+  g_autoptr(GomEntity) entity = NULL;
+  g_autoptr(GError) error = NULL;
+  TraceCounters baseline;
+
+  test_trace_counters_snapshot (&baseline);
+
+  g_assert_true (test_sqlite_context_init (&context,
+                                           "gom-sqlite-driver-options-test-XXXXXX",
+                                           &error));
+  g_assert_no_error (error);
+
+  test_sqlite_create_stress_table (context.db_path);
+
+  options = gom_driver_options_new ();
+  g_assert_cmpuint (gom_driver_options_get_max_connections (options), ==, 0);
+  g_assert_cmpint (gom_driver_options_get_mmap_size (options), ==, -1);
+  g_assert_cmpint (gom_driver_options_get_wal_autocheckpoint (options), ==, -1);
+  g_assert_cmpint (gom_driver_options_get_temp_store (options), ==, GOM_TEMP_STORE_DEFAULT);
+
+  gom_driver_options_set_max_connections (options, GOM_SQLITE_POOL_MAX_LEASES + 2);
+  gom_driver_options_set_max_concurrent_opens (options, 1);
+  gom_driver_options_set_mmap_size (options, 1024 * 1024);
+  gom_driver_options_set_cache_size (options, -4096);
+  gom_driver_options_set_temp_store (options, GOM_TEMP_STORE_MEMORY);
+  gom_driver_options_set_wal_autocheckpoint (options, 1000);
+  gom_driver_options_set_busy_timeout (options, 50);
+
+  driver = gom_driver_open_with_options (context.db_uri, options, &error);
+  g_assert_no_error (error);
+  g_assert_true (GOM_IS_DRIVER (driver));
+
+  registry = test_sqlite_stress_get_registry ();
+  repository = dex_await_object (gom_repository_new (driver, registry, NULL), &error);
+  g_assert_no_error (error);
+  g_assert_true (GOM_IS_REPOSITORY (repository));
+
+  entity = insert_stress_item (repository, 4100, 1, &error);
+  g_assert_no_error (error);
+  g_assert_true (GOM_IS_ENTITY (entity));
+
+  g_assert_cmpint (test_sqlite_read_pragma (repository, "cache_size"), ==, -4096);
+  g_assert_cmpint (test_sqlite_read_pragma (repository, "temp_store"), ==, GOM_TEMP_STORE_MEMORY);
+  g_assert_cmpint (test_sqlite_read_pragma (repository, "busy_timeout"), ==, 50);
+
+  test_sqlite_assert_pool_lease_limit (repository, GOM_SQLITE_POOL_MAX_LEASES + 2);
+
+  g_clear_object (&entity);
+  g_clear_object (&repository);
+  g_clear_object (&driver);
+  test_trace_counters_assert_equal (&baseline);
+}
+
+static void
+test_sqlite_background_checkpointer (void)
+{
+  g_auto(TestSqliteContext) context = {0};
+  g_autoptr(GomDriverOptions) options = NULL;
+  g_autoptr(GomDriver) driver = NULL;
+  g_autoptr(GomRegistry) registry = NULL;
+  g_autoptr(GomRepository) repository = NULL;
+  g_autofree char *wal_path = NULL;
+  g_autoptr(GError) error = NULL;
+  GStatBuf st;
+  gint64 deadline;
+  TraceCounters baseline;
+
+  test_trace_counters_snapshot (&baseline);
+
+  g_assert_true (test_sqlite_context_init (&context,
+                                           "gom-sqlite-checkpointer-test-XXXXXX",
+                                           &error));
+  g_assert_no_error (error);
+
+  test_sqlite_create_stress_table (context.db_path);
+  wal_path = g_strconcat (context.db_path, "-wal", NULL);
+
+  /* A one byte limit forces every background checkpoint to truncate, which
+   * makes its effect observable from the size of the WAL file.
+   */
+  options = gom_driver_options_new ();
+  gom_driver_options_set_checkpoint_interval (options, 10);
+  gom_driver_options_set_wal_size_limit (options, 1);
+
+  driver = gom_driver_open_with_options (context.db_uri, options, &error);
+  g_assert_no_error (error);
+  g_assert_true (GOM_IS_DRIVER (driver));
+
+  registry = test_sqlite_stress_get_registry ();
+  repository = dex_await_object (gom_repository_new (driver, registry, NULL), &error);
+  g_assert_no_error (error);
+  g_assert_true (GOM_IS_REPOSITORY (repository));
+
+  for (guint i = 0; i < 32; i++)
+    {
+      g_autoptr(GomEntity) entity = NULL;
+
+      entity = insert_stress_item (repository, 4200, i, &error);
+      g_assert_no_error (error);
+      g_assert_true (GOM_IS_ENTITY (entity));
+    }
+
+  deadline = g_get_monotonic_time () + 5 * G_USEC_PER_SEC;
+
+  while (g_stat (wal_path, &st) == 0 && st.st_size > 0)
+    {
+      g_assert_cmpint (g_get_monotonic_time (), <, deadline);
+      dex_await (dex_timeout_new_msec (10), NULL);
+    }
+
+  g_assert_cmpuint (test_sqlite_count_stress_items (context.db_path), ==, 32);
+
+  g_clear_object (&repository);
+  g_clear_object (&driver);
+  test_trace_counters_assert_equal (&baseline);
+}
+
+static void
+test_sqlite_statement_cache_reuses_queries (void)
+{
+  g_auto(TestSqliteContext) context = {0};
+  g_autoptr(GomRepository) repository = NULL;
+  g_autoptr(GomQuery) query = NULL;
+  g_autoptr(GError) error = NULL;
+  guint64 hits_before;
+  guint64 misses_before;
+  TraceCounters baseline;
+
+  test_trace_counters_snapshot (&baseline);
+
+  g_assert_true (test_sqlite_context_init (&context,
+                                           "gom-sqlite-statement-cache-test-XXXXXX",
+                                           &error));
+  g_assert_no_error (error);
+
+  test_sqlite_create_stress_table (context.db_path);
+
+  repository = test_sqlite_stress_open_repository (&context, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_true (GOM_IS_REPOSITORY (repository));
+
+  query = stress_item_count_query_new (&error);
+  g_assert_no_error (error);
+  g_assert_true (GOM_IS_QUERY (query));
+
+  hits_before = gom_trace_counter_get (GOM_TRACE_COUNTER_STATEMENT_CACHE_HITS);
+  misses_before = gom_trace_counter_get (GOM_TRACE_COUNTER_STATEMENT_CACHE_MISSES);
+
+  for (guint i = 0; i < GOM_SQLITE_POOL_MAX_LEASES * 2; i++)
+    {
+      g_autoptr(GomCursor) cursor = NULL;
+
+      cursor = dex_await_object (gom_repository_query (repository, query), &error);
+      g_assert_no_error (error);
+      g_assert_true (GOM_IS_CURSOR (cursor));
+      g_assert_cmpuint (gom_cursor_get_count (cursor), ==, 0);
+      g_assert_true (dex_await (gom_cursor_close (cursor), &error));
+      g_assert_no_error (error);
+    }
+
+  /* Sequential queries reuse idle connections, so the count and row
+   * statements miss at most once per pooled connection.
+   */
+  g_assert_cmpuint (gom_trace_counter_get (GOM_TRACE_COUNTER_STATEMENT_CACHE_HITS), >, hits_before);
+  g_assert_cmpuint (gom_trace_counter_get (GOM_TRACE_COUNTER_STATEMENT_CACHE_MISSES) - misses_before,
+                    <=,
+                    GOM_SQLITE_POOL_MAX_LEASES * 2);
+
+  g_clear_object (&query);
+  g_clear_object (&repository);
+  test_trace_counters_assert_equal (&baseline);
+}
+
+static guint64
+test_sqlite_query_count (GomRepository  *repository,
+                         GomQuery       *query,
+                         GError        **error)
+{
+  g_autoptr(GomCursor) cursor = NULL;
+  guint64 count;
+
+  if (!(cursor = dex_await_object (gom_repository_query (repository, query), error)))
+    return 0;
+
+  count = gom_cursor_get_count (cursor);
+
+  if (!dex_await (gom_cursor_close (cursor), error))
+    return 0;
+
+  return count;
+}
+
+static void
+test_sqlite_count_cache_tracks_writes (void)
+{
+  g_auto(TestSqliteContext) context = {0};
+  g_autoptr(GomRepository) repository = NULL;
+  g_autoptr(GomQuery) query = NULL;
+  g_autoptr(GomEntity) entity = NULL;
+  g_autoptr(GError) error = NULL;
+  guint64 hits_before;
+  sqlite3 *db = NULL;
+  TraceCounters baseline;
+
+  test_trace_counters_snapshot (&baseline);
+
+  g_assert_true (test_sqlite_context_init (&context,
+                                           "gom-sqlite-count-cache-test-XXXXXX",
+                                           &error));
+  g_assert_no_error (error);
+
+  test_sqlite_create_stress_table (context.db_path);
+
+  repository = test_sqlite_stress_open_repository (&context, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_true (GOM_IS_REPOSITORY (repository));
+
+  query = stress_item_count_query_new (&error);
+  g_assert_no_error (error);
+
+  g_assert_cmpuint (test_sqlite_query_count (repository, query, &error), ==, 0);
+  g_assert_no_error (error);
+
+  /* Nothing changed, so once a connection has counted the query its
+   * later counts come from the cache.
+   */
+  hits_before = gom_trace_counter_get (GOM_TRACE_COUNTER_COUNT_CACHE_HITS);
+  for (guint i = 0; i < GOM_SQLITE_POOL_MAX_LEASES * 2; i++)
+    {
+      g_assert_cmpuint (test_sqlite_query_count (repository, query, &error), ==, 0);
+      g_assert_no_error (error);
+    }
+  g_assert_cmpuint (gom_trace_counter_get (GOM_TRACE_COUNTER_COUNT_CACHE_HITS), >, hits_before);
+
+  /* Writes through the repository invalidate the cached count */
+  entity = insert_stress_item (repository, 1, 1, &error);
+  g_assert_no_error (error);
+  g_assert_true (GOM_IS_ENTITY (entity));
+  g_assert_cmpuint (test_sqlite_query_count (repository, query, &error), ==, 1);
+  g_assert_no_error (error);
+
+  /* So do commits from connections the repository does not own */
+  test_sqlite_open (context.db_path, &db);
+  test_sqlite_exec_ok (db,
+                       "INSERT INTO stress_items "
+                       "(name, stamp, count, bigcount, ucount, flag, ratio, fvalue, mode) "
+                       "VALUES ('external', x'00', 0, 0, 0, 0, 0.0, 0.0, 0)");
+  test_sqlite_close (db);
+
+  g_assert_cmpuint (test_sqlite_query_count (repository, query, &error), ==, 2);
+  g_assert_no_error (error);
+
+  g_clear_object (&entity);
+  g_clear_object (&query);
+  g_clear_object (&repository);
+  test_trace_counters_assert_equal (&baseline);
+}
+
+static void
+test_sqlite_lease_roundtrip_latency (void)
+{
+  g_auto(TestSqliteContext) context = {0};
+  g_autoptr(GomRepository) repository = NULL;
+  g_autoptr(GomEntity) entity = NULL;
+  g_autoptr(GError) error = NULL;
+  TraceCounters baseline;
+  guint n_iterations = g_test_perf () ? 10000 : 200;
+  gint64 id;
+  double elapsed;
+
+  test_trace_counters_snapshot (&baseline);
+
+  g_assert_true (test_sqlite_context_init (&context,
+                                           "gom-sqlite-lease-latency-test-XXXXXX",
+                                           &error));
+  g_assert_no_error (error);
+
+  test_sqlite_create_stress_table (context.db_path);
+
+  repository = test_sqlite_stress_open_repository (&context, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_true (GOM_IS_REPOSITORY (repository));
+
+  entity = insert_stress_item (repository, 1, 1, &error);
+  g_assert_no_error (error);
+  g_object_get (entity, "id", &id, NULL);
+
+  /* Each query acquires a lease, runs on the connection worker and
+   * releases the lease again before the next one starts.
+   */
+  g_test_timer_start ();
+
+  for (guint i = 0; i < n_iterations; i++)
+    {
+      g_autoptr(GomEntity) materialized = NULL;
+
+      materialized = query_stress_item_by_id (repository, id, &error);
+      g_assert_no_error (error);
+      g_assert_true (GOM_IS_ENTITY (materialized));
+    }
+
+  elapsed = g_test_timer_elapsed ();
+
+  g_test_minimized_result (elapsed * G_USEC_PER_SEC / n_iterations,
+                           "acquire/query/release: %.1f usec",
+                           elapsed * G_USEC_PER_SEC / n_iterations);
+
+  g_clear_object (&entity);
+  g_clear_object (&repository);
+  test_trace_counters_assert_equal (&baseline);
+}
+
+static GomRepository *
+test_sqlite_statement_cache_open_repository (TestSqliteContext  *context,
+                                             guint               n_migrations,
+                                             GError            **error)
+{
+  static const char * const scripts[] = {
+    "CREATE TABLE cache_items (id INTEGER PRIMARY KEY, name TEXT NOT NULL);"
+    "INSERT INTO cache_items (id, name) VALUES (1, 'alpha');",
+    "ALTER TABLE cache_items ADD COLUMN note TEXT NOT NULL DEFAULT 'migrated';",
+  };
+  g_autoptr(GomCustomMigrator) migrator = gom_custom_migrator_new (0);
+
+  g_assert (n_migrations <= G_N_ELEMENTS (scripts));
+
+  for (guint i = 0; i < n_migrations; i++)
+    {
+      g_autoptr(GBytes) script = g_bytes_new_static (scripts[i], strlen (scripts[i]));
+
+      gom_custom_migrator_add_migration (migrator, gom_sql_migration_new (i + 1, script));
+    }
+
+  return dex_await_object (gom_repository_new (GOM_DRIVER (context->driver),
+                                               NULL,
+                                               GOM_MIGRATOR (migrator)),
+                           error);
+}
+
+static GomCursor *
+test_sqlite_statement_cache_query_first (GomRepository  *repository,
+                                         GomQuery       *query,
+                                         GError        **error)
+{
+  g_autoptr(GomCursor) cursor = NULL;
+
+  if (!(cursor = dex_await_object (gom_repository_query (repository, query), error)))
+    return NULL;
+
+  if (!dex_await_boolean (gom_cursor_next (cursor), error))
+    return NULL;
+
+  return g_steal_pointer (&cursor);
+}
+
+static void
+test_sqlite_statement_cache_invalidated_by_migration (void)
+{
+  g_auto(TestSqliteContext) context = {0};
+  g_autoptr(GomQueryBuilder) builder = NULL;
+  g_autoptr(GomRepository) repository = NULL;
+  g_autoptr(GomCursor) cursor = NULL;
+  g_autoptr(GomQuery) query = NULL;
+  g_autoptr(GError) error = NULL;
+  guint64 misses_before;
+  TraceCounters baseline;
+
+  test_trace_counters_snapshot (&baseline);
+
+  g_assert_true (test_sqlite_context_init (&context,
+                                           "gom-sqlite-statement-cache-migration-test-XXXXXX",
+                                           &error));
+  g_assert_no_error (error);
+
+  repository = test_sqlite_statement_cache_open_repository (&context, 1, &error);
+  g_assert_no_error (error);
+  g_assert_true (GOM_IS_REPOSITORY (repository));
+
+  builder = gom_query_builder_new ();
+  gom_query_builder_set_target_relation (builder, "cache_items");
+  query = gom_query_builder_build (builder, &error);
+  g_assert_no_error (error);
+
+  /* Run the query twice so its statement is cached on the pool */
+  for (guint i = 0; i < 2; i++)
+    {
+      g_clear_object (&cursor);
+      cursor = test_sqlite_statement_cache_query_first (repository, query, &error);
+      g_assert_no_error (error);
+      g_assert_cmpuint (gom_cursor_get_n_columns (cursor), ==, 2);
+      g_assert_true (dex_await (gom_cursor_close (cursor), &error));
+      g_assert_no_error (error);
+    }
+
+  g_clear_object (&cursor);
+  g_clear_object (&repository);
+
+  /* Reopening with a second migration alters the table on the same pool */
+  repository = test_sqlite_statement_cache_open_repository (&context, 2, &error);
+  g_assert_no_error (error);
+  g_assert_true (GOM_IS_REPOSITORY (repository));
+
+  misses_before = gom_trace_counter_get (GOM_TRACE_COUNTER_STATEMENT_CACHE_MISSES);
+
+  cursor = test_sqlite_statement_cache_query_first (repository, query, &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (gom_trace_counter_get (GOM_TRACE_COUNTER_STATEMENT_CACHE_MISSES), >, misses_before);
+  g_assert_cmpuint (gom_cursor_get_n_columns (cursor), ==, 3);
+  g_assert_cmpstr (gom_cursor_get_column_name (cursor, 2), ==, "note");
+  g_assert_cmpint (gom_cursor_get_column_int64 (cursor, 0), ==, 1);
+  g_assert_cmpstr (gom_cursor_get_column_string (cursor, 1), ==, "alpha");
+  g_assert_cmpstr (gom_cursor_get_column_string (cursor, 2), ==, "migrated");
+  g_assert_true (dex_await (gom_cursor_close (cursor), &error));
+  g_assert_no_error (error);
+
+  g_clear_object (&cursor);
+  g_clear_object (&query);
+  g_clear_object (&repository);
+  test_trace_counters_assert_equal (&baseline);
+}
+
 static void
 test_sqlite_thread_pool_cancel_queued_shutdown (void)
 {
@@ -2289,8 +2830,15 @@ main (int   argc,
   _g_test_add_func ("/Gom/Sqlite/concurrent-repository-reads", test_sqlite_concurrent_repository_reads);
   _g_test_add_func ("/Gom/Sqlite/limiter-concurrency-no-retry", test_sqlite_limiter_concurrency_no_retry);
   _g_test_add_func ("/Gom/Sqlite/long-read-cursor-queues-writes", test_sqlite_long_read_cursor_queues_writes);
+  _g_test_add_func ("/Gom/Sqlite/readers-do-not-block-writer", test_sqlite_readers_do_not_block_writer);
   _g_test_add_func ("/Gom/Sqlite/migration-open-contention", test_sqlite_migration_open_contention);
   _g_test_add_func ("/Gom/Sqlite/cursor-close-releases-lease", test_sqlite_cursor_close_releases_lease);
+  _g_test_add_func ("/Gom/Sqlite/driver-options-pool-size", test_sqlite_driver_options_pool_size);
+  _g_test_add_func ("/Gom/Sqlite/background-checkpointer", test_sqlite_background_checkpointer);
+  _g_test_add_func ("/Gom/Sqlite/statement-cache-reuses-queries", test_sqlite_statement_cache_reuses_queries);
+  _g_test_add_func ("/Gom/Sqlite/statement-cache-invalidated-by-migration", test_sqlite_statement_cache_invalidated_by_migration);
+  _g_test_add_func ("/Gom/Sqlite/count-cache-tracks-writes", test_sqlite_count_cache_tracks_writes);
+  _g_test_add_func ("/Gom/Sqlite/lease-roundtrip-latency", test_sqlite_lease_roundtrip_latency);
   _g_test_add_func ("/Gom/Sqlite/thread-pool-cancel-queued-shutdown", test_sqlite_thread_pool_cancel_queued_shutdown);
   _g_test_add_func ("/Gom/Sqlite/limiter-pending-acquire-rejects-on-close", test_sqlite_limiter_pending_acquire_rejects_on_close);
   _g_test_add_func ("/Gom/Sqlite/session-begins-immediate-transaction", test_sqlite_session_begins_immediate_transaction);
@@ -1899,6 +1899,103 @@ test_sqlite_repository_query (void)
   g_assert_no_error (error);
 }
 
+static void
+test_sqlite_repository_query_batch (void)
+{
+  g_auto(TestSqliteContext) context = {0};
+  g_autoptr(GomRepository) repository = NULL;
+  g_autoptr(GomRegistry) registry = NULL;
+  g_autoptr(GomQueryBuilder) builder = NULL;
+  g_autoptr(GomQuery) query = NULL;
+  g_autoptr(GomCursor) cursor = NULL;
+  g_autoptr(GomOrdering) ordering = NULL;
+  g_autoptr(GError) error = NULL;
+  sqlite3 *db = NULL;
+  guint n_batches = 0;
+  guint count = 0;
+  guint n_rows;
+
+  g_assert_true (test_sqlite_context_init (&context, "gom-sqlite-test-XXXXXX", &error));
+  g_assert_no_error (error);
+  test_sqlite_open (context.db_path, &db);
+  test_sqlite_exec_ok (db,
+                     "CREATE TABLE items ("
+                     "  id INTEGER PRIMARY KEY, "
+                     "  name TEXT NOT NULL"
+                     ")"
+  );
+  test_sqlite_exec_ok (db,
+                     "WITH RECURSIVE n(x) AS (SELECT 1 UNION ALL SELECT x + 1 FROM n WHERE x < 600) "
+                     "INSERT INTO items (id, name) SELECT x, 'item-' || x FROM n"
+  );
+  test_sqlite_close (db);
+  db = NULL;
+
+  registry = test_sqlite_create_registry ();
+  repository = test_sqlite_context_create_repository (&context, registry, &error);
+  g_assert_no_error (error);
+
+  builder = gom_query_builder_new ();
+  gom_query_builder_set_target_relation (builder, "items");
+  ordering = gom_ordering_new (gom_field_expression_new ("id"), GOM_SORT_ASCENDING);
+  gom_query_builder_add_ordering (builder, g_steal_pointer (&ordering));
+  query = gom_query_builder_build (builder, &error);
+  g_assert_no_error (error);
+
+  cursor = dex_await_object (gom_repository_query (repository, query), &error);
+  g_assert_no_error (error);
+  g_assert_true (GOM_IS_CURSOR (cursor));
+
+  /* Walk the first batch with gom_cursor_next() and the rest batch by batch */
+  n_rows = dex_await_uint (gom_cursor_next_batch (cursor, 256), &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (n_rows, ==, 256);
+
+  do
+    {
+      g_autofree char *expected = g_strdup_printf ("item-%u", count + 1);
+
+      g_assert_cmpint (gom_cursor_get_n_columns (cursor), ==, 2);
+      g_assert_cmpstr (gom_cursor_get_column_name (cursor, 1), ==, "name");
+      g_assert_cmpint (gom_cursor_get_column_int64 (cursor, 0), ==, (gint64)count + 1);
+      g_assert_cmpstr (gom_cursor_get_column_string (cursor, 1), ==, expected);
+      count++;
+    }
+  while (dex_await_boolean (gom_cursor_next (cursor), &error));
+  g_assert_no_error (error);
+  g_assert_cmpuint (count, ==, 600);
+
+  g_assert_true (dex_await (gom_cursor_rewind (cursor), &error));
+  g_assert_no_error (error);
+  count = 0;
+
+  while ((n_rows = dex_await_uint (gom_cursor_next_batch (cursor, 256), &error)))
+    {
+      g_assert_no_error (error);
+      g_assert_cmpuint (n_rows, <=, 256);
+
+      for (guint i = 0; i < n_rows; i++)
+        {
+          if (i > 0)
+            g_assert_true (dex_await_boolean (gom_cursor_next (cursor), &error));
+
+          g_assert_cmpint (gom_cursor_get_column_int64 (cursor, 0), ==, (gint64)count + 1);
+          count++;
+        }
+
+      n_batches++;
+    }
+
+  g_assert_no_error (error);
+  g_assert_cmpuint (count, ==, 600);
+  g_assert_cmpuint (n_batches, ==, 3);
+  g_assert_false (dex_await_boolean (gom_cursor_next (cursor), &error));
+  g_assert_no_error (error);
+
+  dex_await (gom_cursor_close (cursor), &error);
+  g_assert_no_error (error);
+}
+
 static void
 test_sqlite_repository_count (void)
 {
@@ -2289,6 +2386,108 @@ test_sqlite_repository_insert (void)
   g_assert_no_error (error);
 }
 
+static void
+test_sqlite_repository_insert_many_rows (void)
+{
+  g_auto(TestSqliteContext) context = {0};
+  g_autoptr(GomRepository) repository = NULL;
+  g_autoptr(GomRegistry) registry = NULL;
+  g_autoptr(GomInsertionBuilder) insert_builder = NULL;
+  g_autoptr(GomInsertion) insertion = NULL;
+  g_autoptr(GomMutationResult) result = NULL;
+  g_autoptr(GError) error = NULL;
+  sqlite3 *db = NULL;
+  sqlite3_stmt *stmt = NULL;
+  gint64 last_rowid = 0;
+  const guint n_rows = 500;
+
+  g_assert_true (test_sqlite_context_init (&context, "gom-sqlite-test-XXXXXX", &error));
+  g_assert_no_error (error);
+  test_sqlite_open (context.db_path, &db);
+  test_sqlite_exec_ok (db,
+                     "CREATE TABLE items ("
+                     "  id INTEGER PRIMARY KEY, "
+                     "  name TEXT NOT NULL, "
+                     "  category TEXT NOT NULL"
+                     ")"
+  );
+  test_sqlite_close (db);
+  db = NULL;
+
+  registry = test_sqlite_create_registry ();
+  repository = test_sqlite_context_create_repository (&context, registry, &error);
+  g_assert_no_error (error);
+  g_assert_true (GOM_IS_REPOSITORY (repository));
+
+  insert_builder = gom_insertion_builder_new (repository);
+  gom_insertion_builder_set_target_relation (insert_builder, "items");
+  gom_insertion_builder_add_column (insert_builder, gom_field_expression_new ("name"));
+  gom_insertion_builder_add_column (insert_builder, gom_field_expression_new ("category"));
+
+  for (guint i = 0; i < n_rows; i++)
+    {
+      g_autofree char *name = g_strdup_printf ("item-%u", i);
+      GValue name_value = G_VALUE_INIT;
+      GValue category_value = G_VALUE_INIT;
+
+      g_value_init (&name_value, G_TYPE_STRING);
+      g_value_init (&category_value, G_TYPE_STRING);
+      g_value_set_string (&name_value, name);
+      g_value_set_static_string (&category_value, i % 2 ? "odd" : "even");
+
+      {
+        GomExpression *row[] = {
+          gom_literal_expression_new (&name_value),
+          gom_literal_expression_new (&category_value)
+        };
+        gom_insertion_builder_add_row (insert_builder, row, G_N_ELEMENTS (row));
+      }
+
+      g_value_unset (&name_value);
+      g_value_unset (&category_value);
+    }
+
+  insertion = gom_insertion_builder_build (insert_builder, &error);
+  g_assert_no_error (error);
+  g_assert_nonnull (insertion);
+
+  result = dex_await_object (gom_repository_mutate (repository, GOM_MUTATION (insertion)), &error);
+  g_assert_no_error (error);
+  g_assert_true (GOM_IS_MUTATION_RESULT (result));
+  g_assert_cmpuint (gom_mutation_result_get_affected_rows (result), ==, n_rows);
+  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (result)), ==, n_rows);
+
+  /* Every row must still report its own rowid even though the rows share
+   * one prepared statement.
+   */
+  for (guint i = 0; i < n_rows; i++)
+    {
+      g_autoptr(GomRecord) record = g_list_model_get_item (G_LIST_MODEL (result), i);
+      GValue value = G_VALUE_INIT;
+
+      g_assert_true (gom_record_get_column_by_name (record, "rowid", &value));
+      g_assert_true (G_VALUE_HOLDS_INT64 (&value));
+      g_assert_cmpint (g_value_get_int64 (&value), >, last_rowid);
+      last_rowid = g_value_get_int64 (&value);
+      g_value_unset (&value);
+    }
+
+  test_sqlite_open (context.db_path, &db);
+  g_assert_cmpint (sqlite3_prepare_v2 (db,
+                                       "SELECT COUNT(*), MIN(name), MAX(id) FROM items WHERE category = 'odd'",
+                                       -1,
+                                       &stmt,
+                                       NULL),
+                   ==,
+                   SQLITE_OK);
+  g_assert_cmpint (sqlite3_step (stmt), ==, SQLITE_ROW);
+  g_assert_cmpint (sqlite3_column_int64 (stmt, 0), ==, n_rows / 2);
+  g_assert_cmpstr ((const char *)sqlite3_column_text (stmt, 1), ==, "item-1");
+  g_assert_cmpint (sqlite3_column_int64 (stmt, 2), ==, last_rowid);
+  sqlite3_finalize (stmt);
+  test_sqlite_close (db);
+}
+
 static void
 test_sqlite_repository_insert_during_open_read_cursor (void)
 {
@@ -3172,7 +3371,7 @@ test_sqlite_cursor_move (void)
 }
 
 static void
-test_sqlite_repository_query_invalid_entity_field (void)
+test_sqlite_cursor_move_in_short_batch (void)
 {
   g_auto(TestSqliteContext) context = {0};
   g_autoptr(GomRepository) repository = NULL;
@@ -3182,7 +3381,6 @@ test_sqlite_repository_query_invalid_entity_field (void)
   g_autoptr(GomCursor) cursor = NULL;
   g_autoptr(GError) error = NULL;
   sqlite3 *db = NULL;
-  GValue value = G_VALUE_INIT;
 
   g_assert_true (test_sqlite_context_init (&context, "gom-sqlite-test-XXXXXX", &error));
   g_assert_no_error (error);
@@ -3191,7 +3389,11 @@ test_sqlite_repository_query_invalid_entity_field (void)
                      "CREATE TABLE items ("
                      "  id INTEGER PRIMARY KEY, "
                      "  name TEXT NOT NULL"
-                     ")"
+                     ");"
+                     "INSERT INTO items (id, name) VALUES "
+                     "(1, 'alpha'), "
+                     "(2, 'beta'), "
+                     "(3, 'gamma')"
   );
   test_sqlite_close (db);
   db = NULL;
@@ -3201,70 +3403,74 @@ test_sqlite_repository_query_invalid_entity_field (void)
   g_assert_no_error (error);
   g_assert_true (GOM_IS_REPOSITORY (repository));
 
-  g_value_init (&value, G_TYPE_STRING);
-  g_value_set_string (&value, "alpha");
-
   builder = gom_query_builder_new ();
-  gom_query_builder_set_target_entity_type (builder, test_insert_item_get_type ());
-  gom_query_builder_set_filter (builder,
-                                gom_binary_expression_new_equal (gom_field_expression_new ("does_not_exist"),
-                                                                 gom_literal_expression_new (&value)));
+  gom_query_builder_set_target_relation (builder, "items");
+  gom_query_builder_add_ordering (builder, gom_ordering_new (gom_field_expression_new ("id"), GOM_SORT_ASCENDING));
   query = gom_query_builder_build (builder, &error);
   g_assert_no_error (error);
-  g_assert_nonnull (query);
 
   cursor = dex_await_object (gom_repository_query (repository, query), &error);
-  g_assert_null (cursor);
-  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT);
-  g_assert_nonnull (strstr (error->message, "does_not_exist"));
+  g_assert_no_error (error);
+  g_assert_true (GOM_IS_CURSOR (cursor));
 
-  g_value_unset (&value);
-}
+  /* A short batch runs into the end of the results, which leaves the
+   * statement one past its last row.
+   */
+  g_assert_cmpuint (dex_await_uint (gom_cursor_next_batch (cursor, 8), &error), ==, 3);
+  g_assert_no_error (error);
+  g_assert_cmpstr (gom_cursor_get_column_string (cursor, 1), ==, "alpha");
 
-static void
-test_sqlite_repository_query_unregistered_entity_type (void)
-{
-  g_auto(TestSqliteContext) context = {0};
-  g_autoptr(GomRepository) repository = NULL;
-  g_autoptr(GomRegistry) registry = NULL;
-  g_autoptr(GomQueryBuilder) builder = NULL;
-  g_autoptr(GomQuery) query = NULL;
-  g_autoptr(GomCursor) cursor = NULL;
-  g_autoptr(GError) error = NULL;
+  g_assert_true (dex_await_boolean (gom_cursor_move_relative (cursor, 1), &error));
+  g_assert_no_error (error);
+  g_assert_cmpstr (gom_cursor_get_column_string (cursor, 1), ==, "beta");
 
-  g_assert_true (test_sqlite_context_init (&context, "gom-sqlite-test-XXXXXX", &error));
+  g_assert_true (dex_await (gom_cursor_rewind (cursor), &error));
+  g_assert_no_error (error);
+  g_assert_cmpuint (dex_await_uint (gom_cursor_next_batch (cursor, 8), &error), ==, 3);
   g_assert_no_error (error);
 
-  registry = test_sqlite_create_migration_registry ();
-  repository = test_sqlite_context_create_repository (&context, registry, &error);
+  g_assert_false (dex_await_boolean (gom_cursor_move_relative (cursor, -1), &error));
   g_assert_no_error (error);
-  g_assert_true (GOM_IS_REPOSITORY (repository));
 
-  builder = gom_query_builder_new ();
-  gom_query_builder_set_target_entity_type (builder, test_insert_item_get_type ());
-  query = gom_query_builder_build (builder, &error);
+  g_assert_true (dex_await (gom_cursor_rewind (cursor), &error));
   g_assert_no_error (error);
-  g_assert_nonnull (query);
+  g_assert_cmpuint (dex_await_uint (gom_cursor_next_batch (cursor, 8), &error), ==, 3);
+  g_assert_no_error (error);
+  g_assert_true (dex_await_boolean (gom_cursor_next (cursor), &error));
+  g_assert_no_error (error);
+  g_assert_cmpstr (gom_cursor_get_column_string (cursor, 1), ==, "beta");
 
-  cursor = dex_await_object (gom_repository_query (repository, query), &error);
-  g_assert_null (cursor);
-  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT);
-  g_assert_nonnull (strstr (error->message, "not in repository registry"));
+  g_assert_true (dex_await_boolean (gom_cursor_move_relative (cursor, -1), &error));
+  g_assert_no_error (error);
+  g_assert_cmpstr (gom_cursor_get_column_string (cursor, 1), ==, "alpha");
+
+  g_assert_true (dex_await (gom_cursor_rewind (cursor), &error));
+  g_assert_no_error (error);
+  g_assert_cmpuint (dex_await_uint (gom_cursor_next_batch (cursor, 8), &error), ==, 3);
+  g_assert_no_error (error);
+  g_assert_true (dex_await_boolean (gom_cursor_next (cursor), &error));
+  g_assert_no_error (error);
+
+  g_assert_true (dex_await_boolean (gom_cursor_move_relative (cursor, 1), &error));
+  g_assert_no_error (error);
+  g_assert_cmpstr (gom_cursor_get_column_string (cursor, 1), ==, "gamma");
 
+  g_assert_false (dex_await_boolean (gom_cursor_move_relative (cursor, 1), &error));
+  g_assert_no_error (error);
 }
 
 static void
-test_sqlite_repository_mutate_invalid_entity_field (void)
+test_sqlite_cursor_spool (void)
 {
   g_auto(TestSqliteContext) context = {0};
+  g_autoptr(GomDriverOptions) options = NULL;
   g_autoptr(GomRepository) repository = NULL;
   g_autoptr(GomRegistry) registry = NULL;
-  g_autoptr(GomUpdateBuilder) update_builder = NULL;
-  g_autoptr(GomUpdate) update = NULL;
+  g_autoptr(GomQueryBuilder) builder = NULL;
+  g_autoptr(GomQuery) query = NULL;
   g_autoptr(GomCursor) cursor = NULL;
   g_autoptr(GError) error = NULL;
   sqlite3 *db = NULL;
-  GValue value = G_VALUE_INIT;
 
   g_assert_true (test_sqlite_context_init (&context, "gom-sqlite-test-XXXXXX", &error));
   g_assert_no_error (error);
@@ -3273,55 +3479,416 @@ test_sqlite_repository_mutate_invalid_entity_field (void)
                      "CREATE TABLE items ("
                      "  id INTEGER PRIMARY KEY, "
                      "  name TEXT NOT NULL, "
-                     "  category TEXT"
-                     ")"
+                     "  score REAL"
+                     ");"
+                     "INSERT INTO items (id, name, score) VALUES "
+                     "(1, 'alpha', 1.5), "
+                     "(2, 'beta', NULL), "
+                     "(3, 'gamma', 3.5), "
+                     "(4, 'delta', 4.5), "
+                     "(5, 'epsilon', 5.5), "
+                     "(6, 'zeta', 6.5)"
   );
   test_sqlite_close (db);
   db = NULL;
 
+  options = gom_driver_options_new ();
+  g_assert_cmpuint (gom_driver_options_get_cursor_spool_rows (options), ==, 0);
+  gom_driver_options_set_cursor_spool_rows (options, 4);
+  g_assert_cmpuint (gom_driver_options_get_cursor_spool_rows (options), ==, 4);
+
+  g_clear_object (&context.driver);
+  context.driver = gom_driver_open_with_options (context.db_uri, options, &error);
+  g_assert_no_error (error);
+  g_assert_true (GOM_IS_DRIVER (context.driver));
+
   registry = test_sqlite_create_registry ();
   repository = test_sqlite_context_create_repository (&context, registry, &error);
   g_assert_no_error (error);
   g_assert_true (GOM_IS_REPOSITORY (repository));
 
-  g_value_init (&value, G_TYPE_STRING);
-  g_value_set_string (&value, "updated");
+  builder = gom_query_builder_new ();
+  gom_query_builder_set_target_relation (builder, "items");
+  gom_query_builder_add_ordering (builder, gom_ordering_new (gom_field_expression_new ("id"), GOM_SORT_ASCENDING));
+  query = gom_query_builder_build (builder, &error);
+  g_assert_no_error (error);
 
-  update_builder = gom_update_builder_new ();
-  gom_update_builder_set_target_entity_type (update_builder, test_insert_item_get_type ());
-  gom_update_builder_add_assignment (update_builder,
-                                     gom_field_expression_new ("does_not_exist"),
-                                     gom_literal_expression_new (&value));
-  update = gom_update_builder_build (update_builder, &error);
+  cursor = dex_await_object (gom_repository_query (repository, query), &error);
   g_assert_no_error (error);
-  g_assert_nonnull (update);
+  g_assert_true (GOM_IS_CURSOR (cursor));
 
-  cursor = dex_await_object (gom_repository_mutate (repository, GOM_MUTATION (update)), &error);
-  g_assert_null (cursor);
-  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT);
-  g_assert_nonnull (strstr (error->message, "does_not_exist"));
+  /* Backwards seeks within the spool replay rows that were already read */
+  g_assert_true (dex_await_boolean (gom_cursor_move_absolute (cursor, 2), &error));
+  g_assert_no_error (error);
+  g_assert_cmpstr (gom_cursor_get_column_string (cursor, 1), ==, "gamma");
 
-  g_value_unset (&value);
-}
+  g_assert_true (dex_await_boolean (gom_cursor_move_relative (cursor, -1), &error));
+  g_assert_no_error (error);
+  g_assert_cmpstr (gom_cursor_get_column_string (cursor, 1), ==, "beta");
+  g_assert_true (gom_cursor_get_column_null (cursor, 2));
 
-static void
-test_sqlite_cursor_materialize (void)
-{
-  g_auto(TestSqliteContext) context = {0};
-  g_autoptr(GomRepository) repository = NULL;
-  g_autoptr(GomRegistry) registry = NULL;
-  g_autoptr(GomQueryBuilder) query_builder = NULL;
-  g_autoptr(GomQuery) query = NULL;
-  g_autoptr(GomCursor) cursor = NULL;
-  g_autoptr(GomOrdering) ordering = NULL;
-  g_autoptr(GomEntity) entity = NULL;
-  g_autoptr(GomDelta) delta = NULL;
-  g_autoptr(GDateTime) updated_when = NULL;
-  g_autoptr(GError) error = NULL;
-  g_autofree char *when_str = NULL;
-  g_autofree char *updated_when_str = NULL;
-  sqlite3 *db = NULL;
-  sqlite3_stmt *stmt = NULL;
+  g_assert_true (dex_await_boolean (gom_cursor_next (cursor), &error));
+  g_assert_no_error (error);
+  g_assert_cmpint (gom_cursor_get_column_int64 (cursor, 0), ==, 3);
+  g_assert_cmpfloat (gom_cursor_get_column_double (cursor, 2), ==, 3.5);
+
+  g_assert_true (dex_await (gom_cursor_rewind (cursor), &error));
+  g_assert_no_error (error);
+  g_assert_true (dex_await_boolean (gom_cursor_next (cursor), &error));
+  g_assert_no_error (error);
+  g_assert_cmpstr (gom_cursor_get_column_string (cursor, 1), ==, "alpha");
+
+  /* Forward seeks continue past the spooled rows from the statement */
+  g_assert_true (dex_await_boolean (gom_cursor_move_absolute (cursor, 3), &error));
+  g_assert_no_error (error);
+  g_assert_cmpstr (gom_cursor_get_column_string (cursor, 1), ==, "delta");
+
+  /* Reading past the limit drops the spool, seeks still work */
+  g_assert_true (dex_await_boolean (gom_cursor_move_absolute (cursor, 5), &error));
+  g_assert_no_error (error);
+  g_assert_cmpstr (gom_cursor_get_column_string (cursor, 1), ==, "zeta");
+
+  g_assert_true (dex_await_boolean (gom_cursor_move_absolute (cursor, 0), &error));
+  g_assert_no_error (error);
+  g_assert_cmpstr (gom_cursor_get_column_string (cursor, 1), ==, "alpha");
+
+  g_assert_false (dex_await_boolean (gom_cursor_move_absolute (cursor, 6), &error));
+  g_assert_no_error (error);
+  g_assert_false (dex_await_boolean (gom_cursor_next (cursor), &error));
+  g_assert_no_error (error);
+
+  g_assert_true (dex_await_boolean (gom_cursor_move_relative (cursor, -2), &error));
+  g_assert_no_error (error);
+  g_assert_cmpstr (gom_cursor_get_column_string (cursor, 1), ==, "epsilon");
+}
+
+static void
+test_sqlite_changes_committed_cb (GomRepository *repository,
+                                  GomChangeSet  *changes,
+                                  GPtrArray     *collected)
+{
+  g_assert_true (GOM_IS_REPOSITORY (repository));
+  g_assert_true (GOM_IS_CHANGE_SET (changes));
+
+  g_ptr_array_add (collected, g_object_ref (changes));
+}
+
+static guint
+test_sqlite_count_collected_changes (GPtrArray *collected)
+{
+  guint n_changes = 0;
+
+  for (guint i = 0; i < collected->len; i++)
+    n_changes += gom_change_set_get_n_changes (g_ptr_array_index (collected, i));
+
+  return n_changes;
+}
+
+static GomInsertion *
+test_sqlite_build_names_insertion (GomRepository      *repository,
+                                   const char * const *names)
+{
+  g_autoptr(GomInsertionBuilder) builder = NULL;
+  g_autoptr(GError) error = NULL;
+  GomInsertion *insertion;
+
+  builder = gom_insertion_builder_new (repository);
+  gom_insertion_builder_set_target_relation (builder, "items");
+  gom_insertion_builder_add_column (builder, gom_field_expression_new ("name"));
+
+  for (guint i = 0; names[i] != NULL; i++)
+    {
+      GValue value = G_VALUE_INIT;
+
+      g_value_init (&value, G_TYPE_STRING);
+      g_value_set_string (&value, names[i]);
+      {
+        GomExpression *row[] = { gom_literal_expression_new (&value) };
+        gom_insertion_builder_add_row (builder, row, G_N_ELEMENTS (row));
+      }
+      g_value_unset (&value);
+    }
+
+  insertion = gom_insertion_builder_build (builder, &error);
+  g_assert_no_error (error);
+  g_assert_nonnull (insertion);
+
+  return insertion;
+}
+
+static GomInsertion *
+test_sqlite_build_named_insertion (GomRepository *repository,
+                                   const char    *name)
+{
+  const char *names[] = { name, NULL };
+
+  return test_sqlite_build_names_insertion (repository, names);
+}
+
+static void
+test_sqlite_group_commit (void)
+{
+  g_auto(TestSqliteContext) context = {0};
+  g_autoptr(GomDriverOptions) options = NULL;
+  g_autoptr(GomRepository) repository = NULL;
+  g_autoptr(GomRegistry) registry = NULL;
+  g_autoptr(GPtrArray) futures = NULL;
+  g_autoptr(GPtrArray) collected = g_ptr_array_new_with_free_func (g_object_unref);
+  g_autoptr(GError) error = NULL;
+  sqlite3 *db = NULL;
+  sqlite3_stmt *stmt = NULL;
+  int rc;
+
+  g_assert_true (test_sqlite_context_init (&context, "gom-sqlite-test-XXXXXX", &error));
+  g_assert_no_error (error);
+  test_sqlite_open (context.db_path, &db);
+  test_sqlite_exec_ok (db,
+                     "CREATE TABLE items ("
+                     "  id INTEGER PRIMARY KEY, "
+                     "  name TEXT NOT NULL UNIQUE"
+                     ")"
+  );
+  test_sqlite_close (db);
+  db = NULL;
+
+  options = gom_driver_options_new ();
+  g_assert_cmpuint (gom_driver_options_get_group_commit_window (options), ==, 0);
+  gom_driver_options_set_group_commit_window (options, 50);
+  g_assert_cmpuint (gom_driver_options_get_group_commit_window (options), ==, 50);
+  gom_driver_options_set_group_commit_size (options, 8);
+  g_assert_cmpuint (gom_driver_options_get_group_commit_size (options), ==, 8);
+
+  g_clear_object (&context.driver);
+  context.driver = gom_driver_open_with_options (context.db_uri, options, &error);
+  g_assert_no_error (error);
+  g_assert_true (GOM_IS_DRIVER (context.driver));
+
+  registry = test_sqlite_create_registry ();
+  repository = test_sqlite_context_create_repository (&context, registry, &error);
+  g_assert_no_error (error);
+
+  /* Each transaction committed on the writer posts one change set, which
+   * makes the grouping observable.
+   */
+  g_signal_connect (repository,
+                    "changes-committed",
+                    G_CALLBACK (test_sqlite_changes_committed_cb),
+                    collected);
+
+  /* Issue every mutation before awaiting any of them so they share groups.
+   * The duplicate name fails on its own without undoing its neighbours.
+   */
+  futures = g_ptr_array_new_with_free_func (dex_unref);
+
+  for (guint i = 0; i < 20; i++)
+    {
+      g_autoptr(GomInsertion) insertion = NULL;
+      g_autofree char *name = NULL;
+
+      if (i == 5)
+        name = g_strdup ("item-0");
+      else
+        name = g_strdup_printf ("item-%u", i);
+
+      insertion = test_sqlite_build_named_insertion (repository, name);
+      g_ptr_array_add (futures, gom_repository_mutate (repository, GOM_MUTATION (insertion)));
+    }
+
+  for (guint i = 0; i < futures->len; i++)
+    {
+      g_autoptr(GomMutationResult) result = NULL;
+
+      result = dex_await_object (dex_ref (g_ptr_array_index (futures, i)), &error);
+
+      if (i == 5)
+        {
+          g_assert_null (result);
+          g_assert_nonnull (error);
+          g_clear_error (&error);
+          continue;
+        }
+
+      g_assert_no_error (error);
+      g_assert_true (GOM_IS_MUTATION_RESULT (result));
+      g_assert_cmpuint (gom_mutation_result_get_affected_rows (result), ==, 1);
+    }
+
+  test_sqlite_open (context.db_path, &db);
+  rc = sqlite3_prepare_v2 (db, "SELECT COUNT(*) FROM items", -1, &stmt, NULL);
+  g_assert_cmpint (rc, ==, SQLITE_OK);
+  rc = sqlite3_step (stmt);
+  g_assert_cmpint (rc, ==, SQLITE_ROW);
+  g_assert_cmpint (sqlite3_column_int (stmt, 0), ==, 19);
+  sqlite3_finalize (stmt);
+  stmt = NULL;
+  test_sqlite_close (db);
+  db = NULL;
+
+  for (guint i = 0; i < 100 && test_sqlite_count_collected_changes (collected) < 19; i++)
+    dex_await (dex_timeout_new_msec (10), NULL);
+
+  /* Twenty mutations in groups of at most eight commit in three
+   * transactions rather than one each.
+   */
+  g_assert_cmpuint (test_sqlite_count_collected_changes (collected), ==, 19);
+  g_assert_cmpuint (collected->len, ==, 3);
+
+  g_signal_handlers_disconnect_by_func (repository,
+                                        G_CALLBACK (test_sqlite_changes_committed_cb),
+                                        collected);
+}
+
+static void
+test_sqlite_repository_query_invalid_entity_field (void)
+{
+  g_auto(TestSqliteContext) context = {0};
+  g_autoptr(GomRepository) repository = NULL;
+  g_autoptr(GomRegistry) registry = NULL;
+  g_autoptr(GomQueryBuilder) builder = NULL;
+  g_autoptr(GomQuery) query = NULL;
+  g_autoptr(GomCursor) cursor = NULL;
+  g_autoptr(GError) error = NULL;
+  sqlite3 *db = NULL;
+  GValue value = G_VALUE_INIT;
+
+  g_assert_true (test_sqlite_context_init (&context, "gom-sqlite-test-XXXXXX", &error));
+  g_assert_no_error (error);
+  test_sqlite_open (context.db_path, &db);
+  test_sqlite_exec_ok (db,
+                     "CREATE TABLE items ("
+                     "  id INTEGER PRIMARY KEY, "
+                     "  name TEXT NOT NULL"
+                     ")"
+  );
+  test_sqlite_close (db);
+  db = NULL;
+
+  registry = test_sqlite_create_registry ();
+  repository = test_sqlite_context_create_repository (&context, registry, &error);
+  g_assert_no_error (error);
+  g_assert_true (GOM_IS_REPOSITORY (repository));
+
+  g_value_init (&value, G_TYPE_STRING);
+  g_value_set_string (&value, "alpha");
+
+  builder = gom_query_builder_new ();
+  gom_query_builder_set_target_entity_type (builder, test_insert_item_get_type ());
+  gom_query_builder_set_filter (builder,
+                                gom_binary_expression_new_equal (gom_field_expression_new ("does_not_exist"),
+                                                                 gom_literal_expression_new (&value)));
+  query = gom_query_builder_build (builder, &error);
+  g_assert_no_error (error);
+  g_assert_nonnull (query);
+
+  cursor = dex_await_object (gom_repository_query (repository, query), &error);
+  g_assert_null (cursor);
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT);
+  g_assert_nonnull (strstr (error->message, "does_not_exist"));
+
+  g_value_unset (&value);
+}
+
+static void
+test_sqlite_repository_query_unregistered_entity_type (void)
+{
+  g_auto(TestSqliteContext) context = {0};
+  g_autoptr(GomRepository) repository = NULL;
+  g_autoptr(GomRegistry) registry = NULL;
+  g_autoptr(GomQueryBuilder) builder = NULL;
+  g_autoptr(GomQuery) query = NULL;
+  g_autoptr(GomCursor) cursor = NULL;
+  g_autoptr(GError) error = NULL;
+
+  g_assert_true (test_sqlite_context_init (&context, "gom-sqlite-test-XXXXXX", &error));
+  g_assert_no_error (error);
+
+  registry = test_sqlite_create_migration_registry ();
+  repository = test_sqlite_context_create_repository (&context, registry, &error);
+  g_assert_no_error (error);
+  g_assert_true (GOM_IS_REPOSITORY (repository));
+
+  builder = gom_query_builder_new ();
+  gom_query_builder_set_target_entity_type (builder, test_insert_item_get_type ());
+  query = gom_query_builder_build (builder, &error);
+  g_assert_no_error (error);
+  g_assert_nonnull (query);
+
+  cursor = dex_await_object (gom_repository_query (repository, query), &error);
+  g_assert_null (cursor);
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT);
+  g_assert_nonnull (strstr (error->message, "not in repository registry"));
+
+}
+
+static void
+test_sqlite_repository_mutate_invalid_entity_field (void)
+{
+  g_auto(TestSqliteContext) context = {0};
+  g_autoptr(GomRepository) repository = NULL;
+  g_autoptr(GomRegistry) registry = NULL;
+  g_autoptr(GomUpdateBuilder) update_builder = NULL;
+  g_autoptr(GomUpdate) update = NULL;
+  g_autoptr(GomCursor) cursor = NULL;
+  g_autoptr(GError) error = NULL;
+  sqlite3 *db = NULL;
+  GValue value = G_VALUE_INIT;
+
+  g_assert_true (test_sqlite_context_init (&context, "gom-sqlite-test-XXXXXX", &error));
+  g_assert_no_error (error);
+  test_sqlite_open (context.db_path, &db);
+  test_sqlite_exec_ok (db,
+                     "CREATE TABLE items ("
+                     "  id INTEGER PRIMARY KEY, "
+                     "  name TEXT NOT NULL, "
+                     "  category TEXT"
+                     ")"
+  );
+  test_sqlite_close (db);
+  db = NULL;
+
+  registry = test_sqlite_create_registry ();
+  repository = test_sqlite_context_create_repository (&context, registry, &error);
+  g_assert_no_error (error);
+  g_assert_true (GOM_IS_REPOSITORY (repository));
+
+  g_value_init (&value, G_TYPE_STRING);
+  g_value_set_string (&value, "updated");
+
+  update_builder = gom_update_builder_new ();
+  gom_update_builder_set_target_entity_type (update_builder, test_insert_item_get_type ());
+  gom_update_builder_add_assignment (update_builder,
+                                     gom_field_expression_new ("does_not_exist"),
+                                     gom_literal_expression_new (&value));
+  update = gom_update_builder_build (update_builder, &error);
+  g_assert_no_error (error);
+  g_assert_nonnull (update);
+
+  cursor = dex_await_object (gom_repository_mutate (repository, GOM_MUTATION (update)), &error);
+  g_assert_null (cursor);
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT);
+  g_assert_nonnull (strstr (error->message, "does_not_exist"));
+
+  g_value_unset (&value);
+}
+
+static void
+test_sqlite_cursor_materialize (void)
+{
+  g_auto(TestSqliteContext) context = {0};
+  g_autoptr(GomRepository) repository = NULL;
+  g_autoptr(GomRegistry) registry = NULL;
+  g_autoptr(GomQueryBuilder) query_builder = NULL;
+  g_autoptr(GomQuery) query = NULL;
+  g_autoptr(GomCursor) cursor = NULL;
+  g_autoptr(GomOrdering) ordering = NULL;
+  g_autoptr(GomEntity) entity = NULL;
+  g_autoptr(GomDelta) delta = NULL;
+  g_autoptr(GDateTime) updated_when = NULL;
+  g_autoptr(GError) error = NULL;
+  g_autofree char *when_str = NULL;
+  g_autofree char *updated_when_str = NULL;
+  sqlite3 *db = NULL;
+  sqlite3_stmt *stmt = NULL;
   const char *payload = "blob-data";
   const char *payload2 = "blob-data-2";
   const char *iso8601 = "2024-01-02T03:04:05Z";
@@ -3981,6 +4548,107 @@ test_sqlite_session_persist_flush_commit (void)
   db = NULL;
 }
 
+static void
+test_sqlite_session_flush_batches (void)
+{
+  g_auto(TestSqliteContext) context = {0};
+  g_autoptr(GomRepository) repository = NULL;
+  g_autoptr(GomRegistry) registry = NULL;
+  g_autoptr(GomSession) session = NULL;
+  g_autoptr(GPtrArray) items = NULL;
+  g_autoptr(GHashTable) seen = NULL;
+  g_autoptr(GError) error = NULL;
+  sqlite3 *db = NULL;
+  sqlite3_stmt *stmt = NULL;
+  int rc;
+
+  g_assert_true (test_sqlite_context_init (&context, "gom-sqlite-test-XXXXXX", &error));
+  g_assert_no_error (error);
+  test_sqlite_open (context.db_path, &db);
+  test_sqlite_exec_ok (db,
+                     "CREATE TABLE entity_items ("
+                     "  id INTEGER PRIMARY KEY, "
+                     "  name TEXT NOT NULL, "
+                     "  payload BLOB"
+                     ")"
+  );
+  test_sqlite_close (db);
+  db = NULL;
+
+  registry = test_sqlite_create_registry ();
+  repository = test_sqlite_context_create_repository (&context, registry, &error);
+  g_assert_no_error (error);
+
+  session = dex_await_object (gom_repository_begin_session (repository), &error);
+  g_assert_no_error (error);
+  g_assert_true (GOM_IS_SESSION (session));
+
+  items = g_ptr_array_new_with_free_func (g_object_unref);
+  seen = g_hash_table_new_full (g_int64_hash, g_int64_equal, g_free, NULL);
+
+  for (guint i = 0; i < 100; i++)
+    {
+      g_autofree char *name = g_strdup_printf ("item-%u", i);
+      GomEntity *item;
+
+      item = g_object_new (test_crud_item_get_type (),
+                           "name", name,
+                           NULL);
+      gom_entity_set_repository (item, repository);
+      g_ptr_array_add (items, item);
+
+      g_assert_true (dex_await (gom_session_persist (session, item), &error));
+      g_assert_no_error (error);
+    }
+
+  g_assert_true (dex_await (gom_session_flush (session), &error));
+  g_assert_no_error (error);
+
+  /* Every row of the batched insertion gets its own identity back */
+  for (guint i = 0; i < items->len; i++)
+    {
+      GomEntity *item = g_ptr_array_index (items, i);
+      gint64 *id = g_new0 (gint64, 1);
+
+      g_assert_cmpint (gom_entity_get_lifecycle (item), ==, GOM_ENTITY_LIFECYCLE_PERSISTENT);
+      g_object_get (item, "id", id, NULL);
+      g_assert_cmpint (*id, >, 0);
+      g_assert_false (g_hash_table_contains (seen, id));
+      g_hash_table_add (seen, id);
+    }
+
+  /* Touch every other entity so the dirty queue holds a run of updates */
+  for (guint i = 0; i < items->len; i += 2)
+    {
+      g_autofree char *name = g_strdup_printf ("renamed-%u", i);
+
+      g_object_set (g_ptr_array_index (items, i), "name", name, NULL);
+    }
+
+  g_assert_true (dex_await (gom_session_commit (session), &error));
+  g_assert_no_error (error);
+
+  test_sqlite_open (context.db_path, &db);
+  rc = sqlite3_prepare_v2 (db,
+                           "SELECT "
+                           "  COUNT(*), "
+                           "  SUM(CASE WHEN name LIKE 'renamed-%' THEN 1 ELSE 0 END) "
+                           "FROM entity_items",
+                           -1,
+                           &stmt,
+                           NULL);
+  g_assert_cmpint (rc, ==, SQLITE_OK);
+  rc = sqlite3_step (stmt);
+  g_assert_cmpint (rc, ==, SQLITE_ROW);
+  g_assert_cmpint (sqlite3_column_int (stmt, 0), ==, 100);
+  g_assert_cmpint (sqlite3_column_int (stmt, 1), ==, 50);
+  sqlite3_finalize (stmt);
+  stmt = NULL;
+
+  test_sqlite_close (db);
+  db = NULL;
+}
+
 static void
 test_sqlite_repository_update_delete (void)
 {
@@ -4033,77 +4701,330 @@ test_sqlite_repository_update_delete (void)
                                        gom_field_expression_new ("category"),
                                        gom_literal_expression_new (&value));
 
-    g_value_init (&filter_value, G_TYPE_STRING);
-    g_value_set_string (&filter_value, "alpha");
-    gom_update_builder_set_filter (update_builder,
-                                   gom_binary_expression_new_equal (gom_field_expression_new ("name"),
-                                                                    gom_literal_expression_new (&filter_value)));
-  }
-  gom_update_builder_set_limit (update_builder, 1);
+    g_value_init (&filter_value, G_TYPE_STRING);
+    g_value_set_string (&filter_value, "alpha");
+    gom_update_builder_set_filter (update_builder,
+                                   gom_binary_expression_new_equal (gom_field_expression_new ("name"),
+                                                                    gom_literal_expression_new (&filter_value)));
+  }
+  gom_update_builder_set_limit (update_builder, 1);
+
+  update = gom_update_builder_build (update_builder, &error);
+  g_assert_no_error (error);
+  g_assert_nonnull (update);
+
+  result = dex_await_object (gom_repository_mutate (repository, GOM_MUTATION (update)), &error);
+  g_assert_no_error (error);
+  g_assert_true (GOM_IS_MUTATION_RESULT (result));
+  g_assert_cmpuint (gom_mutation_result_get_affected_rows (result), ==, 1);
+  test_sqlite_assert_mutation_result_row (result, 0, 1, FALSE);
+  g_clear_object (&result);
+  deletion_builder = gom_deletion_builder_new ();
+  gom_deletion_builder_set_target_relation (deletion_builder, "items");
+  {
+    g_auto(GValue) value = G_VALUE_INIT;
+
+    g_value_init (&value, G_TYPE_STRING);
+    g_value_set_string (&value, "beta");
+    gom_deletion_builder_set_filter (deletion_builder,
+                                     gom_binary_expression_new_equal (gom_field_expression_new ("name"),
+                                                                      gom_literal_expression_new (&value)));
+  }
+  gom_deletion_builder_set_limit (deletion_builder, 1);
+
+  deletion = gom_deletion_builder_build (deletion_builder, &error);
+  g_assert_no_error (error);
+  g_assert_nonnull (deletion);
+
+  result = dex_await_object (gom_repository_mutate (repository, GOM_MUTATION (deletion)), &error);
+  g_assert_no_error (error);
+  g_assert_true (GOM_IS_MUTATION_RESULT (result));
+  g_assert_cmpuint (gom_mutation_result_get_affected_rows (result), ==, 1);
+  test_sqlite_assert_mutation_result_row (result, 0, 1, FALSE);
+  g_clear_object (&result);
+
+  query_builder = gom_query_builder_new ();
+  gom_query_builder_set_target_relation (query_builder, "items");
+  ordering = gom_ordering_new (gom_field_expression_new ("id"), GOM_SORT_ASCENDING);
+  gom_query_builder_add_ordering (query_builder, g_steal_pointer (&ordering));
+  query = gom_query_builder_build (query_builder, &error);
+  g_assert_no_error (error);
+  g_assert_nonnull (query);
+
+  g_clear_object (&cursor);
+  cursor = dex_await_object (gom_repository_query (repository, query), &error);
+  g_assert_no_error (error);
+  g_assert_true (GOM_IS_CURSOR (cursor));
+
+  g_assert_true (dex_await_boolean (gom_cursor_next (cursor), &error));
+  g_assert_no_error (error);
+  g_assert_cmpstr (gom_cursor_get_column_string (cursor, 1), ==, "alpha");
+  g_assert_cmpstr (gom_cursor_get_column_string (cursor, 2), ==, "updated");
+
+  g_assert_true (dex_await_boolean (gom_cursor_next (cursor), &error));
+  g_assert_no_error (error);
+  g_assert_cmpstr (gom_cursor_get_column_string (cursor, 1), ==, "gamma");
+  g_assert_cmpstr (gom_cursor_get_column_string (cursor, 2), ==, "third");
+
+  g_assert_false (dex_await_boolean (gom_cursor_next (cursor), &error));
+  g_assert_no_error (error);
+
+  dex_await (gom_cursor_close (cursor), &error);
+  g_assert_no_error (error);
+
+}
+
+static void
+test_sqlite_repository_changes_committed (void)
+{
+  g_auto(TestSqliteContext) context = {0};
+  g_autoptr(GomRepository) repository = NULL;
+  g_autoptr(GomRegistry) registry = NULL;
+  g_autoptr(GomUpdateBuilder) update_builder = NULL;
+  g_autoptr(GomUpdate) update = NULL;
+  g_autoptr(GomMutationResult) result = NULL;
+  g_autoptr(GPtrArray) collected = g_ptr_array_new_with_free_func (g_object_unref);
+  g_auto(GValue) identity = G_VALUE_INIT;
+  g_autoptr(GError) error = NULL;
+  GomChangeSet *changes;
+  sqlite3 *db = NULL;
+  gint64 rowid = 0;
+
+  g_assert_true (test_sqlite_context_init (&context, "gom-sqlite-test-XXXXXX", &error));
+  g_assert_no_error (error);
+  test_sqlite_open (context.db_path, &db);
+  test_sqlite_exec_ok (db,
+                     "CREATE TABLE entity_items ("
+                     "  id INTEGER PRIMARY KEY, "
+                     "  name TEXT NOT NULL, "
+                     "  payload BLOB"
+                     ");"
+                     "INSERT INTO entity_items (name) VALUES ('alpha'), ('beta');"
+  );
+  test_sqlite_close (db);
+  db = NULL;
+
+  registry = test_sqlite_create_registry ();
+  repository = test_sqlite_context_create_repository (&context, registry, &error);
+  g_assert_no_error (error);
+  g_assert_true (GOM_IS_REPOSITORY (repository));
+
+  g_signal_connect (repository,
+                    "changes-committed",
+                    G_CALLBACK (test_sqlite_changes_committed_cb),
+                    collected);
+
+  update_builder = gom_update_builder_new ();
+  gom_update_builder_set_target_relation (update_builder, "entity_items");
+  {
+    g_auto(GValue) value = G_VALUE_INIT;
+    g_auto(GValue) filter_value = G_VALUE_INIT;
+
+    g_value_init (&value, G_TYPE_STRING);
+    g_value_set_string (&value, "delta");
+    gom_update_builder_add_assignment (update_builder,
+                                       gom_field_expression_new ("name"),
+                                       gom_literal_expression_new (&value));
+
+    g_value_init (&filter_value, G_TYPE_STRING);
+    g_value_set_string (&filter_value, "beta");
+    gom_update_builder_set_filter (update_builder,
+                                   gom_binary_expression_new_equal (gom_field_expression_new ("name"),
+                                                                    gom_literal_expression_new (&filter_value)));
+  }
+
+  update = gom_update_builder_build (update_builder, &error);
+  g_assert_no_error (error);
+  g_assert_nonnull (update);
+
+  result = dex_await_object (gom_repository_mutate (repository, GOM_MUTATION (update)), &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (gom_mutation_result_get_affected_rows (result), ==, 1);
+
+  for (guint i = 0; i < 100 && collected->len == 0; i++)
+    dex_await (dex_timeout_new_msec (10), NULL);
+
+  g_assert_cmpuint (collected->len, ==, 1);
+  changes = g_ptr_array_index (collected, 0);
+  g_assert_cmpuint (gom_change_set_get_n_changes (changes), ==, 1);
+  g_assert_cmpstr (gom_change_set_get_relation (changes, 0), ==, "entity_items");
+  g_assert_cmpint (gom_change_set_get_kind (changes, 0), ==, GOM_DELTA_KIND_UPDATE);
+  g_assert_true (gom_change_set_get_rowid (changes, 0, &rowid));
+  g_assert_cmpint (rowid, ==, 2);
+  g_assert_true (gom_change_set_get_identity (changes, 0, &identity));
+  g_assert_true (G_VALUE_HOLDS_INT64 (&identity));
+  g_assert_cmpint (g_value_get_int64 (&identity), ==, 2);
+  g_assert_true (gom_change_set_contains_relation (changes, "entity_items"));
+  g_assert_false (gom_change_set_contains_relation (changes, "items"));
+
+  g_signal_handlers_disconnect_by_func (repository,
+                                        G_CALLBACK (test_sqlite_changes_committed_cb),
+                                        collected);
+}
+
+static void
+test_sqlite_repository_changes_committed_failed_mutation (void)
+{
+  static const char * const failing[] = { "gamma", "alpha", NULL };
+  g_auto(TestSqliteContext) context = {0};
+  g_autoptr(GomRepository) repository = NULL;
+  g_autoptr(GomRegistry) registry = NULL;
+  g_autoptr(GomInsertion) insertion = NULL;
+  g_autoptr(GomMutationResult) result = NULL;
+  g_autoptr(GPtrArray) collected = g_ptr_array_new_with_free_func (g_object_unref);
+  g_autoptr(GError) error = NULL;
+  GomChangeSet *changes;
+  sqlite3 *db = NULL;
+  gint64 rowid = 0;
+
+  g_assert_true (test_sqlite_context_init (&context, "gom-sqlite-test-XXXXXX", &error));
+  g_assert_no_error (error);
+  test_sqlite_open (context.db_path, &db);
+  test_sqlite_exec_ok (db,
+                     "CREATE TABLE items ("
+                     "  id INTEGER PRIMARY KEY, "
+                     "  name TEXT NOT NULL UNIQUE"
+                     ");"
+                     "INSERT INTO items (name) VALUES ('alpha');"
+  );
+  test_sqlite_close (db);
+  db = NULL;
+
+  registry = test_sqlite_create_registry ();
+  repository = test_sqlite_context_create_repository (&context, registry, &error);
+  g_assert_no_error (error);
+
+  g_signal_connect (repository,
+                    "changes-committed",
+                    G_CALLBACK (test_sqlite_changes_committed_cb),
+                    collected);
+
+  /* The first row is written, and reported by the update hook, before
+   * the second one fails and takes it back out.
+   */
+  insertion = test_sqlite_build_names_insertion (repository, failing);
+  result = dex_await_object (gom_repository_mutate (repository, GOM_MUTATION (insertion)), &error);
+  g_assert_null (result);
+  g_assert_nonnull (error);
+  g_clear_error (&error);
+  g_clear_object (&insertion);
+
+  /* Changes are posted in commit order, so once this one arrives anything
+   * the failed mutation posted would have too.
+   */
+  insertion = test_sqlite_build_named_insertion (repository, "beta");
+  result = dex_await_object (gom_repository_mutate (repository, GOM_MUTATION (insertion)), &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (gom_mutation_result_get_affected_rows (result), ==, 1);
+
+  for (guint i = 0; i < 100 && collected->len == 0; i++)
+    dex_await (dex_timeout_new_msec (10), NULL);
+
+  g_assert_cmpuint (collected->len, ==, 1);
+  changes = g_ptr_array_index (collected, 0);
+  g_assert_cmpuint (gom_change_set_get_n_changes (changes), ==, 1);
+  g_assert_cmpint (gom_change_set_get_kind (changes, 0), ==, GOM_DELTA_KIND_INSERT);
+  g_assert_true (gom_change_set_get_rowid (changes, 0, &rowid));
+  g_assert_cmpint (rowid, ==, 2);
+
+  g_signal_handlers_disconnect_by_func (repository,
+                                        G_CALLBACK (test_sqlite_changes_committed_cb),
+                                        collected);
+}
+
+static void
+test_sqlite_repository_changes_committed_group_rollback (void)
+{
+  static const char * const failing[] = { "two", "one", NULL };
+  g_auto(TestSqliteContext) context = {0};
+  g_autoptr(GomDriverOptions) options = NULL;
+  g_autoptr(GomRepository) repository = NULL;
+  g_autoptr(GomRegistry) registry = NULL;
+  g_autoptr(GPtrArray) futures = NULL;
+  g_autoptr(GPtrArray) collected = g_ptr_array_new_with_free_func (g_object_unref);
+  g_autoptr(GError) error = NULL;
+  sqlite3 *db = NULL;
+
+  g_assert_true (test_sqlite_context_init (&context, "gom-sqlite-test-XXXXXX", &error));
+  g_assert_no_error (error);
+  test_sqlite_open (context.db_path, &db);
+  test_sqlite_exec_ok (db,
+                     "CREATE TABLE items ("
+                     "  id INTEGER PRIMARY KEY, "
+                     "  name TEXT NOT NULL UNIQUE"
+                     ")"
+  );
+  test_sqlite_close (db);
+  db = NULL;
+
+  options = gom_driver_options_new ();
+  gom_driver_options_set_group_commit_window (options, 50);
+  gom_driver_options_set_group_commit_size (options, 8);
 
-  update = gom_update_builder_build (update_builder, &error);
+  g_clear_object (&context.driver);
+  context.driver = gom_driver_open_with_options (context.db_uri, options, &error);
   g_assert_no_error (error);
-  g_assert_nonnull (update);
 
-  result = dex_await_object (gom_repository_mutate (repository, GOM_MUTATION (update)), &error);
+  registry = test_sqlite_create_registry ();
+  repository = test_sqlite_context_create_repository (&context, registry, &error);
   g_assert_no_error (error);
-  g_assert_true (GOM_IS_MUTATION_RESULT (result));
-  g_assert_cmpuint (gom_mutation_result_get_affected_rows (result), ==, 1);
-  test_sqlite_assert_mutation_result_row (result, 0, 1, FALSE);
-  g_clear_object (&result);
-  deletion_builder = gom_deletion_builder_new ();
-  gom_deletion_builder_set_target_relation (deletion_builder, "items");
+
+  g_signal_connect (repository,
+                    "changes-committed",
+                    G_CALLBACK (test_sqlite_changes_committed_cb),
+                    collected);
+
+  /* The middle mutation writes "two" before failing on "one", and is
+   * rolled back to its savepoint while its neighbours commit.
+   */
+  futures = g_ptr_array_new_with_free_func (dex_unref);
   {
-    g_auto(GValue) value = G_VALUE_INIT;
+    g_autoptr(GomInsertion) first = test_sqlite_build_named_insertion (repository, "one");
+    g_autoptr(GomInsertion) middle = test_sqlite_build_names_insertion (repository, failing);
+    g_autoptr(GomInsertion) last = test_sqlite_build_named_insertion (repository, "three");
 
-    g_value_init (&value, G_TYPE_STRING);
-    g_value_set_string (&value, "beta");
-    gom_deletion_builder_set_filter (deletion_builder,
-                                     gom_binary_expression_new_equal (gom_field_expression_new ("name"),
-                                                                      gom_literal_expression_new (&value)));
+    g_ptr_array_add (futures, gom_repository_mutate (repository, GOM_MUTATION (first)));
+    g_ptr_array_add (futures, gom_repository_mutate (repository, GOM_MUTATION (middle)));
+    g_ptr_array_add (futures, gom_repository_mutate (repository, GOM_MUTATION (last)));
   }
-  gom_deletion_builder_set_limit (deletion_builder, 1);
 
-  deletion = gom_deletion_builder_build (deletion_builder, &error);
-  g_assert_no_error (error);
-  g_assert_nonnull (deletion);
+  for (guint i = 0; i < futures->len; i++)
+    {
+      g_autoptr(GomMutationResult) result = NULL;
 
-  result = dex_await_object (gom_repository_mutate (repository, GOM_MUTATION (deletion)), &error);
-  g_assert_no_error (error);
-  g_assert_true (GOM_IS_MUTATION_RESULT (result));
-  g_assert_cmpuint (gom_mutation_result_get_affected_rows (result), ==, 1);
-  test_sqlite_assert_mutation_result_row (result, 0, 1, FALSE);
-  g_clear_object (&result);
+      result = dex_await_object (dex_ref (g_ptr_array_index (futures, i)), &error);
 
-  query_builder = gom_query_builder_new ();
-  gom_query_builder_set_target_relation (query_builder, "items");
-  ordering = gom_ordering_new (gom_field_expression_new ("id"), GOM_SORT_ASCENDING);
-  gom_query_builder_add_ordering (query_builder, g_steal_pointer (&ordering));
-  query = gom_query_builder_build (query_builder, &error);
-  g_assert_no_error (error);
-  g_assert_nonnull (query);
+      if (i == 1)
+        {
+          g_assert_null (result);
+          g_assert_nonnull (error);
+          g_clear_error (&error);
+          continue;
+        }
 
-  g_clear_object (&cursor);
-  cursor = dex_await_object (gom_repository_query (repository, query), &error);
-  g_assert_no_error (error);
-  g_assert_true (GOM_IS_CURSOR (cursor));
+      g_assert_no_error (error);
+      g_assert_cmpuint (gom_mutation_result_get_affected_rows (result), ==, 1);
+    }
 
-  g_assert_true (dex_await_boolean (gom_cursor_next (cursor), &error));
-  g_assert_no_error (error);
-  g_assert_cmpstr (gom_cursor_get_column_string (cursor, 1), ==, "alpha");
-  g_assert_cmpstr (gom_cursor_get_column_string (cursor, 2), ==, "updated");
+  for (guint i = 0; i < 100 && test_sqlite_count_collected_changes (collected) < 2; i++)
+    dex_await (dex_timeout_new_msec (10), NULL);
 
-  g_assert_true (dex_await_boolean (gom_cursor_next (cursor), &error));
-  g_assert_no_error (error);
-  g_assert_cmpstr (gom_cursor_get_column_string (cursor, 1), ==, "gamma");
-  g_assert_cmpstr (gom_cursor_get_column_string (cursor, 2), ==, "third");
+  /* Give a stray change for the rolled back row time to show up */
+  dex_await (dex_timeout_new_msec (50), NULL);
 
-  g_assert_false (dex_await_boolean (gom_cursor_next (cursor), &error));
-  g_assert_no_error (error);
+  g_assert_cmpuint (test_sqlite_count_collected_changes (collected), ==, 2);
 
-  dex_await (gom_cursor_close (cursor), &error);
-  g_assert_no_error (error);
+  for (guint i = 0; i < collected->len; i++)
+    {
+      GomChangeSet *changes = g_ptr_array_index (collected, i);
+
+      for (guint j = 0; j < gom_change_set_get_n_changes (changes); j++)
+        g_assert_cmpint (gom_change_set_get_kind (changes, j), ==, GOM_DELTA_KIND_INSERT);
+    }
 
+  g_signal_handlers_disconnect_by_func (repository,
+                                        G_CALLBACK (test_sqlite_changes_committed_cb),
+                                        collected);
 }
 
 static void
@@ -4862,6 +5783,129 @@ test_sqlite_repository_expression_variants (void)
   }
 }
 
+static void
+test_sqlite_repository_in_expression (void)
+{
+  g_auto(TestSqliteContext) context = {0};
+  g_autoptr(GomRepository) repository = NULL;
+  g_autoptr(GomRegistry) registry = NULL;
+  g_autoptr(GError) error = NULL;
+  sqlite3 *db = NULL;
+
+  g_assert_true (test_sqlite_context_init (&context, "gom-sqlite-test-XXXXXX", &error));
+  g_assert_no_error (error);
+
+  test_sqlite_open (context.db_path, &db);
+  test_sqlite_exec_ok (db,
+                       "CREATE TABLE in_items ("
+                       "  id INTEGER PRIMARY KEY, "
+                       "  score REAL NOT NULL, "
+                       "  name TEXT, "
+                       "  payload BLOB"
+                       ");"
+                       "INSERT INTO in_items (id, score, name, payload) VALUES "
+                       "(1, 1.5, 'alpha', X'6161'), "
+                       "(2, 2.0, 'be\"ta', NULL), "
+                       "(3, 3.0, 'gamma', X'6262'), "
+                       "(4, 4.5, NULL, NULL)");
+  test_sqlite_close (db);
+  db = NULL;
+
+  registry = test_sqlite_create_registry ();
+  repository = test_sqlite_context_create_repository (&context, registry, &error);
+  g_assert_no_error (error);
+
+  {
+    g_autoptr(GomExpression) filter = NULL;
+    g_autoptr(GomExpression) negated = NULL;
+    GValue values[4] = { G_VALUE_INIT, G_VALUE_INIT, G_VALUE_INIT, G_VALUE_INIT };
+
+    g_value_init (&values[0], G_TYPE_INT64);
+    g_value_set_int64 (&values[0], 1);
+    g_value_init (&values[1], G_TYPE_INT);
+    g_value_set_int (&values[1], 3);
+    g_value_init (&values[2], G_TYPE_UINT);
+    g_value_set_uint (&values[2], 99);
+
+    filter = gom_in_expression_new_for_field ("id", values, 4);
+    g_assert_true (GOM_IS_IN_EXPRESSION (filter));
+    g_assert_cmpuint (gom_in_expression_get_n_values (GOM_IN_EXPRESSION (filter)), ==, 4);
+    g_assert_cmpuint (test_sqlite_query_count_for_filter (repository, "in_items", filter, &error), ==, 2);
+    g_assert_no_error (error);
+
+    negated = gom_unary_expression_new_not (g_steal_pointer (&filter));
+    g_assert_cmpuint (test_sqlite_query_count_for_filter (repository, "in_items", negated, &error), ==, 0);
+    g_assert_no_error (error);
+
+    for (guint i = 0; i < G_N_ELEMENTS (values); i++)
+      if (G_IS_VALUE (&values[i]))
+        g_value_unset (&values[i]);
+  }
+
+  {
+    g_autoptr(GomExpression) filter = NULL;
+    g_autoptr(GomExpression) negated = NULL;
+    GValue values[2] = { G_VALUE_INIT, G_VALUE_INIT };
+
+    g_value_init (&values[0], G_TYPE_STRING);
+    g_value_set_string (&values[0], "be\"ta");
+    g_value_init (&values[1], G_TYPE_STRING);
+    g_value_set_string (&values[1], "gamma");
+
+    filter = gom_in_expression_new_for_field ("name", values, G_N_ELEMENTS (values));
+    g_assert_cmpuint (test_sqlite_query_count_for_filter (repository, "in_items", filter, &error), ==, 2);
+    g_assert_no_error (error);
+
+    negated = gom_unary_expression_new_not (g_steal_pointer (&filter));
+    g_assert_cmpuint (test_sqlite_query_count_for_filter (repository, "in_items", negated, &error), ==, 1);
+    g_assert_no_error (error);
+
+    g_value_unset (&values[0]);
+    g_value_unset (&values[1]);
+  }
+
+  {
+    g_autoptr(GomExpression) filter = NULL;
+    GValue values[2] = { G_VALUE_INIT, G_VALUE_INIT };
+
+    g_value_init (&values[0], G_TYPE_DOUBLE);
+    g_value_set_double (&values[0], 1.5);
+    g_value_init (&values[1], G_TYPE_DOUBLE);
+    g_value_set_double (&values[1], 3.0);
+
+    filter = gom_in_expression_new_for_field ("score", values, G_N_ELEMENTS (values));
+    g_assert_cmpuint (test_sqlite_query_count_for_filter (repository, "in_items", filter, &error), ==, 2);
+    g_assert_no_error (error);
+
+    g_value_unset (&values[0]);
+    g_value_unset (&values[1]);
+  }
+
+  {
+    g_autoptr(GomExpression) filter = NULL;
+    g_autoptr(GBytes) bytes = g_bytes_new_static ("bb", 2);
+    GValue value = G_VALUE_INIT;
+
+    /* Blobs have no JSON form and are bound one by one instead. */
+    g_value_init (&value, G_TYPE_BYTES);
+    g_value_set_boxed (&value, bytes);
+
+    filter = gom_in_expression_new_for_field ("payload", &value, 1);
+    g_assert_cmpuint (test_sqlite_query_count_for_filter (repository, "in_items", filter, &error), ==, 1);
+    g_assert_no_error (error);
+
+    g_value_unset (&value);
+  }
+
+  {
+    g_autoptr(GomExpression) filter = NULL;
+
+    filter = gom_in_expression_new_for_field ("id", NULL, 0);
+    g_assert_cmpuint (test_sqlite_query_count_for_filter (repository, "in_items", filter, &error), ==, 0);
+    g_assert_no_error (error);
+  }
+}
+
 static GomFieldSchema *
 test_find_field_schema (GListModel *fields,
                         const char *name)
@@ -5279,6 +6323,187 @@ test_sqlite_cursor_snapshot (void)
 
 }
 
+static void
+test_sqlite_cursor_peek_column (void)
+{
+  g_auto(TestSqliteContext) context = {0};
+  g_autoptr(GomRepository) repository = NULL;
+  g_autoptr(GomRegistry) registry = NULL;
+  g_autoptr(GomQueryBuilder) query_builder = NULL;
+  g_autoptr(GomQuery) query = NULL;
+  g_autoptr(GomCursor) cursor = NULL;
+  g_autoptr(GomOrdering) ordering = NULL;
+  g_autoptr(GError) error = NULL;
+  const guint8 *data = NULL;
+  gsize len = 0;
+  sqlite3 *db = NULL;
+
+  g_assert_true (test_sqlite_context_init (&context, "gom-sqlite-test-XXXXXX", &error));
+  g_assert_no_error (error);
+  test_sqlite_open (context.db_path, &db);
+  test_sqlite_exec_ok (db,
+                     "CREATE TABLE peek_items ("
+                     "  id INTEGER PRIMARY KEY, "
+                     "  big INTEGER, "
+                     "  name TEXT, "
+                     "  payload BLOB"
+                     ")"
+  );
+  test_sqlite_exec_ok (db,
+                     "INSERT INTO peek_items (id, big, name, payload) VALUES "
+                     "(1, -1, 'alpha', x'00ff10'), "
+                     "(2, 42, NULL, x''), "
+                     "(3, 7, 'gamma', x'deadbeef')"
+  );
+  test_sqlite_close (db);
+  db = NULL;
+
+  registry = test_sqlite_create_registry ();
+  repository = test_sqlite_context_create_repository (&context, registry, &error);
+  g_assert_no_error (error);
+
+  query_builder = gom_query_builder_new ();
+  gom_query_builder_set_target_relation (query_builder, "peek_items");
+  ordering = gom_ordering_new (gom_field_expression_new ("id"), GOM_SORT_ASCENDING);
+  gom_query_builder_add_ordering (query_builder, g_steal_pointer (&ordering));
+  query = gom_query_builder_build (query_builder, &error);
+  g_assert_no_error (error);
+
+  cursor = dex_await_object (gom_repository_query (repository, query), &error);
+  g_assert_no_error (error);
+  g_assert_true (GOM_IS_CURSOR (cursor));
+
+  g_assert_true (dex_await_boolean (gom_cursor_next (cursor), &error));
+  g_assert_no_error (error);
+
+  g_assert_cmpint (gom_cursor_get_column_int64 (cursor, 0), ==, 1);
+  g_assert_cmpint (gom_cursor_get_column_int64 (cursor, 1), ==, -1);
+  g_assert_cmpuint (gom_cursor_get_column_uint64 (cursor, 1), ==, G_MAXUINT64);
+
+  g_assert_true (gom_cursor_peek_column_bytes (cursor, 2, &data, &len));
+  g_assert_cmpmem (data, len, "alpha", 5);
+  g_assert_true (gom_cursor_peek_column_bytes (cursor, 3, &data, &len));
+  g_assert_cmpmem (data, len, "\x00\xff\x10", 3);
+
+  /* Integers are neither binary nor text */
+  g_assert_false (gom_cursor_peek_column_bytes (cursor, 1, &data, &len));
+  g_assert_null (data);
+  g_assert_cmpuint (len, ==, 0);
+  g_assert_false (gom_cursor_peek_column_bytes (cursor, 42, &data, &len));
+
+  g_assert_true (dex_await_boolean (gom_cursor_next (cursor), &error));
+  g_assert_no_error (error);
+
+  g_assert_cmpuint (gom_cursor_get_column_uint64 (cursor, 1), ==, 42);
+  g_assert_false (gom_cursor_peek_column_bytes (cursor, 2, &data, &len));
+  g_assert_true (gom_cursor_peek_column_bytes (cursor, 3, &data, &len));
+  g_assert_cmpuint (len, ==, 0);
+
+  /* Buffered rows are borrowed from the batch */
+  g_assert_cmpuint (dex_await_uint (gom_cursor_next_batch (cursor, 8), &error), ==, 1);
+  g_assert_no_error (error);
+
+  g_assert_cmpint (gom_cursor_get_column_int64 (cursor, 1), ==, 7);
+  g_assert_true (gom_cursor_peek_column_bytes (cursor, 2, &data, &len));
+  g_assert_cmpmem (data, len, "gamma", 5);
+  g_assert_true (gom_cursor_peek_column_bytes (cursor, 3, &data, &len));
+  g_assert_cmpmem (data, len, "\xde\xad\xbe\xef", 4);
+
+  dex_await (gom_cursor_close (cursor), &error);
+  g_assert_no_error (error);
+}
+
+static void
+test_sqlite_cursor_snapshot_shared_header (void)
+{
+  g_auto(TestSqliteContext) context = {0};
+  g_autoptr(GomRepository) repository = NULL;
+  g_autoptr(GomRegistry) registry = NULL;
+  g_autoptr(GomQueryBuilder) query_builder = NULL;
+  g_autoptr(GomQuery) query = NULL;
+  g_autoptr(GomCursor) cursor = NULL;
+  g_autoptr(GomOrdering) ordering = NULL;
+  g_autoptr(GPtrArray) records = NULL;
+  g_autoptr(GError) error = NULL;
+  sqlite3 *db = NULL;
+  const char *first_name_column;
+  const guint n_rows = 600;
+
+  g_assert_true (test_sqlite_context_init (&context, "gom-sqlite-test-XXXXXX", &error));
+  g_assert_no_error (error);
+  test_sqlite_open (context.db_path, &db);
+  test_sqlite_exec_ok (db, "CREATE TABLE snapshot_rows (id INTEGER PRIMARY KEY, name TEXT NOT NULL)");
+  test_sqlite_exec_ok (db, "BEGIN");
+
+  for (guint i = 1; i <= n_rows; i++)
+    {
+      g_autofree char *sql = g_strdup_printf ("INSERT INTO snapshot_rows (id, name) VALUES (%u, 'row-%u')", i, i);
+
+      test_sqlite_exec_ok (db, sql);
+    }
+
+  test_sqlite_exec_ok (db, "COMMIT");
+  test_sqlite_close (db);
+  db = NULL;
+
+  registry = test_sqlite_create_registry ();
+  repository = test_sqlite_context_create_repository (&context, registry, &error);
+  g_assert_no_error (error);
+
+  query_builder = gom_query_builder_new ();
+  gom_query_builder_set_target_relation (query_builder, "snapshot_rows");
+  ordering = gom_ordering_new (gom_field_expression_new ("id"), GOM_SORT_ASCENDING);
+  gom_query_builder_add_ordering (query_builder, g_steal_pointer (&ordering));
+  query = gom_query_builder_build (query_builder, &error);
+  g_assert_no_error (error);
+
+  cursor = dex_await_object (gom_repository_query (repository, query), &error);
+  g_assert_no_error (error);
+  g_assert_true (GOM_IS_CURSOR (cursor));
+
+  records = g_ptr_array_new_with_free_func (g_object_unref);
+
+  while (dex_await_boolean (gom_cursor_next (cursor), &error))
+    {
+      GomRecord *record = gom_cursor_snapshot (cursor, &error);
+
+      g_assert_no_error (error);
+      g_assert_true (GOM_IS_RECORD (record));
+      g_ptr_array_add (records, record);
+    }
+
+  g_assert_no_error (error);
+  g_assert_cmpuint (records->len, ==, n_rows);
+
+  dex_await (gom_cursor_close (cursor), &error);
+  g_assert_no_error (error);
+  g_clear_object (&cursor);
+
+  /* Dropping records out of order must not disturb their neighbours */
+  for (guint i = records->len; i > 0; i--)
+    {
+      if (i % 3 == 0)
+        g_ptr_array_remove_index (records, i - 1);
+    }
+
+  first_name_column = gom_record_get_column_name (g_ptr_array_index (records, 0), 1);
+  g_assert_cmpstr (first_name_column, ==, "name");
+
+  for (guint i = 0; i < records->len; i++)
+    {
+      GomRecord *record = g_ptr_array_index (records, i);
+      gint64 id = gom_record_get_column_int64 (record, 0);
+      g_autofree char *expected = g_strdup_printf ("row-%" G_GINT64_FORMAT, id);
+
+      g_assert_cmpint (id % 3, !=, 0);
+      g_assert_cmpuint (gom_record_get_n_columns (record), ==, 2);
+      g_assert_cmpstr (gom_record_get_column_string (record, 1), ==, expected);
+
+      /* Column names come from a single header shared by every row */
+      g_assert_true (gom_record_get_column_name (record, 1) == first_name_column);
+    }
+}
+
 static void
 test_sqlite_repository_auto_migrate_empty (void)
 {
@@ -5517,11 +6742,16 @@ main (int   argc,
   g_test_init (&argc, &argv, NULL);
   _g_test_add_func ("/Gom/Sqlite/driver-pool", test_sqlite_driver_pool);
   _g_test_add_func ("/Gom/Sqlite/repository-query", test_sqlite_repository_query);
+  _g_test_add_func ("/Gom/Sqlite/repository-query-batch", test_sqlite_repository_query_batch);
   _g_test_add_func ("/Gom/Sqlite/repository-count", test_sqlite_repository_count);
   _g_test_add_func ("/Gom/Sqlite/repository-list-records", test_sqlite_repository_list_records);
   _g_test_add_func ("/Gom/Sqlite/repository-list-entities", test_sqlite_repository_list_entities);
   _g_test_add_func ("/Gom/Sqlite/cursor-move", test_sqlite_cursor_move);
+  _g_test_add_func ("/Gom/Sqlite/cursor-move-in-short-batch", test_sqlite_cursor_move_in_short_batch);
+  _g_test_add_func ("/Gom/Sqlite/cursor-spool", test_sqlite_cursor_spool);
+  _g_test_add_func ("/Gom/Sqlite/group-commit", test_sqlite_group_commit);
   _g_test_add_func ("/Gom/Sqlite/repository-insert", test_sqlite_repository_insert);
+  _g_test_add_func ("/Gom/Sqlite/repository-insert-many-rows", test_sqlite_repository_insert_many_rows);
   _g_test_add_func ("/Gom/Sqlite/repository-insert-during-open-read-cursor", test_sqlite_repository_insert_during_open_read_cursor);
   _g_test_add_func ("/Gom/Sqlite/repository-insert-omits-default-identity", test_sqlite_repository_insert_omits_default_identity);
   _g_test_add_func ("/Gom/Sqlite/repository-insert-unique-constraint", test_sqlite_repository_insert_unique_constraint);
@@ -5535,6 +6765,9 @@ main (int   argc,
   _g_test_add_func ("/Gom/Sqlite/repository-query-unregistered-entity-type", test_sqlite_repository_query_unregistered_entity_type);
   _g_test_add_func ("/Gom/Sqlite/repository-mutate-invalid-entity-field", test_sqlite_repository_mutate_invalid_entity_field);
   _g_test_add_func ("/Gom/Sqlite/repository-update-delete", test_sqlite_repository_update_delete);
+  _g_test_add_func ("/Gom/Sqlite/repository-changes-committed", test_sqlite_repository_changes_committed);
+  _g_test_add_func ("/Gom/Sqlite/repository-changes-committed-failed-mutation", test_sqlite_repository_changes_committed_failed_mutation);
+  _g_test_add_func ("/Gom/Sqlite/repository-changes-committed-group-rollback", test_sqlite_repository_changes_committed_group_rollback);
   _g_test_add_func ("/Gom/Sqlite/entity-crud", test_sqlite_entity_crud);
   _g_test_add_func ("/Gom/Sqlite/entity-crud-errors", test_sqlite_entity_crud_errors);
   _g_test_add_func ("/Gom/Sqlite/entity-default-identity-override", test_sqlite_entity_default_identity_override);
@@ -5544,11 +6777,15 @@ main (int   argc,
   _g_test_add_func ("/Gom/Sqlite/session-rekey-identity-map", test_sqlite_session_rekey_identity_map);
   _g_test_add_func ("/Gom/Sqlite/session-find-one", test_sqlite_session_find_one);
   _g_test_add_func ("/Gom/Sqlite/session-persist-flush-commit", test_sqlite_session_persist_flush_commit);
+  _g_test_add_func ("/Gom/Sqlite/session-flush-batches", test_sqlite_session_flush_batches);
   _g_test_add_func ("/Gom/Sqlite/cursor-snapshot", test_sqlite_cursor_snapshot);
+  _g_test_add_func ("/Gom/Sqlite/cursor-snapshot-shared-header", test_sqlite_cursor_snapshot_shared_header);
+  _g_test_add_func ("/Gom/Sqlite/cursor-peek-column", test_sqlite_cursor_peek_column);
   _g_test_add_func ("/Gom/Sqlite/repository-describe-relation", test_sqlite_repository_describe_relation);
   _g_test_add_func ("/Gom/Sqlite/repository-list-relations", test_sqlite_repository_list_relations);
   _g_test_add_func ("/Gom/Sqlite/repository-search", test_sqlite_repository_search);
   _g_test_add_func ("/Gom/Sqlite/repository-expression-variants", test_sqlite_repository_expression_variants);
+  _g_test_add_func ("/Gom/Sqlite/repository-in-expression", test_sqlite_repository_in_expression);
   _g_test_add_func ("/Gom/Sqlite/repository-vector-distance", test_sqlite_repository_vector_distance);
   _g_test_add_func ("/Gom/Sqlite/repository-auto-migrate-empty", test_sqlite_repository_auto_migrate_empty);
   _g_test_add_func ("/Gom/Sqlite/repository-migrate-v1-to-v2", test_sqlite_repository_migrate_v1_to_v2);
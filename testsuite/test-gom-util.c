@@ -22,6 +22,8 @@
 
 #include <glib.h>
 
+#include "lib/gom-list-diff-private.h"
+#include "lib/gom-page-cache-private.h"
 #include "lib/gom-util-private.h"
 
 static void
@@ -57,6 +59,213 @@ test_gom_util_strv_text_roundtrip (void)
   g_assert_cmpuint (g_strv_length (parsed), ==, 0);
 }
 
+static void
+test_gom_util_list_diff_apply (GPtrArray           *list,
+                               GArray              *hunks,
+                               gconstpointer const *new_items)
+{
+  for (guint i = hunks->len; i > 0; i--)
+    {
+      const GomListDiffHunk *hunk = &g_array_index (hunks, GomListDiffHunk, i - 1);
+
+      g_ptr_array_remove_range (list, hunk->old_position, hunk->n_removed);
+      for (guint j = 0; j < hunk->n_added; j++)
+        g_ptr_array_insert (list,
+                            hunk->old_position + j,
+                            (gpointer)new_items[hunk->new_position + j]);
+    }
+}
+
+static void
+test_gom_util_list_diff (void)
+{
+  static const char *items[] = { "a", "b", "c", "d", "e", "f" };
+  gconstpointer old_items[] = { items[0], items[1], items[2], items[3], items[4] };
+  gconstpointer new_items[] = { items[0], items[2], items[3], items[5], items[4] };
+  gconstpointer old_keys[] = { "1", "2", "3" };
+  gconstpointer new_keys[] = { "1", "3", "4" };
+  gconstpointer keyed_old[] = { &old_keys[0], &old_keys[1], &old_keys[2] };
+  gconstpointer keyed_new[] = { &new_keys[0], &new_keys[1], &new_keys[2] };
+  g_autoptr(GPtrArray) list = g_ptr_array_new ();
+  g_autoptr(GArray) hunks = NULL;
+  const GomListDiffHunk *hunk;
+
+  /* "b" is removed and "f" inserted, everything else stays in place */
+  hunks = _gom_list_diff (old_items, NULL, G_N_ELEMENTS (old_items),
+                          new_items, NULL, G_N_ELEMENTS (new_items),
+                          NULL, GOM_LIST_DIFF_MAX_EDITS);
+  g_assert_cmpuint (hunks->len, ==, 2);
+  hunk = &g_array_index (hunks, GomListDiffHunk, 0);
+  g_assert_cmpuint (hunk->old_position, ==, 1);
+  g_assert_cmpuint (hunk->n_removed, ==, 1);
+  g_assert_cmpuint (hunk->n_added, ==, 0);
+  hunk = &g_array_index (hunks, GomListDiffHunk, 1);
+  g_assert_cmpuint (hunk->old_position, ==, 4);
+  g_assert_cmpuint (hunk->n_removed, ==, 0);
+  g_assert_cmpuint (hunk->new_position, ==, 3);
+  g_assert_cmpuint (hunk->n_added, ==, 1);
+
+  for (guint i = 0; i < G_N_ELEMENTS (old_items); i++)
+    g_ptr_array_add (list, (gpointer)old_items[i]);
+  test_gom_util_list_diff_apply (list, hunks, new_items);
+  g_assert_cmpuint (list->len, ==, G_N_ELEMENTS (new_items));
+  for (guint i = 0; i < list->len; i++)
+    g_assert_true (g_ptr_array_index (list, i) == new_items[i]);
+  g_clear_pointer (&hunks, g_array_unref);
+
+  /* Identical lists need no hunks */
+  hunks = _gom_list_diff (old_items, NULL, G_N_ELEMENTS (old_items),
+                          old_items, NULL, G_N_ELEMENTS (old_items),
+                          NULL, GOM_LIST_DIFF_MAX_EDITS);
+  g_assert_cmpuint (hunks->len, ==, 0);
+  g_clear_pointer (&hunks, g_array_unref);
+
+  /* Items with equal keys match, but new instances still replace old ones */
+  hunks = _gom_list_diff (keyed_old, old_keys, G_N_ELEMENTS (keyed_old),
+                          keyed_new, new_keys, G_N_ELEMENTS (keyed_new),
+                          g_str_equal, GOM_LIST_DIFF_MAX_EDITS);
+  g_ptr_array_set_size (list, 0);
+  for (guint i = 0; i < G_N_ELEMENTS (keyed_old); i++)
+    g_ptr_array_add (list, (gpointer)keyed_old[i]);
+  test_gom_util_list_diff_apply (list, hunks, keyed_new);
+  g_assert_cmpuint (list->len, ==, G_N_ELEMENTS (keyed_new));
+  for (guint i = 0; i < list->len; i++)
+    g_assert_true (g_ptr_array_index (list, i) == keyed_new[i]);
+  g_clear_pointer (&hunks, g_array_unref);
+
+  /* Past the edit limit everything between prefix and suffix is replaced */
+  hunks = _gom_list_diff (old_items, NULL, G_N_ELEMENTS (old_items),
+                          new_items, NULL, G_N_ELEMENTS (new_items),
+                          NULL, 1);
+  g_assert_cmpuint (hunks->len, ==, 1);
+  hunk = &g_array_index (hunks, GomListDiffHunk, 0);
+  g_assert_cmpuint (hunk->old_position, ==, 1);
+  g_assert_cmpuint (hunk->n_removed, ==, 3);
+  g_assert_cmpuint (hunk->n_added, ==, 3);
+}
+
+static gboolean
+test_gom_util_page_cache_evict_cb (guint    page_index,
+                                   gpointer page,
+                                   gpointer user_data)
+{
+  guint *pinned = user_data;
+
+  return page_index != *pinned;
+}
+
+static void
+test_gom_util_page_cache (void)
+{
+  g_autoptr(GomPageCache) cache = _gom_page_cache_new (g_free);
+  guint pinned = G_MAXUINT;
+
+  /* Without a budget nothing is evicted */
+  for (guint i = 0; i < 4; i++)
+    _gom_page_cache_insert (cache, i, g_strdup_printf ("%u", i));
+  g_assert_cmpuint (_gom_page_cache_evict (cache, NULL, NULL), ==, 0);
+  g_assert_cmpuint (_gom_page_cache_get_size (cache), ==, 4);
+
+  /* Looking up page 0 makes it the most recently used one, so pages 1
+   * and 2 go first.
+   */
+  g_assert_cmpstr (_gom_page_cache_lookup (cache, 0), ==, "0");
+  _gom_page_cache_set_max_pages (cache, 2);
+  g_assert_cmpuint (_gom_page_cache_evict (cache, NULL, NULL), ==, 2);
+  g_assert_null (_gom_page_cache_peek (cache, 1));
+  g_assert_null (_gom_page_cache_peek (cache, 2));
+  g_assert_nonnull (_gom_page_cache_peek (cache, 3));
+  g_assert_nonnull (_gom_page_cache_peek (cache, 0));
+
+  /* Pages the callback refuses are skipped */
+  pinned = 3;
+  _gom_page_cache_insert (cache, 4, g_strdup ("4"));
+  g_assert_cmpuint (_gom_page_cache_evict (cache, test_gom_util_page_cache_evict_cb, &pinned), ==, 1);
+  g_assert_nonnull (_gom_page_cache_peek (cache, 3));
+  g_assert_null (_gom_page_cache_peek (cache, 0));
+
+  /* The most recently used page is never evicted */
+  _gom_page_cache_set_max_pages (cache, 1);
+  pinned = G_MAXUINT;
+  g_assert_cmpuint (_gom_page_cache_evict (cache, test_gom_util_page_cache_evict_cb, &pinned), ==, 1);
+  g_assert_cmpuint (_gom_page_cache_get_size (cache), ==, 1);
+  g_assert_cmpstr (_gom_page_cache_peek (cache, 4), ==, "4");
+
+  _gom_page_cache_remove_all (cache);
+  g_assert_cmpuint (_gom_page_cache_get_size (cache), ==, 0);
+}
+
+static void
+test_gom_util_read_ahead (void)
+{
+  g_autoptr(GomPageCache) cache = _gom_page_cache_new (g_free);
+  guint window[GOM_READ_AHEAD_MAX_PAGES];
+  GomReadAhead read_ahead;
+  guint n_window = 0;
+
+  /* The first request has no direction yet */
+  _gom_read_ahead_reset (&read_ahead);
+  g_assert_true (_gom_read_ahead_update (&read_ahead, 5, 20, 4, window, &n_window));
+  g_assert_cmpuint (n_window, ==, 0);
+
+  /* Scrolling forward grows the window with the streak */
+  g_assert_true (_gom_read_ahead_update (&read_ahead, 6, 20, 4, window, &n_window));
+  g_assert_cmpuint (n_window, ==, 1);
+  g_assert_cmpuint (window[0], ==, 7);
+
+  g_assert_true (_gom_read_ahead_update (&read_ahead, 7, 20, 4, window, &n_window));
+  g_assert_cmpuint (n_window, ==, 2);
+  g_assert_cmpuint (window[0], ==, 8);
+  g_assert_cmpuint (window[1], ==, 9);
+
+  /* Staying on the same page leaves the window alone */
+  g_assert_false (_gom_read_ahead_update (&read_ahead, 7, 20, 4, window, &n_window));
+  g_assert_cmpuint (n_window, ==, 2);
+  g_assert_true (_gom_read_ahead_contains (window, n_window, 9));
+  g_assert_false (_gom_read_ahead_contains (window, n_window, 10));
+
+  g_assert_true (_gom_read_ahead_update (&read_ahead, 9, 20, 4, window, &n_window));
+  g_assert_cmpuint (n_window, ==, 4);
+  g_assert_cmpuint (window[0], ==, 10);
+  g_assert_cmpuint (window[3], ==, 13);
+
+  /* Turning around starts over in the other direction */
+  g_assert_true (_gom_read_ahead_update (&read_ahead, 8, 20, 4, window, &n_window));
+  g_assert_cmpuint (n_window, ==, 1);
+  g_assert_cmpuint (window[0], ==, 7);
+
+  /* A long jump is random access, and nothing is read past the end */
+  g_assert_true (_gom_read_ahead_update (&read_ahead, 18, 20, 4, window, &n_window));
+  g_assert_cmpuint (n_window, ==, 0);
+  g_assert_true (_gom_read_ahead_update (&read_ahead, 19, 20, 4, window, &n_window));
+  g_assert_cmpuint (n_window, ==, 0);
+
+  /* Nor before the start */
+  _gom_read_ahead_reset (&read_ahead);
+  g_assert_true (_gom_read_ahead_update (&read_ahead, 2, 20, 4, window, &n_window));
+  g_assert_true (_gom_read_ahead_update (&read_ahead, 1, 20, 4, window, &n_window));
+  g_assert_cmpuint (n_window, ==, 1);
+  g_assert_cmpuint (window[0], ==, 0);
+  g_assert_true (_gom_read_ahead_update (&read_ahead, 0, 20, 4, window, &n_window));
+  g_assert_cmpuint (n_window, ==, 0);
+
+  /* The depth is bounded by the caller */
+  _gom_read_ahead_reset (&read_ahead);
+  for (guint i = 0; i < 4; i++)
+    _gom_read_ahead_update (&read_ahead, i, 20, 1, window, &n_window);
+  g_assert_cmpuint (n_window, ==, 1);
+  g_assert_cmpuint (window[0], ==, 4);
+
+  /* Read-ahead only uses part of the page budget */
+  g_assert_cmpuint (_gom_page_cache_max_read_ahead (cache), ==, GOM_READ_AHEAD_MAX_PAGES);
+  _gom_page_cache_set_max_pages (cache, 16);
+  g_assert_cmpuint (_gom_page_cache_max_read_ahead (cache), ==, 4);
+  _gom_page_cache_set_max_pages (cache, 5);
+  g_assert_cmpuint (_gom_page_cache_max_read_ahead (cache), ==, 2);
+  _gom_page_cache_set_max_pages (cache, 1);
+  g_assert_cmpuint (_gom_page_cache_max_read_ahead (cache), ==, 0);
+}
+
 int
 main (int   argc,
       char *argv[])
@@ -64,6 +273,9 @@ main (int   argc,
   g_test_init (&argc, &argv, NULL);
 
   g_test_add_func ("/Gom/Util/strv-text-roundtrip", test_gom_util_strv_text_roundtrip);
+  g_test_add_func ("/Gom/Util/list-diff", test_gom_util_list_diff);
+  g_test_add_func ("/Gom/Util/page-cache", test_gom_util_page_cache);
+  g_test_add_func ("/Gom/Util/read-ahead", test_gom_util_read_ahead);
 
   return g_test_run ();
 }
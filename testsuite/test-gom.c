@@ -25,6 +25,7 @@
 #include "lib/gom-delta.h"
 #include "lib/gom-cursor-private.h"
 #include "lib/gom-entity-private.h"
+#include "lib/gom-identity-key-private.h"
 #include "lib/gom-query-private.h"
 #include "lib/gom-session-private.h"
 #include "lib/gom-value-private.h"
@@ -1291,6 +1292,109 @@ test_value_identity_key_unsupported (void)
   g_assert_null (key);
 }
 
+static GomIdentityKey *
+build_identity_key (GType         entity_type,
+                    const GValue *first,
+                    const GValue *second)
+{
+  GomIdentityKeyBuilder builder;
+
+  _gom_identity_key_builder_init (&builder, entity_type);
+  g_assert_true (_gom_identity_key_builder_append (&builder, first));
+  if (second != NULL)
+    g_assert_true (_gom_identity_key_builder_append (&builder, second));
+
+  return _gom_identity_key_builder_end (&builder);
+}
+
+static void
+test_identity_key (void)
+{
+  g_autoptr(GomIdentityKey) int_key = NULL;
+  g_autoptr(GomIdentityKey) int64_key = NULL;
+  g_autoptr(GomIdentityKey) string_key = NULL;
+  g_autoptr(GomIdentityKey) other_type_key = NULL;
+  g_autoptr(GomIdentityKey) composite_key = NULL;
+  g_autoptr(GomIdentityKey) swapped_key = NULL;
+  g_autoptr(GomIdentityKey) long_key = NULL;
+  g_autoptr(GHashTable) map = NULL;
+  g_auto(GValue) int_value = G_VALUE_INIT;
+  g_auto(GValue) int64_value = G_VALUE_INIT;
+  g_auto(GValue) string_value = G_VALUE_INIT;
+  g_auto(GValue) other_string_value = G_VALUE_INIT;
+  g_auto(GValue) long_value = G_VALUE_INIT;
+  g_auto(GValue) object_value = G_VALUE_INIT;
+  g_autofree char *long_string = g_strnfill (4096, 'x');
+  GomIdentityKeyBuilder builder;
+  const GomIdentityKey *peeked;
+
+  g_value_init (&int_value, G_TYPE_INT);
+  g_value_set_int (&int_value, 42);
+  g_value_init (&int64_value, G_TYPE_INT64);
+  g_value_set_int64 (&int64_value, 42);
+  g_value_init (&string_value, G_TYPE_STRING);
+  g_value_set_static_string (&string_value, "42");
+  g_value_init (&other_string_value, G_TYPE_STRING);
+  g_value_set_static_string (&other_string_value, "b");
+  g_value_init (&long_value, G_TYPE_STRING);
+  g_value_set_string (&long_value, long_string);
+
+  int_key = build_identity_key (G_TYPE_OBJECT, &int_value, NULL);
+  int64_key = build_identity_key (G_TYPE_OBJECT, &int64_value, NULL);
+  string_key = build_identity_key (G_TYPE_OBJECT, &string_value, NULL);
+  other_type_key = build_identity_key (GOM_TYPE_ENTITY, &int_value, NULL);
+  composite_key = build_identity_key (G_TYPE_OBJECT, &int_value, &other_string_value);
+  swapped_key = build_identity_key (G_TYPE_OBJECT, &other_string_value, &int_value);
+  long_key = build_identity_key (G_TYPE_OBJECT, &long_value, NULL);
+
+  /* Integer widths are normalized, but kinds and entity types are not */
+  g_assert_true (_gom_identity_key_equal (int_key, int64_key));
+  g_assert_cmpuint (_gom_identity_key_hash (int_key), ==, _gom_identity_key_hash (int64_key));
+  g_assert_false (_gom_identity_key_equal (int_key, string_key));
+  g_assert_false (_gom_identity_key_equal (int_key, other_type_key));
+  g_assert_false (_gom_identity_key_equal (composite_key, swapped_key));
+  g_assert_false (_gom_identity_key_equal (int_key, composite_key));
+
+  map = g_hash_table_new_full (_gom_identity_key_hash,
+                               _gom_identity_key_equal,
+                               (GDestroyNotify)_gom_identity_key_unref,
+                               NULL);
+  g_hash_table_insert (map, _gom_identity_key_ref (int_key), GINT_TO_POINTER (1));
+  g_hash_table_insert (map, _gom_identity_key_ref (long_key), GINT_TO_POINTER (2));
+  g_hash_table_insert (map, _gom_identity_key_ref (composite_key), GINT_TO_POINTER (3));
+
+  /* Borrowed keys probe without allocating, including once spilled */
+  _gom_identity_key_builder_init (&builder, G_TYPE_OBJECT);
+  g_assert_true (_gom_identity_key_builder_append (&builder, &int64_value));
+  peeked = _gom_identity_key_builder_peek (&builder);
+  g_assert_nonnull (peeked);
+  g_assert_cmpint (GPOINTER_TO_INT (g_hash_table_lookup (map, peeked)), ==, 1);
+  _gom_identity_key_builder_clear (&builder);
+
+  _gom_identity_key_builder_init (&builder, G_TYPE_OBJECT);
+  g_assert_true (_gom_identity_key_builder_append (&builder, &long_value));
+  peeked = _gom_identity_key_builder_peek (&builder);
+  g_assert_cmpint (GPOINTER_TO_INT (g_hash_table_lookup (map, peeked)), ==, 2);
+  _gom_identity_key_builder_clear (&builder);
+
+  _gom_identity_key_builder_init (&builder, G_TYPE_OBJECT);
+  g_assert_true (_gom_identity_key_builder_append (&builder, &string_value));
+  g_assert_null (g_hash_table_lookup (map, _gom_identity_key_builder_peek (&builder)));
+  _gom_identity_key_builder_clear (&builder);
+
+  /* Unsupported values poison the builder */
+  g_value_init (&object_value, G_TYPE_OBJECT);
+  _gom_identity_key_builder_init (&builder, G_TYPE_OBJECT);
+  g_test_expect_message ("Gom",
+                         G_LOG_LEVEL_CRITICAL,
+                         "*unsupported value type `GObject`*");
+  g_assert_false (_gom_identity_key_builder_append (&builder, &object_value));
+  g_test_assert_expected_messages ();
+  g_assert_false (_gom_identity_key_builder_append (&builder, &int_value));
+  g_assert_null (_gom_identity_key_builder_peek (&builder));
+  g_assert_null (_gom_identity_key_builder_end (&builder));
+}
+
 static void
 test_cursor_materialize_discriminator (void)
 {
@@ -1500,6 +1604,7 @@ main (int   argc,
   _g_test_add_func ("/Gom/migration/sql", test_sql_migration_api);
   _g_test_add_func ("/Gom/value/identity-key", test_value_identity_key);
   _g_test_add_func ("/Gom/value/identity-key-unsupported", test_value_identity_key_unsupported);
+  _g_test_add_func ("/Gom/identity-key/basic", test_identity_key);
   _g_test_add_func ("/Gom/cursor/default-exhaust-getters", test_cursor_default_exhaust_and_getters);
   _g_test_add_func ("/Gom/cursor/get-count", test_cursor_get_count);
   _g_test_add_func ("/Gom/cursor/materialize-discriminator", test_cursor_materialize_discriminator);